@@ -60,15 +60,20 @@
 #define QTH_CFG_GPSD_SERVER_KEY "GPSDSERVER"
 #define QTH_CFG_GPSD_PORT_KEY  "GPSDPORT"
 #define QTH_CFG_TYPE_KEY       "QTH_TYPE"
+#define QTH_CFG_TRACK_KEY      "TRACK"
 
 /* Module files (.mod) */
 
 /* global */
 #define MOD_CFG_GLOBAL_SECTION  "GLOBAL"
 #define MOD_CFG_QTH_FILE_KEY    "QTHFILE"
+#define MOD_CFG_QTH_FILES_KEY   "QTHFILES"    /* Additional ground stations */
+#define MOD_CFG_VIEW_QTH        "VIEW_QTH"    /* Ground station of each view */
 #define MOD_CFG_SATS_KEY        "SATELLITES"
 #define MOD_CFG_TIMEOUT_KEY     "TIMEOUT"
 #define MOD_CFG_WARP_KEY        "WARP"
+#define MOD_CFG_SERVER_KEY      "SERVER"      /* Tracking data server address */
+#define MOD_CFG_SHM_KEY         "SHM"         /* Shared memory snapshot name */
 #define MOD_CFG_LAYOUT          "LAYOUT"      /* Old layout before v1.2 */
 #define MOD_CFG_VIEW_1          "VIEW_1"      /* Old layout before v1.2 */
 #define MOD_CFG_VIEW_2          "VIEW_2"      /* Old layout before v1.2 */
@@ -113,6 +118,7 @@
 #define MOD_CFG_MAP_SHADOW_ALPHA      "SHADOW_ALPHA"
 #define MOD_CFG_MAP_SHOWTRACKS        "SHOWTRACKS"
 #define MOD_CFG_MAP_HIDECOVS          "HIDECOVS"
+#define MOD_CFG_MAP_CAIRO             "CAIRO_RENDERER"
 
 /* polar view specific */
 #define MOD_CFG_POLAR_SECTION          "POLAR"
@@ -0,0 +1,718 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Conjunction screening between satellites.
+ *
+ * Close approaches are found in three stages:
+ *
+ *  1. Apogee/perigee filter: pairs whose radial bands do not overlap within
+ *     the threshold can never meet and are not screened.
+ *  2. Coarse screening: all satellites are propagated at fixed steps and
+ *     binned in a grid of cubes. Only satellites in neighbouring cubes are
+ *     compared, and a pair becomes a candidate when its distance is below a
+ *     bound that covers the relative motion over half a step.
+ *  3. Refinement: around each local minimum of the sampled distance, the
+ *     time of closest approach is found by bisection on the range rate.
+ *
+ * The coarse screening is split into blocks of time steps and the
+ * refinement into satellite pairs; both run on a GThreadPool with per-job
+ * copies of the satellites.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "conjunction.h"
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "sat-log.h"
+
+
+/** \brief Margin of the apogee/perigee filter for perturbations and decay [km]. */
+#define CJ_ORBIT_MARGIN  50.0
+
+/** \brief Upper bound of the gravitational acceleration [km/sec^2]. */
+#define CJ_GMAX          9.81e-3
+
+/** \brief Number of coarse steps in a screening job. */
+#define CJ_BLOCK         60
+
+/** \brief Tolerance of the time of closest approach [days]. */
+#define CJ_TCA_TOL       (1.0e-3/86400.0)
+
+/** \brief Offset of the grid cube indices in the cube key. */
+#define CJ_KEY_OFFSET    (1 << 20)
+
+
+/** \brief A pair that came close at a coarse step; i < j. */
+typedef struct {
+    guint       i;          /*!< Index of the first satellite */
+    guint       j;          /*!< Index of the second satellite */
+    guint       k;          /*!< Coarse step */
+    gdouble     d;          /*!< Distance at the step [km] */
+} cj_cand_t;
+
+/** \brief A satellite binned in the grid. */
+typedef struct {
+    guint64     key;        /*!< Grid cube */
+    guint       s;          /*!< Index in the work array */
+} cj_point_t;
+
+/** \brief Worker state shared by the jobs of one run. */
+typedef struct {
+    conjunction_t *cj;
+    guint      *idx;        /*!< Satellites that passed the orbit filter */
+    guint       n;          /*!< Number of entries in idx */
+    gdouble    *rp;         /*!< Lowest radius of each satellite [km] */
+    gdouble    *ra;         /*!< Highest radius of each satellite [km] */
+    gboolean   *query;      /*!< Pairs are looked up from this satellite */
+    guint       nsteps;     /*!< Number of coarse steps */
+    GMutex      lock;       /*!< Protects cand and cj->events */
+    GArray     *cand;       /*!< Candidates of all screening jobs */
+    GArray     *groups;     /*!< Start of each pair in cand, plus the end */
+} cj_run_t;
+
+
+static void     screen_job(gpointer data, gpointer user_data);
+static void     refine_job(gpointer data, gpointer user_data);
+static void     write_event(FILE * f, conjunction_event_t * ev);
+
+
+/**
+ * \brief Create a new conjunction screening.
+ * \param start Start of the time window [Julian days].
+ * \param stop End of the time window [Julian days].
+ * \param threshold Report approaches closer than this [km].
+ */
+conjunction_t  *conjunction_new(gdouble start, gdouble stop,
+                                gdouble threshold)
+{
+    conjunction_t  *cj = g_new0(conjunction_t, 1);
+
+    cj->start = start;
+    cj->stop = stop;
+    cj->threshold = threshold;
+    cj->step = CONJUNCTION_STEP;
+    cj->sats = g_ptr_array_new();
+    cj->primary = g_array_new(FALSE, FALSE, sizeof(gboolean));
+    cj->events = g_array_new(FALSE, FALSE, sizeof(conjunction_event_t));
+
+    return cj;
+}
+
+
+/** \brief Free a conjunction screening and its results. */
+void conjunction_free(conjunction_t * cj)
+{
+    guint           i;
+
+    if (cj == NULL)
+        return;
+
+    for (i = 0; i < cj->sats->len; i++)
+        gtk_sat_data_free_sat(g_ptr_array_index(cj->sats, i));
+    g_ptr_array_free(cj->sats, TRUE);
+    g_array_free(cj->primary, TRUE);
+    g_array_free(cj->events, TRUE);
+    g_free(cj);
+}
+
+
+/**
+ * \brief Add a satellite.
+ * \param cj The conjunction screening.
+ * \param sat The satellite; it is copied.
+ * \param primary Whether this is one of the satellites to screen.
+ */
+void conjunction_add_sat(conjunction_t * cj, const sat_t * sat,
+                         gboolean primary)
+{
+    sat_t          *copy = g_new(sat_t, 1);
+
+    memcpy(copy, sat, sizeof(sat_t));
+    copy->name = g_strdup(sat->name);
+    copy->nickname = g_strdup(sat->nickname);
+    copy->website = NULL;
+
+    g_ptr_array_add(cj->sats, copy);
+    g_array_append_val(cj->primary, primary);
+    if (primary)
+        cj->nprimary++;
+}
+
+
+/** \brief Check whether the radial bands of two satellites overlap. */
+static inline gboolean bands_overlap(cj_run_t * run, guint i, guint j)
+{
+    return (MAX(run->rp[i], run->rp[j]) - MIN(run->ra[i], run->ra[j]) <=
+            run->cj->threshold);
+}
+
+
+static gint band_cmp(gconstpointer a, gconstpointer b, gpointer data)
+{
+    cj_run_t       *run = data;
+    gdouble         ra = run->rp[*(const guint *)a];
+    gdouble         rb = run->rp[*(const guint *)b];
+
+    return (ra < rb) ? -1 : ((ra > rb) ? 1 : 0);
+}
+
+
+/**
+ * \brief Apogee/perigee filter.
+ *
+ * Computes the radial band of each satellite and keeps the satellites whose
+ * band overlaps the band of a satellite they are screened against.
+ */
+static void orbit_filter(cj_run_t * run)
+{
+    conjunction_t  *cj = run->cj;
+    sat_t          *sat;
+    gboolean       *keep;
+    guint          *order;
+    gdouble         sma, maxra;
+    guint           i, j, n = cj->sats->len, nvalid = 0;
+
+    run->rp = g_new(gdouble, n);
+    run->ra = g_new(gdouble, n);
+    run->query = g_new(gboolean, n);
+    run->idx = g_new(guint, n);
+    keep = g_new0(gboolean, n);
+    order = g_new(guint, n);
+
+    for (i = 0; i < n; i++)
+    {
+        sat = g_ptr_array_index(cj->sats, i);
+        sat->jul_utc = cj->start;
+        run->query[i] = (cj->nprimary == 0) ||
+            g_array_index(cj->primary, gboolean, i);
+
+        if ((sat->meanmo <= 0.0) || decayed(sat))
+        {
+            run->rp[i] = G_MAXDOUBLE;
+            run->ra[i] = -G_MAXDOUBLE;
+            continue;
+        }
+
+        /* same as in has_aos() */
+        sma = 331.25 * exp(log(1440.0 / sat->meanmo) * (2.0 / 3.0));
+        run->rp[i] = sma * (1.0 - sat->tle.eo) - CJ_ORBIT_MARGIN;
+        run->ra[i] = sma * (1.0 + sat->tle.eo) + CJ_ORBIT_MARGIN;
+        order[nvalid++] = i;
+    }
+
+    if (cj->nprimary > 0)
+    {
+        /* few primaries: check them against everything */
+        for (i = 0; i < nvalid; i++)
+        {
+            if (!run->query[order[i]])
+                continue;
+            for (j = 0; j < nvalid; j++)
+                if ((i != j) && bands_overlap(run, order[i], order[j]))
+                    keep[order[i]] = keep[order[j]] = TRUE;
+        }
+    }
+    else
+    {
+        /* sweep the bands sorted by perigee */
+        g_qsort_with_data(order, nvalid, sizeof(guint), band_cmp, run);
+        maxra = -G_MAXDOUBLE;
+        for (i = 0; i < nvalid; i++)
+        {
+            if ((maxra >= run->rp[order[i]] - cj->threshold) ||
+                ((i + 1 < nvalid) && bands_overlap(run, order[i],
+                                                   order[i + 1])))
+                keep[order[i]] = TRUE;
+            maxra = MAX(maxra, run->ra[order[i]]);
+        }
+    }
+
+    run->n = 0;
+    for (i = 0; i < n; i++)
+        if (keep[i])
+            run->idx[run->n++] = i;
+
+    g_free(keep);
+    g_free(order);
+}
+
+
+/** \brief Grid cube of a position. */
+static inline guint64 cube_key(gint cx, gint cy, gint cz)
+{
+    return ((guint64) (CLAMP(cx + CJ_KEY_OFFSET, 0, 2 * CJ_KEY_OFFSET - 1))
+            << 42) |
+        ((guint64) (CLAMP(cy + CJ_KEY_OFFSET, 0, 2 * CJ_KEY_OFFSET - 1))
+         << 21) |
+        (guint64) (CLAMP(cz + CJ_KEY_OFFSET, 0, 2 * CJ_KEY_OFFSET - 1));
+}
+
+
+static gint point_cmp(const void *a, const void *b)
+{
+    guint64         ka = ((const cj_point_t *)a)->key;
+    guint64         kb = ((const cj_point_t *)b)->key;
+
+    return (ka < kb) ? -1 : ((ka > kb) ? 1 : 0);
+}
+
+
+/** \brief Index of the first point in cube key, or n if there is none. */
+static guint find_cube(cj_point_t * pts, guint n, guint64 key)
+{
+    guint           lo = 0, hi = n, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (pts[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+static inline gdouble vec_dist(vector_t * a, vector_t * b)
+{
+    return sqrt((a->x - b->x) * (a->x - b->x) +
+                (a->y - b->y) * (a->y - b->y) +
+                (a->z - b->z) * (a->z - b->z));
+}
+
+
+/**
+ * \brief Run one screening job: a block of coarse steps.
+ *
+ * If two satellites are within the threshold at some time, they are within
+ * threshold + dv*dt/2 + a*dt^2 at the nearest step, where dv is the relative
+ * velocity at that step and a bounds the relative acceleration. The cube
+ * size is the largest such bound, so that a pair can only become a
+ * candidate if the satellites are in neighbouring cubes.
+ */
+static void screen_job(gpointer data, gpointer user_data)
+{
+    cj_run_t       *run = user_data;
+    conjunction_t  *cj = run->cj;
+    guint           block = GPOINTER_TO_UINT(data) - 1;
+    sat_t          *work;
+    cj_point_t     *pts;
+    cj_cand_t       c;
+    GArray         *cand;
+    gint           *cube;
+    gint            dx, dy, dz;
+    guint64         key;
+    guint           a, b, k, sa, sb, ga, gb, n = run->n;
+    gdouble         dt = cj->step, vmax, v, cell, accel, d, dv;
+
+    work = g_new(sat_t, n);
+    for (a = 0; a < n; a++)
+        memcpy(&work[a], g_ptr_array_index(cj->sats, run->idx[a]),
+               sizeof(sat_t));
+    pts = g_new(cj_point_t, n);
+    cube = g_new(gint, 3 * n);
+    cand = g_array_new(FALSE, FALSE, sizeof(cj_cand_t));
+
+    accel = 2.0 * CJ_GMAX * dt * dt / 2.0;
+
+    for (k = block * CJ_BLOCK;
+         (k < (block + 1) * CJ_BLOCK) && (k < run->nsteps); k++)
+    {
+        vmax = 0.0;
+        for (a = 0; a < n; a++)
+        {
+            predict_calc_state(&work[a], cj->start + k * dt / 86400.0);
+            v = sqrt(work[a].vel.x * work[a].vel.x +
+                     work[a].vel.y * work[a].vel.y +
+                     work[a].vel.z * work[a].vel.z);
+            vmax = MAX(vmax, v);
+        }
+
+        cell = cj->threshold + vmax * dt + accel;
+        for (a = 0; a < n; a++)
+        {
+            cube[3 * a] = (gint) floor(work[a].pos.x / cell);
+            cube[3 * a + 1] = (gint) floor(work[a].pos.y / cell);
+            cube[3 * a + 2] = (gint) floor(work[a].pos.z / cell);
+            pts[a].key = cube_key(cube[3 * a], cube[3 * a + 1],
+                                  cube[3 * a + 2]);
+            pts[a].s = a;
+        }
+        qsort(pts, n, sizeof(cj_point_t), point_cmp);
+
+        for (sa = 0; sa < n; sa++)
+        {
+            ga = run->idx[sa];
+            if (!run->query[ga])
+                continue;
+
+            for (dx = -1; dx <= 1; dx++)
+                for (dy = -1; dy <= 1; dy++)
+                    for (dz = -1; dz <= 1; dz++)
+                    {
+                        key = cube_key(cube[3 * sa] + dx,
+                                       cube[3 * sa + 1] + dy,
+                                       cube[3 * sa + 2] + dz);
+                        for (b = find_cube(pts, n, key);
+                             (b < n) && (pts[b].key == key); b++)
+                        {
+                            sb = pts[b].s;
+                            gb = run->idx[sb];
+
+                            /* each pair once */
+                            if ((sb == sa) || (run->query[gb] && (gb < ga)))
+                                continue;
+
+                            if ((work[sa].tle.catnr == work[sb].tle.catnr) ||
+                                !bands_overlap(run, ga, gb))
+                                continue;
+
+                            d = vec_dist(&work[sa].pos, &work[sb].pos);
+                            dv = vec_dist(&work[sa].vel, &work[sb].vel);
+                            if (d <= cj->threshold + dv * dt / 2.0 + accel)
+                            {
+                                c.i = MIN(ga, gb);
+                                c.j = MAX(ga, gb);
+                                c.k = k;
+                                c.d = d;
+                                g_array_append_val(cand, c);
+                            }
+                        }
+                    }
+        }
+    }
+
+    g_mutex_lock(&run->lock);
+    g_array_append_vals(run->cand, cand->data, cand->len);
+    g_mutex_unlock(&run->lock);
+
+    g_array_free(cand, TRUE);
+    g_free(cube);
+    g_free(pts);
+    g_free(work);
+}
+
+
+/** \brief Range rate times range of two satellites at time t [km^2/sec]. */
+static gdouble approach_rate(sat_t * s1, sat_t * s2, gdouble t)
+{
+    vector_t        dr, dv;
+
+    predict_calc_state(s1, t);
+    predict_calc_state(s2, t);
+    Vec_Sub(&s1->pos, &s2->pos, &dr);
+    Vec_Sub(&s1->vel, &s2->vel, &dv);
+
+    return Dot(&dr, &dv);
+}
+
+
+/**
+ * \brief Find the time of closest approach in [a;b].
+ * \return TRUE if the distance has a minimum inside the interval.
+ *
+ * The range rate is negative before and positive after the closest
+ * approach, so its root is found by bisection.
+ */
+static gboolean find_tca(sat_t * s1, sat_t * s2, gdouble a, gdouble b,
+                         conjunction_event_t * ev)
+{
+    gdouble         m;
+
+    if ((approach_rate(s1, s2, a) >= 0.0) ||
+        (approach_rate(s1, s2, b) <= 0.0))
+        return FALSE;
+
+    while (b - a > CJ_TCA_TOL)
+    {
+        m = 0.5 * (a + b);
+        if (approach_rate(s1, s2, m) < 0.0)
+            a = m;
+        else
+            b = m;
+    }
+
+    ev->tca = 0.5 * (a + b);
+    predict_calc_state(s1, ev->tca);
+    predict_calc_state(s2, ev->tca);
+    ev->miss = vec_dist(&s1->pos, &s2->pos);
+    ev->relvel = vec_dist(&s1->vel, &s2->vel);
+
+    return TRUE;
+}
+
+
+/**
+ * \brief Run one refinement job: the candidates of a satellite pair.
+ *
+ * Each local minimum of the sampled distance is refined between the
+ * neighbouring steps. Missing neighbours were not candidates and are
+ * taken to be farther away.
+ */
+static void refine_job(gpointer data, gpointer user_data)
+{
+    cj_run_t       *run = user_data;
+    conjunction_t  *cj = run->cj;
+    guint           g = GPOINTER_TO_UINT(data) - 1;
+    guint           first = g_array_index(run->groups, guint, g);
+    guint           last = g_array_index(run->groups, guint, g + 1);
+    cj_cand_t      *c = &g_array_index(run->cand, cj_cand_t, 0);
+    sat_t           s1, s2;
+    conjunction_event_t ev;
+    gdouble         t, dt = cj->step / 86400.0;
+    guint           r;
+
+    memcpy(&s1, g_ptr_array_index(cj->sats, c[first].i), sizeof(sat_t));
+    memcpy(&s2, g_ptr_array_index(cj->sats, c[first].j), sizeof(sat_t));
+    ev.catnr1 = s1.tle.catnr;
+    ev.catnr2 = s2.tle.catnr;
+    ev.name1 = s1.nickname;
+    ev.name2 = s2.nickname;
+
+    for (r = first; r < last; r++)
+    {
+        if ((r > first) && (c[r - 1].k + 1 == c[r].k) &&
+            (c[r - 1].d <= c[r].d))
+            continue;
+        if ((r + 1 < last) && (c[r + 1].k == c[r].k + 1) &&
+            (c[r + 1].d < c[r].d))
+            continue;
+
+        t = cj->start + c[r].k * dt;
+        if (!find_tca(&s1, &s2, MAX(t - dt, cj->start), MIN(t + dt, cj->stop),
+                      &ev))
+            continue;
+
+        if (ev.miss <= cj->threshold)
+        {
+            g_mutex_lock(&run->lock);
+            g_array_append_val(cj->events, ev);
+            g_mutex_unlock(&run->lock);
+        }
+    }
+}
+
+
+static gint cand_cmp(gconstpointer a, gconstpointer b)
+{
+    const cj_cand_t *ca = a;
+    const cj_cand_t *cb = b;
+
+    if (ca->i != cb->i)
+        return (ca->i < cb->i) ? -1 : 1;
+    if (ca->j != cb->j)
+        return (ca->j < cb->j) ? -1 : 1;
+    if (ca->k != cb->k)
+        return (ca->k < cb->k) ? -1 : 1;
+
+    return 0;
+}
+
+
+static gint event_cmp(gconstpointer a, gconstpointer b)
+{
+    gdouble         ta = ((const conjunction_event_t *)a)->tca;
+    gdouble         tb = ((const conjunction_event_t *)b)->tca;
+
+    return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+
+/** \brief Run the jobs 1..njobs on a new thread pool and wait for them. */
+static gboolean run_jobs(GFunc func, cj_run_t * run, guint njobs,
+                         gint nthreads)
+{
+    GThreadPool    *pool;
+    GError         *err = NULL;
+    guint           i;
+
+    pool = g_thread_pool_new(func, run, nthreads, FALSE, &err);
+    if (pool == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create worker threads (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        return FALSE;
+    }
+
+    for (i = 0; i < njobs; i++)
+        g_thread_pool_push(pool, GUINT_TO_POINTER(i + 1), NULL);
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+
+    return TRUE;
+}
+
+
+/**
+ * \brief Run the screening.
+ * \param cj The conjunction screening.
+ * \param csvfile File to write the conjunctions to, or NULL.
+ * \return TRUE if the screening was completed.
+ *
+ * This function blocks until the screening is finished. The conjunctions
+ * are stored in cj->events sorted by TCA and the names in the events point
+ * to the satellites of cj.
+ */
+gboolean conjunction_run(conjunction_t * cj, const gchar * csvfile)
+{
+    cj_run_t        run;
+    FILE           *f = NULL;
+    cj_cand_t      *c;
+    conjunction_event_t *ev;
+    guint           i, nblocks;
+    gint            nthreads;
+    gboolean        ok;
+
+    if (csvfile != NULL)
+    {
+        f = g_fopen(csvfile, "w");
+        if (f == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not open %s for writing"),
+                        __func__, csvfile);
+            return FALSE;
+        }
+    }
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+    nthreads = g_get_num_processors();
+#else
+    nthreads = CONJUNCTION_THREADS;
+#endif
+
+    g_array_set_size(cj->events, 0);
+
+    memset(&run, 0, sizeof(run));
+    run.cj = cj;
+    g_mutex_init(&run.lock);
+    run.cand = g_array_new(FALSE, FALSE, sizeof(cj_cand_t));
+    run.groups = g_array_new(FALSE, FALSE, sizeof(guint));
+    run.nsteps = (guint) floor((cj->stop - cj->start) * 86400.0 / cj->step) + 1;
+
+    orbit_filter(&run);
+    cj->screened = run.n;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Screening %u of %u satellites in %u steps "
+                  "in %d threads"), __func__, run.n, cj->sats->len,
+                run.nsteps, nthreads);
+
+    /* coarse screening */
+    nblocks = (run.nsteps + CJ_BLOCK - 1) / CJ_BLOCK;
+    ok = run_jobs(screen_job, &run, nblocks, nthreads);
+
+    /* group the candidates by pair */
+    if (ok)
+    {
+        g_array_sort(run.cand, cand_cmp);
+        c = (cj_cand_t *) run.cand->data;
+        for (i = 0; i < run.cand->len; i++)
+            if ((i == 0) || (c[i].i != c[i - 1].i) || (c[i].j != c[i - 1].j))
+                g_array_append_val(run.groups, i);
+        cj->candidates = run.groups->len;
+        g_array_append_val(run.groups, run.cand->len);
+
+        ok = run_jobs(refine_job, &run, cj->candidates, nthreads);
+    }
+
+    if (ok)
+    {
+        g_array_sort(cj->events, event_cmp);
+
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %u candidate pairs, %u conjunctions closer than "
+                      "%.2f km"), __func__, cj->candidates, cj->events->len,
+                    cj->threshold);
+
+        if (f != NULL)
+        {
+            fprintf(f, "# conjunction,tca_utc,tca_jd,catnr1,name1,catnr2,name2,"
+                    "miss_km,relvel_kms\n");
+            for (i = 0; i < cj->events->len; i++)
+            {
+                ev = &g_array_index(cj->events, conjunction_event_t, i);
+                write_event(f, ev);
+            }
+        }
+    }
+
+    g_array_free(run.cand, TRUE);
+    g_array_free(run.groups, TRUE);
+    g_mutex_clear(&run.lock);
+    g_free(run.idx);
+    g_free(run.rp);
+    g_free(run.ra);
+    g_free(run.query);
+
+    if (f != NULL)
+        fclose(f);
+
+    return ok;
+}
+
+
+static void write_event(FILE * f, conjunction_event_t * ev)
+{
+    GDateTime      *dt;
+    gchar          *tstr, *name1, *name2;
+    gdouble         secs;
+
+    secs = (ev->tca - 2440587.5) * 86400.0;
+    dt = g_date_time_new_from_unix_utc((gint64) floor(secs));
+    tstr = g_date_time_format(dt, "%Y-%m-%d %H:%M:%S");
+    g_date_time_unref(dt);
+
+    /* satellite names are free text */
+    name1 = g_strdelimit(g_strdup(ev->name1), ",\"\n", ' ');
+    name2 = g_strdelimit(g_strdup(ev->name2), ",\"\n", ' ');
+
+    fprintf(f, "conjunction,%s.%03d,%.8f,%d,%s,%d,%s,%.3f,%.4f\n",
+            tstr, (gint) floor(1000.0 * (secs - floor(secs))), ev->tca,
+            ev->catnr1, name1, ev->catnr2, name2, ev->miss, ev->relvel);
+
+    g_free(tstr);
+    g_free(name1);
+    g_free(name2);
+}
@@ -0,0 +1,83 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef CONJUNCTION_H
+#define CONJUNCTION_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Default coarse screening step [sec]. */
+#define CONJUNCTION_STEP    60.0
+
+/** \brief Number of worker threads when the CPU count is not known. */
+#define CONJUNCTION_THREADS 4
+
+
+/** \brief A close approach between two satellites. */
+typedef struct {
+    gint        catnr1;     /*!< Catalogue number of the first satellite */
+    gint        catnr2;     /*!< Catalogue number of the second satellite */
+    const gchar *name1;     /*!< Name of the first satellite */
+    const gchar *name2;     /*!< Name of the second satellite */
+    gdouble     tca;        /*!< Time of closest approach [Julian days] */
+    gdouble     miss;       /*!< Miss distance [km] */
+    gdouble     relvel;     /*!< Relative velocity at TCA [km/sec] */
+} conjunction_event_t;
+
+/** \brief A conjunction screening.
+ *
+ * Create it with conjunction_new(), add the satellites and call
+ * conjunction_run(). If any satellite is added as primary, only pairs with
+ * at least one primary satellite are screened; otherwise all pairs are.
+ * The satellites are copied, so the screening can run in a separate thread.
+ */
+typedef struct {
+    gdouble     start;      /*!< Start of the time window [Julian days] */
+    gdouble     stop;       /*!< End of the time window [Julian days] */
+    gdouble     threshold;  /*!< Report approaches closer than this [km] */
+    gdouble     step;       /*!< Coarse screening step [sec] */
+
+    GPtrArray  *sats;       /*!< Copies of the satellites (sat_t) */
+    GArray     *primary;    /*!< Primary flag of each satellite (gboolean) */
+    guint       nprimary;   /*!< Number of primary satellites */
+
+    guint       screened;   /*!< Satellites left after the orbit filter */
+    guint       candidates; /*!< Pairs refined after the coarse screening */
+    GArray     *events;     /*!< The conjunctions found, sorted by TCA */
+} conjunction_t;
+
+
+conjunction_t  *conjunction_new     (gdouble start, gdouble stop,
+                                     gdouble threshold);
+void            conjunction_free    (conjunction_t *cj);
+void            conjunction_add_sat (conjunction_t *cj, const sat_t *sat,
+                                     gboolean primary);
+gboolean        conjunction_run     (conjunction_t *cj, const gchar *csvfile);
+
+#endif
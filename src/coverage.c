@@ -0,0 +1,535 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Coverage and revisit analysis for a network of ground stations.
+ *
+ * For each ground station the contacts of every satellite in the time
+ * window are found with find_aos() and find_los(). The contacts are then
+ * swept in time order to get the covered time, the revisit gaps and the
+ * number of satellites in range at once. The same is done for the centre of
+ * each cell of a lat/lon grid to get a map of the access time.
+ *
+ * Each station and each grid row is a separate job for a GThreadPool. The
+ * jobs work on their own copies of the satellites, and the calling thread
+ * writes the results to the CSV file in order as soon as they are ready.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "coverage.h"
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "qth-track.h"
+#include "sat-log.h"
+
+
+/** \brief Time to skip after LOS before looking for the next AOS [days]. */
+#define COVERAGE_LOS_STEP (60.0/86400.0)
+
+
+/** \brief Start or end of a contact. */
+typedef struct {
+    gdouble     t;          /*!< Time [Julian days] */
+    gint        d;          /*!< +1 for AOS, -1 for LOS */
+} cov_event_t;
+
+/** \brief Worker state shared by the jobs of one run. */
+typedef struct {
+    coverage_t *cov;
+    GAsyncQueue *done;      /*!< Indices of finished jobs, plus one */
+} cov_run_t;
+
+
+static void     coverage_job(gpointer data, gpointer user_data);
+static void     write_station(FILE * f, coverage_station_t * st);
+static void     write_grid_row(FILE * f, coverage_t * cov, guint row);
+
+
+/**
+ * \brief Create a new coverage analysis.
+ * \param start Start of the time window [Julian days].
+ * \param stop End of the time window [Julian days].
+ * \param step Size of the grid cells [deg], 0 for no grid.
+ *
+ * The cell size is rounded down so that the cells divide the globe
+ * exactly, with twice as many columns as rows.
+ */
+coverage_t     *coverage_new(gdouble start, gdouble stop, gdouble step)
+{
+    coverage_t     *cov = g_new0(coverage_t, 1);
+
+    cov->start = start;
+    cov->stop = stop;
+    cov->qths = g_ptr_array_new();
+    cov->sats = g_ptr_array_new();
+
+    if (step > 0.0)
+    {
+        cov->nlat = (guint) ceil(180.0 / step);
+        cov->nlon = 2 * cov->nlat;
+        cov->step = 180.0 / cov->nlat;
+        cov->grid = g_new0(gfloat, cov->nlon * cov->nlat);
+    }
+
+    return cov;
+}
+
+
+/** \brief Free a coverage analysis and its results. */
+void coverage_free(coverage_t * cov)
+{
+    guint           i;
+    qth_t          *qth;
+    sat_t          *sat;
+
+    if (cov == NULL)
+        return;
+
+    for (i = 0; i < cov->qths->len; i++)
+    {
+        qth = g_ptr_array_index(cov->qths, i);
+        g_free(qth->name);
+        qth_track_free(qth->track);
+        g_free(qth);
+    }
+    g_ptr_array_free(cov->qths, TRUE);
+
+    for (i = 0; i < cov->sats->len; i++)
+    {
+        sat = g_ptr_array_index(cov->sats, i);
+        gtk_sat_data_free_sat(sat);
+    }
+    g_ptr_array_free(cov->sats, TRUE);
+
+    g_free(cov->sta);
+    g_free(cov->grid);
+    g_free(cov);
+}
+
+
+/**
+ * \brief Add a ground station.
+ *
+ * The name, the position and the trajectory of a track station are
+ * copied; gpsd stations are analysed at their current position.
+ */
+void coverage_add_station(coverage_t * cov, const qth_t * qth)
+{
+    qth_t          *copy = g_new0(qth_t, 1);
+
+    copy->name = g_strdup(qth->name);
+    copy->lat = qth->lat;
+    copy->lon = qth->lon;
+    copy->alt = qth->alt;
+    copy->track = qth_track_copy(qth->track);
+    copy->type = (copy->track != NULL) ? QTH_TRACK_TYPE : QTH_STATIC_TYPE;
+
+    g_ptr_array_add(cov->qths, copy);
+}
+
+
+/** \brief Add a satellite. */
+void coverage_add_sat(coverage_t * cov, const sat_t * sat)
+{
+    sat_t          *copy = g_new(sat_t, 1);
+
+    memcpy(copy, sat, sizeof(sat_t));
+    copy->name = g_strdup(sat->name);
+    copy->nickname = g_strdup(sat->nickname);
+    copy->website = NULL;
+
+    g_ptr_array_add(cov->sats, copy);
+}
+
+
+/** \brief Add the contacts of a satellite in [start;stop] to ev. */
+static guint sat_contacts(sat_t * sat, qth_t * qth, gdouble start,
+                          gdouble stop, GArray * ev, gdouble * contact)
+{
+    cov_event_t     e;
+    gdouble         aos, los, t;
+    guint           n = 0;
+
+    predict_calc(sat, qth, start);
+
+    if (!has_aos(sat, qth))
+    {
+        /* geostationary: in range for the whole window or not at all */
+        if (!decayed(sat) && (sat->el > 0.0))
+        {
+            aos = start;
+            los = stop;
+        }
+        else
+            return 0;
+    }
+    else
+    {
+        aos = (sat->el > 0.0) ? start : find_aos(sat, qth, start, stop - start);
+        los = 0.0;
+    }
+
+    while ((aos > 0.0) && (aos < stop))
+    {
+        if (los == 0.0)
+        {
+            los = find_los(sat, qth, aos, 0.0);
+            if (los <= aos)
+                break;
+        }
+
+        e.t = aos;
+        e.d = 1;
+        g_array_append_val(ev, e);
+        e.t = MIN(los, stop);
+        e.d = -1;
+        g_array_append_val(ev, e);
+
+        *contact += e.t - aos;
+        n++;
+
+        t = los + COVERAGE_LOS_STEP;
+        if (t >= stop)
+            break;
+
+        aos = find_aos(sat, qth, t, stop - t);
+        los = 0.0;
+    }
+
+    return n;
+}
+
+
+static gint event_cmp(gconstpointer a, gconstpointer b)
+{
+    const cov_event_t *ea = a;
+    const cov_event_t *eb = b;
+
+    if (ea->t < eb->t)
+        return -1;
+    if (ea->t > eb->t)
+        return 1;
+
+    /* LOS before AOS at the same time */
+    return ea->d - eb->d;
+}
+
+
+/**
+ * \brief Find the contacts of all satellites with a station and sweep them.
+ * \param sats Working copies of the satellites.
+ * \param nsat The number of satellites.
+ * \param qth The station.
+ * \param st Statistics to fill in; times are converted to minutes.
+ * \param ev Scratch array for the events.
+ */
+static void station_stats(coverage_t * cov, sat_t * sats, guint nsat,
+                          qth_t * qth, coverage_station_t * st, GArray * ev)
+{
+    cov_event_t    *e;
+    gdouble         t, dt, gapstart = 0.0, gaps = 0.0;
+    guint           i, ngaps = 0;
+    gint            k = 0;
+    gboolean        seen = FALSE;
+
+    g_array_set_size(ev, 0);
+    st->contact = 0.0;
+    st->passes = 0;
+
+    for (i = 0; i < nsat; i++)
+        st->passes += sat_contacts(&sats[i], qth, cov->start, cov->stop, ev,
+                                   &st->contact);
+
+    g_array_sort(ev, event_cmp);
+
+    memset(st->sim, 0, sizeof(st->sim));
+    st->covered = 0.0;
+    st->maxgap = 0.0;
+    st->maxsim = 0;
+
+    t = cov->start;
+    for (i = 0; i <= ev->len; i++)
+    {
+        /* time until the next event, or the end of the window */
+        if (i < ev->len)
+        {
+            e = &g_array_index(ev, cov_event_t, i);
+            dt = e->t - t;
+        }
+        else
+        {
+            e = NULL;
+            dt = cov->stop - t;
+        }
+
+        st->sim[MIN(k, COVERAGE_SIM_MAX)] += dt;
+        if (k > 0)
+            st->covered += dt;
+
+        if (e == NULL)
+            break;
+
+        t = e->t;
+        if ((k == 0) && (e->d > 0) && seen)
+        {
+            /* end of a revisit gap */
+            gaps += t - gapstart;
+            ngaps++;
+            st->maxgap = MAX(st->maxgap, t - gapstart);
+        }
+
+        k += e->d;
+        st->maxsim = MAX(st->maxsim, (guint) MAX(k, 0));
+
+        if (k == 0)
+        {
+            gapstart = t;
+            seen = TRUE;
+        }
+    }
+
+    /* convert to minutes */
+    st->contact *= 1440.0;
+    st->covered *= 1440.0;
+    st->maxgap *= 1440.0;
+    st->meangap = (ngaps > 0) ? 1440.0 * gaps / ngaps : 0.0;
+    for (i = 0; i <= COVERAGE_SIM_MAX; i++)
+        st->sim[i] *= 1440.0;
+
+    /* no contact at all: the gap is the whole window */
+    if (ev->len == 0)
+        st->maxgap = 1440.0 * (cov->stop - cov->start);
+}
+
+
+/** \brief Run one job: a station or a grid row. */
+static void coverage_job(gpointer data, gpointer user_data)
+{
+    cov_run_t      *run = user_data;
+    coverage_t     *cov = run->cov;
+    guint           job = GPOINTER_TO_UINT(data) - 1;
+    sat_t          *sats;
+    GArray         *ev;
+    coverage_station_t st;
+    qth_t           qth;
+    guint           i, row, nsat = cov->sats->len;
+
+    /* working copies, the predictions change the satellite data */
+    sats = g_new(sat_t, nsat);
+    for (i = 0; i < nsat; i++)
+        memcpy(&sats[i], g_ptr_array_index(cov->sats, i), sizeof(sat_t));
+    ev = g_array_new(FALSE, FALSE, sizeof(cov_event_t));
+
+    if (job < cov->qths->len)
+    {
+        station_stats(cov, sats, nsat, g_ptr_array_index(cov->qths, job),
+                      &cov->sta[job], ev);
+    }
+    else
+    {
+        row = job - cov->qths->len;
+        memset(&qth, 0, sizeof(qth));
+        qth.lat = 90.0 - (row + 0.5) * cov->step;
+
+        for (i = 0; i < cov->nlon; i++)
+        {
+            qth.lon = -180.0 + (i + 0.5) * cov->step;
+            station_stats(cov, sats, nsat, &qth, &st, ev);
+            cov->grid[row * cov->nlon + i] = (gfloat) st.covered;
+        }
+    }
+
+    g_array_free(ev, TRUE);
+    g_free(sats);
+
+    g_async_queue_push(run->done, data);
+}
+
+
+/**
+ * \brief Run the analysis.
+ * \param cov The coverage analysis.
+ * \param csvfile File to write the results to, or NULL.
+ * \return TRUE if the analysis was completed.
+ *
+ * This function blocks until all jobs are finished. The results are written
+ * to the CSV file as they become available, stations first and then the
+ * grid from north to south. Each line starts with its record type; the
+ * header of each record type is written as a comment.
+ */
+gboolean coverage_run(coverage_t * cov, const gchar * csvfile)
+{
+    cov_run_t       run;
+    GThreadPool    *pool;
+    GError         *err = NULL;
+    FILE           *f = NULL;
+    gboolean       *done;
+    guint           i, c, njobs, next, job;
+    gint            nthreads;
+
+    if (csvfile != NULL)
+    {
+        f = g_fopen(csvfile, "w");
+        if (f == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not open %s for writing"),
+                        __func__, csvfile);
+            return FALSE;
+        }
+
+        fprintf(f, "# station,name,lat,lon,passes,contact_min,covered_min,"
+                "max_gap_min,mean_gap_min,max_simultaneous");
+        for (i = 0; i <= COVERAGE_SIM_MAX; i++)
+            fprintf(f, ",sim%u%s_min", i, (i == COVERAGE_SIM_MAX) ? "+" : "");
+        fprintf(f, "\n");
+    }
+
+    g_free(cov->sta);
+    cov->sta = g_new0(coverage_station_t, cov->qths->len);
+    for (i = 0; i < cov->qths->len; i++)
+    {
+        qth_t          *qth = g_ptr_array_index(cov->qths, i);
+
+        cov->sta[i].name = qth->name;
+        cov->sta[i].lat = qth->lat;
+        cov->sta[i].lon = qth->lon;
+    }
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+    nthreads = g_get_num_processors();
+#else
+    nthreads = COVERAGE_THREADS;
+#endif
+
+    run.cov = cov;
+    run.done = g_async_queue_new();
+    pool = g_thread_pool_new(coverage_job, &run, nthreads, FALSE, &err);
+    if (pool == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create worker threads (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        g_async_queue_unref(run.done);
+        if (f != NULL)
+            fclose(f);
+        return FALSE;
+    }
+
+    njobs = cov->qths->len + cov->nlat;
+    for (i = 0; i < njobs; i++)
+        g_thread_pool_push(pool, GUINT_TO_POINTER(i + 1), NULL);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Analysing %u satellites, %u stations and %u grid "
+                  "cells in %d threads"), __func__, cov->sats->len,
+                cov->qths->len, cov->nlon * cov->nlat, nthreads);
+
+    /* write finished jobs in order */
+    done = g_new0(gboolean, njobs);
+    next = 0;
+    for (i = 0; i < njobs; i++)
+    {
+        job = GPOINTER_TO_UINT(g_async_queue_pop(run.done)) - 1;
+        done[job] = TRUE;
+
+        for (; (next < njobs) && done[next]; next++)
+        {
+            if (next < cov->qths->len)
+            {
+                if (f != NULL)
+                    write_station(f, &cov->sta[next]);
+            }
+            else
+            {
+                job = next - cov->qths->len;
+                for (c = 0; c < cov->nlon; c++)
+                    cov->gridmax = MAX(cov->gridmax,
+                                       cov->grid[job * cov->nlon + c]);
+
+                if (f != NULL)
+                {
+                    if (job == 0)
+                        fprintf(f, "# grid,lat,lon,access_min\n");
+                    write_grid_row(f, cov, job);
+                }
+            }
+        }
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_async_queue_unref(run.done);
+    g_free(done);
+
+    if (f != NULL)
+        fclose(f);
+
+    return TRUE;
+}
+
+
+static void write_station(FILE * f, coverage_station_t * st)
+{
+    guint           i;
+    gchar          *name;
+
+    /* station names are free text */
+    name = g_strdelimit(g_strdup(st->name), ",\"\n", ' ');
+
+    fprintf(f, "station,%s,%.4f,%.4f,%u,%.2f,%.2f,%.2f,%.2f,%u",
+            name, st->lat, st->lon, st->passes, st->contact, st->covered,
+            st->maxgap, st->meangap, st->maxsim);
+    for (i = 0; i <= COVERAGE_SIM_MAX; i++)
+        fprintf(f, ",%.2f", st->sim[i]);
+    fprintf(f, "\n");
+
+    g_free(name);
+}
+
+
+static void write_grid_row(FILE * f, coverage_t * cov, guint row)
+{
+    guint           i;
+
+    for (i = 0; i < cov->nlon; i++)
+        fprintf(f, "grid,%.2f,%.2f,%.2f\n",
+                90.0 - (row + 0.5) * cov->step,
+                -180.0 + (i + 0.5) * cov->step,
+                cov->grid[row * cov->nlon + i]);
+}
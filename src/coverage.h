@@ -0,0 +1,91 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef COVERAGE_H
+#define COVERAGE_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+#include "qth-data.h"
+
+
+/** \brief Simultaneous visibility is counted up to this many satellites. */
+#define COVERAGE_SIM_MAX    8
+
+/** \brief Number of worker threads when the CPU count is not known. */
+#define COVERAGE_THREADS    4
+
+
+/** \brief Coverage statistics for one ground station.
+ *
+ * All times are in minutes. Revisit gaps are the times without any
+ * satellite in range between two contacts.
+ */
+typedef struct {
+    gchar      *name;       /*!< Station name */
+    gdouble     lat;        /*!< Latitude [deg N] */
+    gdouble     lon;        /*!< Longitude [deg E] */
+    guint       passes;     /*!< Number of passes of all satellites */
+    gdouble     contact;    /*!< Sum of the pass durations */
+    gdouble     covered;    /*!< Time with at least one satellite in range */
+    gdouble     maxgap;     /*!< Longest revisit gap */
+    gdouble     meangap;    /*!< Mean revisit gap */
+    guint       maxsim;     /*!< Largest number of satellites in range at once */
+    gdouble     sim[COVERAGE_SIM_MAX + 1];  /*!< Time with n satellites in range; the last bin is n or more */
+} coverage_station_t;
+
+/** \brief A coverage analysis.
+ *
+ * Create it with coverage_new(), add the ground stations and satellites and
+ * call coverage_run(). The satellites are copied, so the analysis can run in
+ * a separate thread while the module keeps tracking.
+ */
+typedef struct {
+    gdouble     start;      /*!< Start of the time window [Julian days] */
+    gdouble     stop;       /*!< End of the time window [Julian days] */
+    gdouble     step;       /*!< Size of the grid cells [deg] */
+
+    GPtrArray  *qths;       /*!< The ground stations (qth_t) */
+    GPtrArray  *sats;       /*!< Copies of the satellites (sat_t) */
+
+    coverage_station_t *sta;    /*!< Statistics of each ground station */
+
+    guint       nlon;       /*!< Number of grid columns, from -180 deg E */
+    guint       nlat;       /*!< Number of grid rows, from 90 deg N */
+    gfloat     *grid;       /*!< Access time of each grid cell [min] */
+    gfloat      gridmax;    /*!< Largest access time in the grid [min] */
+} coverage_t;
+
+
+coverage_t     *coverage_new         (gdouble start, gdouble stop,
+                                      gdouble step);
+void            coverage_free        (coverage_t *cov);
+void            coverage_add_station (coverage_t *cov, const qth_t *qth);
+void            coverage_add_sat     (coverage_t *cov, const sat_t *sat);
+gboolean        coverage_run         (coverage_t *cov, const gchar *csvfile);
+
+#endif
@@ -0,0 +1,370 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Interpolated ephemeris cache.
+ *
+ * When the time controller runs with a high throttle value or the user drags
+ * time back and forth, running SGP4/SDP4 for every satellite in every cycle
+ * is a waste since the simulated time moves along a well defined path. The
+ * ephemeris cache stores the exact SGP4/SDP4 state at equally spaced nodes
+ * and evaluates the position and velocity between the nodes using cubic
+ * Hermite interpolation.
+ *
+ * The node spacing is chosen per satellite so that the interpolation error,
+ * which for cubic Hermite interpolation is bounded by h^4/384 * max|r''''|,
+ * stays below EPHEM_CACHE_TOLERANCE. The fourth derivative is estimated from
+ * the angular rate and radius at perigee, which is where it peaks.
+ *
+ * For deep-space satellites the SDP4 lunar-solar periodics are only
+ * refreshed every 30 minutes of propagation time, which makes SDP4 itself
+ * path dependent at the 100 m level; the interpolation error is well below
+ * that.
+ *
+ * Interpolation only pays off while the nodes are reused. A node costs a
+ * bit more than propagating directly, so the break-even is at about half
+ * a node spacing per cycle; a satellite is propagated directly in cycles
+ * where time moves more than EPHEM_CACHE_MAX_TICK node spacings, which
+ * includes jumps. The window of nodes is extended one node at a time in
+ * the direction time is moving and trimmed at the other end; when time has
+ * left the window, it is restarted with the two nodes around the new time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "ephem-cache.h"
+#include "predict-tools.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+static void     free_track(gpointer track);
+static gdouble  get_node_step(sat_t * sat);
+static void     calc_node(ephem_track_t * track, gdouble t,
+                          ephem_node_t * node, gdouble ref_phase);
+static void     reset_track(ephem_track_t * track, gdouble t);
+static void     extend_track(ephem_track_t * track, gdouble t);
+
+
+/** \brief Create a new, empty ephemeris cache. */
+ephem_cache_t  *ephem_cache_new()
+{
+    ephem_cache_t  *cache;
+
+    cache = g_new(ephem_cache_t, 1);
+    cache->tracks = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                          NULL, free_track);
+
+    return cache;
+}
+
+/** \brief Free an ephemeris cache and all its nodes. */
+void ephem_cache_free(ephem_cache_t * cache)
+{
+    if (cache == NULL)
+        return;
+
+    g_hash_table_destroy(cache->tracks);
+    g_free(cache);
+}
+
+/**
+ * \brief Remove all nodes from the cache.
+ *
+ * This must be called whenever the orbital elements of the satellites
+ * change, e.g. after a TLE update or when the satellites are reloaded.
+ */
+void ephem_cache_clear(ephem_cache_t * cache)
+{
+    g_return_if_fail(cache != NULL);
+
+    g_hash_table_remove_all(cache->tracks);
+}
+
+/**
+ * \brief Calculate satellite data using the ephemeris cache.
+ * \param cache The ephemeris cache.
+ * \param sat Pointer to the satellite data.
+ * \param frame The observer frame; the calculation is done for frame->time.
+ *
+ * This function is a drop-in replacement for predict_calc_frame(). The nodes
+ * around the frame time are computed on demand, whereafter the satellite position and
+ * velocity are interpolated and the observer relative data is calculated
+ * using predict_calc_from_state().
+ */
+void ephem_cache_calc(ephem_cache_t * cache, sat_t * sat,
+                      obs_frame_t * frame)
+{
+    ephem_track_t  *track;
+    ephem_node_t   *n0, *n1;
+    gdouble         h, s, s2, s3;
+    gdouble         h00, h10, h01, h11;
+    gdouble         d00, d10, d01, d11;
+    gdouble         t, dt;
+    guint           i;
+
+    g_return_if_fail((cache != NULL) && (sat != NULL) && (frame != NULL));
+
+    t = frame->time;
+
+    track = g_hash_table_lookup(cache->tracks, &sat->tle.catnr);
+    if (track == NULL)
+    {
+        track = g_new(ephem_track_t, 1);
+
+        /* private copy, so that the cache never disturbs sat;
+           the name pointers are shared but never touched */
+        memcpy(&track->work, sat, sizeof(sat_t));
+        track->step = get_node_step(sat);
+        track->last = 0.0;
+        track->nodes = g_array_new(FALSE, FALSE, sizeof(ephem_node_t));
+        g_hash_table_insert(cache->tracks, &track->work.tle.catnr, track);
+
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Node spacing for %s is %.1f sec"),
+                    __func__, sat->nickname, track->step * 86400.0);
+    }
+
+    /* new nodes in most cycles cost more than propagating directly */
+    dt = fabs(t - track->last);
+    track->last = t;
+    if (dt >= EPHEM_CACHE_MAX_TICK * track->step)
+    {
+        predict_calc_frame(sat, frame);
+        return;
+    }
+
+    extend_track(track, t);
+
+    i = (guint) floor((t - g_array_index(track->nodes, ephem_node_t, 0).t) /
+                      track->step);
+    if (i > track->nodes->len - 2)
+        i = track->nodes->len - 2;
+
+    n0 = &g_array_index(track->nodes, ephem_node_t, i);
+    n1 = &g_array_index(track->nodes, ephem_node_t, i + 1);
+
+    /* cubic Hermite basis functions and their derivatives */
+    h = track->step * 86400.0;
+    s = (t - n0->t) / track->step;
+    s2 = s * s;
+    s3 = s2 * s;
+
+    h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    h10 = s3 - 2.0 * s2 + s;
+    h01 = -2.0 * s3 + 3.0 * s2;
+    h11 = s3 - s2;
+
+    d00 = 6.0 * s2 - 6.0 * s;
+    d10 = 3.0 * s2 - 4.0 * s + 1.0;
+    d01 = -6.0 * s2 + 6.0 * s;
+    d11 = 3.0 * s2 - 2.0 * s;
+
+    sat->pos.x = h00 * n0->pos.x + h10 * h * n0->vel.x +
+        h01 * n1->pos.x + h11 * h * n1->vel.x;
+    sat->pos.y = h00 * n0->pos.y + h10 * h * n0->vel.y +
+        h01 * n1->pos.y + h11 * h * n1->vel.y;
+    sat->pos.z = h00 * n0->pos.z + h10 * h * n0->vel.z +
+        h01 * n1->pos.z + h11 * h * n1->vel.z;
+
+    sat->vel.x = (d00 * n0->pos.x + d10 * h * n0->vel.x +
+                  d01 * n1->pos.x + d11 * h * n1->vel.x) / h;
+    sat->vel.y = (d00 * n0->pos.y + d10 * h * n0->vel.y +
+                  d01 * n1->pos.y + d11 * h * n1->vel.y) / h;
+    sat->vel.z = (d00 * n0->pos.z + d10 * h * n0->vel.z +
+                  d01 * n1->pos.z + d11 * h * n1->vel.z) / h;
+
+    Magnitude(&sat->pos);
+
+    /* phase is only used for display; linear interpolation is sufficient */
+    sat->phase = FMod2p(n0->phase + s * (n1->phase - n0->phase));
+
+    predict_calc_from_state(sat, frame);
+}
+
+/** \brief Free a track; called by the hash table. */
+static void free_track(gpointer track)
+{
+    ephem_track_t  *trk = (ephem_track_t *) track;
+
+    g_array_free(trk->nodes, TRUE);
+    g_free(trk);
+}
+
+/**
+ * \brief Get the node spacing for a satellite.
+ * \param sat Pointer to the satellite data.
+ * \return The node spacing in days.
+ *
+ * The spacing is chosen so that h^4/384 * r_p * w_p^4 equals
+ * EPHEM_CACHE_TOLERANCE, where r_p is the perigee radius and w_p is the
+ * angular rate at perigee.
+ */
+static gdouble get_node_step(sat_t * sat)
+{
+    gdouble         n, a, e, rp, wp, h;
+
+    n = sat->tle.xno / 60.0;    /* rad/min -> rad/sec */
+    e = sat->tle.eo;
+
+    if ((n <= 0.0) || (e >= 1.0))
+        return EPHEM_CACHE_MIN_STEP / 86400.0;
+
+    a = pow(ge / (n * n), 1.0 / 3.0);
+    rp = a * (1.0 - e);
+    wp = n * sqrt(1.0 + e) / pow(1.0 - e, 1.5);
+
+    h = pow(384.0 * EPHEM_CACHE_TOLERANCE / (rp * pow(wp, 4.0)), 0.25);
+
+    /* the radial motion makes r'''' grow faster than r_p*w_p^4 for
+       eccentric orbits; this empirical factor keeps the error bounded */
+    h *= sqrt((1.0 - e) / (1.0 + e));
+    h = CLAMP(h, EPHEM_CACHE_MIN_STEP, EPHEM_CACHE_MAX_STEP);
+
+    return h / 86400.0;
+}
+
+/**
+ * \brief Calculate a single node.
+ * \param track The track the node belongs to.
+ * \param t The node time.
+ * \param node Pointer to the node that will be filled.
+ * \param ref_phase Phase of the neighbouring node used for unwrapping.
+ */
+static void calc_node(ephem_track_t * track, gdouble t,
+                      ephem_node_t * node, gdouble ref_phase)
+{
+    sat_t          *sat = &track->work;
+
+    sat->jul_utc = t;
+    sat->tsince = (t - sat->jul_epoch) * xmnpda;
+
+    if (sat->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4(sat, sat->tsince);
+    else
+        SGP4(sat, sat->tsince);
+
+    Convert_Sat_State(&sat->pos, &sat->vel);
+
+    node->t = t;
+    node->pos = sat->pos;
+    node->vel = sat->vel;
+    node->phase = sat->phase;
+
+    /* unwrap phase so that it is continuous along the track */
+    node->phase += twopi * floor((ref_phase - node->phase) / twopi + 0.5);
+}
+
+/** \brief Discard all nodes and start a new window with the nodes at t and t+step. */
+static void reset_track(ephem_track_t * track, gdouble t)
+{
+    ephem_node_t    node;
+
+    g_array_set_size(track->nodes, 0);
+
+    calc_node(track, t, &node, 0.0);
+    g_array_append_val(track->nodes, node);
+    calc_node(track, t + track->step, &node, node.phase);
+    g_array_append_val(track->nodes, node);
+}
+
+/**
+ * \brief Make sure that t is covered by the nodes of a track.
+ *
+ * If t is within one node of the current window the window is extended
+ * by one node, otherwise the window is restarted at t. When the window
+ * exceeds EPHEM_CACHE_MAX_NODES nodes, it is cut to half that size at the
+ * end opposite to where it grows, so that trimming costs O(1) per node.
+ */
+static void extend_track(ephem_track_t * track, gdouble t)
+{
+    ephem_node_t   *first, *last;
+    ephem_node_t    node;
+    gdouble         gap;
+
+    if (track->nodes->len < 2)
+    {
+        reset_track(track, t);
+        return;
+    }
+
+    first = &g_array_index(track->nodes, ephem_node_t, 0);
+    last = &g_array_index(track->nodes, ephem_node_t, track->nodes->len - 1);
+
+    if (t >= first->t && t < last->t)
+        return;
+
+    /* distance to the window in number of nodes */
+    if (t < first->t)
+        gap = (first->t - t) / track->step;
+    else
+        gap = (t - last->t) / track->step;
+
+    if (gap > 1.0)
+    {
+        reset_track(track, t);
+        return;
+    }
+
+    if (t >= last->t)
+    {
+        /* grow forward */
+        while (t >= last->t)
+        {
+            calc_node(track, last->t + track->step, &node, last->phase);
+            g_array_append_val(track->nodes, node);
+            last = &g_array_index(track->nodes, ephem_node_t,
+                                  track->nodes->len - 1);
+        }
+
+        if (track->nodes->len > EPHEM_CACHE_MAX_NODES)
+            g_array_remove_range(track->nodes, 0,
+                                 track->nodes->len -
+                                 EPHEM_CACHE_MAX_NODES / 2);
+    }
+    else
+    {
+        /* grow backward */
+        while (t < first->t)
+        {
+            calc_node(track, first->t - track->step, &node, first->phase);
+            g_array_prepend_val(track->nodes, node);
+            first = &g_array_index(track->nodes, ephem_node_t, 0);
+        }
+
+        if (track->nodes->len > EPHEM_CACHE_MAX_NODES)
+            g_array_remove_range(track->nodes, EPHEM_CACHE_MAX_NODES / 2,
+                                 track->nodes->len -
+                                 EPHEM_CACHE_MAX_NODES / 2);
+    }
+}
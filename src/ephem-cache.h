@@ -0,0 +1,80 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef EPHEM_CACHE_H
+#define EPHEM_CACHE_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+#include "qth-data.h"
+
+
+/** \brief Position error the node spacing is chosen for [km]. */
+#define EPHEM_CACHE_TOLERANCE   0.01
+
+/** \brief Smallest allowed node spacing [sec]. */
+#define EPHEM_CACHE_MIN_STEP    5.0
+
+/** \brief Largest allowed node spacing [sec]. */
+#define EPHEM_CACHE_MAX_STEP    1800.0
+
+/** \brief Largest time step per cycle that is interpolated [node spacings]. */
+#define EPHEM_CACHE_MAX_TICK    0.5
+
+/** \brief Maximum number of nodes kept per satellite. */
+#define EPHEM_CACHE_MAX_NODES   1024
+
+
+/** \brief Ephemeris node; the exact SGP4/SDP4 state at a given time. */
+typedef struct {
+    gdouble     t;      /*!< Node time in "jul_utc" */
+    vector_t    pos;    /*!< ECI position [km] */
+    vector_t    vel;    /*!< ECI velocity [km/sec] */
+    gdouble     phase;  /*!< Orbit phase [rad], unwrapped along the track */
+} ephem_node_t;
+
+/** \brief Equally spaced ephemeris nodes for one satellite. */
+typedef struct {
+    sat_t       work;   /*!< Private copy of the satellite used for propagation */
+    gdouble     step;   /*!< Node spacing [days] */
+    gdouble     last;   /*!< Time of the previous calculation */
+    GArray     *nodes;  /*!< ephem_node_t entries sorted by time */
+} ephem_track_t;
+
+/** \brief Ephemeris cache for a set of satellites. */
+typedef struct {
+    GHashTable *tracks; /*!< ephem_track_t entries keyed by catalogue number */
+} ephem_cache_t;
+
+
+ephem_cache_t  *ephem_cache_new   (void);
+void            ephem_cache_free  (ephem_cache_t *cache);
+void            ephem_cache_clear (ephem_cache_t *cache);
+void            ephem_cache_calc  (ephem_cache_t *cache, sat_t *sat,
+                                   obs_frame_t *frame);
+
+#endif
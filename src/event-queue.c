@@ -0,0 +1,321 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Priority queue of upcoming AOS/LOS events.
+ *
+ * The queue is updated from the module cycle after each satellite has been
+ * propagated. An entry is only touched when the AOS or LOS time of the
+ * satellite changes, which happens a few times per pass, so keeping the
+ * heaps in order costs O(log n) per event instead of a scan over all
+ * satellites in every cycle.
+ *
+ * Views can use the serial number of the queue to find out whether any
+ * event has changed since their last update. The entries are also kept in
+ * a list ordered by serial, so that a view only visits the entries that
+ * changed since its last update.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+
+#include "event-queue.h"
+
+
+static gboolean heap_before(event_entry_t * a, event_entry_t * b);
+static void     heap_swap(GPtrArray * heap, gint i, gint j);
+static void     heap_sift_up(GPtrArray * heap, gint i);
+static void     heap_sift_down(GPtrArray * heap, gint i);
+static void     heap_insert(GPtrArray * heap, event_entry_t * entry);
+static void     heap_remove(GPtrArray * heap, event_entry_t * entry);
+
+
+/** \brief Create a new, empty event queue. */
+event_queue_t  *event_queue_new()
+{
+    event_queue_t  *queue;
+
+    queue = g_new(event_queue_t, 1);
+    queue->entries = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                           NULL, g_free);
+    queue->aos_heap = g_ptr_array_new();
+    queue->los_heap = g_ptr_array_new();
+    queue->changed = g_queue_new();
+    queue->serial = 0;
+
+    return queue;
+}
+
+/** \brief Free an event queue and all its entries. */
+void event_queue_free(event_queue_t * queue)
+{
+    if (queue == NULL)
+        return;
+
+    g_hash_table_destroy(queue->entries);
+    g_ptr_array_free(queue->aos_heap, TRUE);
+    g_ptr_array_free(queue->los_heap, TRUE);
+    g_queue_free(queue->changed);
+    g_free(queue);
+}
+
+/**
+ * \brief Remove all entries from the queue.
+ *
+ * This must be called when the satellites are reloaded since the entries
+ * point to the satellite structures. The serial number is not reset so
+ * that views will pick up the new entries.
+ */
+void event_queue_clear(event_queue_t * queue)
+{
+    g_ptr_array_set_size(queue->aos_heap, 0);
+    g_ptr_array_set_size(queue->los_heap, 0);
+    g_queue_clear(queue->changed);
+    g_hash_table_remove_all(queue->entries);
+    queue->serial++;
+}
+
+/**
+ * \brief Update the next event of a satellite.
+ * \param queue The event queue.
+ * \param sat The satellite. aos, los and el must be up to date.
+ * \return TRUE if the entry has changed.
+ *
+ * The satellite is in range if the next LOS comes before the next AOS.
+ * The elevation is only used for satellites that have neither AOS nor LOS,
+ * so the entry stays untouched between events.
+ */
+gboolean event_queue_update(event_queue_t * queue, sat_t * sat)
+{
+    event_entry_t  *entry;
+    gboolean        inpass;
+
+    entry = g_hash_table_lookup(queue->entries, &sat->tle.catnr);
+    if (entry == NULL)
+    {
+        entry = g_new(event_entry_t, 1);
+        entry->catnum = sat->tle.catnr;
+        entry->sat = sat;
+        entry->idx = -1;
+        entry->link = g_list_alloc();
+        entry->link->data = entry;
+        g_queue_push_tail_link(queue->changed, entry->link);
+        g_hash_table_insert(queue->entries, &entry->catnum, entry);
+    }
+    else if (entry->aos == sat->aos && entry->los == sat->los)
+    {
+        /* no events; only the elevation can change the state */
+        if (sat->aos > 0.0 || sat->los > 0.0 ||
+            entry->inpass == (sat->el > 0.0))
+            return FALSE;
+    }
+
+    /* take it out of its current heap */
+    if (entry->idx >= 0)
+        heap_remove(entry->inpass ? queue->los_heap : queue->aos_heap, entry);
+
+    entry->sat = sat;
+    entry->aos = sat->aos;
+    entry->los = sat->los;
+
+    if (sat->aos <= 0.0 && sat->los <= 0.0)
+    {
+        /* no predicted events; stationary, decayed or never in range */
+        inpass = (sat->el > 0.0);
+        entry->t = -1.0;
+    }
+    else if (sat->los > 0.0 && (sat->aos <= 0.0 || sat->los < sat->aos))
+    {
+        inpass = TRUE;
+        entry->t = sat->los;
+    }
+    else
+    {
+        inpass = FALSE;
+        entry->t = sat->aos;
+    }
+
+    entry->inpass = inpass;
+
+    if (entry->t > 0.0 || inpass)
+        heap_insert(inpass ? queue->los_heap : queue->aos_heap, entry);
+
+    entry->serial = ++queue->serial;
+
+    /* move to the end of the list of changed entries */
+    if (entry->link != queue->changed->tail)
+    {
+        g_queue_unlink(queue->changed, entry->link);
+        g_queue_push_tail_link(queue->changed, entry->link);
+    }
+
+    return TRUE;
+}
+
+/** \brief Get the queue entry of a satellite or NULL if there is none. */
+event_entry_t  *event_queue_lookup(event_queue_t * queue, gint catnum)
+{
+    return (event_entry_t *) g_hash_table_lookup(queue->entries, &catnum);
+}
+
+/** \brief Get the satellite out of range with the earliest AOS or NULL. */
+sat_t          *event_queue_next_aos(event_queue_t * queue)
+{
+    if (queue->aos_heap->len == 0)
+        return NULL;
+
+    return ((event_entry_t *) g_ptr_array_index(queue->aos_heap, 0))->sat;
+}
+
+/** \brief Get the satellite in range with the earliest LOS or NULL. */
+sat_t          *event_queue_next_los(event_queue_t * queue)
+{
+    if (queue->los_heap->len == 0)
+        return NULL;
+
+    return ((event_entry_t *) g_ptr_array_index(queue->los_heap, 0))->sat;
+}
+
+/**
+ * \brief Call a function for each entry that has changed.
+ * \param queue The event queue.
+ * \param since Serial number of the last update seen by the caller.
+ * \param func Function called with the catalogue number and the entry.
+ * \param data User data passed to func.
+ *
+ * The entries are visited latest change first; only the entries that have
+ * changed are visited. func must not update the queue.
+ */
+void event_queue_foreach_changed(event_queue_t * queue, guint since,
+                                 GHFunc func, gpointer data)
+{
+    GList          *link;
+    event_entry_t  *entry;
+
+    for (link = queue->changed->tail; link != NULL; link = link->prev)
+    {
+        entry = (event_entry_t *) link->data;
+        if (entry->serial <= since)
+            break;
+
+        func(&entry->catnum, entry, data);
+    }
+}
+
+/*
+ * Heap ordering. Entries without an event time are kept at the end of the
+ * heap. Each entry remembers its position so that it can be removed or
+ * moved without searching.
+ */
+static gboolean heap_before(event_entry_t * a, event_entry_t * b)
+{
+    if (a->t < 0.0)
+        return FALSE;
+    if (b->t < 0.0)
+        return TRUE;
+
+    return a->t < b->t;
+}
+
+static void heap_swap(GPtrArray * heap, gint i, gint j)
+{
+    event_entry_t  *a = g_ptr_array_index(heap, i);
+    event_entry_t  *b = g_ptr_array_index(heap, j);
+
+    g_ptr_array_index(heap, i) = b;
+    g_ptr_array_index(heap, j) = a;
+    a->idx = j;
+    b->idx = i;
+}
+
+static void heap_sift_up(GPtrArray * heap, gint i)
+{
+    gint            parent;
+
+    while (i > 0)
+    {
+        parent = (i - 1) / 2;
+        if (!heap_before(g_ptr_array_index(heap, i),
+                         g_ptr_array_index(heap, parent)))
+            break;
+
+        heap_swap(heap, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(GPtrArray * heap, gint i)
+{
+    gint            n = heap->len;
+    gint            child;
+
+    while ((child = 2 * i + 1) < n)
+    {
+        if (child + 1 < n &&
+            heap_before(g_ptr_array_index(heap, child + 1),
+                        g_ptr_array_index(heap, child)))
+            child++;
+
+        if (!heap_before(g_ptr_array_index(heap, child),
+                         g_ptr_array_index(heap, i)))
+            break;
+
+        heap_swap(heap, i, child);
+        i = child;
+    }
+}
+
+static void heap_insert(GPtrArray * heap, event_entry_t * entry)
+{
+    entry->idx = heap->len;
+    g_ptr_array_add(heap, entry);
+    heap_sift_up(heap, entry->idx);
+}
+
+static void heap_remove(GPtrArray * heap, event_entry_t * entry)
+{
+    gint            i = entry->idx;
+    gint            last = heap->len - 1;
+
+    if (i != last)
+    {
+        heap_swap(heap, i, last);
+        g_ptr_array_remove_index(heap, last);
+        heap_sift_down(heap, i);
+        heap_sift_up(heap, i);
+    }
+    else
+    {
+        g_ptr_array_remove_index(heap, last);
+    }
+
+    entry->idx = -1;
+}
@@ -0,0 +1,77 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Upcoming event of a single satellite. */
+typedef struct {
+    gint        catnum; /*!< Catalogue number; hash table key */
+    sat_t      *sat;    /*!< The satellite */
+    gdouble     aos;    /*!< sat->aos when the entry was last updated */
+    gdouble     los;    /*!< sat->los when the entry was last updated */
+    gboolean    inpass; /*!< Satellite is in range and the next event is LOS */
+    gdouble     t;      /*!< Time of next event or -1.0 if there is none */
+    gint        idx;    /*!< Position in the heap or -1 if not in a heap */
+    guint       serial; /*!< Queue serial when the entry was last changed */
+    GList      *link;   /*!< Position in the list of changed entries */
+} event_entry_t;
+
+/**
+ * \brief Upcoming AOS and LOS events of a set of satellites.
+ *
+ * Satellites that are out of range are kept in a min-heap sorted by AOS,
+ * satellites that are in range in a min-heap sorted by LOS. Satellites that
+ * are in range without a predicted LOS (e.g. geostationary) go to the end
+ * of the LOS heap.
+ */
+typedef struct {
+    GHashTable *entries;    /*!< event_entry_t keyed by catalogue number */
+    GPtrArray  *aos_heap;   /*!< Satellites out of range, earliest AOS first */
+    GPtrArray  *los_heap;   /*!< Satellites in range, earliest LOS first */
+    GQueue     *changed;    /*!< Entries ordered by serial, latest last */
+    guint       serial;     /*!< Incremented every time an entry changes */
+} event_queue_t;
+
+
+event_queue_t  *event_queue_new     (void);
+void            event_queue_free    (event_queue_t *queue);
+void            event_queue_clear   (event_queue_t *queue);
+gboolean        event_queue_update  (event_queue_t *queue, sat_t *sat);
+event_entry_t  *event_queue_lookup  (event_queue_t *queue, gint catnum);
+sat_t          *event_queue_next_aos (event_queue_t *queue);
+sat_t          *event_queue_next_los (event_queue_t *queue);
+void            event_queue_foreach_changed (event_queue_t *queue,
+                                             guint since,
+                                             GHFunc func,
+                                             gpointer data);
+
+#endif
@@ -0,0 +1,165 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Range circle shapes.
+ *
+ * The shape of a range circle only depends on the latitude of the
+ * sub-satellite point and on the size of the footprint; the longitude just
+ * moves it sideways. The shapes are therefore computed for quantised values
+ * of these two and kept in a small direct mapped cache, so that a
+ * geostationary satellite or a LEO satellite that has only moved a little
+ * since the last refresh do not need any trigonometry at all.
+ *
+ * The shapes are computed in straight loops over precomputed azimuth tables
+ * without branches, which the compiler can vectorise.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <math.h>
+#include <glib.h>
+
+#include "footprint.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+static void     init_tables(void);
+static void     calc_shape(footprint_shape_t * shape);
+
+/** \brief Cosine of each azimuth step. */
+static gdouble  cos_az[FOOTPRINT_POINTS];
+
+/** \brief The shape cache; allocated on first use. */
+static footprint_shape_t *cache = NULL;
+
+
+/**
+ * \brief Get the range circle shape for a satellite.
+ * \param ssplat The latitude of the sub-satellite point [deg].
+ * \param footprint The footprint diameter [km].
+ * \return The shape, which remains valid until another shape is stored
+ *         in the same cache slot.
+ */
+const footprint_shape_t *footprint_get_shape(gdouble ssplat,
+                                             gdouble footprint)
+{
+    footprint_shape_t *shape;
+    gint            lat_key;
+    gint            size_key;
+    guint           idx;
+
+    if (cache == NULL)
+        init_tables();
+
+    lat_key = (gint) floor(ssplat / FOOTPRINT_LAT_STEP + 0.5);
+    size_key = (gint) floor(footprint / FOOTPRINT_SIZE_STEP + 0.5);
+
+    idx = ((guint) lat_key * 2654435761u ^ (guint) size_key * 40503u) %
+        FOOTPRINT_CACHE_SIZE;
+    shape = &cache[idx];
+
+    if (shape->lat_key != lat_key || shape->size_key != size_key)
+    {
+        shape->lat_key = lat_key;
+        shape->size_key = size_key;
+        calc_shape(shape);
+    }
+
+    return shape;
+}
+
+/** \brief Remove all shapes from the cache. */
+void footprint_cache_clear()
+{
+    guint           i;
+
+    if (cache == NULL)
+        return;
+
+    for (i = 0; i < FOOTPRINT_CACHE_SIZE; i++)
+        cache[i].size_key = -1;
+}
+
+/** \brief Allocate the cache and fill the azimuth table. */
+static void init_tables()
+{
+    guint           i;
+
+    for (i = 0; i < FOOTPRINT_POINTS; i++)
+        cos_az[i] = cos(de2ra * (gdouble) i);
+
+    cache = g_new(footprint_shape_t, FOOTPRINT_CACHE_SIZE);
+    footprint_cache_clear();
+}
+
+/**
+ * \brief Calculate a range circle shape for its quantised keys.
+ *
+ * Range circle calculations.
+ * Borrowed from gsat 0.9.0 by Xavier Crehueras, EB3CZS
+ * who borrowed from John Magliacane, KD2BD.
+ * Optimized by Alexandru Csete and William J Beksi.
+ *
+ * cos(rangelat) is obtained from sin(rangelat) since rangelat is always
+ * within +/- 90 deg. Points where the longitude can not be resolved are put
+ * at the longitude of the SSP, like before.
+ */
+static void calc_shape(footprint_shape_t * shape)
+{
+    gdouble         ssplat, beta;
+    gdouble         sin_lat, cos_lat, sin_beta, cos_beta;
+    gdouble         s, num, dem, ratio;
+    gint            ok;
+    guint           i;
+
+    ssplat = de2ra * shape->lat_key * FOOTPRINT_LAT_STEP;
+    beta = (0.5 * shape->size_key * FOOTPRINT_SIZE_STEP) / xkmper;
+
+    sin_lat = sin(ssplat);
+    cos_lat = cos(ssplat);
+    sin_beta = sin(beta);
+    cos_beta = cos(beta);
+
+    for (i = 0; i < FOOTPRINT_POINTS; i++)
+    {
+        s = sin_lat * cos_beta + cos_az[i] * sin_beta * cos_lat;
+        s = s > 1.0 ? 1.0 : (s < -1.0 ? -1.0 : s);
+
+        num = cos_beta - sin_lat * s;
+        dem = cos_lat * sqrt(1.0 - s * s);
+
+        ok = (dem > 0.0) & (fabs(num) <= dem);
+        ratio = ok ? num / dem : 1.0;
+
+        shape->lat[i] = asin(s) / de2ra;
+        shape->dlon[i] = -acos(ratio) / de2ra;
+    }
+}
@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H 1
+
+#include <glib.h>
+
+
+/** \brief Number of points on one half of the range circle. */
+#define FOOTPRINT_POINTS        180
+
+/** \brief Quantisation of the SSP latitude in the shape cache [deg]. */
+#define FOOTPRINT_LAT_STEP      0.05
+
+/** \brief Quantisation of the footprint diameter in the shape cache [km]. */
+#define FOOTPRINT_SIZE_STEP     1.0
+
+/** \brief Number of shapes kept in the cache. */
+#define FOOTPRINT_CACHE_SIZE    256
+
+
+/** \brief One half of a range circle relative to the sub-satellite point.
+ *
+ * Point i is the edge of the footprint in the direction of azimuth i deg.
+ * The other half is the mirror image in longitude.
+ */
+typedef struct {
+    gint        lat_key;                    /*!< Quantised SSP latitude */
+    gint        size_key;                   /*!< Quantised footprint */
+    gdouble     lat[FOOTPRINT_POINTS];      /*!< Latitude of each point [deg] */
+    gdouble     dlon[FOOTPRINT_POINTS];     /*!< Longitude relative to the SSP [deg] */
+} footprint_shape_t;
+
+
+const footprint_shape_t *footprint_get_shape (gdouble ssplat, gdouble footprint);
+void                     footprint_cache_clear (void);
+
+#endif
@@ -0,0 +1,203 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file gpredict-shm.h
+ * \brief Layout of the shared memory snapshot of a module.
+ *
+ * A module with the SHM key in its configuration writes the tracking data
+ * of each cycle to a POSIX shared memory object. This header describes the
+ * layout and has the functions other local programs need to read it. It
+ * does not depend on GLib and can be copied into other projects.
+ *
+ * The data is protected by a sequence lock: the writer makes seq odd while
+ * it updates the records and even again when done. A reader copies the
+ * records and retries if seq was odd or changed meanwhile, so it never
+ * blocks the writer. The records are sorted by catalogue number.
+ *
+ * When gpredict closes the module or needs a larger object, it sets the
+ * closed flag and unlinks the object; readers should then reopen it.
+ * An object whose writer process no longer exists is replaced by the next
+ * writer using the same name; a live writer's object is never replaced.
+ *
+ * Example:
+ *
+ *   const gpredict_shm_t *shm = gpredict_shm_open("/gpredict");
+ *   gpredict_shm_sat_t sats[64];
+ *   double t;
+ *   int n = gpredict_shm_read(shm, sats, 64, &t);
+ */
+#ifndef GPREDICT_SHM_H
+#define GPREDICT_SHM_H 1
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#define GPREDICT_SHM_MAGIC      0x48535047      /*!< "GPSH" */
+#define GPREDICT_SHM_VERSION    1
+#define GPREDICT_SHM_RETRIES    1000    /*!< Attempts made by gpredict_shm_read() */
+
+/** \brief Tracking data of one satellite. */
+typedef struct {
+    uint32_t        catnum;     /*!< Catalogue number */
+    uint32_t        reserved;
+    double          az;         /*!< Azimuth [deg] */
+    double          el;         /*!< Elevation [deg] */
+    double          range;      /*!< Range [km] */
+    double          range_rate; /*!< Range rate [km/sec] */
+    double          ssplat;     /*!< SSP latitude [deg] */
+    double          ssplon;     /*!< SSP longitude [deg] */
+    double          alt;        /*!< Altitude [km] */
+    double          aos;        /*!< Next AOS (Julian date), 0 if none */
+    double          los;        /*!< Next LOS (Julian date), 0 if none */
+} gpredict_shm_sat_t;
+
+/** \brief Header of the shared memory object, followed by the records. */
+typedef struct {
+    uint32_t        magic;      /*!< GPREDICT_SHM_MAGIC */
+    uint32_t        version;    /*!< GPREDICT_SHM_VERSION */
+    uint32_t        size;       /*!< Size of the object [bytes] */
+    uint32_t        record_size;        /*!< sizeof(gpredict_shm_sat_t) */
+    uint32_t        capacity;   /*!< Room for this many records */
+    volatile uint32_t closed;   /*!< Set when the object is abandoned */
+    uint32_t        writer;     /*!< Process ID of the writer */
+    uint32_t        reserved;
+    volatile uint32_t seq;      /*!< Sequence lock, odd while writing */
+    volatile uint32_t count;    /*!< Number of valid records */
+    volatile double time;       /*!< Time of the data (Julian date) */
+    gpredict_shm_sat_t sats[];  /*!< The records */
+} gpredict_shm_t;
+
+
+/**
+ * \brief Map a shared memory snapshot read-only.
+ * \param name The name given in the SHM key, e.g. "/gpredict".
+ * \return The snapshot or NULL if it does not exist or is not valid.
+ */
+static inline const gpredict_shm_t *gpredict_shm_open(const char *name)
+{
+    const gpredict_shm_t *shm;
+    struct stat     st;
+    void           *map;
+    int             fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(gpredict_shm_t))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    shm = (const gpredict_shm_t *)map;
+    if (shm->magic != GPREDICT_SHM_MAGIC ||
+        shm->version != GPREDICT_SHM_VERSION ||
+        shm->record_size != sizeof(gpredict_shm_sat_t) ||
+        shm->size != (size_t) st.st_size)
+    {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    return shm;
+}
+
+/** \brief Unmap a snapshot opened with gpredict_shm_open(). */
+static inline void gpredict_shm_close(const gpredict_shm_t *shm)
+{
+    if (shm != NULL)
+        munmap((void *)shm, shm->size);
+}
+
+/**
+ * \brief Copy a consistent snapshot of the records.
+ * \param shm The snapshot.
+ * \param sats Buffer for the records.
+ * \param max Size of the buffer (records).
+ * \param time Return value for the time of the data, may be NULL.
+ * \return Number of records copied, 0 if no consistent copy could be made
+ *         within GPREDICT_SHM_RETRIES attempts, or -1 if the object has
+ *         been closed and must be reopened.
+ */
+static inline int gpredict_shm_read(const gpredict_shm_t *shm,
+                                    gpredict_shm_sat_t *sats,
+                                    unsigned int max, double *time)
+{
+    uint32_t        seq;
+    uint32_t        count;
+    double          t;
+    int             tries;
+
+    for (tries = 0;; tries++)
+    {
+        if (shm->closed)
+            return -1;
+        if (tries == GPREDICT_SHM_RETRIES)
+            return 0;
+
+        seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+        {
+            /* the writer is busy */
+            sched_yield();
+            continue;
+        }
+
+        count = shm->count;
+        if (count > shm->capacity)
+            continue;
+        if (count > max)
+            count = max;
+
+        t = shm->time;
+        memcpy(sats, shm->sats, count * sizeof(gpredict_shm_sat_t));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == seq)
+            break;
+    }
+
+    if (time != NULL)
+        *time = t;
+
+    return (int)count;
+}
+
+#endif
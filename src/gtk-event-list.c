@@ -100,17 +100,21 @@ const gfloat EVENT_LIST_HEAD_XALIGN[EVENT_LIST_COL_NUMBER] = {
 static void          gtk_event_list_class_init (GtkEventListClass *class);
 static void          gtk_event_list_init       (GtkEventList      *list);
 static void          gtk_event_list_destroy    (GtkObject       *object);
-static GtkTreeModel *create_and_fill_model   (GHashTable      *sats);
-static void          event_list_add_satellites (gpointer key,
+static GtkTreeModel *create_and_fill_model   (GtkEventList    *evlist);
+static void          event_list_add_satellite  (GtkEventList *evlist,
+                                                GtkListStore *store,
+                                                sat_t        *sat);
+static GtkListStore *get_store                 (GtkEventList *evlist);
+static void          event_list_update_event   (gpointer key,
                                                 gpointer value,
-                                                gpointer user_data);
-static gboolean      event_list_update_sats    (GtkTreeModel *model,
-                                                GtkTreePath  *path,
-                                                GtkTreeIter  *iter,
-                                                gpointer      data);
+                                                gpointer data);
+static void          event_list_update_pos     (gpointer key,
+                                                gpointer value,
+                                                gpointer data);
 
 /* cell rendering related functions */
-static void          check_and_set_cell_renderer (GtkTreeViewColumn *column,
+static void          check_and_set_cell_renderer (GtkEventList      *evlist,
+                                                  GtkTreeViewColumn *column,
                                                   GtkCellRenderer   *renderer,
                                                   gint               i);
 
@@ -157,6 +161,13 @@ static void row_activated_cb (GtkTreeView       *tree_view,
 static GtkVBoxClass *parent_class = NULL;
 
 
+/** \brief Row of a satellite in the list store. */
+typedef struct {
+    gint        catnum;     /*!< Catalogue number; key in the rows table */
+    GtkTreeIter iter;       /*!< The row; list store iters are persistent */
+} event_list_row_t;
+
+
 GType gtk_event_list_get_type ()
 {
     static GType gtk_event_list_type = 0;
@@ -208,7 +219,9 @@ static void gtk_event_list_class_init (GtkEventListClass *class)
 
 static void gtk_event_list_init (GtkEventList *list)
 {
-    (void) list; /* avoid unused warning compiler warning. */
+    list->events = NULL;
+    list->events_serial = 0;
+    list->rows = g_hash_table_new_full (g_int_hash, g_int_equal, NULL, g_free);
 }
 
 
@@ -220,6 +233,10 @@ static void gtk_event_list_destroy (GtkObject *object)
 
     g_key_file_set_integer(evlist->cfgdata, MOD_CFG_EVENT_LIST_SECTION, MOD_CFG_EVENT_LIST_SORT_ORDER, evlist->sort_order);
     
+    if (evlist->rows != NULL) {
+        g_hash_table_destroy (evlist->rows);
+        evlist->rows = NULL;
+    }
 
 
     (* GTK_OBJECT_CLASS (parent_class)->destroy) (object);
@@ -228,12 +245,12 @@ static void gtk_event_list_destroy (GtkObject *object)
 
 /** \brief Create a new GtkEventList widget.
   * \param cfgdata Pointer to the module configuration data.
-  * \param sats Hash table containing the satellites tracked by the parent module.
+  * \param sats Registry with the satellites tracked by the parent module.
   * \param qth Pointer to the QTH used by this module.
   * \param columns Visible columns (currently not in use).
   *
   */
-GtkWidget *gtk_event_list_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth, guint32 columns)
+GtkWidget *gtk_event_list_new (GKeyFile *cfgdata, sat_registry_t *sats, qth_t *qth, guint32 columns)
 {
     GtkWidget    *widget;
     GtkEventList *evlist;
@@ -319,7 +336,7 @@ GtkWidget *gtk_event_list_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
         gtk_tree_view_column_set_sort_column_id (column, i);
 
         /* set cell data function; allows to format data before rendering */
-        check_and_set_cell_renderer (column, renderer, i);
+        check_and_set_cell_renderer (evlist, column, renderer, i);
 
         /* hide columns that have not been specified */
         if (!(evlist->flags & (1 << i))) {
@@ -329,7 +346,7 @@ GtkWidget *gtk_event_list_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
     }
 
     /* create model and finalise treeview */
-    model = create_and_fill_model (evlist->satellites);
+    model = create_and_fill_model (evlist);
     filter = gtk_tree_model_filter_new (model, NULL);
     sortable =gtk_tree_model_sort_new_with_model(filter);
     evlist->sortable =  sortable;
@@ -373,9 +390,10 @@ GtkWidget *gtk_event_list_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
 
 
 /** \brief Create and file the tree model for the even list. */
-static GtkTreeModel *create_and_fill_model   (GHashTable      *sats)
+static GtkTreeModel *create_and_fill_model   (GtkEventList    *evlist)
 {
     GtkListStore *liststore;
+    guint         i;
 
 
     liststore = gtk_list_store_new (EVENT_LIST_COL_NUMBER,
@@ -384,55 +402,72 @@ static GtkTreeModel *create_and_fill_model   (GHashTable      *sats)
                                     G_TYPE_DOUBLE,     // az
                                     G_TYPE_DOUBLE,     // el
                                     G_TYPE_BOOLEAN,    // TRUE if AOS, FALSE if LOS
-                                    G_TYPE_DOUBLE,     // time
+                                    G_TYPE_DOUBLE,     // time of event
                                     G_TYPE_BOOLEAN,    // decayed 
                                     G_TYPE_INT);       // bold for storing weight
 
-    /* add each satellite from hash table */
-    g_hash_table_foreach (sats, event_list_add_satellites, liststore);
+    /* add each satellite from the registry */
+    for (i = 0; i < evlist->satellites->num; i++)
+        event_list_add_satellite (evlist, liststore,
+                                  sat_registry_nth (evlist->satellites, i));
 
     return GTK_TREE_MODEL (liststore);
 }
 
 
-/** \brief Add satellites. This function is a g_hash_table_foreach() callback.
-  * \param key The key of the satellite in the hash table.
-  * \param value Pointer to the satellite (sat_t structure) that should be added.
-  * \param user_data Pointer to the GtkListStore where the satellite should be added
+/** \brief Add a satellite.
+  * \param evlist Pointer to the GtkEventList widget.
+  * \param store Pointer to the GtkListStore where the satellite should be added.
+  * \param sat Pointer to the satellite (sat_t structure) that should be added.
   *
-  * This function is called by by the create_and_fill_models() function for adding
-  * the satellites to the internal liststore.
+  * The row is remembered in evlist->rows so that it can be updated without
+  * walking the model. The event columns are filled in from the event queue
+  * once the satellite has been propagated.
   */
-static void event_list_add_satellites (gpointer key, gpointer value, gpointer user_data)
+static void event_list_add_satellite (GtkEventList *evlist, GtkListStore *store, sat_t *sat)
 {
-    GtkListStore *store = GTK_LIST_STORE (user_data);
-    GtkTreeIter   item;
-    sat_t        *sat = SAT (value);
+    event_list_row_t *row;
 
-    (void) key; /* avoid unused warning compiler warning. */
+    row = g_new (event_list_row_t, 1);
+    row->catnum = sat->tle.catnr;
 
-    gtk_list_store_append (store, &item);
-    gtk_list_store_set (store, &item,
+    gtk_list_store_append (store, &row->iter);
+    gtk_list_store_set (store, &row->iter,
                         EVENT_LIST_COL_NAME, sat->nickname,
                         EVENT_LIST_COL_CATNUM, sat->tle.catnr,
                         EVENT_LIST_COL_AZ, sat->az,
                         EVENT_LIST_COL_EL, sat->el,
                         EVENT_LIST_COL_EVT, (sat->el >= 0) ? TRUE : FALSE,
-                        EVENT_LIST_COL_TIME, 0.0,
+                        EVENT_LIST_COL_TIME, -1.0,
                         EVENT_LIST_COL_DECAY, !decayed(sat),
                         -1);    
+
+    g_hash_table_insert (evlist->rows, &row->catnum, row);
 }
 
 
+/** \brief Get the list store behind the filter and sort models. */
+static GtkListStore *get_store (GtkEventList *evlist)
+{
+    return GTK_LIST_STORE (gtk_tree_model_filter_get_model (GTK_TREE_MODEL_FILTER (
+                           gtk_tree_model_sort_get_model (GTK_TREE_MODEL_SORT (
+                           evlist->sortable)))));
+}
+
 
-/** \brief Update satellites */
+/** \brief Update satellites
+  *
+  * The event columns are only touched for satellites whose next event has
+  * changed in the event queue. The countdown, azimuth and elevation are
+  * computed by the cell data functions when a row is drawn, so only the
+  * visible rows cost anything. Azimuth and elevation are written to the
+  * model only when the list is sorted by one of them.
+  */
 void gtk_event_list_update          (GtkWidget *widget)
 {
-    GtkTreeModel *model;
     GtkEventList   *evlist = GTK_EVENT_LIST (widget);
 
 
-
     /* first, do some sanity checks */
     if ((evlist == NULL) || !IS_GTK_EVENT_LIST (evlist)) {
         sat_log_log (SAT_LOG_LEVEL_ERROR,
@@ -441,118 +476,77 @@ void gtk_event_list_update          (GtkWidget *widget)
 		return;
     }
 
-    /* get and tranverse the model */
-    model = gtk_tree_model_filter_get_model( GTK_TREE_MODEL_FILTER(
-             gtk_tree_model_sort_get_model( GTK_TREE_MODEL_SORT (
-             gtk_tree_view_get_model (GTK_TREE_VIEW (evlist->treeview))))));
-
     /*save the sort information */
     gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (evlist->sortable),
                                           &(evlist->sort_column),
                                           &(evlist->sort_order));
 
-
-    /* update */
-    gtk_tree_model_foreach (model, event_list_update_sats, evlist);
-
-
-#if 0
-    /* check refresh rate */
-    if (evlist->counter < evlist->refresh) {
-        evlist->counter++;
+    /* update rows of satellites with new events */
+    if (evlist->events != NULL) {
+        event_queue_foreach_changed (evlist->events, evlist->events_serial,
+                                     event_list_update_event, evlist);
+        evlist->events_serial = evlist->events->serial;
     }
-    else {
-        evlist->counter = 1;
-
-        /* get and tranverse the model */
-        model = gtk_tree_model_filter_get_model(gtk_tree_view_get_model (GTK_TREE_VIEW (evlist->treeview)));
-
 
-        /* update */
-        gtk_tree_model_foreach (model, event_list_update_sats, evlist);
+    if (evlist->sort_column == EVENT_LIST_COL_AZ ||
+        evlist->sort_column == EVENT_LIST_COL_EL) {
+        g_hash_table_foreach (evlist->rows, event_list_update_pos, evlist);
     }
-#endif
+
+    gtk_widget_queue_draw (evlist->treeview);
 }
 
 
-/** \brief Update data in each column in a given row */
-static gboolean event_list_update_sats (GtkTreeModel *model,
-                                        GtkTreePath  *path,
-                                        GtkTreeIter  *iter,
-                                        gpointer      data)
+/** \brief Update the event columns of a satellite.
+  *
+  * This is a event_queue_foreach_changed() callback.
+  */
+static void event_list_update_event (gpointer key, gpointer value, gpointer data)
 {
-    GtkEventList *evlist = GTK_EVENT_LIST (data);
-    guint      *catnum;
-    sat_t      *sat;
-    gdouble     number, now;
-
-    (void) path; /* avoid unused warning compiler warning. */
-
-    /* get the catalogue number for this row
-       then look it up in the hash table
-    */
-    catnum = g_new0 (guint, 1);
-    gtk_tree_model_get (model, iter, EVENT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT (g_hash_table_lookup (evlist->satellites, catnum));
-
-    if (sat == NULL) {
-        /* satellite not tracked anymore => remove */
-        sat_log_log (SAT_LOG_LEVEL_INFO,
-                     _("%s: Failed to get data for #%d."),
-                     __func__, *catnum);
-
-        gtk_list_store_remove (GTK_LIST_STORE (model), iter);
-
-        sat_log_log (SAT_LOG_LEVEL_ERROR,
-                     _("%s: Satellite #%d removed from list."),
-                     __func__, *catnum);
-    }
-    else {
-
-        /* update data */
-        now = evlist->tstamp;
+    GtkEventList     *evlist = GTK_EVENT_LIST (data);
+    event_entry_t    *entry = (event_entry_t *) value;
+    event_list_row_t *row;
+
+    row = g_hash_table_lookup (evlist->rows, key);
+    if (row == NULL)
+        return;
+
+    gtk_list_store_set (get_store (evlist), &row->iter,
+                        EVENT_LIST_COL_EVT, entry->inpass,
+                        EVENT_LIST_COL_TIME, entry->t,
+                        EVENT_LIST_COL_DECAY, !decayed(entry->sat),
+                        EVENT_LIST_COL_BOLD, entry->inpass ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
+                        -1);
+}
 
-        if (sat->el > 0.0) {
-            if (sat->los > 0.0) {
-                number = sat->los - now;
-            }
-            else {
-                number = -1.0;   /* Sat is staionary or no event */
-            }
-        }
-        else {
-            if (sat->aos > 0.0) {
-                number = sat->aos - now;
-            }
-            else {
-                number = -1.0; /* Sat is staionary or no event */
-            }
-        }
 
-        /* store new data */
-        gtk_list_store_set (GTK_LIST_STORE (model), iter,
-                            EVENT_LIST_COL_AZ, sat->az,
-                            EVENT_LIST_COL_EL, sat->el,
-                            EVENT_LIST_COL_EVT, (sat->el >= 0) ? TRUE : FALSE,
-                            EVENT_LIST_COL_TIME, number,
-                            EVENT_LIST_COL_DECAY, !decayed(sat),
-                            EVENT_LIST_COL_BOLD,(sat->el>0.0)?PANGO_WEIGHT_BOLD:PANGO_WEIGHT_NORMAL,
-                            -1);
+/** \brief Store azimuth and elevation of a satellite in the model.
+  *
+  * This is only needed for sorting by azimuth or elevation.
+  */
+static void event_list_update_pos (gpointer key, gpointer value, gpointer data)
+{
+    GtkEventList     *evlist = GTK_EVENT_LIST (data);
+    event_list_row_t *row = (event_list_row_t *) value;
+    sat_t            *sat;
 
-    }
+    (void) key;                 /* avoid unused parameter compiler warning */
 
-    g_free (catnum);
+    sat = sat_registry_lookup (evlist->satellites, row->catnum);
+    if (sat == NULL)
+        return;
 
-    /* Return value not documented what to return, but it seems that
-       FALSE continues to next row while TRUE breaks
-    */
-    return FALSE;
+    gtk_list_store_set (get_store (evlist), &row->iter,
+                        EVENT_LIST_COL_AZ, sat->az,
+                        EVENT_LIST_COL_EL, sat->el,
+                        -1);
 }
 
 
 
 /** \brief Set cell renderer function. */
-static void check_and_set_cell_renderer (GtkTreeViewColumn *column,
+static void check_and_set_cell_renderer (GtkEventList      *evlist,
+                                         GtkTreeViewColumn *column,
                                          GtkCellRenderer   *renderer,
                                          gint               i)
 {
@@ -565,7 +559,7 @@ static void check_and_set_cell_renderer (GtkTreeViewColumn *column,
         gtk_tree_view_column_set_cell_data_func (column,
                                                  renderer,
                                                  degree_cell_data_function,
-                                                 GUINT_TO_POINTER (i),
+                                                 evlist,
                                                  NULL);
         break;
 
@@ -583,7 +577,7 @@ static void check_and_set_cell_renderer (GtkTreeViewColumn *column,
         gtk_tree_view_column_set_cell_data_func (column,
                                                  renderer,
                                                  time_cell_data_function,
-                                                 GUINT_TO_POINTER (i),
+                                                 evlist,
                                                  NULL);
         break;
 
@@ -631,24 +625,23 @@ static void evtype_cell_data_function (GtkTreeViewColumn *col,
 
 
 
-/* AOS/LOS; convert julian date to string */
+/* AOS/LOS; the cell contains the time of the event, render the countdown */
 static void time_cell_data_function (GtkTreeViewColumn *col,
                                      GtkCellRenderer   *renderer,
                                      GtkTreeModel      *model,
                                      GtkTreeIter       *iter,
-                                     gpointer           column)
+                                     gpointer           list)
 {
     (void) col; /* avoid unused warning compiler warning. */
 
     gdouble    number;
     gchar     *buff;
-    guint      coli = GPOINTER_TO_UINT (column);
 
     guint         h,m,s;
 
 
     /* get cell data */
-    gtk_tree_model_get (model, iter, coli, &number, -1);
+    gtk_tree_model_get (model, iter, EVENT_LIST_COL_TIME, &number, -1);
 
     /* format the time code */
     if (number < 0.0) {
@@ -656,6 +649,10 @@ static void time_cell_data_function (GtkTreeViewColumn *col,
     }
     else {
 
+        number -= GTK_EVENT_LIST (list)->tstamp;
+        if (number < 0.0)
+            number = 0.0;
+
         /* convert julian date to seconds */
         s = (guint) (number * 86400);
 
@@ -684,22 +681,30 @@ static void time_cell_data_function (GtkTreeViewColumn *col,
 
 
 
-/* general floats with 2 digits + degree char. Used for Az and El */
+/* general floats with 2 digits + degree char. Used for Az and El.
+   The value is taken from the satellite so that the model does not have
+   to be updated in every cycle. */
 static void degree_cell_data_function (GtkTreeViewColumn *col,
                                        GtkCellRenderer   *renderer,
                                        GtkTreeModel      *model,
                                        GtkTreeIter       *iter,
-                                       gpointer           column)
+                                       gpointer           list)
 {
-    (void) col; /* avoid unused warning compiler warning. */
-        
     gdouble    number;
     gchar     *buff;
-    guint      coli = GPOINTER_TO_UINT (column);
+    gint       coli = gtk_tree_view_column_get_sort_column_id (col);
+    gint       catnum;
+    sat_t     *sat;
 
 
     /* get the value */
-    gtk_tree_model_get (model, iter, coli, &number, -1);
+    gtk_tree_model_get (model, iter, EVENT_LIST_COL_CATNUM, &catnum, -1);
+    sat = sat_registry_lookup (GTK_EVENT_LIST (list)->satellites, catnum);
+
+    if (sat != NULL)
+        number = (coli == EVENT_LIST_COL_AZ) ? sat->az : sat->el;
+    else
+        gtk_tree_model_get (model, iter, coli, &number, -1);
 
     /* format the number */
     buff = g_strdup_printf ("%.2f\302\260", number);
@@ -835,30 +840,27 @@ row_activated_cb (GtkTreeView       *tree_view,
 {
     GtkTreeModel  *model;
     GtkTreeIter    iter;
-    guint         *catnum;
+    gint           catnum;
     sat_t         *sat;
     
     (void) column; /* avoid unused warning compiler warning. */
 
-    catnum = g_new0 (guint, 1);
     model = gtk_tree_view_get_model(tree_view);
     gtk_tree_model_get_iter (model, &iter, path);
     gtk_tree_model_get (model, &iter,
-                        EVENT_LIST_COL_CATNUM, catnum,
+                        EVENT_LIST_COL_CATNUM, &catnum,
                         -1);
 
-    sat = SAT (g_hash_table_lookup (GTK_EVENT_LIST (list)->satellites, catnum));
+    sat = sat_registry_lookup (GTK_EVENT_LIST (list)->satellites, catnum);
 
     if (sat == NULL) {
         sat_log_log (SAT_LOG_LEVEL_INFO,
                      _("%s:%d Failed to get data for %d."),
-                     __FILE__, __LINE__, *catnum);
+                     __FILE__, __LINE__, catnum);
     }
     else {
         show_sat_info(sat, gtk_widget_get_toplevel (GTK_WIDGET (list)));
     }
-
-    g_free (catnum);
 }
 
 static void view_popup_menu (GtkWidget *treeview, GdkEventButton *event, gpointer list)
@@ -866,26 +868,24 @@ static void view_popup_menu (GtkWidget *treeview, GdkEventButton *event, gpointe
     GtkTreeSelection *selection;
     GtkTreeModel     *model;
     GtkTreeIter       iter;
-    guint            *catnum;
+    gint              catnum;
     sat_t            *sat;
 
-    catnum = g_new0 (guint, 1);
-
     /* get selected satellite */
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (treeview));
     if (gtk_tree_selection_get_selected (selection, &model, &iter))  {
 
 
         gtk_tree_model_get (model, &iter,
-                            EVENT_LIST_COL_CATNUM, catnum,
+                            EVENT_LIST_COL_CATNUM, &catnum,
                             -1);
 
-        sat = SAT (g_hash_table_lookup (GTK_EVENT_LIST (list)->satellites, catnum));
+        sat = sat_registry_lookup (GTK_EVENT_LIST (list)->satellites, catnum);
 
         if (sat == NULL) {
             sat_log_log (SAT_LOG_LEVEL_INFO,
                          _("%s:%d Failed to get data for %d."),
-                         __FILE__, __LINE__, *catnum);
+                         __FILE__, __LINE__, catnum);
 
         }
         else {
@@ -900,19 +900,57 @@ static void view_popup_menu (GtkWidget *treeview, GdkEventButton *event, gpointe
                      _("%s:%d: There is no selection; skip popup."),
                      __FILE__, __LINE__);
     }
-
-    g_free (catnum);
 }
 
 
 
 
 
-/** \brief Reload reference to satellites (e.g. after TLE update). */
+/** \brief Reload reference to satellites (e.g. after TLE update).
+  *
+  * Rows of satellites that are no longer tracked are removed and rows for
+  * new satellites are added. All event columns are refreshed from the event
+  * queue in the next update.
+  */
 void
-gtk_event_list_reload_sats (GtkWidget *evlist, GHashTable *sats)
+gtk_event_list_reload_sats (GtkWidget *widget, sat_registry_t *sats)
 {
-    GTK_EVENT_LIST (evlist)->satellites = sats;
+    GtkEventList     *evlist = GTK_EVENT_LIST (widget);
+    GtkListStore     *store = get_store (evlist);
+    GHashTableIter    iter;
+    gpointer          value;
+    event_list_row_t *row;
+    sat_t            *sat;
+    guint             i;
+
+    evlist->satellites = sats;
+    evlist->events_serial = 0;
+
+    g_hash_table_iter_init (&iter, evlist->rows);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        row = (event_list_row_t *) value;
+        if (sat_registry_lookup (sats, row->catnum) == NULL) {
+            sat_log_log (SAT_LOG_LEVEL_INFO,
+                         _("%s: Satellite #%d removed from list."),
+                         __func__, row->catnum);
+            gtk_list_store_remove (store, &row->iter);
+            g_hash_table_iter_remove (&iter);
+        }
+    }
+
+    for (i = 0; i < sats->num; i++) {
+        sat = sat_registry_nth (sats, i);
+        if (g_hash_table_lookup (evlist->rows, &sat->tle.catnr) == NULL)
+            event_list_add_satellite (evlist, store, sat);
+    }
+}
+
+
+/** \brief Set the event queue the list is updated from. */
+void gtk_event_list_set_events (GtkWidget *widget, event_queue_t *events)
+{
+    GTK_EVENT_LIST (widget)->events = events;
+    GTK_EVENT_LIST (widget)->events_serial = 0;
 }
 
 
@@ -920,33 +958,26 @@ gtk_event_list_reload_sats (GtkWidget *evlist, GHashTable *sats)
 void gtk_event_list_select_sat  (GtkWidget *widget, gint catnum)
 {
     GtkEventList *list;
-    GtkTreeModel *model;
+    GtkTreeModel *filter;
     GtkTreeSelection *selection;
-    GtkTreeIter iter;
-    gint i,n;
-    gint sat;
+    GtkTreeIter fiter, siter;
+    event_list_row_t *row;
     
     
     list = GTK_EVENT_LIST(widget);
-    model = gtk_tree_view_get_model(GTK_TREE_VIEW(list->treeview));
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(list->treeview));
 
-    /* iterate over the satellite list until a amtch is found */
-    n = g_hash_table_size(list->satellites);
-    for (i = 0; i < n; i++) {
-        
-        if (gtk_tree_model_iter_nth_child(model, &iter, NULL, i)) {
-            gtk_tree_model_get(model, &iter, EVENT_LIST_COL_CATNUM, &sat, -1);
-            if (sat == catnum) {
-                gtk_tree_selection_select_iter(selection, &iter);
-                i = n;
-            }
-        }
-        else {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: GtkEventList has not child with index %d"),
-                        __func__, i);
-        }
-    }
+    row = g_hash_table_lookup (list->rows, &catnum);
+    if (row == NULL)
+        return;
+
+    /* convert the list store row to a row in the sorted view */
+    filter = gtk_tree_model_sort_get_model (GTK_TREE_MODEL_SORT (list->sortable));
+    if (!gtk_tree_model_filter_convert_child_iter_to_iter (GTK_TREE_MODEL_FILTER (filter),
+                                                           &fiter, &row->iter))
+        return;
 
+    gtk_tree_model_sort_convert_child_iter_to_iter (GTK_TREE_MODEL_SORT (list->sortable),
+                                                    &siter, &fiter);
+    gtk_tree_selection_select_iter (selection, &siter);
 }
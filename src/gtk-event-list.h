@@ -33,6 +33,8 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
+#include "event-queue.h"
+#include "sat-registry.h"
 
 
 #ifdef __cplusplus
@@ -63,7 +65,7 @@ struct _gtk_event_list
      GtkWidget       *treeview;     /*!< the tree view itself */
      GtkWidget       *swin;         /*!< scrolled window */
      
-     GHashTable      *satellites;   /*!< Satellites. */
+     sat_registry_t  *satellites;   /*!< Satellites. */
      qth_t           *qth;          /*!< Pointer to current location. */
 
      guint32          flags;        /*!< Flags indicating which columns are visible */
@@ -73,6 +75,10 @@ struct _gtk_event_list
     gint              sort_column;
     GtkSortType       sort_order;
     GtkTreeModel      *sortable;
+
+    event_queue_t    *events;       /*!< Upcoming events; owned by GtkSatModule */
+    guint             events_serial; /*!< Event queue serial of last update */
+    GHashTable       *rows;         /*!< GtkTreeIter of each satellite keyed by catnum */
      
      void (* update) (GtkWidget *widget);  /*!< update function */
 
@@ -112,14 +118,15 @@ typedef enum {
 
 GType          gtk_event_list_get_type (void);
 GtkWidget*     gtk_event_list_new      (GKeyFile   *cfgdata,
-                                        GHashTable *sats,
+                                        sat_registry_t *sats,
                                         qth_t      *qth,
                                         guint32     columns);
 void           gtk_event_list_update   (GtkWidget  *widget);
 void           gtk_event_list_reconf   (GtkWidget  *widget, GKeyFile *cfgdat);
 
-void gtk_event_list_reload_sats (GtkWidget *satlist, GHashTable *sats);
+void gtk_event_list_reload_sats (GtkWidget *satlist, sat_registry_t *sats);
 void gtk_event_list_select_sat  (GtkWidget *widget, gint catnum);
+void gtk_event_list_set_events  (GtkWidget *widget, event_queue_t *events);
 
 #ifdef __cplusplus
 }
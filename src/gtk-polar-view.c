@@ -44,6 +44,7 @@
 #include "sat-info.h"
 #include "time-tools.h"
 #include "orbit-tools.h"
+#include "startup-profile.h"
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
 #endif
@@ -67,6 +68,7 @@ static void     size_allocate_cb(GtkWidget * widget,
                                  GtkAllocation * allocation, gpointer data);
 static void     update_sat(gpointer key, gpointer value, gpointer data);
 static void     update_track(gpointer key, gpointer value, gpointer data);
+static void     free_sat_obj(gpointer data);
 static void     correct_pole_coor(GtkPolarView * polv, polar_view_pole_t pole,
                                   gfloat * x, gfloat * y,
                                   GtkAnchorType * anch);
@@ -87,8 +89,6 @@ static void     get_canvas_bg_color(GtkPolarView * polv, GdkColor * color);
 static gchar   *los_time_to_str(GtkPolarView * polv, sat_t * sat);
 static void     gtk_polar_view_store_showtracks(GtkPolarView * pv);
 static void     gtk_polar_view_load_showtracks(GtkPolarView * pv);
-static GooCanvasItemModel *create_time_tick(GtkPolarView * pv, gdouble time,
-                                            gfloat x, gfloat y);
 static void     azel_to_xy(GtkPolarView * p, gdouble az, gdouble el,
                            gfloat * x, gfloat * y);
 static void     xy_to_azel(GtkPolarView * p, gfloat x, gfloat y, gfloat * az,
@@ -152,6 +152,8 @@ static void gtk_polar_view_init(GtkPolarView * polview)
     polview->sats = NULL;
     polview->qth = NULL;
     polview->obj = NULL;
+    polview->trklayer = NULL;
+    polview->satlayer = NULL;
     polview->naos = 0.0;
     polview->ncat = 0;
     polview->size = 0;
@@ -171,7 +173,15 @@ static void gtk_polar_view_init(GtkPolarView * polview)
 
 static void gtk_polar_view_destroy(GtkObject * object)
 {
-    gtk_polar_view_store_showtracks(GTK_POLAR_VIEW(object));
+    GtkPolarView   *polv = GTK_POLAR_VIEW(object);
+
+    gtk_polar_view_store_showtracks(polv);
+
+    if (polv->obj != NULL)
+    {
+        g_hash_table_destroy(polv->obj);
+        polv->obj = NULL;
+    }
 
     (*GTK_OBJECT_CLASS(parent_class)->destroy) (object);
 }
@@ -179,15 +189,16 @@ static void gtk_polar_view_destroy(GtkObject * object)
 
 /** \brief Create a new GtkPolarView widget.
  *  \param cfgdata The configuration data of the parent module.
- *  \param sats Pointer to the hash table containing the asociated satellites.
+ *  \param sats Pointer to the registry containing the asociated satellites.
  *  \param qth Pointer to the ground station data.
  */
-GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
+GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, sat_registry_t * sats,
                                    qth_t * qth)
 {
     GtkWidget      *polv;
     GooCanvasItemModel *root;
     GdkColor        bg_color = { 0, 0xFFFF, 0xFFFF, 0xFFFF };
+    gint64          t;
 
     polv = g_object_new(GTK_TYPE_POLAR_VIEW, NULL);
 
@@ -198,7 +209,7 @@ GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
 
     GTK_POLAR_VIEW(polv)->obj = g_hash_table_new_full(g_int_hash,
                                                       g_int_equal,
-                                                      g_free, NULL);
+                                                      g_free, free_sat_obj);
 
     GTK_POLAR_VIEW(polv)->showtracks_on = g_hash_table_new_full(g_int_hash,
                                                                 g_int_equal,
@@ -272,9 +283,12 @@ GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
     gtk_widget_show(GTK_POLAR_VIEW(polv)->canvas);
 
     /* Create the canvas model */
+    t = startup_profile_begin();
     root = create_canvas_model(GTK_POLAR_VIEW(polv));
     goo_canvas_set_root_item_model(GOO_CANVAS(GTK_POLAR_VIEW(polv)->canvas),
                                    root);
+    startup_profile_end(t, "gtk_polar_view_canvas", "%u satellites",
+                        sats->num);
 
     g_object_unref(root);
 
@@ -300,6 +314,9 @@ static GooCanvasItemModel *create_canvas_model(GtkPolarView * polv)
     polv->cx = POLV_DEFAULT_SIZE / 2;
     polv->cy = POLV_DEFAULT_SIZE / 2;
 
+    /* sky tracks go below everything else */
+    polv->trklayer = goo_canvas_group_model_new(root, NULL);
+
     col = mod_cfg_get_int(polv->cfgdata,
                           MOD_CFG_POLAR_SECTION,
                           MOD_CFG_POLAR_AXIS_COL, SAT_CFG_INT_POLAR_AXIS_COL);
@@ -427,6 +444,9 @@ static GooCanvasItemModel *create_canvas_model(GtkPolarView * polv)
                                           "fill-color-rgba", col, "alignment",
                                           PANGO_ALIGN_RIGHT, NULL);
 
+    /* satellites go on top */
+    polv->satlayer = goo_canvas_group_model_new(root, NULL);
+
     return root;
 }
 
@@ -624,7 +644,7 @@ static void update_polv_size(GtkPolarView * polv)
                      "x", (gfloat) polv->cx + polv->r + 2 * POLV_LINE_EXTRA,
                      "y", (gfloat) polv->cy + polv->r + POLV_LINE_EXTRA, NULL);
 
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        sat_registry_foreach(polv->sats, update_sat, polv);
 
         /* sky tracks */
         g_hash_table_foreach(polv->obj, update_track, polv);
@@ -657,7 +677,6 @@ void gtk_polar_view_update(GtkWidget * widget)
     gchar          *buff;
     guint           h, m, s;
     sat_t          *sat = NULL;
-    gint           *catnr;
 
     if (polv->resize)
     {
@@ -679,7 +698,7 @@ void gtk_polar_view_update(GtkWidget * widget)
         polv->ncat = 0;
 
         /* update sats */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        sat_registry_foreach(polv->sats, update_sat, polv);
 
         /* update countdown to NEXT AOS label */
         if (polv->eventinfo)
@@ -687,10 +706,7 @@ void gtk_polar_view_update(GtkWidget * widget)
 
             if (polv->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = polv->ncat;
-                sat = SAT(g_hash_table_lookup(polv->sats, catnr));
-                g_free(catnr);
+                sat = sat_registry_lookup(polv->sats, polv->ncat);
 
                 /* last desperate sanity check */
                 if (sat != NULL)
@@ -745,443 +761,429 @@ void gtk_polar_view_update(GtkWidget * widget)
 }
 
 
-static void update_sat(gpointer key, gpointer value, gpointer data)
+/** \brief Free a satellite object (hash table value destroy function). */
+static void free_sat_obj(gpointer data)
 {
-    gint           *catnum;
-    sat_t          *sat = SAT(value);
-    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
-    sat_obj_t      *obj = NULL;
-    gfloat          x, y;
-    GooCanvasItemModel *root;
-    gint            idx, i;
-    gdouble         now;        // = get_current_daynum ();
-    gchar          *text;
-    gchar          *losstr;
-    gchar          *tooltip;
-    guint32         colour;
+    sat_obj_t      *obj = SAT_OBJ(data);
 
-    (void)key;                  /* avoid unused parameter compiler warning */
+    free_pass(obj->pass);
+    g_free(obj->skytrack);
+    g_free(obj);
+}
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
 
-    now = polv->tstamp;
+/** \brief Show or hide a canvas item model. */
+static void set_visible(GooCanvasItemModel * item, gboolean visible)
+{
+    g_object_set(item, "visibility",
+                 visible ? GOO_CANVAS_ITEM_VISIBLE : GOO_CANVAS_ITEM_HIDDEN,
+                 NULL);
+}
 
-    /* update next AOS */
-    if (sat->aos > now)
-    {
-        if ((sat->aos < polv->naos) || (polv->naos == 0.0))
-        {
-            polv->naos = sat->aos;
-            polv->ncat = sat->tle.catnr;
-        }
-    }
 
-    /* if sat is out of range */
-    if ((sat->el < 0.00) || decayed(sat))
-    {
+/** \brief Create the persistent canvas items of a satellite.
+ *
+ * The marker and label live in a group under polv->satlayer, the sky track
+ * and its time ticks in a group under polv->trklayer. Both groups stay on
+ * the canvas for the lifetime of the view and are only shown and hidden as
+ * the satellite rises and sets.
+ */
+static sat_obj_t *create_sat_obj(GtkPolarView * polv, sat_t * sat)
+{
+    sat_obj_t      *obj;
+    gint           *catkey;
+    gint            catnum = sat->tle.catnr;
+    guint32         colour;
+    gint            i;
 
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
+    obj = g_try_new0(sat_obj_t, 1);
+    if (obj == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Cannot allocate memory for satellite %d."),
+                    __func__, catnum);
+        return NULL;
+    }
 
-        /* if sat is on canvas */
-        if (obj != NULL)
-        {
+    if (g_hash_table_lookup_extended(polv->showtracks_on, &catnum, NULL, NULL))
+        obj->showtrack = TRUE;
+    else if (g_hash_table_lookup_extended
+             (polv->showtracks_off, &catnum, NULL, NULL))
+        obj->showtrack = FALSE;
+    else
+        obj->showtrack = polv->showtrack;
+
+    colour = mod_cfg_get_int(polv->cfgdata,
+                             MOD_CFG_POLAR_SECTION,
+                             MOD_CFG_POLAR_SAT_COL, SAT_CFG_INT_POLAR_SAT_COL);
+
+    obj->group = goo_canvas_group_model_new(polv->satlayer,
+                                            "visibility",
+                                            GOO_CANVAS_ITEM_HIDDEN, NULL);
+    obj->marker = goo_canvas_rect_model_new(obj->group, 0, 0,
+                                            2 * MARKER_SIZE_HALF,
+                                            2 * MARKER_SIZE_HALF,
+                                            "fill-color-rgba", colour,
+                                            "stroke-color-rgba", colour, NULL);
+    obj->label = goo_canvas_text_model_new(obj->group, sat->nickname, 0, 0,
+                                           -1, GTK_ANCHOR_NORTH,
+                                           "font", "Sans 8",
+                                           "fill-color-rgba", colour, NULL);
+    g_object_set_data(G_OBJECT(obj->marker), "catnum",
+                      GINT_TO_POINTER(catnum));
+    g_object_set_data(G_OBJECT(obj->label), "catnum", GINT_TO_POINTER(catnum));
+
+    colour = mod_cfg_get_int(polv->cfgdata,
+                             MOD_CFG_POLAR_SECTION,
+                             MOD_CFG_POLAR_TRACK_COL,
+                             SAT_CFG_INT_POLAR_TRACK_COL);
+
+    obj->trgroup = goo_canvas_group_model_new(polv->trklayer,
+                                              "visibility",
+                                              GOO_CANVAS_ITEM_HIDDEN, NULL);
+    obj->track = goo_canvas_polyline_model_new(obj->trgroup, FALSE, 0,
+                                               "line-width", 1.0,
+                                               "stroke-color-rgba", colour,
+                                               "line-cap",
+                                               CAIRO_LINE_CAP_SQUARE,
+                                               "line-join",
+                                               CAIRO_LINE_JOIN_MITER, NULL);
+    for (i = 0; i < TRACK_TICK_NUM; i++)
+        obj->trtick[i] = goo_canvas_text_model_new(obj->trgroup, "", 0, 0,
+                                                   -1, GTK_ANCHOR_WEST,
+                                                   "font", "Sans 7",
+                                                   "fill-color-rgba", colour,
+                                                   NULL);
 
-            /* remove sat from canvas */
-            root = goo_canvas_get_root_item_model(GOO_CANVAS(polv->canvas));
+    catkey = g_new(gint, 1);
+    *catkey = catnum;
+    g_hash_table_insert(polv->obj, catkey, obj);
 
-            idx = goo_canvas_item_model_find_child(root, obj->marker);
-            if (idx != -1)
-            {
-                goo_canvas_item_model_remove_child(root, idx);
-            }
+    return obj;
+}
 
-            idx = goo_canvas_item_model_find_child(root, obj->label);
-            if (idx != -1)
-            {
-                goo_canvas_item_model_remove_child(root, idx);
-            }
 
-            /* remove sky track */
-            if (obj->showtrack)
-            {
-                gtk_polar_view_delete_track(polv, obj, sat);
-            }
+/** \brief Show the sky track group if the track is enabled and available. */
+static void update_track_visibility(sat_obj_t * obj)
+{
+    set_visible(obj->trgroup,
+                obj->visible && obj->showtrack && (obj->skynum > 0));
+}
 
-            /* free pass info */
-            free_pass(obj->pass);
-            obj->pass = NULL;
 
-            /* if this was the selected satellite we need to
-               clear the info text
-             */
-            if (obj->selected)
-            {
-                g_object_set(polv->sel, "text", "", NULL);
-            }
+/** \brief Convert the pass details into an Az/El polyline.
+ *
+ * The pass details are traversed once and stored as a flat array of Az/El
+ * pairs together with the position and time of the time ticks. Redrawing the
+ * track after a resize or when it is toggled on then only needs azel_to_xy.
+ */
+static void build_sky_track(sat_obj_t * obj)
+{
+    GSList         *node;
+    pass_detail_t  *detail;
+    gdouble         az, el;
+    guint           num, i, tres;
 
-            g_free(obj);
+    g_free(obj->skytrack);
+    obj->skytrack = NULL;
+    obj->skynum = 0;
+    obj->ntick = 0;
 
-            /* remove sat object from hash table */
-            g_hash_table_remove(polv->obj, catnum);
+    if (obj->pass == NULL)
+        return;
 
-            /* FIXME: remove track from chart */
+    num = g_slist_length(obj->pass->details);
+    if (num < 2)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s:%d: Pass had no points in it."), __FILE__, __LINE__);
+        return;
+    }
 
-        }
+    /* time resolution for time ticks; we need
+       3 additional points to AOS and LOS ticks.
+     */
+    tres = MAX((num - 2) / (TRACK_TICK_NUM - 1), 1);
 
-        g_free(catnum);
-    }
+    obj->skytrack = g_new(gdouble, 2 * num);
 
-    /* sat is within range */
-    else
+    /* first point should be (aos_az,0.0) */
+    az = obj->pass->aos_az;
+    el = 0.0;
+    obj->skytrack[0] = az;
+    obj->skytrack[1] = el;
+    obj->tickidx[0] = 0;
+    obj->ticktime[0] = obj->pass->aos;
+    obj->ntick = 1;
+
+    node = obj->pass->details->next;
+    for (i = 1; i < num - 1; i++, node = node->next)
     {
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
-        azel_to_xy(polv, sat->az, sat->el, &x, &y);
+        detail = PASS_DETAIL(node->data);
 
-        /* if sat is already on canvas */
-        if (obj != NULL)
+        /* points below the horizon repeat the previous one */
+        if (detail->el >= 0.0)
         {
+            az = detail->az;
+            el = detail->el;
+        }
+        obj->skytrack[2 * i] = az;
+        obj->skytrack[2 * i + 1] = el;
 
-            /* update LOS count down */
-            if (sat->los > 0.0)
-            {
-                losstr = los_time_to_str(polv, sat);
-            }
-            else
-            {
-                losstr =
-                    g_strdup_printf(_("%s\nAlways in range"), sat->nickname);
-            }
+        if (!(i % tres) && (obj->ntick < TRACK_TICK_NUM))
+        {
+            obj->tickidx[obj->ntick] = i;
+            obj->ticktime[obj->ntick] = detail->time;
+            obj->ntick++;
+        }
+    }
 
-            /* update label */
-            g_object_set(obj->label, "text", sat->nickname, NULL);
+    /* last point should be (los_az, 0.0)  */
+    obj->skytrack[2 * (num - 1)] = obj->pass->los_az;
+    obj->skytrack[2 * (num - 1) + 1] = 0.0;
 
-            /* update tooltip */
-            tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                              "Az: %5.1f\302\260\n"
-                                              "El: %5.1f\302\260\n"
-                                              "%s",
-                                              sat->nickname,
-                                              sat->az, sat->el, losstr);
+    obj->skynum = num;
+}
 
-            g_object_set(obj->marker,
-                         "x", x - MARKER_SIZE_HALF,
-                         "y", y - MARKER_SIZE_HALF, "tooltip", tooltip, NULL);
-            g_object_set(obj->label,
-                         "x", x, "y", y + 2, "tooltip", tooltip, NULL);
 
-            g_free(tooltip);
+/** \brief Place a time tick next to the sky track point (x,y). */
+static void set_time_tick(GtkPolarView * pv, GooCanvasItemModel * item,
+                          gdouble time, gfloat x, gfloat y)
+{
+    gchar           buff[8];
+    GtkAnchorType   anchor;
 
-            /* update selection info if satellite is
-               selected
-             */
-            if (obj->selected)
-            {
-                text = g_strdup_printf("%s\n%s", sat->nickname, losstr);
-                g_object_set(polv->sel, "text", text, NULL);
-                g_free(text);
-            }
+    daynum_to_str(buff, 8, "%H:%M", time);
 
-            /* Current pass and sky track needs update if they were calculated at
-             * a different location or time (time controller)
-             */
-            if (obj->pass)
-            {
-                /** FIXME: threshold */
-                gboolean qth_upd = qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
-                gboolean time_upd = !((obj->pass->aos <= now) && (obj->pass->los >= now));
+    if (x > pv->cx)
+    {
+        anchor = GTK_ANCHOR_EAST;
+        x -= 5;
+    }
+    else
+    {
+        anchor = GTK_ANCHOR_WEST;
+        x += 5;
+    }
 
-                if (qth_upd || time_upd)
-                {
-                    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                                _("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
-                                __FILE__, __func__, *catnum, qth_upd, time_upd);
-
-                    root = goo_canvas_get_root_item_model(GOO_CANVAS(polv->canvas));
-
-                    /* remove sky track */
-                    if (obj->showtrack)
-                    {
-                        idx = goo_canvas_item_model_find_child(root, obj->track);
-                        if (idx != -1)
-                            goo_canvas_item_model_remove_child(root, idx);
-
-                        for (i = 0; i < TRACK_TICK_NUM; i++)
-                        {
-                            idx = goo_canvas_item_model_find_child(root, obj->trtick[i]);
-                            if (idx != -1)
-                                goo_canvas_item_model_remove_child(root, idx);
-                        }
-                    }
-
-                    /* free pass info */
-                    free_pass(obj->pass);
-                    obj->pass = NULL;
-
-                    /*compute new pass */
-                    obj->pass = get_current_pass(sat, polv->qth, now);
-
-                    /* Finally, create the sky track if necessary */
-                    if (obj->showtrack)
-                        gtk_polar_view_create_track(polv, obj, sat);
-                }
-            }
-            g_free(losstr);
-            g_free(catnum);     // FIXME: why free here, what about else?
-        }
-        else
-        {
-            /* add sat to canvas */
-            obj = g_try_new(sat_obj_t, 1);
+    g_object_set(item, "text", buff, "anchor", anchor,
+                 "x", (gdouble) x, "y", (gdouble) y, NULL);
+}
 
-            if (obj != NULL)
-            {
-                /* space was allocated now use it */
-                obj->selected = FALSE;
 
-                if (g_hash_table_lookup_extended
-                    (polv->showtracks_on, catnum, NULL, NULL))
-                {
-                    obj->showtrack = TRUE;
-                }
-                else if (g_hash_table_lookup_extended
-                         (polv->showtracks_off, catnum, NULL, NULL))
-                {
-                    obj->showtrack = FALSE;
-                }
-                else
-                {
-                    obj->showtrack = polv->showtrack;
-                }
-                obj->istarget = FALSE;
-
-                root =
-                    goo_canvas_get_root_item_model(GOO_CANVAS(polv->canvas));
-
-                colour = mod_cfg_get_int(polv->cfgdata,
-                                         MOD_CFG_POLAR_SECTION,
-                                         MOD_CFG_POLAR_SAT_COL,
-                                         SAT_CFG_INT_POLAR_SAT_COL);
-
-                /* create tooltip */
-                tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                                  "Az: %5.1f\302\260\n"
-                                                  "El: %5.1f\302\260\n",
-                                                  sat->nickname,
-                                                  sat->az, sat->el);
-
-                obj->marker = goo_canvas_rect_model_new(root,
-                                                        x - MARKER_SIZE_HALF,
-                                                        y - MARKER_SIZE_HALF,
-                                                        2 * MARKER_SIZE_HALF,
-                                                        2 * MARKER_SIZE_HALF,
-                                                        "fill-color-rgba",
-                                                        colour,
-                                                        "stroke-color-rgba",
-                                                        colour, "tooltip",
-                                                        tooltip, NULL);
-                obj->label =
-                    goo_canvas_text_model_new(root, sat->nickname, x, y + 2,
-                                              -1, GTK_ANCHOR_NORTH, "font",
-                                              "Sans 8", "fill-color-rgba",
-                                              colour, "tooltip", tooltip,
-                                              NULL);
-
-                g_free(tooltip);
-                if (goo_canvas_item_model_find_child(root, obj->marker) != -1)
-                    goo_canvas_item_model_raise(obj->marker, NULL);
-                else
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _
-                                ("%s: marker added to polarview not showing %d."),
-                                __func__, *catnum);
+/** \brief Project the precomputed sky track onto the canvas. */
+static void draw_sky_track(GtkPolarView * pv, sat_obj_t * obj)
+{
+    GooCanvasPoints *points;
+    gfloat          x, y;
+    guint           i, t;
 
-                if (goo_canvas_item_model_find_child(root, obj->label) != -1)
-                    goo_canvas_item_model_raise(obj->label, NULL);
-                else
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _
-                                ("%s: label added to polarview not showing %d."),
-                                __func__, *catnum);
+    if (obj->skynum == 0)
+        return;
 
-                g_object_set_data(G_OBJECT(obj->marker), "catnum",
-                                  GINT_TO_POINTER(*catnum));
-                g_object_set_data(G_OBJECT(obj->label), "catnum",
-                                  GINT_TO_POINTER(*catnum));
+    points = goo_canvas_points_new(obj->skynum);
 
-                /* get info about the current pass */
-                obj->pass = get_current_pass(sat, polv->qth, now);
+    for (i = 0, t = 0; i < obj->skynum; i++)
+    {
+        azel_to_xy(pv, obj->skytrack[2 * i], obj->skytrack[2 * i + 1], &x, &y);
+        points->coords[2 * i] = (double)x;
+        points->coords[2 * i + 1] = (double)y;
 
-                /* add sat to hash table */
-                g_hash_table_insert(polv->obj, catnum, obj);
+        if ((t < obj->ntick) && (obj->tickidx[t] == i))
+        {
+            set_time_tick(pv, obj->trtick[t], obj->ticktime[t], x, y);
+            t++;
+        }
+    }
 
-                /* Finally, create the sky track if necessary */
-                if (obj->showtrack)
-                    gtk_polar_view_create_track(polv, obj, sat);
+    for (t = obj->ntick; t < TRACK_TICK_NUM; t++)
+        g_object_set(obj->trtick[t], "text", "", NULL);
 
-            }
-            else
-            {
-                /* obj == NULL */
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s: Cannot allocate memory for satellite %d."),
-                            __func__, sat->tle.catnr);
-                return;
+    g_object_set(obj->track, "points", points, NULL);
+    goo_canvas_points_unref(points);
+}
 
-            }
-        }
 
-    }
+/** \brief Compute the current pass and its sky track. */
+static void update_pass(GtkPolarView * polv, sat_obj_t * obj, sat_t * sat,
+                        gdouble now)
+{
+    free_pass(obj->pass);
+    obj->pass = get_current_pass(sat, polv->qth, now);
 
+    build_sky_track(obj);
+    if (obj->showtrack)
+        draw_sky_track(polv, obj);
+
+    update_track_visibility(obj);
 }
 
 
-/** \brief Update sky track drawing after size allocate. */
-static void update_track(gpointer key, gpointer value, gpointer data)
+static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    sat_obj_t      *obj = SAT_OBJ(value);;
-    GtkPolarView   *pv = GTK_POLAR_VIEW(data);
-    guint           num, i;
-    GooCanvasPoints *points;
+    gint            catnum;
+    sat_t          *sat = SAT(value);
+    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
+    sat_obj_t      *obj = NULL;
     gfloat          x, y;
-    pass_detail_t  *detail;
-    guint           tres, ttidx;
+    gdouble         now;        // = get_current_daynum ();
+    gchar          *text;
+    gchar          *losstr;
+    gchar          *tooltip;
 
     (void)key;                  /* avoid unused parameter compiler warning */
 
-    if (obj->showtrack)
-    {
-        if (obj->pass == NULL)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%d: Failed to get satellite pass."),
-                        __FILE__, __LINE__);
-            return;
-        }
+    catnum = sat->tle.catnr;
 
-        /* create points */
-        num = g_slist_length(obj->pass->details);
-        if (num == 0)
+    now = polv->tstamp;
+
+    /* update next AOS */
+    if (sat->aos > now)
+    {
+        if ((sat->aos < polv->naos) || (polv->naos == 0.0))
         {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%d: Pass had no points in it."),
-                        __FILE__, __LINE__);
-            return;
+            polv->naos = sat->aos;
+            polv->ncat = sat->tle.catnr;
         }
+    }
 
-        points = goo_canvas_points_new(num);
-
-        /* first point should be (aos_az,0.0) */
-        azel_to_xy(pv, obj->pass->aos_az, 0.0, &x, &y);
-        points->coords[0] = (double)x;
-        points->coords[1] = (double)y;
-
-        /* time tick 0 */
-        g_object_set(obj->trtick[0], "x", (gdouble) x, "y", (gdouble) y, NULL);
-
-        /* time resolution for time ticks; we need
-           3 additional points to AOS and LOS ticks.
-         */
-        tres = (num - 2) / (TRACK_TICK_NUM - 1);
-        ttidx = 1;
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
 
-        for (i = 1; i < num - 1; i++)
+    /* if sat is out of range */
+    if ((sat->el < 0.00) || decayed(sat))
+    {
+        /* hide it if it is on canvas */
+        if ((obj != NULL) && obj->visible)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
-            if (detail->el >= 0)
-                azel_to_xy(pv, detail->az, detail->el, &x, &y);
-            points->coords[2 * i] = (double)x;
-            points->coords[2 * i + 1] = (double)y;
+            obj->visible = FALSE;
+            set_visible(obj->group, FALSE);
+            update_track_visibility(obj);
+
+            /* free pass info */
+            free_pass(obj->pass);
+            obj->pass = NULL;
+            g_free(obj->skytrack);
+            obj->skytrack = NULL;
+            obj->skynum = 0;
 
-            if (!(i % tres))
+            /* if this was the selected satellite we need to
+               clear the info text
+             */
+            if (obj->selected)
             {
-                /* update time tick */
-                if (ttidx < TRACK_TICK_NUM)
-                    g_object_set(obj->trtick[ttidx],
-                                 "x", (gdouble) x, "y", (gdouble) y, NULL);
-                ttidx++;
+                g_object_set(polv->sel, "text", "", NULL);
             }
         }
 
-        /* last point should be (los_az, 0.0)  */
-        azel_to_xy(pv, obj->pass->los_az, 0.0, &x, &y);
-        points->coords[2 * (num - 1)] = (double)x;
-        points->coords[2 * (num - 1) + 1] = (double)y;
+        return;
+    }
+
+    /* sat is within range */
+    if (obj == NULL)
+    {
+        obj = create_sat_obj(polv, sat);
+        if (obj == NULL)
+            return;
+    }
 
-        g_object_set(obj->track, "points", points, NULL);
+    azel_to_xy(polv, sat->az, sat->el, &x, &y);
 
-        goo_canvas_points_unref(points);
+    /* update LOS count down */
+    if (sat->los > 0.0)
+    {
+        losstr = los_time_to_str(polv, sat);
+    }
+    else
+    {
+        losstr = g_strdup_printf(_("%s\nAlways in range"), sat->nickname);
     }
-}
 
+    /* update label */
+    g_object_set(obj->label, "text", sat->nickname, NULL);
 
-static GooCanvasItemModel *create_time_tick(GtkPolarView * pv, gdouble time,
-                                            gfloat x, gfloat y)
-{
-    GooCanvasItemModel *item;
-    gchar           buff[7];
-    GtkAnchorType   anchor;
-    GooCanvasItemModel *root;
-    guint32         col;
+    /* update tooltip */
+    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
+                                      "Az: %5.1f\302\260\n"
+                                      "El: %5.1f\302\260\n"
+                                      "%s",
+                                      sat->nickname, sat->az, sat->el, losstr);
 
-    root = goo_canvas_get_root_item_model(GOO_CANVAS(pv->canvas));
+    g_object_set(obj->marker,
+                 "x", x - MARKER_SIZE_HALF,
+                 "y", y - MARKER_SIZE_HALF, "tooltip", tooltip, NULL);
+    g_object_set(obj->label, "x", x, "y", y + 2, "tooltip", tooltip, NULL);
 
-    col = mod_cfg_get_int(pv->cfgdata,
-                          MOD_CFG_POLAR_SECTION,
-                          MOD_CFG_POLAR_TRACK_COL,
-                          SAT_CFG_INT_POLAR_TRACK_COL);
+    g_free(tooltip);
 
-    daynum_to_str(buff, 8, "%H:%M", time);
+    if (!obj->visible)
+    {
+        obj->visible = TRUE;
+        set_visible(obj->group, TRUE);
+    }
 
-    if (x > pv->cx)
+    /* update selection info if satellite is
+       selected
+     */
+    if (obj->selected)
     {
-        anchor = GTK_ANCHOR_EAST;
-        x -= 5;
+        text = g_strdup_printf("%s\n%s", sat->nickname, losstr);
+        g_object_set(polv->sel, "text", text, NULL);
+        g_free(text);
+    }
+
+    g_free(losstr);
+
+    /* Current pass and sky track needs update if they were calculated at
+     * a different location or time (time controller)
+     */
+    if (obj->pass == NULL)
+    {
+        update_pass(polv, obj, sat, now);
     }
     else
     {
-        anchor = GTK_ANCHOR_WEST;
-        x += 5;
+        /** FIXME: threshold */
+        gboolean        qth_upd =
+            qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
+        gboolean        time_upd = !((obj->pass->aos <= now) &&
+                                     (obj->pass->los >= now));
+
+        if (qth_upd || time_upd)
+        {
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
+                        __FILE__, __func__, catnum, qth_upd, time_upd);
+
+            update_pass(polv, obj, sat, now);
+        }
     }
+}
+
 
-    item = goo_canvas_text_model_new(root, buff,
-                                     (gdouble) x, (gdouble) y,
-                                     -1, anchor,
-                                     "font", "Sans 7",
-                                     "fill-color-rgba", col, NULL);
+/** \brief Update sky track drawing after size allocate. */
+static void update_track(gpointer key, gpointer value, gpointer data)
+{
+    sat_obj_t      *obj = SAT_OBJ(value);
 
-    goo_canvas_item_model_lower(item, NULL);
+    (void)key;                  /* avoid unused parameter compiler warning */
 
-    return item;
+    if (obj->visible && obj->showtrack)
+        draw_sky_track(GTK_POLAR_VIEW(data), obj);
 }
 
-/** \brief Create a sky track for a satellite.
+
+/** \brief Show the sky track of a satellite.
  *  \param pv Pointer to the GtkPolarView object.
  *  \param obj Pointer to the sat_obj_t object.
  *  \param sat Pointer to the sat_t object.
  *
- * Note: This function is only used when the the satellite comes within range
- *       and the ALWAYS_SHOW_SKY_TRACK option is TRUE.
+ * The track is drawn from the Az/El polyline precomputed for the current pass.
  */
 void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
                                  sat_t * sat)
 {
-    guint           i;
-    GooCanvasItemModel *root;
-    pass_detail_t  *detail;
-    guint           num;
-    GooCanvasPoints *points;
-    gfloat          x, y;
-    guint32         col;
-    guint           tres, ttidx;
-
     (void)sat;                  /* avoid unused parameter compiler warning */
 
-    /* get satellite object */
-    /*obj = SAT_OBJ(g_object_get_data (G_OBJECT (item), "obj"));
-       sat = SAT(g_object_get_data (G_OBJECT (item), "sat"));
-       qth = (qth_t *)(g_object_get_data (G_OBJECT (item), "qth")); */
-
     if (obj == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1198,102 +1200,18 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
         return;
     }
 
-    root = goo_canvas_get_root_item_model(GOO_CANVAS(pv->canvas));
-
-    /* add sky track */
-
-    /* create points */
-    num = g_slist_length(obj->pass->details);
-    if (num == 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Pass had no points in it."), __FILE__, __LINE__);
-        return;
-    }
-
-    /* time resolution for time ticks; we need
-       3 additional points to AOS and LOS ticks.
-     */
-    tres = (num - 2) / (TRACK_TICK_NUM - 1);
-
-    points = goo_canvas_points_new(num);
-
-
-
-    /* first point should be (aos_az,0.0) */
-    azel_to_xy(pv, obj->pass->aos_az, 0.0, &x, &y);
-    points->coords[0] = (double)x;
-    points->coords[1] = (double)y;
-    obj->trtick[0] = create_time_tick(pv, obj->pass->aos, x, y);
-
-    ttidx = 1;
-
-    for (i = 1; i < num - 1; i++)
-    {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
-        if (detail->el >= 0.0)
-            azel_to_xy(pv, detail->az, detail->el, &x, &y);
-        points->coords[2 * i] = (double)x;
-        points->coords[2 * i + 1] = (double)y;
-
-        if (!(i % tres))
-        {
-            /* create a time tick */
-            if (ttidx < TRACK_TICK_NUM)
-                obj->trtick[ttidx] = create_time_tick(pv, detail->time, x, y);
-            ttidx++;
-        }
-    }
-
-    /* last point should be (los_az, 0.0)  */
-    azel_to_xy(pv, obj->pass->los_az, 0.0, &x, &y);
-    points->coords[2 * (num - 1)] = (double)x;
-    points->coords[2 * (num - 1) + 1] = (double)y;
-
-    /* create poly-line */
-    col = mod_cfg_get_int(pv->cfgdata,
-                          MOD_CFG_POLAR_SECTION,
-                          MOD_CFG_POLAR_TRACK_COL,
-                          SAT_CFG_INT_POLAR_TRACK_COL);
-
-    obj->track = goo_canvas_polyline_model_new(root, FALSE, 0,
-                                               "points", points,
-                                               "line-width", 1.0,
-                                               "stroke-color-rgba", col,
-                                               "line-cap",
-                                               CAIRO_LINE_CAP_SQUARE,
-                                               "line-join",
-                                               CAIRO_LINE_JOIN_MITER, NULL);
-    goo_canvas_points_unref(points);
-
-    /* put track on the bottom of the sack */
-    goo_canvas_item_model_lower(obj->track, NULL);
-
+    draw_sky_track(pv, obj);
+    update_track_visibility(obj);
 }
 
+/** \brief Hide the sky track of a satellite. */
 void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj,
                                  sat_t * sat)
 {
-    gint            idx, i;
-    GooCanvasItemModel *root;
-
-    root = goo_canvas_get_root_item_model(GOO_CANVAS(pv->canvas));
-    idx = goo_canvas_item_model_find_child(root, obj->track);
-
-    if (idx != -1)
-    {
-        goo_canvas_item_model_remove_child(root, idx);
-    }
-
-    for (i = 0; i < TRACK_TICK_NUM; i++)
-    {
-        idx = goo_canvas_item_model_find_child(root, obj->trtick[i]);
+    (void)pv;                   /* avoid unused parameter compiler warning */
+    (void)sat;                  /* avoid unused parameter compiler warning */
 
-        if (idx != -1)
-        {
-            goo_canvas_item_model_remove_child(root, idx);
-        }
-    }
+    update_track_visibility(obj);
 }
 
 /** \brief Convert Az/El to canvas based XY coordinates. */
@@ -1477,7 +1395,6 @@ on_button_press(GooCanvasItem * item,
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
     gint            catnum =
         GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
     sat_t          *sat = NULL;
 
     (void)target;               /* avoid unused parameter compiler warning */
@@ -1489,10 +1406,7 @@ on_button_press(GooCanvasItem * item,
     case 1:
         if (event->type == GDK_2BUTTON_PRESS)
         {
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = catnum;
-
-            sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+            sat = sat_registry_lookup(polv->sats, catnum);
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(data)));
@@ -1503,17 +1417,12 @@ on_button_press(GooCanvasItem * item,
             }
         }
 
-        g_free(catpoint);
-
         break;
 
 
         /* pop-up menu */
     case 3:
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = catnum;
-
-        sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+        sat = sat_registry_lookup(polv->sats, catnum);
 
         if (sat != NULL)
         {
@@ -1530,8 +1439,6 @@ on_button_press(GooCanvasItem * item,
                         __FILE__, __LINE__, catnum);
         }
 
-        g_free(catpoint);
-
         break;
 
     default:
@@ -1560,21 +1467,17 @@ on_button_release(GooCanvasItem * item,
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
     gint            catnum =
         GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
     sat_obj_t      *obj = NULL;
     guint32         color;
 
     (void)target;               /* avoid unused parameter compiler warning */
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
     switch (event->button)
     {
 
         /* Select / de-select satellite */
     case 1:
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catpoint));
+        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
         if (obj == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1600,7 +1503,7 @@ on_button_release(GooCanvasItem * item,
                                         MOD_CFG_POLAR_SECTION,
                                         MOD_CFG_POLAR_SAT_COL,
                                         SAT_CFG_INT_POLAR_SAT_COL);
-                *catpoint = 0;
+                catnum = 0;
 
                 g_object_set(polv->sel, "text", "", NULL);
             }
@@ -1613,7 +1516,7 @@ on_button_release(GooCanvasItem * item,
                          "stroke-color-rgba", color, NULL);
 
             /* clear other selections */
-            g_hash_table_foreach(polv->obj, clear_selection, catpoint);
+            g_hash_table_foreach(polv->obj, clear_selection, &catnum);
         }
 
         break;
@@ -1622,8 +1525,6 @@ on_button_release(GooCanvasItem * item,
         break;
     }
 
-    g_free(catpoint);
-
     return TRUE;
 }
 
@@ -1697,7 +1598,7 @@ static void get_canvas_bg_color(GtkPolarView * polv, GdkColor * color)
 
 
 /** \brief Reload reference to satellites (e.g. after TLE update). */
-void gtk_polar_view_reload_sats(GtkWidget * polv, GHashTable * sats)
+void gtk_polar_view_reload_sats(GtkWidget * polv, sat_registry_t * sats)
 {
 
     GTK_POLAR_VIEW(polv)->sats = sats;
@@ -1708,21 +1609,17 @@ void gtk_polar_view_reload_sats(GtkWidget * polv, GHashTable * sats)
 
 
 /** \brief Select a satellite (puublic)
- * 
- * \todo Current selection is loast when satellite goes LOS
+ *
+ * Satellites below the horizon can only be selected once they have been
+ * on the canvas; the selection is kept while they are hidden.
  */
 void gtk_polar_view_select_sat(GtkWidget * widget, gint catnum)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(widget);
-    gint           *catpoint = NULL;
     sat_obj_t      *obj = NULL;
     guint32         color;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
-
-    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catpoint));
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
     if (obj == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
@@ -1748,10 +1645,7 @@ void gtk_polar_view_select_sat(GtkWidget * widget, gint catnum)
     }
 
     /* clear previous selection, if any */
-    g_hash_table_foreach(polv->obj, clear_selection, catpoint);
-
-    g_free(catpoint);
-
+    g_hash_table_foreach(polv->obj, clear_selection, &catnum);
 }
 
 
@@ -34,6 +34,7 @@
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
 #include "predict-tools.h"
+#include "sat-registry.h"
 #include <goocanvas.h>
 
 /* *INDENT-OFF* */
@@ -61,9 +62,17 @@ typedef struct {
     gboolean        selected;   /*!< Satellite is selected. */
     gboolean        showtrack;  /*!< Show ground track. */
     gboolean        istarget;   /*!< Is this object the target. */
+    gboolean        visible;    /*!< Satellite is above the horizon. */
     pass_t         *pass;       /*!< Details of the current pass. */
+    gdouble        *skytrack;   /*!< Az/El pairs of the sky track. */
+    guint           skynum;     /*!< Number of points in the sky track. */
+    guint           ntick;      /*!< Number of time ticks in use. */
+    guint           tickidx[TRACK_TICK_NUM];    /*!< Sky track index of each time tick. */
+    gdouble         ticktime[TRACK_TICK_NUM];   /*!< Time of each time tick. */
+    GooCanvasItemModel *group;  /*!< Group holding marker and label. */
     GooCanvasItemModel *marker; /*!< Item showing position of satellite. */
     GooCanvasItemModel *label;  /*!< Item showing the satellite name. */
+    GooCanvasItemModel *trgroup;        /*!< Group holding sky track and time ticks. */
     GooCanvasItemModel *track;  /*!< Sky track. */
     GooCanvasItemModel *trtick[TRACK_TICK_NUM]; /*!< Time ticks along the sky track */
 } sat_obj_t;
@@ -102,6 +111,8 @@ struct _GtkPolarView {
     GooCanvasItemModel *curs;   /*!< cursor tracking text */
     GooCanvasItemModel *next;   /*!< next event text */
     GooCanvasItemModel *sel;    /*!< Text showing info about selected satellite. */
+    GooCanvasItemModel *trklayer;       /*!< Group holding the sky tracks, below the axes. */
+    GooCanvasItemModel *satlayer;       /*!< Group holding the satellites, on top. */
 
     GHashTable     *showtracks_on;
     GHashTable     *showtracks_off;
@@ -112,10 +123,10 @@ struct _GtkPolarView {
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< module configuration data */
-    GHashTable     *sats;       /*!< Satellites. */
+    sat_registry_t *sats;       /*!< Satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
 
-    GHashTable     *obj;        /*!< Canvas items representing each visible satellite */
+    GHashTable     *obj;        /*!< Canvas items of each satellite seen so far */
 
     guint           cx;         /*!< center X */
     guint           cy;         /*!< center Y */
@@ -143,11 +154,11 @@ struct _GtkPolarViewClass {
 GType           gtk_polar_view_get_type(void);
 
 GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata,
-                                   GHashTable * sats, qth_t * qth);
+                                   sat_registry_t * sats, qth_t * qth);
 void            gtk_polar_view_update(GtkWidget * widget);
 void            gtk_polar_view_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_polar_view_reload_sats(GtkWidget * polv,
-                                           GHashTable * sats);
+                                           sat_registry_t * sats);
 void            gtk_polar_view_select_sat(GtkWidget * widget, gint catnum);
 void            gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
                                             sat_t * sat);
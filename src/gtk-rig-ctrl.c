@@ -285,7 +285,7 @@ GtkWidget *gtk_rig_ctrl_new(GtkSatModule * module)
                      NULL);
 
     /* store satellites */
-    g_hash_table_foreach(module->satellites, store_sats, widget);
+    sat_registry_foreach(module->satellites, store_sats, widget);
 
     GTK_RIG_CTRL(widget)->target =
         SAT(g_slist_nth_data(GTK_RIG_CTRL(widget)->sats, 0));
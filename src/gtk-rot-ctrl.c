@@ -206,7 +206,7 @@ GtkWidget      *gtk_rot_ctrl_new(GtkSatModule * module)
     widget = g_object_new(GTK_TYPE_ROT_CTRL, NULL);
 
     /* store satellites */
-    g_hash_table_foreach(module->satellites, store_sats, widget);
+    sat_registry_foreach(module->satellites, store_sats, widget);
 
     GTK_ROT_CTRL(widget)->target =
         SAT(g_slist_nth_data(GTK_ROT_CTRL(widget)->sats, 0));
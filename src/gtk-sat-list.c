@@ -139,13 +139,52 @@ const gfloat SAT_LIST_COL_XALIGN[SAT_LIST_COL_NUMBER] = {
     0.5,                        // visibility
 };
 
+/** \brief Length of the string cache for the next event column. */
+#define SAT_LIST_EVENT_LEN (TIME_FORMAT_MAX_LENGTH + 6)
+
+/**
+ * \brief Row of a satellite in the list store.
+ *
+ * Holds the values last written to the model so that only the columns that
+ * have actually changed are written in the next refresh.
+ */
+typedef struct {
+    gint        catnum;         /*!< Catalogue number; key in the rows table */
+    sat_t      *sat;            /*!< The satellite shown in this row */
+    GtkTreeIter iter;           /*!< The row; list store iters are persistent */
+    gboolean    valid;          /*!< FALSE until all columns have been written */
+    gdouble     num[SAT_LIST_COL_NUMBER];   /*!< Numeric columns */
+    glong       orbit;          /*!< Orbit number */
+    gboolean    decay;          /*!< Decay column */
+    gint        bold;           /*!< Font weight */
+    gdouble     radec_utc;      /*!< Time of the last RA/Dec calculation */
+    gdouble     evt_aos;        /*!< AOS used for the next event column */
+    gdouble     evt_los;        /*!< LOS used for the next event column */
+    gchar       dir[4];         /*!< Direction */
+    gchar       ssp[7];         /*!< SSP locator */
+    gchar       vis[2];         /*!< Visibility */
+    gchar       event[SAT_LIST_EVENT_LEN];  /*!< Next event */
+} sat_list_row_t;
+
+/** \brief Column values collected for a single gtk_list_store_set_valuesv(). */
+typedef struct {
+    gint        n;
+    gint        cols[SAT_LIST_COL_NUMBER];
+    GValue      vals[SAT_LIST_COL_NUMBER];
+} sat_list_set_t;
+
+
 static void gtk_sat_list_class_init(GtkSatListClass * class);
 static void gtk_sat_list_init(GtkSatList * list);
 static void gtk_sat_list_destroy(GtkObject * object);
-static GtkTreeModel *create_and_fill_model(GHashTable * sats);
-static void sat_list_add_satellites(gpointer key, gpointer value, gpointer user_data);
-static gboolean sat_list_update_sats(GtkTreeModel * model,
-                                     GtkTreePath * path, GtkTreeIter * iter, gpointer data);
+static GtkTreeModel *create_and_fill_model(GtkSatList * satlist);
+static void sat_list_add_satellite(GtkSatList * satlist, GtkListStore * store, sat_t * sat);
+static GtkListStore *get_store(GtkSatList * satlist);
+static void sat_list_update_row(GtkSatList * satlist, GtkListStore * store,
+                                gpointer row, guint32 mask);
+static void set_double(sat_list_row_t * row, sat_list_set_t * set, gint col, gdouble value);
+static void set_string(sat_list_row_t * row, sat_list_set_t * set, gint col,
+                       gchar * cache, gsize size, const gchar * value);
 
 /* cell rendering related functions */
 static void check_and_set_cell_renderer(GtkTreeViewColumn * column,
@@ -245,7 +284,8 @@ static void gtk_sat_list_class_init(GtkSatListClass * class)
 
 static void gtk_sat_list_init(GtkSatList * list)
 {
-    (void)list;                 /* avoid unusued parameter compiler warning */
+    list->rows = g_hash_table_new_full(g_int_hash, g_int_equal, NULL, g_free);
+    list->tformat = NULL;
     /*     GtkWidget *vbox,*hbox; */
 
 
@@ -274,11 +314,19 @@ static void gtk_sat_list_destroy(GtkObject * object)
     g_key_file_set_integer(list->cfgdata, MOD_CFG_LIST_SECTION,
                            MOD_CFG_LIST_SORT_ORDER, list->sort_order);
 
+    if (list->rows != NULL)
+    {
+        g_hash_table_destroy(list->rows);
+        list->rows = NULL;
+    }
+    g_free(list->tformat);
+    list->tformat = NULL;
+
     (*GTK_OBJECT_CLASS(parent_class)->destroy) (object);
 }
 
 
-GtkWidget *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth, guint32 columns)
+GtkWidget *gtk_sat_list_new(GKeyFile * cfgdata, sat_registry_t * sats, qth_t * qth, guint32 columns)
 {
     GtkWidget *widget;
     GtkTreeModel *model, *filter, *sortable;
@@ -385,7 +433,7 @@ GtkWidget *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth,
     }
 
     /* create model and finalise treeview */
-    model = create_and_fill_model(GTK_SAT_LIST(widget)->satellites);
+    model = create_and_fill_model(GTK_SAT_LIST(widget));
     filter = gtk_tree_model_filter_new(model, NULL);
     sortable = gtk_tree_model_sort_new_with_model(filter);
     GTK_SAT_LIST(widget)->sortable = sortable;
@@ -429,9 +477,10 @@ GtkWidget *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth,
 }
 
 
-static GtkTreeModel *create_and_fill_model(GHashTable * sats)
+static GtkTreeModel *create_and_fill_model(GtkSatList * satlist)
 {
     GtkListStore *liststore;
+    guint i;
 
     liststore = gtk_list_store_new(SAT_LIST_COL_NUMBER, G_TYPE_STRING,  // name
                                    G_TYPE_INT,  // catnum
@@ -463,22 +512,31 @@ static GtkTreeModel *create_and_fill_model(GHashTable * sats)
         );
 
 
-    g_hash_table_foreach(sats, sat_list_add_satellites, liststore);
+    for (i = 0; i < satlist->satellites->num; i++)
+        sat_list_add_satellite(satlist, liststore,
+                               sat_registry_nth(satlist->satellites, i));
 
     return GTK_TREE_MODEL(liststore);
 }
 
 
-static void sat_list_add_satellites(gpointer key, gpointer value, gpointer user_data)
+/**
+ * \brief Add a satellite to the list store.
+ *
+ * The row is remembered in satlist->rows together with the satellite so that
+ * it can be refreshed without walking the model.
+ */
+static void sat_list_add_satellite(GtkSatList * satlist, GtkListStore * store, sat_t * sat)
 {
-    GtkListStore *store = GTK_LIST_STORE(user_data);
-    GtkTreeIter item;
-    sat_t *sat = SAT(value);
+    sat_list_row_t *row;
 
-    (void)key;                  /* avoid unusued parameter compiler warning */
+    row = g_new0(sat_list_row_t, 1);
+    row->catnum = sat->tle.catnr;
+    row->sat = sat;
+    row->valid = FALSE;
 
-    gtk_list_store_append(store, &item);
-    gtk_list_store_set(store, &item,
+    gtk_list_store_append(store, &row->iter);
+    gtk_list_store_set(store, &row->iter,
                        SAT_LIST_COL_NAME, sat->nickname,
                        SAT_LIST_COL_CATNUM, sat->tle.catnr,
                        SAT_LIST_COL_AZ, sat->az,
@@ -504,14 +562,30 @@ static void sat_list_add_satellites(gpointer key, gpointer value, gpointer user_
                        SAT_LIST_COL_MA, sat->ma,
                        SAT_LIST_COL_PHASE, sat->phase,
                        SAT_LIST_COL_ORBIT, sat->orbit, SAT_LIST_COL_DECAY, !decayed(sat), -1);
+
+    g_hash_table_insert(satlist->rows, &row->catnum, row);
+}
+
+
+/** \brief Get the list store behind the filter and sort models. */
+static GtkListStore *get_store(GtkSatList * satlist)
+{
+    return GTK_LIST_STORE(gtk_tree_model_filter_get_model(GTK_TREE_MODEL_FILTER
+                                                          (gtk_tree_model_sort_get_model
+                                                           (GTK_TREE_MODEL_SORT
+                                                            (satlist->sortable)))));
 }
 
 
 /** \brief Update satellites */
 void gtk_sat_list_update(GtkWidget * widget)
 {
-    GtkTreeModel *model;
     GtkSatList *satlist = GTK_SAT_LIST(widget);
+    GtkListStore *store;
+    GHashTableIter iter;
+    gpointer row;
+    gchar *tformat;
+    guint32 mask;
 
     /* first, do some sanity checks */
     if ((satlist == NULL) || !IS_GTK_SAT_LIST(satlist))
@@ -529,264 +603,283 @@ void gtk_sat_list_update(GtkWidget * widget)
     {
         satlist->counter = 1;
 
-        /* get and tranverse the model */
-        model =
-            gtk_tree_model_filter_get_model(GTK_TREE_MODEL_FILTER
-                                            (gtk_tree_model_sort_get_model
-                                             (GTK_TREE_MODEL_SORT
-                                              (gtk_tree_view_get_model
-                                               (GTK_TREE_VIEW(satlist->treeview))))));
+        store = get_store(satlist);
 
         /*save the sort information */
         gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(satlist->sortable),
                                              &(satlist->sort_column), &(satlist->sort_order));
 
-        /* optimisation: detach model from view while updating */
-        /* No, we do not do it, because it makes selections and scrolling
-           impossible
-         */
-        /*         g_object_ref (model); */
-        /*         gtk_tree_view_set_model (GTK_TREE_VIEW (satlist->treeview), NULL); */
+        /* rewrite the next event column if the time format has changed */
+        tformat = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+        if (satlist->tformat == NULL || g_strcmp0(tformat, satlist->tformat))
+        {
+            g_free(satlist->tformat);
+            satlist->tformat = tformat;
 
-        /* update */
-        gtk_tree_model_foreach(model, sat_list_update_sats, satlist);
+            g_hash_table_iter_init(&iter, satlist->rows);
+            while (g_hash_table_iter_next(&iter, NULL, &row))
+                ((sat_list_row_t *) row)->event[0] = '\0';
+        }
+        else
+        {
+            g_free(tformat);
+        }
 
-        /* re-attach model to view */
-        /*         gtk_tree_view_set_model (GTK_TREE_VIEW (satlist->treeview), model); */
+        /* hidden columns are only needed if the list is sorted by them */
+        mask = satlist->flags;
+        if (satlist->sort_column >= 0 && satlist->sort_column < SAT_LIST_COL_NUMBER)
+            mask |= 1 << satlist->sort_column;
 
-        /*         g_object_unref (model); */
+        /* update */
+        g_hash_table_iter_init(&iter, satlist->rows);
+        while (g_hash_table_iter_next(&iter, NULL, &row))
+            sat_list_update_row(satlist, store, row, mask);
     }
 
 }
 
 
-/** \brief Update data in each column in a given row */
-static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
-                                     GtkTreeIter * iter, gpointer data)
+/** \brief Queue a numeric column for update if its value has changed. */
+static void set_double(sat_list_row_t * row, sat_list_set_t * set, gint col, gdouble value)
 {
-    GtkSatList *satlist = GTK_SAT_LIST(data);
-    guint *catnum;
-    sat_t *sat;
-    gchar *buff;
-    gdouble doppler;
-    gdouble delay;
-    gdouble loss;
-    gdouble oldrate;
-    gint retcode;
+    if (row->valid && row->num[col] == value)
+        return;
 
-    (void)path;                 /* avoid unusued parameter compiler warning */
+    row->num[col] = value;
+    g_value_init(&set->vals[set->n], G_TYPE_DOUBLE);
+    g_value_set_double(&set->vals[set->n], value);
+    set->cols[set->n++] = col;
+}
 
-    /* get the catalogue number for this row
-       then look it up in the hash table
-     */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(satlist->satellites, catnum));
 
-    if (sat == NULL)
-    {
-        /* satellite not tracked anymore => remove */
-        sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Failed to get data for #%d."), __func__, *catnum);
+/**
+ * \brief Queue a string column for update if its value has changed.
+ * \param cache The string last written to the column; updated if needed.
+ * \param size Size of the cache.
+ */
+static void set_string(sat_list_row_t * row, sat_list_set_t * set, gint col,
+                       gchar * cache, gsize size, const gchar * value)
+{
+    if (row->valid && !strcmp(cache, value))
+        return;
 
-        gtk_list_store_remove(GTK_LIST_STORE(model), iter);
+    g_strlcpy(cache, value, size);
+    g_value_init(&set->vals[set->n], G_TYPE_STRING);
+    g_value_set_static_string(&set->vals[set->n], cache);
+    set->cols[set->n++] = col;
+}
 
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Satellite #%d removed from list."), __func__, *catnum);
-    }
-    else
+
+/**
+ * \brief Update data in the columns of a given row.
+ * \param satlist The GtkSatList widget.
+ * \param store The list store.
+ * \param data The row (sat_list_row_t).
+ * \param mask The columns that need to be updated.
+ *
+ * Only columns whose value has changed since the last refresh are written
+ * to the model and all of them are written with a single call, so each row
+ * emits at most one "row-changed" signal.
+ */
+static void sat_list_update_row(GtkSatList * satlist, GtkListStore * store,
+                                gpointer data, guint32 mask)
+{
+    sat_list_row_t *row = (sat_list_row_t *) data;
+    sat_t *sat = row->sat;
+    sat_list_set_t set;
+    const gchar *dir;
+    gchar buff[SAT_LIST_EVENT_LEN];
+    gboolean decay;
+    gint bold;
+    gint i;
+
+    set.n = 0;
+    memset(set.vals, 0, sizeof(set.vals));
+
+    /* direction needs the previous range rate, so do it first */
+    if (mask & SAT_LIST_FLAG_DIR)
     {
-        /* store new data */
-        gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                           SAT_LIST_COL_AZ, sat->az,
-                           SAT_LIST_COL_EL, sat->el,
-                           SAT_LIST_COL_RANGE, sat->range,
-                           SAT_LIST_COL_RANGE_RATE, sat->range_rate,
-                           SAT_LIST_COL_LAT, sat->ssplat,
-                           SAT_LIST_COL_LON, sat->ssplon,
-                           SAT_LIST_COL_FOOTPRINT, sat->footprint,
-                           SAT_LIST_COL_ALT, sat->alt,
-                           SAT_LIST_COL_VEL, sat->velo,
-                           SAT_LIST_COL_MA, sat->ma,
-                           SAT_LIST_COL_PHASE, sat->phase,
-                           SAT_LIST_COL_ORBIT, sat->orbit,
-                           SAT_LIST_COL_DECAY, !decayed(sat),
-                           SAT_LIST_COL_BOLD,
-                           (sat->el > 0.0) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL, -1);
-
-        /* doppler shift @ 100 MHz */
-        if (satlist->flags & SAT_LIST_FLAG_DOPPLER)
+        if (sat->otype == ORBIT_TYPE_GEO)
         {
-            doppler = -100.0e06 * (sat->range_rate / 299792.4580);      // Hz
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DOPPLER, doppler, -1);
+            dir = "G";
         }
-
-        /* delay */
-        if (satlist->flags & SAT_LIST_FLAG_DELAY)
+        else if (decayed(sat))
         {
-            delay = sat->range / 299.7924580;   // msec 
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DELAY, delay, -1);
+            dir = "D";
         }
-
-        /* path loss */
-        if (satlist->flags & SAT_LIST_FLAG_LOSS)
+        else if (sat->range_rate > 0.001)
         {
-            loss = 72.4 + 20.0 * log10(sat->range);     // dB
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_LOSS, loss, -1);
+            /* going down */
+            dir = "\342\206\223";
         }
-
-        /* calculate direction */
-        if (satlist->flags & SAT_LIST_FLAG_DIR)
+        else if ((sat->range_rate <= 0.001) && (sat->range_rate >= -0.001))
         {
-            if (sat->otype == ORBIT_TYPE_GEO)
-            {
-                buff = g_strdup("G");
-            }
-            else if (decayed(sat))
-            {
-                buff = g_strdup("D");
-            }
-            else if (sat->range_rate > 0.001)
-            {
-                /* going down */
-                buff = g_strdup("\342\206\223");
-            }
-            else if ((sat->range_rate <= 0.001) && (sat->range_rate >= -0.001))
-            {
-                gtk_tree_model_get(model, iter, SAT_LIST_COL_RANGE_RATE, &oldrate, -1);
-                /* turning around; don't know which way ? */
-                if (sat->range_rate < oldrate)
-                {
-                    /* starting to approach */
-                    buff = g_strdup("\342\206\272");
-                }
-                else
-                {
-                    /* to receed */
-                    buff = g_strdup("\342\206\267");
-                }
-            }
-            else if (sat->range_rate < -0.001)
+            /* turning around; don't know which way ? */
+            if (sat->range_rate < row->num[SAT_LIST_COL_RANGE_RATE])
             {
-                /* coming up */
-                buff = g_strdup("\342\206\221");
+                /* starting to approach */
+                dir = "\342\206\272";
             }
             else
             {
-                buff = g_strdup("-");
+                /* to receed */
+                dir = "\342\206\267";
             }
-
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DIR, buff, -1);
-
-            /* free memory */
-            g_free(buff);
-
         }
-
-        /* SSP locator */
-        if (satlist->flags & SAT_LIST_FLAG_SSP)
+        else if (sat->range_rate < -0.001)
         {
-
-            buff = g_try_malloc(7);
-
-            retcode = longlat2locator(sat->ssplon, sat->ssplat, buff, 3);
-            if (retcode == RIG_OK)
-            {
-                buff[6] = '\0';
-                gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_SSP, buff, -1);
-            }
-            g_free(buff);
+            /* coming up */
+            dir = "\342\206\221";
         }
-
-        /* Ra and Dec */
-        if (satlist->flags & (SAT_LIST_FLAG_RA | SAT_LIST_FLAG_DEC))
+        else
         {
-            obs_astro_t astro;
-
-            Calculate_RADec(sat, satlist->qth, &astro);
+            dir = "-";
+        }
 
-            sat->ra = Degrees(astro.ra);
-            sat->dec = Degrees(astro.dec);
+        set_string(row, &set, SAT_LIST_COL_DIR, row->dir, sizeof(row->dir), dir);
+    }
 
-            gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                               SAT_LIST_COL_RA, sat->ra, SAT_LIST_COL_DEC, sat->dec, -1);
-        }
+    if (mask & SAT_LIST_FLAG_AZ)
+        set_double(row, &set, SAT_LIST_COL_AZ, sat->az);
+    if (mask & SAT_LIST_FLAG_EL)
+        set_double(row, &set, SAT_LIST_COL_EL, sat->el);
+    if (mask & SAT_LIST_FLAG_RANGE)
+        set_double(row, &set, SAT_LIST_COL_RANGE, sat->range);
+    if (mask & (SAT_LIST_FLAG_RANGE_RATE | SAT_LIST_FLAG_DIR))
+        set_double(row, &set, SAT_LIST_COL_RANGE_RATE, sat->range_rate);
+    if (mask & SAT_LIST_FLAG_LAT)
+        set_double(row, &set, SAT_LIST_COL_LAT, sat->ssplat);
+    if (mask & SAT_LIST_FLAG_LON)
+        set_double(row, &set, SAT_LIST_COL_LON, sat->ssplon);
+    if (mask & SAT_LIST_FLAG_FOOTPRINT)
+        set_double(row, &set, SAT_LIST_COL_FOOTPRINT, sat->footprint);
+    if (mask & SAT_LIST_FLAG_ALT)
+        set_double(row, &set, SAT_LIST_COL_ALT, sat->alt);
+    if (mask & SAT_LIST_FLAG_VEL)
+        set_double(row, &set, SAT_LIST_COL_VEL, sat->velo);
+    if (mask & SAT_LIST_FLAG_MA)
+        set_double(row, &set, SAT_LIST_COL_MA, sat->ma);
+    if (mask & SAT_LIST_FLAG_PHASE)
+        set_double(row, &set, SAT_LIST_COL_PHASE, sat->phase);
+
+    if ((mask & SAT_LIST_FLAG_ORBIT) && (!row->valid || row->orbit != sat->orbit))
+    {
+        row->orbit = sat->orbit;
+        g_value_init(&set.vals[set.n], G_TYPE_LONG);
+        g_value_set_long(&set.vals[set.n], sat->orbit);
+        set.cols[set.n++] = SAT_LIST_COL_ORBIT;
+    }
 
-        /* upcoming events */
-        /*** FIXME: not necessary to update every time */
-        if (satlist->flags & SAT_LIST_FLAG_AOS)
-        {
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_AOS, sat->aos, -1);
-        }
-        if (satlist->flags & SAT_LIST_FLAG_LOS)
-        {
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_LOS, sat->los, -1);
+    decay = !decayed(sat);
+    if (!row->valid || row->decay != decay)
+    {
+        row->decay = decay;
+        g_value_init(&set.vals[set.n], G_TYPE_BOOLEAN);
+        g_value_set_boolean(&set.vals[set.n], decay);
+        set.cols[set.n++] = SAT_LIST_COL_DECAY;
+    }
 
-        }
-        if (satlist->flags & SAT_LIST_FLAG_NEXT_EVENT)
-        {
-            gdouble number;
-            gchar buff[TIME_FORMAT_MAX_LENGTH];
-            gchar *tfstr;
-            gchar *fmtstr;
-            gchar *alstr;
+    bold = (sat->el > 0.0) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL;
+    if (!row->valid || row->bold != bold)
+    {
+        row->bold = bold;
+        g_value_init(&set.vals[set.n], G_TYPE_INT);
+        g_value_set_int(&set.vals[set.n], bold);
+        set.cols[set.n++] = SAT_LIST_COL_BOLD;
+    }
 
+    /* doppler shift @ 100 MHz */
+    if (mask & SAT_LIST_FLAG_DOPPLER)
+        set_double(row, &set, SAT_LIST_COL_DOPPLER,
+                   -100.0e06 * (sat->range_rate / 299792.4580));        // Hz
 
-            if (sat->aos > sat->los)
-            {
-                /* next event is LOS */
-                number = sat->los;
-                alstr = g_strdup("LOS: ");
-            }
-            else
-            {
-                /* next event is AOS */
-                number = sat->aos;
-                alstr = g_strdup("AOS: ");
-            }
+    /* delay */
+    if (mask & SAT_LIST_FLAG_DELAY)
+        set_double(row, &set, SAT_LIST_COL_DELAY, sat->range / 299.7924580);  // msec 
 
-            if (number == 0.0)
-            {
-                gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                                   SAT_LIST_COL_NEXT_EVENT, "--- N/A ---", -1);
-            }
-            else
-            {
+    /* path loss */
+    if (mask & SAT_LIST_FLAG_LOSS)
+        set_double(row, &set, SAT_LIST_COL_LOSS, 72.4 + 20.0 * log10(sat->range));    // dB
 
-                /* format the number */
-                tfstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-                fmtstr = g_strconcat(alstr, tfstr, NULL);
-                g_free(tfstr);
+    /* SSP locator */
+    if (mask & SAT_LIST_FLAG_SSP)
+    {
+        if (longlat2locator(sat->ssplon, sat->ssplat, buff, 3) == RIG_OK)
+        {
+            buff[6] = '\0';
+            set_string(row, &set, SAT_LIST_COL_SSP, row->ssp, sizeof(row->ssp), buff);
+        }
+    }
 
-                daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
+    /* Ra and Dec; only when the satellite has moved */
+    if ((mask & (SAT_LIST_FLAG_RA | SAT_LIST_FLAG_DEC)) &&
+        (!row->valid || row->radec_utc != sat->jul_utc))
+    {
+        obs_astro_t astro;
 
-                gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_NEXT_EVENT, buff, -1);
+        /* computed into the row; the satellite is read-only here */
+        Calculate_RADec(sat, satlist->qth, &astro);
+        row->radec_utc = sat->jul_utc;
 
+        set_double(row, &set, SAT_LIST_COL_RA, Degrees(astro.ra));
+        set_double(row, &set, SAT_LIST_COL_DEC, Degrees(astro.dec));
+    }
 
-                g_free(fmtstr);
-            }
+    /* upcoming events */
+    if (mask & SAT_LIST_FLAG_AOS)
+        set_double(row, &set, SAT_LIST_COL_AOS, sat->aos);
+    if (mask & SAT_LIST_FLAG_LOS)
+        set_double(row, &set, SAT_LIST_COL_LOS, sat->los);
+
+    /* the next event string only changes with the events; an empty cache
+       means that the time format has changed */
+    if ((mask & SAT_LIST_FLAG_NEXT_EVENT) &&
+        (!row->valid || row->event[0] == '\0' ||
+         row->evt_aos != sat->aos || row->evt_los != sat->los))
+    {
+        gdouble number;
+        gchar *fmtstr;
 
-            g_free(alstr);
+        row->evt_aos = sat->aos;
+        row->evt_los = sat->los;
 
+        if (sat->aos > sat->los)
+        {
+            /* next event is LOS */
+            number = sat->los;
+            fmtstr = g_strconcat("LOS: ", satlist->tformat, NULL);
         }
-
-        if (satlist->flags & SAT_LIST_FLAG_VISIBILITY)
+        else
         {
-            sat_vis_t vis;
-
-            vis = get_sat_vis(sat, satlist->qth, sat->jul_utc);
-            buff = g_strdup_printf("%c", vis_to_chr(vis));
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_VISIBILITY, buff, -1);
-            g_free(buff);
+            /* next event is AOS */
+            number = sat->aos;
+            fmtstr = g_strconcat("AOS: ", satlist->tformat, NULL);
         }
+
+        if (number == 0.0)
+            g_strlcpy(buff, "--- N/A ---", sizeof(buff));
+        else
+            daynum_to_str(buff, sizeof(buff), fmtstr, number);
+
+        g_free(fmtstr);
+
+        set_string(row, &set, SAT_LIST_COL_NEXT_EVENT, row->event, sizeof(row->event), buff);
     }
 
-    g_free(catnum);
+    if (mask & SAT_LIST_FLAG_VISIBILITY)
+    {
+        buff[0] = vis_to_chr(get_sat_vis(sat, satlist->qth, sat->jul_utc));
+        buff[1] = '\0';
+        set_string(row, &set, SAT_LIST_COL_VISIBILITY, row->vis, sizeof(row->vis), buff);
+    }
 
-    /* Return value not documented what to return, but it seems that
-       FALSE continues to next row while TRUE breaks
-     */
-    return FALSE;
+    row->valid = TRUE;
+
+    if (set.n > 0)
+        gtk_list_store_set_valuesv(store, &row->iter, set.cols, set.vals, set.n);
+
+    for (i = 0; i < set.n; i++)
+        g_value_unset(&set.vals[i]);
 }
 
 
@@ -1230,30 +1323,26 @@ static void row_activated_cb(GtkTreeView * tree_view,
 {
     GtkTreeModel *model;
     GtkTreeIter iter;
-    guint *catnum;
+    gint catnum;
     sat_t *sat;
 
     (void)column;               /* avoid compiler warning */
 
-    catnum = g_new0(guint, 1);
-
     model = gtk_tree_view_get_model(tree_view);
     gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
+    gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &catnum, -1);
 
-    sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+    sat = sat_registry_lookup(GTK_SAT_LIST(list)->satellites, catnum);
 
     if (sat == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s:%d Failed to get data for %d."), __FILE__, __LINE__, *catnum);
+                    _("%s:%d Failed to get data for %d."), __FILE__, __LINE__, catnum);
     }
     else
     {
         show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(list)));
     }
-
-    g_free(catnum);
 }
 
 static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event, gpointer list)
@@ -1261,23 +1350,21 @@ static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event, gpoint
     GtkTreeSelection *selection;
     GtkTreeModel *model;
     GtkTreeIter iter;
-    guint *catnum;
+    gint catnum;
     sat_t *sat;
 
-    catnum = g_new0(guint, 1);
-
     /* get selected satellite */
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
     if (gtk_tree_selection_get_selected(selection, &model, &iter))
     {
-        gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
+        gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &catnum, -1);
 
-        sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+        sat = sat_registry_lookup(GTK_SAT_LIST(list)->satellites, catnum);
 
         if (sat == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s:%d Failed to get data for %d."), __FILE__, __LINE__, *catnum);
+                        _("%s:%d Failed to get data for %d."), __FILE__, __LINE__, catnum);
 
         }
         else
@@ -1290,8 +1377,6 @@ static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event, gpoint
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%d: There is no selection; skip popup."), __FILE__, __LINE__);
     }
-
-    g_free(catnum);
 }
 
 
@@ -1343,45 +1428,74 @@ static void Calculate_RADec(sat_t * sat, qth_t * qth, obs_astro_t * obs_set)
 }
 
 
-/** \brief Reload reference to satellites (e.g. after TLE update). */
-void gtk_sat_list_reload_sats(GtkWidget * satlist, GHashTable * sats)
+/**
+ * \brief Reload reference to satellites (e.g. after TLE update).
+ *
+ * The rows are pointed to the new satellite structures. Rows of satellites
+ * that are no longer tracked are removed and rows for new satellites are
+ * added.
+ */
+void gtk_sat_list_reload_sats(GtkWidget * widget, sat_registry_t * sats)
 {
-    GTK_SAT_LIST(satlist)->satellites = sats;
+    GtkSatList *satlist = GTK_SAT_LIST(widget);
+    GtkListStore *store = get_store(satlist);
+    GHashTableIter iter;
+    gpointer value;
+    sat_list_row_t *row;
+    sat_t *sat;
+    guint i;
+
+    satlist->satellites = sats;
+
+    g_hash_table_iter_init(&iter, satlist->rows);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        row = (sat_list_row_t *) value;
+        row->sat = sat_registry_lookup(sats, row->catnum);
+        row->valid = FALSE;
+
+        if (row->sat == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Satellite #%d removed from list."), __func__, row->catnum);
+            gtk_list_store_remove(store, &row->iter);
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+
+    for (i = 0; i < sats->num; i++)
+    {
+        sat = sat_registry_nth(sats, i);
+        if (g_hash_table_lookup(satlist->rows, &sat->tle.catnr) == NULL)
+            sat_list_add_satellite(satlist, store, sat);
+    }
 }
 
 /** \brief Select a satellite */
 void gtk_sat_list_select_sat(GtkWidget * satlist, gint catnum)
 {
     GtkSatList *slist;
-    GtkTreeModel *model;
+    GtkTreeModel *filter;
     GtkTreeSelection *selection;
-    GtkTreeIter iter;
-    gint i, n;
-    gint sat;
+    GtkTreeIter fiter, siter;
+    sat_list_row_t *row;
 
 
     slist = GTK_SAT_LIST(satlist);
-    model = gtk_tree_view_get_model(GTK_TREE_VIEW(slist->treeview));
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(slist->treeview));
 
-    /* iterate over the satellite list until a amtch is found */
-    n = g_hash_table_size(slist->satellites);
-    for (i = 0; i < n; i++)
-    {
+    row = g_hash_table_lookup(slist->rows, &catnum);
+    if (row == NULL)
+        return;
 
-        if (gtk_tree_model_iter_nth_child(model, &iter, NULL, i))
-        {
-            gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &sat, -1);
-            if (sat == catnum)
-            {
-                gtk_tree_selection_select_iter(selection, &iter);
-                i = n;
-            }
-        }
-        else
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: GtkSatList has not child with index %d"), __func__, i);
-        }
-    }
+    /* convert the list store row to a row in the sorted view; decayed
+       satellites are not visible */
+    filter = gtk_tree_model_sort_get_model(GTK_TREE_MODEL_SORT(slist->sortable));
+    if (!gtk_tree_model_filter_convert_child_iter_to_iter(GTK_TREE_MODEL_FILTER(filter),
+                                                          &fiter, &row->iter))
+        return;
+
+    gtk_tree_model_sort_convert_child_iter_to_iter(GTK_TREE_MODEL_SORT(slist->sortable),
+                                                   &siter, &fiter);
+    gtk_tree_selection_select_iter(selection, &siter);
 }
@@ -33,6 +33,7 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
+#include "sat-registry.h"
 
 
 #ifdef __cplusplus
@@ -63,7 +64,7 @@ struct _gtk_sat_list
      GtkWidget       *treeview;     /*!< the tree view itself */
      GtkWidget       *swin;         /*!< scrolled window */
      
-     GHashTable      *satellites;   /*!< Satellites. */
+     sat_registry_t  *satellites;   /*!< Satellites. */
      qth_t           *qth;          /*!< Pointer to current location. */
 
      guint32          flags;        /*!< Flags indicating which columns are visible */
@@ -75,6 +76,8 @@ struct _gtk_sat_list
     gint              sort_column;
     GtkSortType       sort_order;
     GtkTreeModel     *sortable;     /*!< a sortable version of the tree model for filtering */
+    GHashTable       *rows;         /*!< Row of each satellite keyed by catnum */
+    gchar            *tformat;      /*!< Time format used for the next event column */
     
      void (* update) (GtkWidget *widget);  /*!< update function */
 };
@@ -152,13 +155,13 @@ typedef enum {
 
 GType          gtk_sat_list_get_type        (void);
 GtkWidget*     gtk_sat_list_new             (GKeyFile   *cfgdata,
-                                                        GHashTable *sats,
+                                                        sat_registry_t *sats,
                                                         qth_t      *qth,
                                                         guint32     columns);
 void           gtk_sat_list_update          (GtkWidget  *widget);
 void           gtk_sat_list_reconf          (GtkWidget  *widget, GKeyFile *cfgdat);
 
-void gtk_sat_list_reload_sats (GtkWidget *satlist, GHashTable *sats);
+void gtk_sat_list_reload_sats (GtkWidget *satlist, sat_registry_t *sats);
 void gtk_sat_list_select_sat  (GtkWidget *satlist, gint catnum);
 
 
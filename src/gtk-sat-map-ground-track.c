@@ -31,6 +31,7 @@
  *       and gtk-sat-map-popup.c.
  *
  */
+#include <string.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include "sgpsdp/sgp4sdp4.h"
@@ -49,6 +50,7 @@
 #include "sat-cfg.h"
 #include "predict-tools.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 
 
 static void     create_polylines  (GtkSatMap *satmap, sat_t *sat, qth_t *qth, sat_map_obj_t *obj);
@@ -76,12 +78,17 @@ ground_track_create (GtkSatMap *satmap, sat_t *sat, qth_t *qth, sat_map_obj_t *o
      double         t0;          /* time when this_orbit starts */
      double         t;
      ssp_t         *this_ssp;
+     sat_t          sat_working;
 
 
      sat_log_log (SAT_LOG_LEVEL_DEBUG,
                      _("%s: Creating ground track for %s"),
                  __func__, sat->nickname);
 
+     /* propagate a private copy; the satellite data is shared with the
+        other views and must keep the state of the current cycle */
+     sat = memcpy (&sat_working, sat, sizeof (sat_t));
+
      /* just to be safe... if empty GSList is not NULL => segfault */
      obj->track_data.latlon = NULL;
 
@@ -165,11 +172,6 @@ ground_track_create (GtkSatMap *satmap, sat_t *sat, qth_t *qth, sat_map_obj_t *o
                       __func__, sat->nickname);
          return;
      }
-     
-
-     /* Reset satellite structure to eliminate glitches in single sat 
-        view and other places when new ground track is layed out */
-     predict_calc(sat, qth, satmap->tstamp);
 
      /* reverse GSList */
      obj->track_data.latlon = g_slist_reverse (obj->track_data.latlon);
@@ -291,6 +293,9 @@ ground_track_delete (GtkSatMap *satmap, sat_t *sat, qth_t *qth, sat_map_obj_t *o
 
           obj->track_orbit = 0;
      }
+
+     if (satmap->cairo)
+          gtk_sat_map_layer_invalidate (GTK_SAT_MAP_LAYER (satmap->layer), FALSE);
 }
 
 
@@ -325,6 +330,12 @@ create_polylines (GtkSatMap *satmap, sat_t *sat, qth_t *qth, sat_map_obj_t *obj)
      (void) sat; /* prevent unused parameter compiler warning */
      (void) qth; /* prevent unused parameter compiler warning */
 
+     /* the Cairo layer draws the track directly from the SSP list */
+     if (satmap->cairo) {
+          gtk_sat_map_layer_invalidate (GTK_SAT_MAP_LAYER (satmap->layer), FALSE);
+          return;
+     }
+
      /* initialise parameters */
      lastx = -50.0;
      lasty = -50.0;
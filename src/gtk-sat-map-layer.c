@@ -0,0 +1,950 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Cairo renderer for the satellites on the map.
+ *
+ * Each satellite on the map normally consists of at least four canvas items
+ * with their own properties, tooltips and hit testing, which does not scale
+ * to catalogues with thousands of objects. This canvas item draws all
+ * satellites, footprints and ground tracks in a single paint call from
+ * packed arrays, and uses a uniform grid for picking the satellite under
+ * the mouse pointer.
+ *
+ * The map image, the grid lines and the solar terminator are rendered into
+ * an image surface that is reused until the map is resized or the
+ * terminator moves.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <gtk/gtk.h>
+#include <goocanvas.h>
+#include <math.h>
+#include <string.h>
+
+#include "config-keys.h"
+#include "gtk-sat-map-layer.h"
+#include "gtk-sat-map.h"
+#include "mod-cfg-get-param.h"
+#include "sat-cfg.h"
+
+
+#define MARKER_SIZE_HALF    1   /* same as on the canvas items */
+#define LABEL_FONT_SIZE     (8.0 * 96.0 / 72.0)     /* "Sans 8" at 96 dpi */
+
+
+/** \brief The canvas item showing a GtkSatMapLayer. */
+typedef struct {
+    GooCanvasItemSimple parent;
+} GtkSatMapLayerView;
+
+typedef struct {
+    GooCanvasItemSimpleClass parent_class;
+} GtkSatMapLayerViewClass;
+
+
+static void     gtk_sat_map_layer_class_init(GtkSatMapLayerClass * class);
+static void     gtk_sat_map_layer_init(GtkSatMapLayer * layer);
+static void     gtk_sat_map_layer_finalize(GObject * object);
+static void     layer_model_iface_init(GooCanvasItemModelIface * iface);
+static GooCanvasItem *layer_create_item(GooCanvasItemModel * model,
+                                        GooCanvas * canvas);
+static void     gtk_sat_map_layer_view_class_init(GtkSatMapLayerViewClass *
+                                                  class);
+static void     layer_view_update(GooCanvasItemSimple * simple, cairo_t * cr);
+static void     layer_view_paint(GooCanvasItemSimple * simple, cairo_t * cr,
+                                 const GooCanvasBounds * bounds);
+static gboolean layer_view_is_item_at(GooCanvasItemSimple * simple,
+                                      gdouble x, gdouble y, cairo_t * cr,
+                                      gboolean is_pointer_event);
+static void     set_source_col(cairo_t * cr, guint32 col);
+static void     paint_background(GtkSatMapLayer * layer, cairo_t * cr);
+static void     footprint_path(GtkSatMapLayer * layer, cairo_t * cr,
+                               guint slot);
+static void     paint_footprints(GtkSatMapLayer * layer, cairo_t * cr);
+static void     paint_tracks(GtkSatMapLayer * layer, cairo_t * cr);
+static void     paint_markers(GtkSatMapLayer * layer, cairo_t * cr,
+                              const GooCanvasBounds * bounds);
+static void     paint_labels(GtkSatMapLayer * layer, cairo_t * cr,
+                             const GooCanvasBounds * bounds);
+static void     build_grid(GtkSatMapLayer * layer);
+
+static GObjectClass *parent_class = NULL;
+
+
+/** \brief Register the layer item model. */
+GType gtk_sat_map_layer_get_type()
+{
+    static GType    gtk_sat_map_layer_type = 0;
+
+    if (!gtk_sat_map_layer_type)
+    {
+        static const GTypeInfo gtk_sat_map_layer_info = {
+            sizeof(GtkSatMapLayerClass),
+            NULL,               /* base init */
+            NULL,               /* base finalize */
+            (GClassInitFunc) gtk_sat_map_layer_class_init,
+            NULL,               /* class finalize */
+            NULL,               /* class data */
+            sizeof(GtkSatMapLayer),
+            0,                  /* n_preallocs */
+            (GInstanceInitFunc) gtk_sat_map_layer_init,
+            NULL
+        };
+        static const GInterfaceInfo model_info = {
+            (GInterfaceInitFunc) layer_model_iface_init,
+            NULL,               /* interface finalize */
+            NULL                /* interface data */
+        };
+
+        gtk_sat_map_layer_type =
+            g_type_register_static(GOO_TYPE_CANVAS_ITEM_MODEL_SIMPLE,
+                                   "GtkSatMapLayer",
+                                   &gtk_sat_map_layer_info, 0);
+        g_type_add_interface_static(gtk_sat_map_layer_type,
+                                    GOO_TYPE_CANVAS_ITEM_MODEL, &model_info);
+    }
+
+    return gtk_sat_map_layer_type;
+}
+
+
+/** \brief Register the canvas item showing the layer. */
+GType gtk_sat_map_layer_view_get_type()
+{
+    static GType    gtk_sat_map_layer_view_type = 0;
+
+    if (!gtk_sat_map_layer_view_type)
+    {
+        static const GTypeInfo gtk_sat_map_layer_view_info = {
+            sizeof(GtkSatMapLayerViewClass),
+            NULL,               /* base init */
+            NULL,               /* base finalize */
+            (GClassInitFunc) gtk_sat_map_layer_view_class_init,
+            NULL,               /* class finalize */
+            NULL,               /* class data */
+            sizeof(GtkSatMapLayerView),
+            0,                  /* n_preallocs */
+            NULL,               /* instance init */
+            NULL
+        };
+
+        gtk_sat_map_layer_view_type =
+            g_type_register_static(GOO_TYPE_CANVAS_ITEM_SIMPLE,
+                                   "GtkSatMapLayerView",
+                                   &gtk_sat_map_layer_view_info, 0);
+    }
+
+    return gtk_sat_map_layer_view_type;
+}
+
+
+static void gtk_sat_map_layer_class_init(GtkSatMapLayerClass * class)
+{
+    GObjectClass   *gobject_class = G_OBJECT_CLASS(class);
+
+    parent_class = g_type_class_peek_parent(class);
+
+    gobject_class->finalize = gtk_sat_map_layer_finalize;
+}
+
+
+static void gtk_sat_map_layer_init(GtkSatMapLayer * layer)
+{
+    layer->satmap = NULL;
+    layer->num = 0;
+    layer->size = 0;
+    layer->obj = NULL;
+    layer->catnum = NULL;
+    layer->name = NULL;
+    layer->labw = NULL;
+    layer->x = NULL;
+    layer->y = NULL;
+    layer->fp = NULL;
+    layer->fpn1 = NULL;
+    layer->fpn2 = NULL;
+    layer->cols = 0;
+    layer->rows = 0;
+    layer->cell_start = NULL;
+    layer->cell_slot = NULL;
+    layer->grid_valid = FALSE;
+    layer->bgd = NULL;
+}
+
+
+static void gtk_sat_map_layer_finalize(GObject * object)
+{
+    GtkSatMapLayer *layer = GTK_SAT_MAP_LAYER(object);
+    guint           i;
+
+    for (i = 0; i < layer->num; i++)
+    {
+        g_free(layer->name[i]);
+        g_free(layer->fp[i]);
+    }
+
+    g_free(layer->obj);
+    g_free(layer->catnum);
+    g_free(layer->name);
+    g_free(layer->labw);
+    g_free(layer->x);
+    g_free(layer->y);
+    g_free(layer->fp);
+    g_free(layer->fpn1);
+    g_free(layer->fpn2);
+    g_free(layer->cell_start);
+    g_free(layer->cell_slot);
+
+    if (layer->bgd != NULL)
+        cairo_surface_destroy(layer->bgd);
+
+    parent_class->finalize(object);
+}
+
+
+static void layer_model_iface_init(GooCanvasItemModelIface * iface)
+{
+    iface->create_item = layer_create_item;
+}
+
+
+/** \brief Create the canvas item for a layer model. */
+static GooCanvasItem *layer_create_item(GooCanvasItemModel * model,
+                                        GooCanvas * canvas)
+{
+    GooCanvasItem  *item;
+
+    (void)canvas;               /* avoid unusued parameter compiler warning */
+
+    item = g_object_new(GTK_TYPE_SAT_MAP_LAYER_VIEW, NULL);
+    goo_canvas_item_set_model(item, model);
+
+    return item;
+}
+
+
+static void gtk_sat_map_layer_view_class_init(GtkSatMapLayerViewClass * class)
+{
+    GooCanvasItemSimpleClass *simple_class =
+        (GooCanvasItemSimpleClass *) class;
+
+    simple_class->simple_update = layer_view_update;
+    simple_class->simple_paint = layer_view_paint;
+    simple_class->simple_is_item_at = layer_view_is_item_at;
+}
+
+
+/**
+ * \brief Create a new satellite layer.
+ * \param satmap The map the layer belongs to.
+ * \return A new item model, which must be added to the root of the canvas.
+ *
+ * The colours are read from the module configuration of the map.
+ */
+GooCanvasItemModel *gtk_sat_map_layer_new(GtkSatMap * satmap)
+{
+    GtkSatMapLayer *layer;
+
+    layer = g_object_new(GTK_TYPE_SAT_MAP_LAYER, NULL);
+    layer->satmap = satmap;
+
+    layer->col = mod_cfg_get_int(satmap->cfgdata,
+                                 MOD_CFG_MAP_SECTION,
+                                 MOD_CFG_MAP_SAT_COL,
+                                 SAT_CFG_INT_MAP_SAT_COL);
+    layer->selcol = mod_cfg_get_int(satmap->cfgdata,
+                                    MOD_CFG_MAP_SECTION,
+                                    MOD_CFG_MAP_SAT_SEL_COL,
+                                    SAT_CFG_INT_MAP_SAT_SEL_COL);
+    layer->covcol = mod_cfg_get_int(satmap->cfgdata,
+                                    MOD_CFG_MAP_SECTION,
+                                    MOD_CFG_MAP_SAT_COV_COL,
+                                    SAT_CFG_INT_MAP_SAT_COV_COL);
+    layer->shadowcol = mod_cfg_get_int(satmap->cfgdata,
+                                       MOD_CFG_MAP_SECTION,
+                                       MOD_CFG_MAP_SHADOW_ALPHA,
+                                       SAT_CFG_INT_MAP_SHADOW_ALPHA);
+    layer->trackcol = mod_cfg_get_int(satmap->cfgdata,
+                                      MOD_CFG_MAP_SECTION,
+                                      MOD_CFG_MAP_TRACK_COL,
+                                      SAT_CFG_INT_MAP_TRACK_COL);
+    layer->gridcol = mod_cfg_get_int(satmap->cfgdata,
+                                     MOD_CFG_MAP_SECTION,
+                                     MOD_CFG_MAP_GRID_COL,
+                                     SAT_CFG_INT_MAP_GRID_COL);
+    layer->termcol = mod_cfg_get_int(satmap->cfgdata,
+                                     MOD_CFG_MAP_SECTION,
+                                     MOD_CFG_MAP_TERMINATOR_COL,
+                                     SAT_CFG_INT_MAP_TERMINATOR_COL);
+    layer->nightcol = mod_cfg_get_int(satmap->cfgdata,
+                                      MOD_CFG_MAP_SECTION,
+                                      MOD_CFG_MAP_GLOBAL_SHADOW_COL,
+                                      SAT_CFG_INT_MAP_GLOBAL_SHADOW_COL);
+
+    return GOO_CANVAS_ITEM_MODEL(layer);
+}
+
+
+/**
+ * \brief Add a satellite to the layer.
+ * \param layer The layer.
+ * \param obj The map object of the satellite.
+ * \param sat The satellite.
+ * \return The slot of the satellite.
+ *
+ * The satellite is not drawn until its position has been set using
+ * gtk_sat_map_layer_set_sat().
+ */
+guint gtk_sat_map_layer_add(GtkSatMapLayer * layer, sat_map_obj_t * obj,
+                            sat_t * sat)
+{
+    guint           slot;
+
+    if (layer->num == layer->size)
+    {
+        layer->size = layer->size ? 2 * layer->size : 64;
+
+        layer->obj = g_renew(sat_map_obj_t *, layer->obj, layer->size);
+        layer->catnum = g_renew(gint, layer->catnum, layer->size);
+        layer->name = g_renew(gchar *, layer->name, layer->size);
+        layer->labw = g_renew(gfloat, layer->labw, layer->size);
+        layer->x = g_renew(gfloat, layer->x, layer->size);
+        layer->y = g_renew(gfloat, layer->y, layer->size);
+        layer->fp = g_renew(gfloat *, layer->fp, layer->size);
+        layer->fpn1 = g_renew(guint, layer->fpn1, layer->size);
+        layer->fpn2 = g_renew(guint, layer->fpn2, layer->size);
+        layer->cell_slot = g_renew(guint, layer->cell_slot, layer->size);
+    }
+
+    slot = layer->num++;
+
+    layer->obj[slot] = obj;
+    layer->catnum[slot] = sat->tle.catnr;
+    layer->name[slot] = g_strdup(sat->nickname);
+    layer->labw[slot] = -1.0;
+    layer->x[slot] = -100.0;
+    layer->y[slot] = -100.0;
+    layer->fp[slot] = NULL;
+    layer->fpn1[slot] = 0;
+    layer->fpn2[slot] = 0;
+
+    obj->layer_slot = slot;
+    layer->grid_valid = FALSE;
+
+    return slot;
+}
+
+
+/**
+ * \brief Remove a satellite from the layer.
+ * \param layer The layer.
+ * \param slot The slot of the satellite.
+ *
+ * The last satellite is moved into the free slot and its map object is
+ * updated accordingly.
+ */
+void gtk_sat_map_layer_remove(GtkSatMapLayer * layer, guint slot)
+{
+    guint           last;
+
+    g_return_if_fail(slot < layer->num);
+
+    g_free(layer->name[slot]);
+    g_free(layer->fp[slot]);
+
+    last = --layer->num;
+    if (slot != last)
+    {
+        layer->obj[slot] = layer->obj[last];
+        layer->catnum[slot] = layer->catnum[last];
+        layer->name[slot] = layer->name[last];
+        layer->labw[slot] = layer->labw[last];
+        layer->x[slot] = layer->x[last];
+        layer->y[slot] = layer->y[last];
+        layer->fp[slot] = layer->fp[last];
+        layer->fpn1[slot] = layer->fpn1[last];
+        layer->fpn2[slot] = layer->fpn2[last];
+
+        layer->obj[slot]->layer_slot = slot;
+    }
+
+    layer->grid_valid = FALSE;
+}
+
+
+/**
+ * \brief Update the position and footprint of a satellite.
+ * \param layer The layer.
+ * \param slot The slot of the satellite.
+ * \param x The X coordinate of the satellite.
+ * \param y The Y coordinate of the satellite.
+ * \param p1 The first part of the footprint.
+ * \param p2 The second part of the footprint or NULL.
+ *
+ * The layer is not redrawn until gtk_sat_map_layer_invalidate() is called,
+ * so that a whole update cycle only causes one redraw.
+ */
+void gtk_sat_map_layer_set_sat(GtkSatMapLayer * layer, guint slot,
+                               gfloat x, gfloat y,
+                               GooCanvasPoints * p1, GooCanvasPoints * p2)
+{
+    guint           n1, n2, i;
+    gfloat         *fp;
+
+    g_return_if_fail(slot < layer->num);
+
+    layer->x[slot] = x;
+    layer->y[slot] = y;
+
+    n1 = p1->num_points;
+    n2 = (p2 != NULL) ? p2->num_points : 0;
+
+    if (n1 + n2 != layer->fpn1[slot] + layer->fpn2[slot])
+        layer->fp[slot] = g_renew(gfloat, layer->fp[slot], 2 * (n1 + n2));
+
+    fp = layer->fp[slot];
+    for (i = 0; i < 2 * n1; i++)
+        fp[i] = (gfloat) p1->coords[i];
+    for (i = 0; i < 2 * n2; i++)
+        fp[2 * n1 + i] = (gfloat) p2->coords[i];
+
+    layer->fpn1[slot] = n1;
+    layer->fpn2[slot] = n2;
+
+    layer->grid_valid = FALSE;
+}
+
+
+/**
+ * \brief Find the satellite at a given position.
+ * \param layer The layer.
+ * \param x The X coordinate on the canvas.
+ * \param y The Y coordinate on the canvas.
+ * \return The catalogue number of the nearest satellite within
+ *         SAT_MAP_LAYER_PICK pixels, or 0 if there is none.
+ */
+gint gtk_sat_map_layer_pick(GtkSatMapLayer * layer, gdouble x, gdouble y)
+{
+    gint            cx, cy, i, j;
+    guint           k, slot, cell;
+    gdouble         dx, dy, d2;
+    gdouble         best = SAT_MAP_LAYER_PICK * SAT_MAP_LAYER_PICK;
+    gint            catnum = 0;
+
+    if (!layer->grid_valid)
+        build_grid(layer);
+
+    if (layer->cols == 0 || x < 0.0 || y < 0.0)
+        return 0;
+
+    cx = (gint) (x / SAT_MAP_LAYER_CELL);
+    cy = (gint) (y / SAT_MAP_LAYER_CELL);
+
+    for (j = cy - 1; j <= cy + 1; j++)
+    {
+        if (j < 0 || j >= (gint) layer->rows)
+            continue;
+
+        for (i = cx - 1; i <= cx + 1; i++)
+        {
+            if (i < 0 || i >= (gint) layer->cols)
+                continue;
+
+            cell = j * layer->cols + i;
+            for (k = layer->cell_start[cell]; k < layer->cell_start[cell + 1];
+                 k++)
+            {
+                slot = layer->cell_slot[k];
+                dx = layer->x[slot] - x;
+                dy = layer->y[slot] - y;
+                d2 = dx * dx + dy * dy;
+
+                if (d2 <= best)
+                {
+                    best = d2;
+                    catnum = layer->catnum[slot];
+                }
+            }
+        }
+    }
+
+    return catnum;
+}
+
+
+/**
+ * \brief Request a redraw of the layer.
+ * \param layer The layer.
+ * \param background Whether the background must be rendered again too,
+ *                   e.g. because the map has been resized.
+ */
+void gtk_sat_map_layer_invalidate(GtkSatMapLayer * layer, gboolean background)
+{
+    if (background && layer->bgd != NULL)
+    {
+        cairo_surface_destroy(layer->bgd);
+        layer->bgd = NULL;
+    }
+
+    g_signal_emit_by_name(layer, "changed", background);
+}
+
+
+/** \brief Sort the satellites into the cells of the picking grid. */
+static void build_grid(GtkSatMapLayer * layer)
+{
+    GtkSatMap      *satmap = layer->satmap;
+    guint           cols, rows, ncells;
+    guint           i, cell;
+    guint          *cell_of;
+    gint            cx, cy;
+
+    cols = (satmap->x0 + satmap->width) / SAT_MAP_LAYER_CELL + 1;
+    rows = (satmap->y0 + satmap->height) / SAT_MAP_LAYER_CELL + 1;
+    ncells = cols * rows;
+
+    if (cols != layer->cols || rows != layer->rows)
+    {
+        layer->cols = cols;
+        layer->rows = rows;
+        layer->cell_start = g_renew(guint, layer->cell_start, ncells + 1);
+    }
+    memset(layer->cell_start, 0, (ncells + 1) * sizeof(guint));
+
+    /* counting sort: count, prefix sum, scatter */
+    cell_of = g_new(guint, layer->num + 1);
+    for (i = 0; i < layer->num; i++)
+    {
+        cx = CLAMP((gint) (layer->x[i] / SAT_MAP_LAYER_CELL), 0,
+                   (gint) cols - 1);
+        cy = CLAMP((gint) (layer->y[i] / SAT_MAP_LAYER_CELL), 0,
+                   (gint) rows - 1);
+        cell_of[i] = cy * cols + cx;
+        layer->cell_start[cell_of[i] + 1]++;
+    }
+
+    for (cell = 0; cell < ncells; cell++)
+        layer->cell_start[cell + 1] += layer->cell_start[cell];
+
+    for (i = 0; i < layer->num; i++)
+    {
+        cell = cell_of[i];
+        layer->cell_slot[layer->cell_start[cell]++] = i;
+    }
+
+    /* the scatter has moved each start to the next cell */
+    for (cell = ncells; cell > 0; cell--)
+        layer->cell_start[cell] = layer->cell_start[cell - 1];
+    layer->cell_start[0] = 0;
+
+    g_free(cell_of);
+    layer->grid_valid = TRUE;
+}
+
+
+/** \brief The layer covers the whole map. */
+static void layer_view_update(GooCanvasItemSimple * simple, cairo_t * cr)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP_LAYER(simple->model)->satmap;
+
+    (void)cr;                   /* avoid unusued parameter compiler warning */
+
+    simple->bounds.x1 = satmap->x0;
+    simple->bounds.y1 = satmap->y0;
+    simple->bounds.x2 = satmap->x0 + satmap->width;
+    simple->bounds.y2 = satmap->y0 + satmap->height;
+}
+
+
+/** \brief Paint the background and all satellites. */
+static void layer_view_paint(GooCanvasItemSimple * simple, cairo_t * cr,
+                             const GooCanvasBounds * bounds)
+{
+    GtkSatMapLayer *layer = GTK_SAT_MAP_LAYER(simple->model);
+
+    paint_background(layer, cr);
+
+    cairo_save(cr);
+    cairo_set_line_width(cr, 1.0);
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_SQUARE);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+
+    paint_footprints(layer, cr);
+    paint_tracks(layer, cr);
+    paint_markers(layer, cr, bounds);
+    paint_labels(layer, cr, bounds);
+
+    cairo_restore(cr);
+}
+
+
+/**
+ * \brief Check whether there is a satellite at a position.
+ *
+ * Only satellites are hit, so that events on the empty map still reach the
+ * root item.
+ */
+static gboolean layer_view_is_item_at(GooCanvasItemSimple * simple,
+                                      gdouble x, gdouble y, cairo_t * cr,
+                                      gboolean is_pointer_event)
+{
+    (void)cr;                   /* avoid unusued parameter compiler warning */
+    (void)is_pointer_event;     /* avoid unusued parameter compiler warning */
+
+    return gtk_sat_map_layer_pick(GTK_SAT_MAP_LAYER(simple->model), x, y) != 0;
+}
+
+
+/** \brief Set an RGBA colour as cairo source. */
+static void set_source_col(cairo_t * cr, guint32 col)
+{
+    cairo_set_source_rgba(cr,
+                          ((col >> 24) & 0xFF) / 255.0,
+                          ((col >> 16) & 0xFF) / 255.0,
+                          ((col >> 8) & 0xFF) / 255.0, (col & 0xFF) / 255.0);
+}
+
+
+/**
+ * \brief Paint the cached background.
+ *
+ * The background is rendered from the (hidden) map, heat map, grid and
+ * terminator items of the GtkSatMap, so their geometry is only computed in one place.
+ */
+static void paint_background(GtkSatMapLayer * layer, cairo_t * cr)
+{
+    GtkSatMap      *satmap = layer->satmap;
+    GdkPixbuf      *pbuf = NULL;
+    GooCanvasPoints *pts = NULL;
+    cairo_t        *bcr;
+    gdouble         xstep, ystep, pos;
+    gint            i;
+
+    if (layer->bgd == NULL)
+    {
+        layer->bgd = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                                satmap->x0 + satmap->width,
+                                                satmap->y0 + satmap->height);
+        bcr = cairo_create(layer->bgd);
+
+        /* map */
+        g_object_get(satmap->map, "pixbuf", &pbuf, NULL);
+        if (pbuf != NULL)
+        {
+            gdk_cairo_set_source_pixbuf(bcr, pbuf, satmap->x0, satmap->y0);
+            cairo_paint(bcr);
+            g_object_unref(pbuf);
+            pbuf = NULL;
+        }
+
+        /* coverage heat map */
+        if (satmap->heatmap != NULL)
+            g_object_get(satmap->heatmap, "pixbuf", &pbuf, NULL);
+        if (pbuf != NULL)
+        {
+            gdk_cairo_set_source_pixbuf(bcr, pbuf, satmap->x0, satmap->y0);
+            cairo_paint(bcr);
+            g_object_unref(pbuf);
+        }
+
+        /* solar terminator */
+        g_object_get(satmap->terminator, "points", &pts, NULL);
+        if (pts != NULL)
+        {
+            for (i = 0; i < pts->num_points; i++)
+                cairo_line_to(bcr, pts->coords[2 * i], pts->coords[2 * i + 1]);
+            cairo_close_path(bcr);
+            set_source_col(bcr, layer->nightcol);
+            cairo_fill_preserve(bcr);
+            cairo_set_line_width(bcr, 1.0);
+            set_source_col(bcr, layer->termcol);
+            cairo_stroke(bcr);
+            goo_canvas_points_unref(pts);
+        }
+
+        /* grid lines */
+        if (satmap->showgrid)
+        {
+            xstep = 30.0 * satmap->width / 360.0;
+            ystep = 30.0 * satmap->height / 180.0;
+
+            for (i = 0; i < 5; i++)
+            {
+                pos = satmap->y0 + (i + 1) * ystep;
+                cairo_move_to(bcr, satmap->x0, pos);
+                cairo_line_to(bcr, satmap->x0 + satmap->width, pos);
+            }
+            for (i = 0; i < 11; i++)
+            {
+                pos = satmap->x0 + (i + 1) * xstep;
+                cairo_move_to(bcr, pos, satmap->y0);
+                cairo_line_to(bcr, pos, satmap->y0 + satmap->height);
+            }
+            cairo_set_line_width(bcr, 0.5);
+            set_source_col(bcr, layer->gridcol);
+            cairo_stroke(bcr);
+        }
+
+        cairo_destroy(bcr);
+    }
+
+    cairo_set_source_surface(cr, layer->bgd, 0, 0);
+    cairo_paint(cr);
+}
+
+
+/** \brief Add the footprint of a slot to the current path. */
+static void footprint_path(GtkSatMapLayer * layer, cairo_t * cr, guint slot)
+{
+    const gfloat   *fp = layer->fp[slot];
+    guint           i;
+
+    if (layer->fpn1[slot] > 0)
+    {
+        cairo_move_to(cr, fp[0], fp[1]);
+        for (i = 1; i < layer->fpn1[slot]; i++)
+            cairo_line_to(cr, fp[2 * i], fp[2 * i + 1]);
+    }
+
+    fp += 2 * layer->fpn1[slot];
+    if (layer->fpn2[slot] > 0)
+    {
+        cairo_move_to(cr, fp[0], fp[1]);
+        for (i = 1; i < layer->fpn2[slot]; i++)
+            cairo_line_to(cr, fp[2 * i], fp[2 * i + 1]);
+    }
+}
+
+
+/**
+ * \brief Paint the footprints.
+ *
+ * All coverage areas are filled in one go, and the outlines are stroked in
+ * two batches: unselected and selected.
+ */
+static void paint_footprints(GtkSatMapLayer * layer, cairo_t * cr)
+{
+    guint           i;
+    gboolean        any = FALSE;
+
+    /* coverage areas */
+    for (i = 0; i < layer->num; i++)
+    {
+        if (layer->obj[i]->showcov)
+        {
+            footprint_path(layer, cr, i);
+            cairo_close_path(cr);
+            any = TRUE;
+        }
+    }
+    if (any)
+    {
+        cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+        set_source_col(cr, layer->covcol);
+        cairo_fill(cr);
+    }
+
+    /* outlines */
+    for (i = 0; i < layer->num; i++)
+        if (!layer->obj[i]->selected)
+            footprint_path(layer, cr, i);
+    set_source_col(cr, layer->col);
+    cairo_stroke(cr);
+
+    for (i = 0; i < layer->num; i++)
+        if (layer->obj[i]->selected)
+            footprint_path(layer, cr, i);
+    set_source_col(cr, layer->selcol);
+    cairo_stroke(cr);
+}
+
+
+/**
+ * \brief Paint the ground tracks.
+ *
+ * The track is split where it wraps around the map, like the polylines
+ * created by the ground track code for the canvas renderer.
+ */
+static void paint_tracks(GtkSatMapLayer * layer, cairo_t * cr)
+{
+    GtkSatMap      *satmap = layer->satmap;
+    GSList         *node;
+    ssp_t          *ssp;
+    gdouble         x, y, lastx;
+    gboolean        first;
+    guint           i;
+
+    for (i = 0; i < layer->num; i++)
+    {
+        if (!layer->obj[i]->showtrack)
+            continue;
+
+        first = TRUE;
+        lastx = 0.0;
+        for (node = layer->obj[i]->track_data.latlon; node != NULL;
+             node = node->next)
+        {
+            ssp = (ssp_t *) node->data;
+            gtk_sat_map_lonlat_to_xy(satmap, ssp->lon, ssp->lat, &x, &y);
+
+            if (first || fabs(x - lastx) > satmap->width / 2.0)
+                cairo_move_to(cr, x, y);
+            else
+                cairo_line_to(cr, x, y);
+
+            first = FALSE;
+            lastx = x;
+        }
+    }
+
+    set_source_col(cr, layer->trackcol);
+    cairo_stroke(cr);
+}
+
+
+/** \brief Paint the satellite markers and their shadows. */
+static void paint_markers(GtkSatMapLayer * layer, cairo_t * cr,
+                          const GooCanvasBounds * bounds)
+{
+    const gdouble   size = 2 * MARKER_SIZE_HALF;
+    gdouble         x, y;
+    guint           i;
+
+    /* shadows */
+    for (i = 0; i < layer->num; i++)
+    {
+        x = layer->x[i] - MARKER_SIZE_HALF;
+        y = layer->y[i] - MARKER_SIZE_HALF;
+        if (x + size + 1 < bounds->x1 || x > bounds->x2 ||
+            y + size + 1 < bounds->y1 || y > bounds->y2)
+            continue;
+
+        cairo_rectangle(cr, x + 1, y + 1, size, size);
+    }
+    set_source_col(cr, layer->shadowcol);
+    cairo_stroke(cr);
+
+    /* markers: unselected first, then the selected on top */
+    for (i = 0; i < layer->num; i++)
+    {
+        x = layer->x[i] - MARKER_SIZE_HALF;
+        y = layer->y[i] - MARKER_SIZE_HALF;
+        if (layer->obj[i]->selected ||
+            x + size < bounds->x1 || x > bounds->x2 ||
+            y + size < bounds->y1 || y > bounds->y2)
+            continue;
+
+        cairo_rectangle(cr, x, y, size, size);
+    }
+    set_source_col(cr, layer->col);
+    cairo_fill_preserve(cr);
+    cairo_stroke(cr);
+
+    for (i = 0; i < layer->num; i++)
+    {
+        if (layer->obj[i]->selected)
+            cairo_rectangle(cr, layer->x[i] - MARKER_SIZE_HALF,
+                            layer->y[i] - MARKER_SIZE_HALF, size, size);
+    }
+    set_source_col(cr, layer->selcol);
+    cairo_fill_preserve(cr);
+    cairo_stroke(cr);
+}
+
+
+/**
+ * \brief Paint the satellite names.
+ *
+ * The labels are placed next to the marker the same way as the canvas
+ * renderer does, i.e. they are moved to the side of the marker close to the
+ * edges of the map.
+ */
+static void paint_labels(GtkSatMapLayer * layer, cairo_t * cr,
+                         const GooCanvasBounds * bounds)
+{
+    GtkSatMap      *satmap = layer->satmap;
+    cairo_text_extents_t ext;
+    cairo_font_extents_t fext;
+    gdouble         x, y, lx, ly;
+    guint           i;
+
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, LABEL_FONT_SIZE);
+    cairo_font_extents(cr, &fext);
+
+    for (i = 0; i < layer->num; i++)
+    {
+        x = layer->x[i];
+        y = layer->y[i];
+
+        if (layer->labw[i] < 0.0)
+        {
+            cairo_text_extents(cr, layer->name[i], &ext);
+            layer->labw[i] = ext.x_advance;
+        }
+
+        /* same placement rules as update_sat() in gtk-sat-map.c */
+        if (x < 50)
+        {
+            lx = x + 3;
+            ly = y + (fext.ascent - fext.descent) / 2.0;
+        }
+        else if ((satmap->width - x) < 50)
+        {
+            lx = x - 3 - layer->labw[i];
+            ly = y + (fext.ascent - fext.descent) / 2.0;
+        }
+        else if ((satmap->height - y) < 25)
+        {
+            lx = x - layer->labw[i] / 2.0;
+            ly = y - 2 - fext.descent;
+        }
+        else
+        {
+            lx = x - layer->labw[i] / 2.0;
+            ly = y + 2 + fext.ascent;
+        }
+
+        if (lx + layer->labw[i] + 1 < bounds->x1 || lx > bounds->x2 ||
+            ly + fext.descent + 1 < bounds->y1 || ly - fext.ascent > bounds->y2)
+            continue;
+
+        set_source_col(cr, layer->shadowcol);
+        cairo_move_to(cr, lx + 1, ly + 1);
+        cairo_show_text(cr, layer->name[i]);
+
+        set_source_col(cr, layer->obj[i]->selected ?
+                       layer->selcol : layer->col);
+        cairo_move_to(cr, lx, ly);
+        cairo_show_text(cr, layer->name[i]);
+    }
+}
@@ -0,0 +1,116 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef __GTK_SAT_MAP_LAYER_H__
+#define __GTK_SAT_MAP_LAYER_H__ 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <goocanvas.h>
+#include "gtk-sat-map.h"
+
+
+#define GTK_TYPE_SAT_MAP_LAYER       (gtk_sat_map_layer_get_type ())
+#define GTK_SAT_MAP_LAYER(obj)       G_TYPE_CHECK_INSTANCE_CAST (obj, gtk_sat_map_layer_get_type (), GtkSatMapLayer)
+#define GTK_IS_SAT_MAP_LAYER(obj)    G_TYPE_CHECK_INSTANCE_TYPE (obj, gtk_sat_map_layer_get_type ())
+
+#define GTK_TYPE_SAT_MAP_LAYER_VIEW  (gtk_sat_map_layer_view_get_type ())
+
+#define SAT_MAP_LAYER_CELL  16   /*!< Size of a picking grid cell in pixels. */
+#define SAT_MAP_LAYER_PICK  4.0  /*!< Max distance in pixels for picking a satellite. */
+
+
+/** \brief Canvas item model drawing all satellites of a GtkSatMap.
+ *
+ * The satellites are kept in packed arrays indexed by slot number and are
+ * drawn in a single paint call, instead of using a handful of canvas items
+ * for each satellite. The background map, grid and terminator are rendered
+ * into an image surface which is only redrawn when they change.
+ *
+ * The slot of a satellite is stored in its sat_map_obj_t; slots are moved
+ * when other satellites are removed.
+ */
+typedef struct {
+    GooCanvasItemModelSimple parent;
+
+    GtkSatMap      *satmap;     /*!< The map we belong to. */
+
+    guint           num;        /*!< Number of used slots. */
+    guint           size;       /*!< Number of allocated slots. */
+    sat_map_obj_t **obj;        /*!< Satellite object of each slot. */
+    gint           *catnum;     /*!< Catalogue number of each slot. */
+    gchar         **name;       /*!< Label of each slot. */
+    gfloat         *labw;       /*!< Label width, < 0 if not measured yet. */
+    gfloat         *x;          /*!< Marker X coordinate. */
+    gfloat         *y;          /*!< Marker Y coordinate. */
+    gfloat        **fp;         /*!< Footprint coordinates, both parts. */
+    guint          *fpn1;       /*!< Number of points in the first part. */
+    guint          *fpn2;       /*!< Number of points in the second part. */
+
+    guint           cols;       /*!< Columns of the picking grid. */
+    guint           rows;       /*!< Rows of the picking grid. */
+    guint          *cell_start; /*!< First entry of each cell in cell_slot. */
+    guint          *cell_slot;  /*!< Slots sorted by grid cell. */
+    gboolean        grid_valid; /*!< Picking grid matches the positions. */
+
+    cairo_surface_t *bgd;       /*!< Cached background. */
+
+    guint32         col;        /*!< Satellite colour. */
+    guint32         selcol;     /*!< Selected satellite colour. */
+    guint32         covcol;     /*!< Coverage area colour. */
+    guint32         shadowcol;  /*!< Shadow colour. */
+    guint32         trackcol;   /*!< Ground track colour. */
+    guint32         gridcol;    /*!< Grid colour. */
+    guint32         termcol;    /*!< Terminator colour. */
+    guint32         nightcol;   /*!< Global shadow colour. */
+} GtkSatMapLayer;
+
+typedef struct {
+    GooCanvasItemModelSimpleClass parent_class;
+} GtkSatMapLayerClass;
+
+
+GType               gtk_sat_map_layer_get_type      (void);
+GType               gtk_sat_map_layer_view_get_type (void);
+
+GooCanvasItemModel *gtk_sat_map_layer_new           (GtkSatMap *satmap);
+guint               gtk_sat_map_layer_add           (GtkSatMapLayer *layer,
+                                                     sat_map_obj_t *obj,
+                                                     sat_t *sat);
+void                gtk_sat_map_layer_remove        (GtkSatMapLayer *layer,
+                                                     guint slot);
+void                gtk_sat_map_layer_set_sat       (GtkSatMapLayer *layer,
+                                                     guint slot,
+                                                     gfloat x, gfloat y,
+                                                     GooCanvasPoints *p1,
+                                                     GooCanvasPoints *p2);
+gint                gtk_sat_map_layer_pick          (GtkSatMapLayer *layer,
+                                                     gdouble x, gdouble y);
+void                gtk_sat_map_layer_invalidate    (GtkSatMapLayer *layer,
+                                                     gboolean background);
+
+#endif
@@ -45,6 +45,7 @@
 #include "gtk-sat-map-popup.h"
 #include "gtk-sat-data.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 #include "gtk-sat-popup-common.h"
 
 
@@ -209,6 +210,12 @@ coverage_toggled (GtkCheckMenuItem *item, gpointer data)
           covcol = 0x00000000;
      }
 
+     /* the Cairo layer uses the showcov flag directly */
+     if (satmap->cairo) {
+          gtk_sat_map_layer_invalidate (GTK_SAT_MAP_LAYER (satmap->layer), FALSE);
+          return;
+     }
+
      g_object_set (obj->range1,
                       "fill-color-rgba", covcol,
                       NULL);
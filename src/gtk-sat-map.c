@@ -52,13 +52,14 @@
 
 #include "compat.h"
 #include "config-keys.h"
+#include "footprint.h"
 #include "gpredict-utils.h"
 #include "gtk-sat-data.h"
 #include "gtk-sat-map-popup.h"
 #include "gtk-sat-map-ground-track.h"
+#include "gtk-sat-map-layer.h"
 #include "gtk-sat-map.h"
 #include "locator.h"
-#include "map-tools.h"
 #include "mod-cfg-get-param.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
@@ -67,13 +68,12 @@
 #include "sat-info.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
+#include "startup-profile.h"
+#include "terminator.h"
 #include "time-tools.h"
 
 #define MARKER_SIZE_HALF    1
 
-/* Update terminator every 30 seconds */
-#define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
-
 static void     gtk_sat_map_class_init(GtkSatMapClass * class);
 static void     gtk_sat_map_init(GtkSatMap * polview);
 static void     gtk_sat_map_destroy(GtkObject * object);
@@ -82,6 +82,14 @@ static void     size_allocate_cb(GtkWidget * widget,
 static void     update_map_size(GtkSatMap * satmap);
 static void     update_sat(gpointer key, gpointer value, gpointer data);
 static void     plot_sat(gpointer key, gpointer value, gpointer data);
+static void     update_sat_layer(GtkSatMap * satmap, sat_t * sat,
+                                 sat_map_obj_t * obj);
+static void     update_track(GtkSatMap * satmap, sat_t * sat,
+                             sat_map_obj_t * obj);
+static gchar   *sat_tooltip(GtkSatMap * satmap, sat_t * sat);
+static gint     item_catnum(GooCanvasItem * item, gdouble x, gdouble y);
+static void     set_obj_colour(GtkSatMap * satmap, sat_map_obj_t * obj,
+                               guint32 col);
 static void     lonlat_to_xy(GtkSatMap * m, gdouble lon, gdouble lat,
                              gfloat * x, gfloat * y);
 static void     xy_to_lonlat(GtkSatMap * m, gfloat x, gfloat y, gfloat * lon,
@@ -100,8 +108,7 @@ static gboolean on_button_release(GooCanvasItem * item,
 static void     clear_selection(gpointer key, gpointer val, gpointer data);
 static void     load_map_file(GtkSatMap * satmap, float clon);
 static GooCanvasItemModel *create_canvas_model(GtkSatMap * satmap);
-static gdouble  arccos(gdouble, gdouble);
-static gboolean pole_is_covered(sat_t * sat);
+static void     create_layer(GtkSatMap * satmap, GooCanvasItemModel * root);
 static gboolean north_pole_is_covered(sat_t * sat);
 static gboolean south_pole_is_covered(sat_t * sat);
 static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
@@ -112,6 +119,7 @@ static void     sort_points_x(GtkSatMap * satmap, sat_t * sat,
                               GooCanvasPoints * points, gint num);
 static void     sort_points_y(GtkSatMap * satmap, sat_t * sat,
                               GooCanvasPoints * points, gint num);
+static gboolean rotate_points_x(GooCanvasPoints * points, gint num);
 static gint     compare_coordinates_x(gconstpointer a, gconstpointer b,
                                       gpointer data);
 static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
@@ -119,8 +127,9 @@ static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
 static void     update_selected(GtkSatMap * satmap, sat_t * sat);
 static void     draw_grid_lines(GtkSatMap * satmap, GooCanvasItemModel * root);
 static void     redraw_grid_lines(GtkSatMap * satmap);
+static void     redraw_heatmap(GtkSatMap * satmap);
 static void     draw_terminator(GtkSatMap * satmap, GooCanvasItemModel * root);
-static void     redraw_terminator(GtkSatMap * satmap);
+static void     redraw_terminator(GtkSatMap * satmap, gboolean force);
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat);
 static void     gtk_sat_map_load_showtracks(GtkSatMap * map);
 static void     gtk_sat_map_store_showtracks(GtkSatMap * satmap);
@@ -209,15 +218,41 @@ static void gtk_sat_map_init(GtkSatMap * satmap)
     satmap->showgrid = FALSE;
     satmap->keepratio = FALSE;
     satmap->resize = FALSE;
+    satmap->cairo = FALSE;
+    satmap->layer = NULL;
+    satmap->mapimg = NULL;
+    satmap->termpts = NULL;
+    satmap->heatmap = NULL;
+    satmap->heatsrc = NULL;
+    satmap->termlat = 0.0;
+    satmap->termlon = 0.0;
 }
 
 
 /** \brief Destroy a GtkSatMap widget. */
 static void gtk_sat_map_destroy(GtkObject * object)
 {
-    gtk_sat_map_store_showtracks(GTK_SAT_MAP(object));
+    GtkSatMap      *satmap = GTK_SAT_MAP(object);
+
+    gtk_sat_map_store_showtracks(satmap);
+
+    gtk_sat_map_store_hidecovs(satmap);
+
+    /* destroy may be called more than once */
+    map_cache_close(satmap->mapimg);
+    satmap->mapimg = NULL;
+
+    if (satmap->termpts != NULL)
+    {
+        goo_canvas_points_unref(satmap->termpts);
+        satmap->termpts = NULL;
+    }
 
-    gtk_sat_map_store_hidecovs(GTK_SAT_MAP(object));
+    if (satmap->heatsrc != NULL)
+    {
+        g_object_unref(satmap->heatsrc);
+        satmap->heatsrc = NULL;
+    }
 
     (*GTK_OBJECT_CLASS(parent_class)->destroy) (object);
 }
@@ -229,12 +264,13 @@ static void gtk_sat_map_destroy(GtkObject * object)
  *  onto the canvas. Each satellite is then plotted on the map.
  *
  */
-GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
+GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, sat_registry_t * sats,
                                 qth_t * qth)
 {
     GtkSatMap      *satmap;
     GooCanvasItemModel *root;
     guint32         col;
+    gint64          t;
 
     satmap = g_object_new(GTK_TYPE_SAT_MAP, NULL);
 
@@ -275,6 +311,15 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
                                          MOD_CFG_MAP_SECTION,
                                          MOD_CFG_MAP_KEEP_RATIO,
                                          SAT_CFG_BOOL_MAP_KEEP_RATIO);
+
+    /* large modules are drawn with the Cairo layer unless configured */
+    if (g_key_file_has_key(cfgdata, MOD_CFG_MAP_SECTION, MOD_CFG_MAP_CAIRO,
+                           NULL))
+        satmap->cairo = g_key_file_get_boolean(cfgdata, MOD_CFG_MAP_SECTION,
+                                               MOD_CFG_MAP_CAIRO, NULL);
+    else
+        satmap->cairo = (sats->num > SAT_MAP_CAIRO_THRESHOLD);
+
     col = mod_cfg_get_int(cfgdata,
                           MOD_CFG_MAP_SECTION,
                           MOD_CFG_MAP_INFO_BGD_COL,
@@ -292,7 +337,9 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
                                                   MOD_CFG_MAP_CENTER,
                                                   SAT_CFG_INT_MAP_CENTER);
 
+    t = startup_profile_begin();
     load_map_file(satmap, clon);
+    startup_profile_end(t, "load_map_file", NULL);
 
 
     /* Initial size request should be based on map size
@@ -301,12 +348,11 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
        main container window.
      */
     /*  gtk_widget_set_size_request (satmap->canvas, */
-    /*  gdk_pixbuf_get_width (satmap->origmap), */
-    /*  gdk_pixbuf_get_height (satmap->origmap)); */
+    /*  satmap->mapimg->width, */
+    /*  satmap->mapimg->height); */
 
     goo_canvas_set_bounds(GOO_CANVAS(satmap->canvas), 0, 0,
-                          gdk_pixbuf_get_width(satmap->origmap),
-                          gdk_pixbuf_get_height(satmap->origmap));
+                          satmap->mapimg->width, satmap->mapimg->height);
 
 
     /* connect size-request signal */
@@ -320,8 +366,11 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     gtk_widget_show(satmap->canvas);
 
     /* create the canvas model */
+    t = startup_profile_begin();
     root = create_canvas_model(satmap);
     goo_canvas_set_root_item_model(GOO_CANVAS(satmap->canvas), root);
+    startup_profile_end(t, "gtk_sat_map_canvas", "%u satellites%s",
+                        sats->num, satmap->cairo ? " (cairo)" : "");
 
     g_object_unref(root);
 
@@ -331,7 +380,7 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     gtk_sat_map_load_hide_coverages(satmap);
 
     /* plot each sat on the canvas */
-    g_hash_table_foreach(satmap->sats, plot_sat, satmap);
+    sat_registry_foreach(satmap->sats, plot_sat, satmap);
 
     /* gtk_box_pack_start (GTK_BOX (satmap), satmap->swin, TRUE, TRUE, 0); */
     gtk_container_add(GTK_CONTAINER(satmap), satmap->canvas);
@@ -350,6 +399,7 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
 static GooCanvasItemModel *create_canvas_model(GtkSatMap * satmap)
 {
     GooCanvasItemModel *root;
+    GdkPixbuf      *pbuf;
     gchar          *buff;
     gfloat          x, y;
     guint32         col;
@@ -357,15 +407,16 @@ static GooCanvasItemModel *create_canvas_model(GtkSatMap * satmap)
     root = goo_canvas_group_model_new(NULL, NULL);
 
     /* map dimensions */
-    satmap->width = 200;        // was: gdk_pixbuf_get_width (satmap->origmap);
-    satmap->height = 100;       // was: gdk_pixbuf_get_height (satmap->origmap);
+    satmap->width = 200;        // was: satmap->mapimg->width;
+    satmap->height = 100;       // was: satmap->mapimg->height;
     satmap->x0 = 0;
     satmap->y0 = 0;
 
-    /* background map */
-    satmap->map = goo_canvas_image_model_new(root,
-                                             satmap->origmap,
+    /* background map; the real size is set in update_map_size() */
+    pbuf = map_cache_get_scaled(satmap->mapimg, satmap->width, satmap->height);
+    satmap->map = goo_canvas_image_model_new(root, pbuf,
                                              satmap->x0, satmap->y0, NULL);
+    g_object_unref(pbuf);
 
     goo_canvas_item_model_lower(satmap->map, NULL);
 
@@ -465,10 +516,50 @@ static GooCanvasItemModel *create_canvas_model(GtkSatMap * satmap)
                                             "fill-color-rgba", col,
                                             "use-markup", TRUE, NULL);
 
+    if (satmap->cairo)
+        create_layer(satmap, root);
+
     return root;
 }
 
 
+/** \brief Create the Cairo layer for drawing the satellites.
+ *
+ * The layer is put at the bottom of the canvas and draws the map, the grid
+ * lines and the terminator itself, so the corresponding items are hidden.
+ * Grid labels and QTH info remain canvas items.
+ */
+static void create_layer(GtkSatMap * satmap, GooCanvasItemModel * root)
+{
+    guint           i;
+
+    g_object_set(satmap->map, "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+    g_object_set(satmap->terminator,
+                 "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+
+    for (i = 0; i < 5; i++)
+    {
+        g_object_set(satmap->gridh[i],
+                     "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+        if (!satmap->showgrid)
+            g_object_set(satmap->gridhlab[i],
+                         "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+    }
+    for (i = 0; i < 11; i++)
+    {
+        g_object_set(satmap->gridv[i],
+                     "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+        if (!satmap->showgrid)
+            g_object_set(satmap->gridvlab[i],
+                         "visibility", GOO_CANVAS_ITEM_INVISIBLE, NULL);
+    }
+
+    satmap->layer = gtk_sat_map_layer_new(satmap);
+    goo_canvas_item_model_add_child(root, satmap->layer, 0);
+    g_object_unref(satmap->layer);
+}
+
+
 /** \brief Manage new size allocation.
  *
  * This function is called when the canvas receives a new size allocation,
@@ -499,7 +590,7 @@ size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation, gpointer data)
  * If the aspect ratio of the map is to be kept, we must use the following
  * algorithm to calculate the map dimensions:
  *
- *   ratio = origmap.w / origmap.h
+ *   ratio = mapimg.w / mapimg.h
  *   size = min (alloc.w, ratio*alloc.h)
  *   map.w = size
  *   map.h = size / ratio
@@ -525,8 +616,7 @@ static void update_map_size(GtkSatMap * satmap)
             /* Use allocation->width and allocation->height to calculate
              *  new X0 Y0 width and height. Map proportions must be kept.
              */
-            ratio = gdk_pixbuf_get_width(satmap->origmap) /
-                gdk_pixbuf_get_height(satmap->origmap);
+            ratio = satmap->mapimg->width / satmap->mapimg->height;
 
             size = MIN(allocation.width, ratio * allocation.height);
 
@@ -537,10 +627,8 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->y0 = (allocation.height - satmap->height) / 2;
 
             /* rescale pixbuf */
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_cache_get_scaled(satmap->mapimg,
+                                        satmap->width, satmap->height);
         }
         else
         {
@@ -550,10 +638,8 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->height = allocation.height;
 
             /* rescale pixbuf */
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_cache_get_scaled(satmap->mapimg,
+                                        satmap->width, satmap->height);
         }
 
         /* set canvas bounds to match new size */
@@ -571,8 +657,11 @@ static void update_map_size(GtkSatMap * satmap)
         /* grid lines */
         redraw_grid_lines(satmap);
 
+        /* coverage heat map */
+        redraw_heatmap(satmap);
+
         /* Solar terminator. */
-        redraw_terminator(satmap);
+        redraw_terminator(satmap, TRUE);
 
         /* QTH */
         lonlat_to_xy(satmap, satmap->qth->lon, satmap->qth->lat, &x, &y);
@@ -603,7 +692,11 @@ static void update_map_size(GtkSatMap * satmap)
 
 
         /* update satellites */
-        g_hash_table_foreach(satmap->sats, update_sat, satmap);
+        sat_registry_foreach(satmap->sats, update_sat, satmap);
+
+        if (satmap->cairo)
+            gtk_sat_map_layer_invalidate(GTK_SAT_MAP_LAYER(satmap->layer),
+                                         TRUE);
 
         satmap->resize = FALSE;
     }
@@ -639,7 +732,6 @@ void gtk_sat_map_update(GtkWidget * widget)
     sat_t          *sat = NULL;
     gdouble         number, now;
     gchar          *buff;
-    gint           *catnr;
     guint           h, m, s;
     gchar          *ch, *cm, *cs;
     gfloat          x, y;
@@ -699,12 +791,16 @@ void gtk_sat_map_update(GtkWidget * widget)
 
 
         /* update sats */
-        g_hash_table_foreach(satmap->sats, update_sat, satmap);
+        sat_registry_foreach(satmap->sats, update_sat, satmap);
+
+        if (satmap->cairo)
+            gtk_sat_map_layer_invalidate(GTK_SAT_MAP_LAYER(satmap->layer),
+                                         FALSE);
 
         /* Update the Solar Terminator if necessary */
 	if (fabs(satmap->tstamp - satmap->terminator_last_tstamp) > TERMINATOR_UPDATE_INTERVAL) {
 	    satmap->terminator_last_tstamp = satmap->tstamp;
-            redraw_terminator(satmap);
+            redraw_terminator(satmap, FALSE);
 	}
 
         /* update countdown to NEXT AOS label */
@@ -714,10 +810,7 @@ void gtk_sat_map_update(GtkWidget * widget)
             if (satmap->ncat > 0)
             {
 
-                catnr = g_try_new0(gint, 1);
-                *catnr = satmap->ncat;
-                sat = SAT(g_hash_table_lookup(satmap->sats, catnr));
-                g_free(catnr);
+                sat = sat_registry_lookup(satmap->sats, satmap->ncat);
 
                 /* last desperate sanity check */
                 if (sat != NULL)
@@ -862,12 +955,32 @@ on_motion_notify(GooCanvasItem * item,
                  GooCanvasItem * target, GdkEventMotion * event, gpointer data)
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    sat_t          *sat = NULL;
     gfloat          lat, lon;
     gchar          *text;
 
     (void)target;               /* avoid unusued parameter compiler warning */
     (void)item;                 /* avoid unusued parameter compiler warning */
 
+    /* the Cairo layer has only one tooltip for all satellites */
+    if (satmap->cairo)
+    {
+        sat = sat_registry_lookup(satmap->sats,
+                                  gtk_sat_map_layer_pick(GTK_SAT_MAP_LAYER
+                                                         (satmap->layer),
+                                                         event->x, event->y));
+        if (sat != NULL)
+        {
+            text = sat_tooltip(satmap, sat);
+            g_object_set(satmap->layer, "tooltip", text, NULL);
+            g_free(text);
+        }
+        else
+        {
+            g_object_set(satmap->layer, "tooltip", NULL, NULL);
+        }
+    }
+
     /* set text only if QTH info is enabled */
     if (satmap->cursinfo)
     {
@@ -934,11 +1047,8 @@ static          gboolean
 on_button_press(GooCanvasItem * item,
                 GooCanvasItem * target, GdkEventButton * event, gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
+    gint            catnum = item_catnum(item, event->x, event->y);
     sat_t          *sat = NULL;
 
     (void)target;               /* avoid unusued parameter compiler warning */
@@ -950,10 +1060,7 @@ on_button_press(GooCanvasItem * item,
     case 1:
         if (event->type == GDK_2BUTTON_PRESS)
         {
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = catnum;
-
-            sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+            sat = sat_registry_lookup(satmap->sats, catnum);
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(data)));
@@ -964,17 +1071,12 @@ on_button_press(GooCanvasItem * item,
             }
         }
 
-        g_free(catpoint);
-
         break;
 
 
         /* pop-up menu */
     case 3:
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = catnum;
-
-        sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+        sat = sat_registry_lookup(satmap->sats, catnum);
 
         if (sat != NULL)
         {
@@ -987,8 +1089,6 @@ on_button_press(GooCanvasItem * item,
             /* clicked on map -> map pop-up in the future */
         }
 
-        g_free(catpoint);
-
         break;
 
     default:
@@ -1011,24 +1111,18 @@ on_button_release(GooCanvasItem * item,
                   GooCanvasItem * target,
                   GdkEventButton * event, gpointer data)
 {
-    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
-    gint            catnum =
-        GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
-    gint           *catpoint = NULL;
+    gint            catnum = item_catnum(item, event->x, event->y);
     sat_map_obj_t  *obj = NULL;
     guint32         col;
 
     (void)target;               /* avoid unusued parameter compiler warning */
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
     switch (event->button)
     {
         /* Select / de-select satellite */
     case 1:
-        obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catpoint));
+        obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
         if (obj == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1053,32 +1147,21 @@ on_button_release(GooCanvasItem * item,
                                       MOD_CFG_MAP_SECTION,
                                       MOD_CFG_MAP_SAT_COL,
                                       SAT_CFG_INT_MAP_SAT_COL);
-                *catpoint = 0;
+                catnum = 0;
 
                 g_object_set(satmap->sel, "text", "", NULL);
             }
 
-            g_object_set(obj->marker,
-                         "fill-color-rgba", col,
-                         "stroke-color-rgba", col, NULL);
-            g_object_set(obj->label,
-                         "fill-color-rgba", col,
-                         "stroke-color-rgba", col, NULL);
-            g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
-
-            if (obj->oldrcnum == 2)
-                g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+            set_obj_colour(satmap, obj, col);
 
             /* clear other selections */
-            g_hash_table_foreach(satmap->obj, clear_selection, catpoint);
+            g_hash_table_foreach(satmap->obj, clear_selection, &catnum);
         }
         break;
     default:
         break;
     }
 
-    g_free(catpoint);
-
     return TRUE;
 }
 
@@ -1099,6 +1182,10 @@ static void clear_selection(gpointer key, gpointer val, gpointer data)
     {
         obj->selected = FALSE;
 
+        /* the Cairo layer uses the selected flag directly */
+        if (obj->marker == NULL)
+            return;
+
         /** FIXME: this is only global default; need the satmap here! */
         col = sat_cfg_get_int(SAT_CFG_INT_MAP_SAT_COL);
 
@@ -1118,15 +1205,10 @@ static void clear_selection(gpointer key, gpointer val, gpointer data)
 void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
 {
     GtkSatMap      *smap = GTK_SAT_MAP(satmap);
-    gint           *catpoint = NULL;
     sat_map_obj_t  *obj = NULL;
     guint32         col;
 
-
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(smap->obj, catpoint));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(smap->obj, &catnum));
     if (obj == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1142,21 +1224,180 @@ void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
                               MOD_CFG_MAP_SAT_SEL_COL,
                               SAT_CFG_INT_MAP_SAT_SEL_COL);
 
-        g_object_set(obj->marker,
-                     "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
-        g_object_set(obj->label,
-                     "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
-        g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
-
-        if (obj->oldrcnum == 2)
-            g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+        set_obj_colour(smap, obj, col);
 
         /* clear other selections */
-        g_hash_table_foreach(smap->obj, clear_selection, catpoint);
+        g_hash_table_foreach(smap->obj, clear_selection, &catnum);
     }
+}
 
-    g_free(catpoint);
 
+/** \brief Colour of a heat map cell; v is the access time relative to the maximum. */
+static guint32 heat_colour(gfloat v)
+{
+    guint32         r, g, b, a;
+
+    if (v <= 0.0)
+        return 0;
+
+    /* blue - green - yellow - red */
+    v = CLAMP(v, 0.0, 1.0);
+    if (v < 0.5)
+    {
+        r = 0;
+        g = (guint32) (510.0 * v);
+        b = (guint32) (255.0 * (1.0 - 2.0 * v));
+    }
+    else
+    {
+        r = (guint32) (510.0 * (v - 0.5));
+        g = 255 - (guint32) (255.0 * (v - 0.5));
+        b = 0;
+    }
+    a = 0x40 + (guint32) (0x60 * v);
+
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+
+/**
+ * \brief Show a coverage heat map on the map.
+ * \param satmap The GtkSatMap widget.
+ * \param grid Access time of each cell, row by row from 90 deg N with the
+ *             columns starting at -180 deg E; NULL removes the heat map.
+ * \param nlon The number of columns.
+ * \param nlat The number of rows.
+ * \param max The largest value in the grid.
+ *
+ * The grid is converted once to a small pixbuf in map order, taking the
+ * centre longitude of the map into account, and scaled to the map size
+ * whenever the map is resized.
+ */
+void gtk_sat_map_set_heatmap(GtkSatMap * satmap, const gfloat * grid,
+                             guint nlon, guint nlat, gfloat max)
+{
+    GooCanvasItemModel *root;
+    guchar         *pixels, *p;
+    guint32         col;
+    gint            rowstride;
+    guint           i, j, k;
+    gdouble         lon;
+
+    if (satmap->heatsrc != NULL)
+    {
+        g_object_unref(satmap->heatsrc);
+        satmap->heatsrc = NULL;
+    }
+
+    if ((grid != NULL) && (nlon > 0) && (nlat > 0))
+    {
+        satmap->heatsrc = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8,
+                                         nlon, nlat);
+        pixels = gdk_pixbuf_get_pixels(satmap->heatsrc);
+        rowstride = gdk_pixbuf_get_rowstride(satmap->heatsrc);
+
+        for (i = 0; i < nlon; i++)
+        {
+            /* grid column under this column of the map */
+            lon = satmap->left_side_lon + (i + 0.5) * 360.0 / nlon;
+            k = ((guint) floor((lon + 540.0) * nlon / 360.0)) % nlon;
+
+            for (j = 0; j < nlat; j++)
+            {
+                col = heat_colour((max > 0.0) ? grid[j * nlon + k] / max : 0.0);
+                p = pixels + j * rowstride + 4 * i;
+                p[0] = (col >> 24) & 0xFF;
+                p[1] = (col >> 16) & 0xFF;
+                p[2] = (col >> 8) & 0xFF;
+                p[3] = col & 0xFF;
+            }
+        }
+
+        if (satmap->heatmap == NULL)
+        {
+            root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
+            satmap->heatmap = goo_canvas_image_model_new(root, NULL,
+                                                         satmap->x0,
+                                                         satmap->y0, NULL);
+            goo_canvas_item_model_raise(satmap->heatmap, satmap->map);
+
+            /* the Cairo layer paints it with the background */
+            if (satmap->cairo)
+                g_object_set(satmap->heatmap, "visibility",
+                             GOO_CANVAS_ITEM_INVISIBLE, NULL);
+        }
+    }
+
+    redraw_heatmap(satmap);
+}
+
+
+/** \brief Scale the heat map to the map size. */
+static void redraw_heatmap(GtkSatMap * satmap)
+{
+    GdkPixbuf      *pbuf = NULL;
+
+    if (satmap->heatmap == NULL)
+        return;
+
+    if ((satmap->heatsrc != NULL) && (satmap->width > 0) &&
+        (satmap->height > 0))
+        pbuf = gdk_pixbuf_scale_simple(satmap->heatsrc, satmap->width,
+                                       satmap->height, GDK_INTERP_BILINEAR);
+
+    g_object_set(satmap->heatmap,
+                 "pixbuf", pbuf,
+                 "x", (gdouble) satmap->x0, "y", (gdouble) satmap->y0, NULL);
+
+    if (pbuf != NULL)
+        g_object_unref(pbuf);
+
+    if (satmap->cairo)
+        gtk_sat_map_layer_invalidate(GTK_SAT_MAP_LAYER(satmap->layer), TRUE);
+}
+
+
+/** \brief Set the colour of a satellite object.
+ *
+ * With the Cairo renderer the colour follows from the selected flag, so the
+ * layer only needs to be redrawn.
+ */
+static void set_obj_colour(GtkSatMap * satmap, sat_map_obj_t * obj,
+                           guint32 col)
+{
+    if (satmap->cairo)
+    {
+        gtk_sat_map_layer_invalidate(GTK_SAT_MAP_LAYER(satmap->layer), FALSE);
+        return;
+    }
+
+    g_object_set(obj->marker,
+                 "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
+    g_object_set(obj->label,
+                 "fill-color-rgba", col, "stroke-color-rgba", col, NULL);
+    g_object_set(obj->range1, "stroke-color-rgba", col, NULL);
+
+    if (obj->oldrcnum == 2)
+        g_object_set(obj->range2, "stroke-color-rgba", col, NULL);
+}
+
+
+/** \brief Get the catalogue number of the satellite under a canvas item.
+ *  \param item The canvas item that received an event.
+ *  \param x The X coordinate of the event.
+ *  \param y The Y coordinate of the event.
+ *
+ * The Cairo layer is a single item for all satellites, so the satellite
+ * has to be picked using the coordinates.
+ */
+static gint item_catnum(GooCanvasItem * item, gdouble x, gdouble y)
+{
+    GooCanvasItemModel *model = goo_canvas_item_get_model(item);
+
+    if (GTK_IS_SAT_MAP_LAYER(model))
+        return gtk_sat_map_layer_pick(GTK_SAT_MAP_LAYER(model), x, y);
+
+    return GPOINTER_TO_INT(g_object_get_data(G_OBJECT(model), "catnum"));
 }
 
 /** \brief Reconfigure map.
@@ -1177,15 +1418,18 @@ void gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat)
  *  \param clon The longitude that should be the center of the map
  *
  * This function is called shortly after the canvas has been created. Its purpose
- * is to load a mapfile into satmap->origmap.
+ * is to load a mapfile into satmap->mapimg.
  *
- * The function ensures that satmap->origmap will contain a valid GdkPixpuf, by
+ * The function ensures that satmap->mapimg will contain a valid map, by
  * using the following logic:
  *
  *   - Get either module specific or global map file using mod_cfg_get_str
  *   - If the returned file does not exist try sat_cfg_get_str_def
  *   - If loading of default map does not succeed, create a dummy GdkPixbuf
- *     (and raise all possible alarms)
+ *     (and raise all possible alarms); this is done by map_cache_open()
+ *
+ * The map image is shared with other map views using the same file and
+ * centre longitude.
  *
  * \note satmap->cfgdata should contain a valid GKeyFile.
  *
@@ -1194,8 +1438,6 @@ static void load_map_file(GtkSatMap * satmap, float clon)
 {
     gchar          *buff;
     gchar          *mapfile;
-    GError         *error = NULL;
-    GdkPixbuf      *tmpbuf;
 
     /* get local, global or default map file */
     buff = mod_cfg_get_str(satmap->cfgdata,
@@ -1238,30 +1480,7 @@ static void load_map_file(GtkSatMap * satmap, float clon)
                     __FILE__, __LINE__, mapfile);
     }
 
-    /* try to load the map file */
-    tmpbuf = gdk_pixbuf_new_from_file(mapfile, &error);
-
-    if (error != NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Error loading map file (%s)"),
-                    __FILE__, __LINE__, error->message);
-        g_clear_error(&error);
-
-        /* create a dummy GdkPixbuf to avoid crash */
-        tmpbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 400, 200);
-        gdk_pixbuf_fill(tmpbuf, 0x0F0F0F0F);
-    }
-
-    /* create a blank map with same parameters as tmpbuf */
-    satmap->origmap = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
-                                     FALSE,
-                                     gdk_pixbuf_get_bits_per_sample(tmpbuf),
-                                     gdk_pixbuf_get_width(tmpbuf),
-                                     gdk_pixbuf_get_height(tmpbuf));
-
-    map_tools_shift_center(tmpbuf, satmap->origmap, clon);
-    g_object_unref(tmpbuf);
+    satmap->mapimg = map_cache_open(mapfile, clon);
     g_free(mapfile);
 
     /* Calculate longitude at the left side (-180 deg if center is at 0 deg longitude) */
@@ -1274,35 +1493,6 @@ static void load_map_file(GtkSatMap * satmap, float clon)
 }
 
 
-/** \brief Arccosine implementation. 
- *
- * Returns a value between zero and two pi.
- * Borrowed from gsat 0.9 by Xavier Crehueras, EB3CZS.
- * Optimized by Alexandru Csete.
- */
-static          gdouble arccos(gdouble x, gdouble y)
-{
-    if (x && y)
-    {
-        if (y > 0.0)
-            return acos(x / y);
-        else if (y < 0.0)
-            return pi + acos(x / y);
-    }
-
-    return 0.0;
-}
-
-
-/** \brief Check whether the footprint covers the North or South pole. */
-static          gboolean pole_is_covered(sat_t * sat)
-{
-    if (north_pole_is_covered(sat) || south_pole_is_covered(sat))
-        return TRUE;
-    else
-        return FALSE;
-}
-
 /** \brief Check whether the footprint covers the North pole. */
 static          gboolean north_pole_is_covered(sat_t * sat)
 {
@@ -1425,55 +1615,34 @@ mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon, gdouble mapbreak)
  */
 static          guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
 {
+    const footprint_shape_t *shape;
     guint           azi;
     gfloat          sx, sy, msx, msy, ssx, ssy;
-    gdouble         ssplat, ssplon, beta, azimuth, num, dem;
     gdouble         rangelon, rangelat, mlon;
+    gboolean        north, south;
     gboolean        warped = FALSE;
     guint           numrc = 1;
 
-    /* Range circle calculations.
-     * Borrowed from gsat 0.9.0 by Xavier Crehueras, EB3CZS
-     * who borrowed from John Magliacane, KD2BD.
-     * Optimized by Alexandru Csete and William J Beksi.
-     */
-    ssplat = sat->ssplat * de2ra;
-    ssplon = sat->ssplon * de2ra;
-    beta = (0.5 * sat->footprint) / xkmper;
+    /* the shape only depends on the latitude and the size of the footprint,
+       so all we have to do here is to move it to the longitude of the SSP */
+    shape = footprint_get_shape(sat->ssplat, sat->footprint);
+    north = north_pole_is_covered(sat);
+    south = south_pole_is_covered(sat);
 
-    for (azi = 0; azi < 180; azi++)
+    for (azi = 0; azi < FOOTPRINT_POINTS; azi++)
     {
-        azimuth = de2ra * (double)azi;
-        rangelat = asin(sin(ssplat) * cos(beta) + cos(azimuth) *
-                        sin(beta) * cos(ssplat));
-        num = cos(beta) - (sin(ssplat) * sin(rangelat));
-        dem = cos(ssplat) * cos(rangelat);
-
-        if (azi == 0 && north_pole_is_covered(sat))
-            rangelon = ssplon + pi;
-
-        else if (azi == 180 && south_pole_is_covered(sat))
-            rangelon = ssplon + pi;
-
-        else if (fabs(num / dem) > 1.0)
-            rangelon = ssplon;
+        rangelat = shape->lat[azi];
 
+        if (azi == 0 && north)
+            rangelon = sat->ssplon + 180.0;
         else
-        {
-            if ((180.0 - azi) >= 0)
-                rangelon = ssplon - arccos(num, dem);
-            else
-                rangelon = ssplon + arccos(num, dem);
-        }
-
-        while (rangelon < -pi)
-            rangelon += twopi;
+            rangelon = sat->ssplon + shape->dlon[azi];
 
-        while (rangelon > (pi))
-            rangelon -= twopi;
+        while (rangelon < -180.0)
+            rangelon += 360.0;
 
-        rangelat = rangelat / de2ra;
-        rangelon = rangelon / de2ra;
+        while (rangelon > 180.0)
+            rangelon -= 360.0;
 
         /* mirror longitude */
         if (mirror_lon(sat, rangelon, &mlon, satmap->left_side_lon))
@@ -1495,7 +1664,7 @@ static          guint calculate_footprint(GtkSatMap * satmap, sat_t * sat)
      */
 
     /* pole is covered => sort points1 and add additional points */
-    if (pole_is_covered(sat))
+    if (north || south)
     {
 
         sort_points_x(satmap, sat, points1, 360);
@@ -1742,9 +1911,15 @@ sort_points_x(GtkSatMap * satmap, sat_t * sat, GooCanvasPoints * points,
 {
     gsize           size = 2 * sizeof(double);
 
-    /* call g_qsort_with_data, which warps the qsort function
-       from stdlib */
-    g_qsort_with_data(points->coords, num, size, compare_coordinates_x, NULL);
+    /* a range circle around a pole is already ordered by longitude except
+       for the wrap at the map border, so normally a rotation will do */
+    if (!rotate_points_x(points, num))
+    {
+        /* call g_qsort_with_data, which warps the qsort function
+           from stdlib */
+        g_qsort_with_data(points->coords, num, size, compare_coordinates_x,
+                          NULL);
+    }
 
     /* move point at position 0 to position 1 */
     points->coords[2] = satmap->x0;
@@ -1777,6 +1952,65 @@ sort_points_x(GtkSatMap * satmap, sat_t * sat, GooCanvasPoints * points,
 }
 
 
+/** \brief Sort points by X coordinate if they are cyclically ordered.
+ *  \param points The points to sort.
+ *  \param num The number of points.
+ *  \return TRUE if the points have been sorted, FALSE if they were not
+ *          cyclically ordered in either direction.
+ *
+ * The points are sorted by rotating (and if necessary reversing) the array
+ * so that it starts right after the wrap in X.
+ */
+static          gboolean
+rotate_points_x(GooCanvasPoints * points, gint num)
+{
+    gdouble        *tmp;
+    gint            i, j;
+    gint            up = 0, down = 0;
+    gint            iup = 0, idown = 0;
+
+    if (num < 2)
+        return TRUE;
+
+    /* count the direction changes around the ring and remember where
+       the single wrap is */
+    for (i = 0; i < num; i++)
+    {
+        j = (i + 1) % num;
+        if (points->coords[2 * j] > points->coords[2 * i])
+        {
+            up++;
+            iup = i;
+        }
+        else if (points->coords[2 * j] < points->coords[2 * i])
+        {
+            down++;
+            idown = j;
+        }
+    }
+
+    if (up != 1 && down != 1)
+        return FALSE;
+
+    tmp = g_new(gdouble, 2 * num);
+    for (i = 0; i < num; i++)
+    {
+        /* ascending after the only drop, or backwards from the only rise */
+        if (down == 1)
+            j = (idown + i) % num;
+        else
+            j = (iup - i + num) % num;
+
+        tmp[2 * i] = points->coords[2 * j];
+        tmp[2 * i + 1] = points->coords[2 * j + 1];
+    }
+    memcpy(points->coords, tmp, 2 * num * sizeof(gdouble));
+    g_free(tmp);
+
+    return TRUE;
+}
+
+
 /** \brief Sort points according to Y coordinates.
  *  \param satmap The GtkSatMap structure.
  *  \param sat The satellite data structure.
@@ -1949,6 +2183,23 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->track_data.lines = NULL;
     obj->track_orbit = 0;
 
+    /* the Cairo layer only needs a slot for the satellite */
+    if (satmap->cairo)
+    {
+        obj->marker = NULL;
+        obj->shadowm = NULL;
+        obj->label = NULL;
+        obj->shadowl = NULL;
+        obj->range1 = NULL;
+        obj->range2 = NULL;
+
+        gtk_sat_map_layer_add(GTK_SAT_MAP_LAYER(satmap->layer), obj, sat);
+        update_sat_layer(satmap, sat, obj);
+
+        g_hash_table_insert(satmap->obj, catnum, obj);
+        return;
+    }
+
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
     /* satellite color */
@@ -2091,7 +2342,7 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
  */
 static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    gint           *catnum;
+    gint            catnum;
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
     sat_t          *sat = SAT(value);
@@ -2102,14 +2353,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     gint            idx;
     guint32         col, covcol;
     gchar          *tooltip;
-    gchar          *aosstr;
 
     //gdouble sspla,ssplo;
 
     root = goo_canvas_get_root_item_model(GOO_CANVAS(satmap->canvas));
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
+    catnum = sat->tle.catnr;
 
     now = satmap->tstamp;
 
@@ -2123,10 +2372,20 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
 
     /* get rid of a decayed satellite */
-    if (decayed(sat) && obj != NULL)
+    if (decayed(sat) && obj != NULL && satmap->cairo)
+    {
+        gtk_sat_map_layer_remove(GTK_SAT_MAP_LAYER(satmap->layer),
+                                 obj->layer_slot);
+        if (obj->showtrack)
+            ground_track_update(satmap, sat, satmap->qth, obj, TRUE);
+        g_hash_table_remove(satmap->obj, &catnum);
+        g_free(obj);
+        return;
+    }
+    else if (decayed(sat) && obj != NULL)
     {
         /* remove items */
         idx = goo_canvas_item_model_find_child(root, obj->marker);
@@ -2147,12 +2406,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         idx = goo_canvas_item_model_find_child(root, obj->range2);
         if (idx != -1)
             goo_canvas_item_model_remove_child(root, idx);
-        g_hash_table_remove(satmap->obj, catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         if (obj->showtrack)
             ground_track_update(satmap, sat, satmap->qth, obj, TRUE);
         g_free(obj);
         /* remove obj from hash */
-        g_hash_table_remove(satmap->obj, catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         return;
     }
 
@@ -2177,6 +2436,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         update_selected(satmap, sat);
     }
 
+    if (satmap->cairo)
+    {
+        update_sat_layer(satmap, sat, obj);
+        update_track(satmap, sat, obj);
+        return;
+    }
+
     //sat_debugger_get_ssp (&ssplo,&sspla);
     //sat->ssplon = ssplo;
     //sat->ssplat = sspla;
@@ -2186,20 +2452,10 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     g_object_set(obj->shadowl, "text", sat->nickname, NULL);
 
     /* we update tooltips every time */
-    aosstr = aoslos_time_to_str(satmap, sat);
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260\n"
-                                      "%s",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el, aosstr);
+    tooltip = sat_tooltip(satmap, sat);
     g_object_set(obj->marker, "tooltip", tooltip, NULL);
     g_object_set(obj->label, "tooltip", tooltip, NULL);
     g_free(tooltip);
-    g_free(aosstr);
 
     lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
 
@@ -2317,7 +2573,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                                                             CAIRO_LINE_JOIN_MITER,
                                                             NULL);
                 g_object_set_data(G_OBJECT(obj->range2), "catnum",
-                                  GINT_TO_POINTER(*catnum));
+                                  GINT_TO_POINTER(catnum));
             }
             else
             {
@@ -2345,6 +2601,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         goo_canvas_points_unref(points2);
     }
 
+    update_track(satmap, sat, obj);
+}
+
+
+/** \brief Update the ground track of a satellite if necessary. */
+static void update_track(GtkSatMap * satmap, sat_t * sat, sat_map_obj_t * obj)
+{
     /* if ground track is visible check whether we have passed into a
        new orbit, in which case we need to recalculate the ground track
      */
@@ -2360,8 +2623,62 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             ground_track_update(satmap, sat, satmap->qth, obj, FALSE);
         }
     }
+}
+
+
+/** \brief Update a satellite in the Cairo layer.
+ *
+ * Like the canvas items, the position and footprint are only updated when
+ * the satellite has moved at least 2 * MARKER_SIZE_HALF or the map has been
+ * resized.
+ */
+static void update_sat_layer(GtkSatMap * satmap, sat_t * sat,
+                             sat_map_obj_t * obj)
+{
+    GtkSatMapLayer *layer = GTK_SAT_MAP_LAYER(satmap->layer);
+    gfloat          x, y;
+    guint           rcnum;
+
+    lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
+
+    if (!satmap->resize &&
+        (fabs(layer->x[obj->layer_slot] - x) < 2 * MARKER_SIZE_HALF) &&
+        (fabs(layer->y[obj->layer_slot] - y) < 2 * MARKER_SIZE_HALF))
+        return;
+
+    points1 = goo_canvas_points_new(360);
+    points2 = goo_canvas_points_new(360);
+
+    rcnum = calculate_footprint(satmap, sat);
+    gtk_sat_map_layer_set_sat(layer, obj->layer_slot, x, y,
+                              points1, rcnum == 2 ? points2 : NULL);
+    obj->newrcnum = rcnum;
+    obj->oldrcnum = rcnum;
+
+    goo_canvas_points_unref(points1);
+    goo_canvas_points_unref(points2);
+}
+
+
+/** \brief Create the tooltip text for a satellite. */
+static gchar   *sat_tooltip(GtkSatMap * satmap, sat_t * sat)
+{
+    gchar          *aosstr;
+    gchar          *tooltip;
+
+    aosstr = aoslos_time_to_str(satmap, sat);
+    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
+                                      "Lon: %5.1f\302\260\n"
+                                      "Lat: %5.1f\302\260\n"
+                                      " Az: %5.1f\302\260\n"
+                                      " El: %5.1f\302\260\n"
+                                      "%s",
+                                      sat->nickname,
+                                      sat->ssplon, sat->ssplat,
+                                      sat->az, sat->el, aosstr);
+    g_free(aosstr);
 
-    g_free(catnum);
+    return tooltip;
 }
 
 
@@ -2664,7 +2981,9 @@ static void draw_terminator(GtkSatMap * satmap, GooCanvasItemModel * root)
                                        SAT_CFG_INT_MAP_GLOBAL_SHADOW_COL);
 
     /* We do not set any polygon vertices here, but trust that the redraw_terminator
-       will be called in due course to do the job. */
+       will be called in due course to do the job. The points are allocated once
+       and reused on every redraw. */
+    satmap->termpts = goo_canvas_points_new(TERMINATOR_POINTS + 2);
 
     satmap->terminator = goo_canvas_polyline_model_new(root, FALSE, 0,
                                                        "line-width", 1.0,
@@ -2759,88 +3078,69 @@ static void redraw_grid_lines(GtkSatMap * satmap)
 
 
 
-static inline gdouble sgn(gdouble const t)
-{
-    return t < 0.0 ? -1.0 : 1.0;
-}
-
-
-
-/** \brief Redraw solar terminator. */
-static void redraw_terminator(GtkSatMap * satmap)
+/** \brief Redraw solar terminator.
+ *  \param satmap The GtkSatMap widget.
+ *  \param force Redraw even if the subsolar point has not moved.
+ *
+ * The terminator is taken from the shared table (see terminator.c) and is
+ * only redrawn when the subsolar point has moved by at least one pixel. The
+ * polygon runs from the left to the right edge of the map and is closed
+ * through the pole in darkness, so it is filled with the night shade.
+ */
+static void redraw_terminator(GtkSatMap * satmap, gboolean force)
 {
-    /* Set of (x, y) points along the terminator, one on each line of longitude in
-       increments of longitudinal degrees. */
-    GooCanvasPoints *line;
-
-    /* A variable which iterates over the longitudes. */
-    int             longitude;
-
-    /* Working variables in the computation of the terminator coordinates. */
-    gfloat          x, y;
-
-    /* Vector normal to plane containing a line of longitude (z component is
-       always zero). */
-    /* Note: our coordinates have z along the Earth's axis, x pointing through the
-       intersection of the Greenwich Meridian and the Equator, and y right-handedly
-       perpendicular to both. */
-    gdouble         lx, ly;
-
-    /* The position of the sun as latitude, longitude. */
-    geodetic_t      geodetic;
-
-    /* Vector which points from the centre of the Earth to the Sun in inertial
-       coordinates. */
-    vector_t        sun_;
-
-    /* The same vector in geodesic coordinates. */
-    gdouble         sx, sy, sz;
-
-    /* Vector cross-product of (lx,ly,lz) and sun vector. */
-    gdouble         rx, ry, rz;
+    const terminator_t *term;
+    GooCanvasPoints *line = satmap->termpts;
+    gdouble         dlon, dlat, xstep, ynight;
+    gdouble         pos, frac, lat;
+    gint            i, idx;
 
+    term = terminator_get(satmap->tstamp);
 
+    if (!force)
+    {
+        dlon = fabs(term->sunlon - satmap->termlon);
+        if (dlon > 180.0)
+            dlon = 360.0 - dlon;
+        dlat = fabs(term->sunlat - satmap->termlat);
 
-    line = goo_canvas_points_new(363);
-
-    Calculate_Solar_Position(satmap->tstamp, &sun_);
-    Calculate_LatLonAlt(satmap->tstamp, &sun_, &geodetic);
+        if ((dlon * satmap->width / 360.0 < 1.0) &&
+            (dlat * satmap->height / 180.0 < 1.0))
+            return;
+    }
 
-    sx = cos(geodetic.lat) * cos(geodetic.lon);
-    sy = cos(geodetic.lat) * sin(-geodetic.lon);
-    sz = sin(geodetic.lat);
+    satmap->termlon = term->sunlon;
+    satmap->termlat = term->sunlat;
 
+    xstep = satmap->width / 360.0;
 
-    for (longitude = -180; longitude <= 180; ++longitude)
+    for (i = 0; i < TERMINATOR_POINTS; i++)
     {
+        /* map longitude at this x, wrapped into the table; the centre
+           need not be a whole degree so interpolate between columns */
+        pos = satmap->left_side_lon + i + 180.0;
+        idx = (gint) floor(pos);
+        frac = pos - idx;
+        idx = ((idx % 360) + 360) % 360;
 
-        lx = cos(de2ra * (longitude + sgn(sz) * 90));
-        ly = sin(de2ra * (longitude + sgn(sz) * 90));
-        /* lz = 0.0; */
-
-        rx = ly * sz /* -lz*sy */ ;
-        ry = /* lz*sx */ -lx * sz;
-        rz = -lx * sy - ly * sx;
+        /* lat[360] is lat[0] again, so idx + 1 is always valid */
+        lat = term->lat[idx] + frac * (term->lat[idx + 1] - term->lat[idx]);
 
-        gdouble         length = sqrt(rx * rx + ry * ry + rz * rz);
-
-        lonlat_to_xy(satmap,
-                     longitude, asin(rz / length) * (1.0 / de2ra), &x, &y);
-
-        line->coords[2 * (longitude + 181)] = x;
-        line->coords[2 * (longitude + 181) + 1] = y;
+        line->coords[2 * (i + 1)] = satmap->x0 + i * xstep;
+        line->coords[2 * (i + 1) + 1] = satmap->y0 +
+            (90.0 - lat) * satmap->height / 180.0;
     }
 
-    lonlat_to_xy(satmap, -180.0, sz < 0.0 ? 90.0 : -90.0, &x, &y);
-    line->coords[0] = x;
-    line->coords[1] = y;
-
-    lonlat_to_xy(satmap, 180.0, sz < 0.0 ? 90.0 : -90.0, &x, &y);
-    line->coords[724] = x;
-    line->coords[725] = y;
+    ynight = satmap->y0 + (90.0 - term->nightlat) * satmap->height / 180.0;
+    line->coords[0] = satmap->x0;
+    line->coords[1] = ynight;
+    line->coords[2 * (TERMINATOR_POINTS + 1)] = satmap->x0 + satmap->width;
+    line->coords[2 * (TERMINATOR_POINTS + 1) + 1] = ynight;
 
     g_object_set(satmap->terminator, "points", line, NULL);
-    goo_canvas_points_unref(line);
+
+    if (satmap->cairo)
+        gtk_sat_map_layer_invalidate(GTK_SAT_MAP_LAYER(satmap->layer), TRUE);
 }
 
 
@@ -2862,7 +3162,7 @@ void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
 
 
 /** \brief Reload reference to satellites (e.g. after TLE update). */
-void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
+void gtk_sat_map_reload_sats(GtkWidget * satmap, sat_registry_t * sats)
 {
     GTK_SAT_MAP(satmap)->sats = sats;
     GTK_SAT_MAP(satmap)->naos = 0.0;
@@ -35,6 +35,8 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
+#include "map-cache.h"
+#include "sat-registry.h"
 #include <goocanvas.h>
 
 
@@ -44,6 +46,7 @@ extern "C" {
 
 
 #define SAT_MAP_RANGE_CIRCLE_POINTS    180  /*!< Number of points used to plot a satellite range half circle. */
+#define SAT_MAP_CAIRO_THRESHOLD        500  /*!< Use the Cairo renderer by default above this number of satellites. */
 
 
 #define GTK_SAT_MAP(obj)          G_TYPE_CHECK_INSTANCE_CAST (obj, gtk_sat_map_get_type (), GtkSatMap)
@@ -102,6 +105,7 @@ typedef struct {
     
     ground_track_t  track_data;   /*!< Ground track data. */
     long   track_orbit;  /*!< Orbit when the ground track has been updated. */
+    guint           layer_slot;   /*!< Slot in the Cairo layer (Cairo renderer only). */
     
 } sat_map_obj_t;
     
@@ -116,6 +120,8 @@ typedef struct {
     GtkWidget  *canvas;                 /*!< The canvas widget. */
     
     GooCanvasItemModel *map;            /*!< The canvas map item. */
+    GooCanvasItemModel *heatmap;        /*!< Coverage heat map, NULL if not shown. */
+    GdkPixbuf          *heatsrc;        /*!< Heat map at grid resolution in map order. */
     
     gdouble             left_side_lon;  /*!< Left-most longitude (used when center is not 0 lon). */
     
@@ -133,6 +139,12 @@ typedef struct {
     GooCanvasItemModel *gridhlab[5];    /*!< Horizontal grid labels. */
 
     GooCanvasItemModel *terminator;     /*!< Outline of sun shadow on Earth. */
+    GooCanvasPoints    *termpts;        /*!< Points of the terminator, reused on each redraw. */
+    gdouble             termlat;        /*!< Subsolar latitude of the last terminator drawn. */
+    gdouble             termlon;        /*!< Subsolar longitude of the last terminator drawn. */
+
+    gboolean            cairo;          /*!< Draw the satellites with the Cairo layer instead of canvas items. */
+    GooCanvasItemModel *layer;          /*!< The Cairo layer, NULL if not used. */
 
     gdouble terminator_last_tstamp;        /*!< Timestamp of the last terminator drawn. Used to prevent redrawing the terminator too often. */
     
@@ -142,7 +154,7 @@ typedef struct {
     gdouble     tstamp;                 /*!< Time stamp for calculations; set by GtkSatModule */
     
     GKeyFile   *cfgdata;                /*!< Module configuration data. */
-    GHashTable *sats;                   /*!< Pointer to satellites (owned by parent GtkSatModule). */
+    sat_registry_t *sats;               /*!< Pointer to satellites (owned by parent GtkSatModule). */
     qth_t      *qth;                    /*!< Pointer to current location. */
     
     GHashTable *obj;                    /*!< Canvas items representing each satellite. */
@@ -166,7 +178,7 @@ typedef struct {
     
     gchar      *infobgd;                /*!< Background color of info text. */
     
-    GdkPixbuf  *origmap;                /*!< Original map kept here for high quality scaling. */
+    map_image_t *mapimg;                /*!< Shared map image used for scaling. */
     
 } GtkSatMap;
     
@@ -179,7 +191,7 @@ struct _GtkSatMapClass
 
 GType          gtk_sat_map_get_type (void);
 GtkWidget*     gtk_sat_map_new      (GKeyFile   *cfgdata,
-                                     GHashTable *sats,
+                                     sat_registry_t *sats,
                                      qth_t      *qth);
 void           gtk_sat_map_update   (GtkWidget  *widget);
 void           gtk_sat_map_reconf   (GtkWidget  *widget, GKeyFile *cfgdat);
@@ -188,8 +200,10 @@ void           gtk_sat_map_lonlat_to_xy (GtkSatMap *m,
                                          gdouble lon, gdouble lat,
                                          gdouble *x, gdouble *y);
 
-void gtk_sat_map_reload_sats (GtkWidget *satmap, GHashTable *sats);
+void gtk_sat_map_reload_sats (GtkWidget *satmap, sat_registry_t *sats);
 void gtk_sat_map_select_sat  (GtkWidget *satmap, gint catnum);
+void gtk_sat_map_set_heatmap (GtkSatMap *satmap, const gfloat *grid,
+                              guint nlon, guint nlat, gfloat max);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,353 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file gtk-sat-module-conjunction.c
+ * \brief Conjunction screening of the satellites in a module.
+ *
+ * The satellites of the module are screened against each other or against
+ * all satellites in the local TLE database. The screening runs in a
+ * separate thread and the closest approaches are shown when it is done.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <string.h>
+#include "compat.h"
+#include "conjunction.h"
+#include "gtk-sat-data.h"
+#include "gtk-sat-module.h"
+#include "gtk-sat-module-conjunction.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+
+/** \brief Number of conjunctions listed in the result dialog. */
+#define CONJUNCTION_SHOW 10
+
+
+/** \brief A conjunction screening running for a module. */
+typedef struct {
+    GtkSatModule   *module;     /*!< The module; NULL if it has been closed */
+    conjunction_t  *cj;         /*!< The screening */
+    gchar          *csvfile;    /*!< Output file, or NULL */
+    gboolean        catalogue;  /*!< Also screen the rest of the TLE database */
+    gboolean        ok;         /*!< The screening was completed */
+} conjunction_job_t;
+
+
+/**
+ * \brief Add the satellites in the TLE database that are not screened yet.
+ * \return The number of satellites added.
+ *
+ * Reading the whole database takes a while, so this runs in the screening
+ * thread.
+ */
+static guint add_catalogue(conjunction_t * cj)
+{
+    GDir           *dir;
+    const gchar    *fname;
+    gchar          *dirname;
+    GHashTable     *known;
+    sat_t           sat;
+    gint            catnum;
+    guint           i;
+    guint           n = 0;
+
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open satdata directory %s"),
+                    __func__, dirname);
+        g_free(dirname);
+        return 0;
+    }
+
+    /* the satellites of the module are already there */
+    known = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (i = 0; i < cj->sats->len; i++)
+    {
+        catnum = ((sat_t *) g_ptr_array_index(cj->sats, i))->tle.catnr;
+        g_hash_table_insert(known, GINT_TO_POINTER(catnum),
+                            GINT_TO_POINTER(1));
+    }
+
+    while ((fname = g_dir_read_name(dir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        catnum = (gint) g_ascii_strtoll(fname, NULL, 10);
+        if (g_hash_table_lookup(known, GINT_TO_POINTER(catnum)) != NULL)
+            continue;
+
+        memset(&sat, 0, sizeof(sat_t));
+        if (!gtk_sat_data_read_sat(catnum, &sat))
+        {
+            conjunction_add_sat(cj, &sat, FALSE);
+            n++;
+        }
+        g_free(sat.name);
+        g_free(sat.nickname);
+        g_free(sat.website);
+    }
+
+    g_hash_table_destroy(known);
+    g_dir_close(dir);
+    g_free(dirname);
+
+    return n;
+}
+
+
+/** \brief Show the results; runs in the main loop when the screening is done. */
+static gboolean conjunction_done(gpointer data)
+{
+    conjunction_job_t *job = data;
+    conjunction_t  *cj = job->cj;
+    conjunction_event_t *ev;
+    conjunction_event_t **closest;
+    GtkWidget      *dialog;
+    GtkWindow      *parent = NULL;
+    GString        *text;
+    gchar           tbuf[TIME_FORMAT_MAX_LENGTH];
+    guint           i, j, n;
+
+    if (job->module != NULL)
+    {
+        g_object_remove_weak_pointer(G_OBJECT(job->module),
+                                     (gpointer *) & job->module);
+        parent = GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(job->module)));
+    }
+
+    if (!job->ok)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Conjunction screening failed"), __func__);
+        conjunction_free(cj);
+        g_free(job->csvfile);
+        g_free(job);
+        return FALSE;
+    }
+
+    /* the closest approaches, by miss distance */
+    n = MIN(cj->events->len, CONJUNCTION_SHOW);
+    closest = g_new0(conjunction_event_t *, n + 1);
+    for (i = 0; i < cj->events->len; i++)
+    {
+        ev = &g_array_index(cj->events, conjunction_event_t, i);
+        for (j = MIN(i, n); (j > 0) && (closest[j - 1]->miss > ev->miss); j--)
+            closest[j] = closest[j - 1];
+        if (j < n)
+            closest[j] = ev;
+    }
+
+    text = g_string_new(NULL);
+    g_string_printf(text, _("%d conjunctions closer than %.1f km "
+                            "(%d candidate pairs)."),
+                    cj->events->len, cj->threshold, cj->candidates);
+    for (i = 0; i < n; i++)
+    {
+        ev = closest[i];
+        daynum_to_str(tbuf, TIME_FORMAT_MAX_LENGTH, "%Y/%m/%d %H:%M:%S",
+                      ev->tca);
+        g_string_append_printf(text, "\n%s  %s - %s  %.3f km  %.2f km/s",
+                               tbuf, ev->name1, ev->name2, ev->miss,
+                               ev->relvel);
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %s %d - %d miss %.3f km, %.2f km/s"),
+                    __func__, tbuf, ev->catnr1, ev->catnr2, ev->miss,
+                    ev->relvel);
+    }
+    if (job->csvfile != NULL)
+        g_string_append_printf(text, _("\n\nAll conjunctions were saved to %s"),
+                               job->csvfile);
+
+    dialog = gtk_message_dialog_new(parent, GTK_DIALOG_DESTROY_WITH_PARENT,
+                                    GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+                                    "%s", text->str);
+    gtk_window_set_title(GTK_WINDOW(dialog), _("Conjunction Screening"));
+    g_signal_connect_swapped(dialog, "response",
+                             G_CALLBACK(gtk_widget_destroy), dialog);
+    gtk_widget_show_all(dialog);
+
+    g_string_free(text, TRUE);
+    g_free(closest);
+    conjunction_free(cj);
+    g_free(job->csvfile);
+    g_free(job);
+
+    return FALSE;
+}
+
+
+/** \brief Thread running the screening. */
+static gpointer conjunction_thread(gpointer data)
+{
+    conjunction_job_t *job = data;
+
+    if (job->catalogue)
+        add_catalogue(job->cj);
+
+    job->ok = conjunction_run(job->cj, job->csvfile);
+    g_idle_add(conjunction_done, job);
+
+    return NULL;
+}
+
+
+/**
+ * \brief Start a conjunction screening.
+ * \param mod The module.
+ *
+ * Asks for the time window, the miss distance and the output file and
+ * starts the screening in the background.
+ */
+void conjunction_create(GtkSatModule * mod)
+{
+    GtkWidget      *dialog;
+    GtkWidget      *table;
+    GtkWidget      *label;
+    GtkWidget      *days;
+    GtkWidget      *dist;
+    GtkWidget      *catalogue;
+    GtkWidget      *file;
+    conjunction_job_t *job;
+    gboolean        all;
+    gdouble         start;
+    guint           i;
+    GThread        *thread;
+    GError         *err = NULL;
+
+    dialog = gtk_dialog_new_with_buttons(_("Conjunction Screening"),
+                                         GTK_WINDOW(gtk_widget_get_toplevel
+                                                    (GTK_WIDGET(mod))),
+                                         GTK_DIALOG_MODAL |
+                                         GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+                                         GTK_STOCK_EXECUTE, GTK_RESPONSE_OK,
+                                         NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_OK);
+
+    table = gtk_table_new(4, 2, FALSE);
+    gtk_table_set_col_spacings(GTK_TABLE(table), 10);
+    gtk_table_set_row_spacings(GTK_TABLE(table), 10);
+    gtk_container_set_border_width(GTK_CONTAINER(table), 10);
+
+    /* time window */
+    label = gtk_label_new(_("Time window [days]:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 0, 1);
+    days = gtk_spin_button_new_with_range(1, 14, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(days), 7);
+    gtk_table_attach_defaults(GTK_TABLE(table), days, 1, 2, 0, 1);
+
+    /* miss distance */
+    label = gtk_label_new(_("Miss distance [km]:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 1, 2);
+    dist = gtk_spin_button_new_with_range(0.1, 100.0, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(dist), 5.0);
+    gtk_table_attach_defaults(GTK_TABLE(table), dist, 1, 2, 1, 2);
+
+    /* catalogue */
+    catalogue = gtk_check_button_new_with_label(_("Screen against all "
+                                                  "satellites in the "
+                                                  "database"));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(catalogue), TRUE);
+    gtk_widget_set_tooltip_text(catalogue,
+                                _("If checked, the satellites of the module "
+                                  "are screened against all satellites in "
+                                  "the TLE database. Otherwise only against "
+                                  "each other."));
+    gtk_table_attach_defaults(GTK_TABLE(table), catalogue, 0, 2, 2, 3);
+
+    /* output file */
+    label = gtk_label_new(_("Save results as:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 3, 4);
+    file = gtk_file_chooser_button_new(_("Select a file"),
+                                       GTK_FILE_CHOOSER_ACTION_SAVE);
+    gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(file),
+                                        g_get_home_dir());
+    gtk_widget_set_tooltip_text(file,
+                                _("CSV file with all conjunctions. "
+                                  "Leave empty to only show the closest."));
+    gtk_table_attach_defaults(GTK_TABLE(table), file, 1, 2, 3, 4);
+
+    gtk_widget_show_all(table);
+    gtk_container_add(GTK_CONTAINER
+                      (gtk_dialog_get_content_area(GTK_DIALOG(dialog))),
+                      table);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) != GTK_RESPONSE_OK)
+    {
+        gtk_widget_destroy(dialog);
+        return;
+    }
+
+    /* the screening starts at the time shown by the module */
+    start = mod->tmgCdnum;
+    job = g_new0(conjunction_job_t, 1);
+    job->cj = conjunction_new(start,
+                              start +
+                              gtk_spin_button_get_value(GTK_SPIN_BUTTON(days)),
+                              gtk_spin_button_get_value(GTK_SPIN_BUTTON(dist)));
+    job->csvfile = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file));
+    all = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(catalogue));
+    gtk_widget_destroy(dialog);
+
+    g_mutex_lock(&mod->busy);
+    for (i = 0; i < mod->satellites->num; i++)
+        conjunction_add_sat(job->cj, sat_registry_nth(mod->satellites, i),
+                            all);
+    g_mutex_unlock(&mod->busy);
+
+    job->catalogue = all;
+
+    job->module = mod;
+    g_object_add_weak_pointer(G_OBJECT(mod), (gpointer *) & job->module);
+
+    thread = g_thread_try_new("gpredict_conjunction", conjunction_thread, job, &err);
+    if (thread == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create conjunction thread (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        job->ok = FALSE;
+        conjunction_done(job);
+        return;
+    }
+
+    g_thread_unref(thread);
+}
@@ -0,0 +1,286 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file gtk-sat-module-coverage.c
+ * \brief Coverage analysis of the satellites in a module.
+ *
+ * The analysis uses the satellites of the module and all ground stations
+ * configured by the user. It runs in a separate thread; when it is done,
+ * the access time of each grid cell is shown as a heat map on the map
+ * views of the module.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include "compat.h"
+#include "coverage.h"
+#include "gtk-sat-map.h"
+#include "gtk-sat-module.h"
+#include "gtk-sat-module-coverage.h"
+#include "qth-data.h"
+#include "sat-log.h"
+
+
+/** \brief A coverage analysis running for a module. */
+typedef struct {
+    GtkSatModule   *module;     /*!< The module; NULL if it has been closed */
+    coverage_t     *cov;        /*!< The analysis */
+    gchar          *csvfile;    /*!< Output file, or NULL */
+    gboolean        ok;         /*!< The analysis was completed */
+} coverage_job_t;
+
+
+/** \brief Add all ground stations in the user configuration directory. */
+static guint add_stations(coverage_t * cov)
+{
+    GDir           *dir;
+    const gchar    *fname;
+    gchar          *dirname, *path;
+    qth_t          *qth;
+    guint           n = 0;
+
+    dirname = get_user_conf_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open user cfg dir %s"),
+                    __func__, dirname);
+        g_free(dirname);
+        return 0;
+    }
+
+    while ((fname = g_dir_read_name(dir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".qth"))
+            continue;
+
+        path = g_strconcat(dirname, G_DIR_SEPARATOR_S, fname, NULL);
+        qth = g_new0(qth_t, 1);
+        if (qth_data_read(path, qth))
+        {
+            coverage_add_station(cov, qth);
+            n++;
+        }
+        qth_data_free(qth);
+        g_free(path);
+    }
+
+    g_dir_close(dir);
+    g_free(dirname);
+
+    return n;
+}
+
+
+/** \brief Show the results; runs in the main loop when the analysis is done. */
+static gboolean coverage_done(gpointer data)
+{
+    coverage_job_t *job = data;
+    coverage_t     *cov = job->cov;
+    coverage_station_t *st;
+    GSList         *views;
+    guint           i;
+
+    if (job->module != NULL)
+    {
+        g_object_remove_weak_pointer(G_OBJECT(job->module),
+                                     (gpointer *) & job->module);
+
+        if (job->ok)
+            for (views = job->module->views; views != NULL;
+                 views = views->next)
+                if (IS_GTK_SAT_MAP(views->data))
+                    gtk_sat_map_set_heatmap(GTK_SAT_MAP(views->data),
+                                            cov->grid, cov->nlon, cov->nlat,
+                                            cov->gridmax);
+    }
+
+    if (job->ok)
+    {
+        for (i = 0; i < cov->qths->len; i++)
+        {
+            st = &cov->sta[i];
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: %s: %d passes, covered %.1f min, "
+                          "max gap %.1f min, mean gap %.1f min"),
+                        __func__, st->name, st->passes, st->covered,
+                        st->maxgap, st->meangap);
+        }
+        if (job->csvfile != NULL)
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Coverage results written to %s"),
+                        __func__, job->csvfile);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Coverage analysis failed"), __func__);
+    }
+
+    coverage_free(cov);
+    g_free(job->csvfile);
+    g_free(job);
+
+    return FALSE;
+}
+
+
+/** \brief Thread running the analysis. */
+static gpointer coverage_thread(gpointer data)
+{
+    coverage_job_t *job = data;
+
+    job->ok = coverage_run(job->cov, job->csvfile);
+    g_idle_add(coverage_done, job);
+
+    return NULL;
+}
+
+
+/**
+ * \brief Start a coverage analysis.
+ * \param mod The module.
+ *
+ * Asks for the time window, grid size and output file and starts the
+ * analysis in the background.
+ */
+void coverage_create(GtkSatModule * mod)
+{
+    GtkWidget      *dialog;
+    GtkWidget      *table;
+    GtkWidget      *label;
+    GtkWidget      *hours;
+    GtkWidget      *step;
+    GtkWidget      *file;
+    coverage_job_t *job;
+    gdouble         start;
+    guint           i;
+    GThread        *thread;
+    GError         *err = NULL;
+
+    dialog = gtk_dialog_new_with_buttons(_("Coverage Analysis"),
+                                         GTK_WINDOW(gtk_widget_get_toplevel
+                                                    (GTK_WIDGET(mod))),
+                                         GTK_DIALOG_MODAL |
+                                         GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+                                         GTK_STOCK_EXECUTE, GTK_RESPONSE_OK,
+                                         NULL);
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_OK);
+
+    table = gtk_table_new(3, 2, FALSE);
+    gtk_table_set_col_spacings(GTK_TABLE(table), 10);
+    gtk_table_set_row_spacings(GTK_TABLE(table), 10);
+    gtk_container_set_border_width(GTK_CONTAINER(table), 10);
+
+    /* time window */
+    label = gtk_label_new(_("Time window [hours]:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 0, 1);
+    hours = gtk_spin_button_new_with_range(1, 720, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(hours), 24);
+    gtk_table_attach_defaults(GTK_TABLE(table), hours, 1, 2, 0, 1);
+
+    /* grid size */
+    label = gtk_label_new(_("Grid size [deg]:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 1, 2);
+    step = gtk_spin_button_new_with_range(1, 30, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(step), 5);
+    gtk_widget_set_tooltip_text(step,
+                                _("The coverage map is computed on a grid "
+                                  "with this cell size. Smaller cells take "
+                                  "longer to compute."));
+    gtk_table_attach_defaults(GTK_TABLE(table), step, 1, 2, 1, 2);
+
+    /* output file */
+    label = gtk_label_new(_("Save results as:"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 2, 3);
+    file = gtk_file_chooser_button_new(_("Select a file"),
+                                       GTK_FILE_CHOOSER_ACTION_SAVE);
+    gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(file),
+                                        g_get_home_dir());
+    gtk_widget_set_tooltip_text(file,
+                                _("CSV file with the statistics of each "
+                                  "ground station and the coverage grid. "
+                                  "Leave empty to only show the map."));
+    gtk_table_attach_defaults(GTK_TABLE(table), file, 1, 2, 2, 3);
+
+    gtk_widget_show_all(table);
+    gtk_container_add(GTK_CONTAINER
+                      (gtk_dialog_get_content_area(GTK_DIALOG(dialog))),
+                      table);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) != GTK_RESPONSE_OK)
+    {
+        gtk_widget_destroy(dialog);
+        return;
+    }
+
+    /* the analysis starts at the time shown by the module */
+    start = mod->tmgCdnum;
+    job = g_new0(coverage_job_t, 1);
+    job->cov = coverage_new(start,
+                            start + gtk_spin_button_get_value(GTK_SPIN_BUTTON
+                                                              (hours)) / 24.0,
+                            gtk_spin_button_get_value(GTK_SPIN_BUTTON(step)));
+    job->csvfile = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(file));
+    gtk_widget_destroy(dialog);
+
+    add_stations(job->cov);
+
+    g_mutex_lock(&mod->busy);
+    for (i = 0; i < mod->satellites->num; i++)
+        coverage_add_sat(job->cov, sat_registry_nth(mod->satellites, i));
+    g_mutex_unlock(&mod->busy);
+
+    job->module = mod;
+    g_object_add_weak_pointer(G_OBJECT(mod), (gpointer *) & job->module);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Coverage analysis of %d satellites and %d stations"),
+                __func__, job->cov->sats->len, job->cov->qths->len);
+
+    thread = g_thread_try_new("gpredict_coverage", coverage_thread, job, &err);
+    if (thread == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create coverage thread (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        job->ok = FALSE;
+        coverage_done(job);
+        return;
+    }
+
+    g_thread_unref(thread);
+}
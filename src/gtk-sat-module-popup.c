@@ -40,6 +40,8 @@
 #endif
 #include "gtk-sat-module.h"
 #include "gtk-sat-module-tmg.h"
+#include "gtk-sat-module-conjunction.h"
+#include "gtk-sat-module-coverage.h"
 #include "gtk-sat-module-popup.h"
 #include "gtk-rig-ctrl.h"
 #include "gtk-rot-ctrl.h"
@@ -55,6 +57,8 @@ static void     screen_state_cb(GtkWidget * menuitem, gpointer data);
 static void     sat_selected_cb(GtkWidget * menuitem, gpointer data);
 static void     sky_at_glance_cb(GtkWidget * menuitem, gpointer data);
 static void     tmgr_cb(GtkWidget * menuitem, gpointer data);
+static void     coverage_cb(GtkWidget * menuitem, gpointer data);
+static void     conjunction_cb(GtkWidget * menuitem, gpointer data);
 static void     rigctrl_cb(GtkWidget * menuitem, gpointer data);
 static void     rotctrl_cb(GtkWidget * menuitem, gpointer data);
 static void     delete_cb(GtkWidget * menuitem, gpointer data);
@@ -165,7 +169,9 @@ void gtk_sat_module_popup(GtkSatModule * module)
     satsubmenu = gtk_menu_new();
     gtk_menu_item_set_submenu(GTK_MENU_ITEM(menuitem), satsubmenu);
 
-    sats = g_hash_table_get_values(module->satellites);
+    sats = NULL;
+    for (i = 0; i < module->satellites->num; i++)
+        sats = g_list_prepend(sats, sat_registry_nth(module->satellites, i));
     sats = g_list_sort(sats, (GCompareFunc) sat_nickname_compare);
 
     n = g_list_length(sats);
@@ -179,6 +185,7 @@ void gtk_sat_module_popup(GtkSatModule * module)
                          module);
         gtk_menu_shell_append(GTK_MENU_SHELL(satsubmenu), menuitem);
     }
+    g_list_free(sats);
 
     /* separator */
     menuitem = gtk_separator_menu_item_new();
@@ -194,6 +201,21 @@ void gtk_sat_module_popup(GtkSatModule * module)
     g_signal_connect(menuitem, "activate",
                      G_CALLBACK(sky_at_glance_cb), module);
 
+    /* coverage analysis */
+    menuitem = gtk_image_menu_item_new_with_label(_("Coverage analysis"));
+    image = gtk_image_new_from_stock(GTK_STOCK_EXECUTE, GTK_ICON_SIZE_MENU);
+    gtk_image_menu_item_set_image(GTK_IMAGE_MENU_ITEM(menuitem), image);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(coverage_cb), module);
+
+    /* conjunction screening */
+    menuitem = gtk_image_menu_item_new_with_label(_("Conjunction screening"));
+    image = gtk_image_new_from_stock(GTK_STOCK_FIND, GTK_ICON_SIZE_MENU);
+    gtk_image_menu_item_set_image(GTK_IMAGE_MENU_ITEM(menuitem), image);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menuitem);
+    g_signal_connect(menuitem, "activate", G_CALLBACK(conjunction_cb),
+                     module);
+
     /* time manager */
     menuitem = gtk_image_menu_item_new_with_label(_("Time Controller"));
     buff = icon_file_name("gpredict-clock-small.png");
@@ -910,6 +932,26 @@ static void tmgr_cb(GtkWidget * menuitem, gpointer data)
     tmg_create(module);
 }
 
+/** Start a coverage analysis of the satellites in the module. */
+static void coverage_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    (void)menuitem;             /* avoid unused parameter compiler warning */
+
+    coverage_create(module);
+}
+
+/** Start a conjunction screening of the satellites in the module. */
+static void conjunction_cb(GtkWidget * menuitem, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    (void)menuitem;             /* avoid unused parameter compiler warning */
+
+    conjunction_create(module);
+}
+
 /**
  * \brief Open Radio control window. 
  * \param menuitem The menuitem that was selected.
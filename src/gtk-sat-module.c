@@ -47,6 +47,7 @@
 #include <sys/time.h>
 #include "sgpsdp/sgp4sdp4.h"
 #include "sat-log.h"
+#include "startup-profile.h"
 #include "gpredict-utils.h"
 #include "config-keys.h"
 #include "sat-cfg.h"
@@ -85,10 +86,10 @@ static void     gtk_sat_module_read_cfg_data(GtkSatModule * module,
                                              const gchar * cfgfile);
 
 static void     gtk_sat_module_load_sats(GtkSatModule * module);
-static void     gtk_sat_module_free_sat(gpointer sat);
+static void     sync_stations(GtkSatModule * module);
 static gboolean gtk_sat_module_timeout_cb(gpointer module);
-static void     gtk_sat_module_update_sat(gpointer key,
-                                          gpointer val, gpointer data);
+static void     gtk_sat_module_update_sat(GtkSatModule * module,
+                                          guint idx);
 static void     gtk_sat_module_popup_cb(GtkWidget * button, gpointer data);
 
 static void     update_header(GtkSatModule * module);
@@ -96,10 +97,15 @@ static void     update_child(GtkWidget * child, gdouble tstamp);
 static void     create_module_layout(GtkSatModule * module);
 static void     get_grid_size(GtkSatModule * module, guint * rows,
                               guint * cols);
-static GtkWidget *create_view(GtkSatModule * module, guint num);
+static GtkWidget *create_view(GtkSatModule * module, guint num,
+                              guint idx);
+static void     view_data(GtkSatModule * module, guint idx,
+                          sat_registry_t ** sats, qth_t ** qth,
+                          event_queue_t ** events);
+static void     update_stations(GtkSatModule * module);
 
 static void     reload_sats_in_child(GtkWidget * widget,
-                                     GtkSatModule * module);
+                                     sat_registry_t * sats);
 
 static void     update_skg(GtkSatModule * module);
 static void     update_autotrack(GtkSatModule * module);
@@ -161,10 +167,12 @@ static void gtk_sat_module_init(GtkSatModule * module)
     module->qth = g_try_new0(qth_t, 1);
     qth_init(module->qth);
 
-    module->satellites = g_hash_table_new_full(g_int_hash,
-                                               g_int_equal,
-                                               g_free,
-                                               gtk_sat_module_free_sat);
+    module->satellites = sat_registry_new();
+    module->stations = g_ptr_array_new();
+
+    module->ephem = ephem_cache_new();
+    module->ephem_active = FALSE;
+    module->events = event_queue_new();
 
     module->rotctrlwin = NULL;
     module->rotctrl = NULL;
@@ -183,7 +191,9 @@ static void gtk_sat_module_init(GtkSatModule * module)
 
     module->grid = NULL;
     module->views = NULL;
+    module->viewqth = NULL;
     module->nviews = 0;
+    module->lazy = FALSE;
 
     module->timerid = 0;
 
@@ -241,19 +251,55 @@ static void gtk_sat_module_destroy(GtkObject * object)
         module->qth = NULL;
     }
 
+    /* clean up additional ground stations */
+    if (module->stations)
+    {
+        g_ptr_array_foreach(module->stations, (GFunc) obs_station_free, NULL);
+        g_ptr_array_free(module->stations, TRUE);
+        module->stations = NULL;
+    }
+
+    /* the server and the snapshot read the satellites */
+    if (module->server)
+    {
+        mod_server_free(module->server);
+        module->server = NULL;
+    }
+
+    if (module->shm)
+    {
+        mod_shm_free(module->shm);
+        module->shm = NULL;
+    }
+
     /* clean up satellites */
     if (module->satellites)
     {
-        g_hash_table_destroy(module->satellites);
+        sat_registry_free(module->satellites);
         module->satellites = NULL;
     }
 
+    if (module->ephem)
+    {
+        ephem_cache_free(module->ephem);
+        module->ephem = NULL;
+    }
+
+    if (module->events)
+    {
+        event_queue_free(module->events);
+        module->events = NULL;
+    }
+
     if (module->grid)
     {
         g_free(module->grid);
         module->grid = NULL;
     }
 
+    g_free(module->viewqth);
+    module->viewqth = NULL;
+
     /* FIXME: free module->views? */
 
     (*GTK_OBJECT_CLASS(parent_class)->destroy) (object);
@@ -270,7 +316,31 @@ static void gtk_sat_module_destroy(GtkObject * object)
 GtkWidget      *gtk_sat_module_new(const gchar * cfgfile)
 {
     GtkWidget      *widget;
-    GtkWidget      *butbox;
+
+    widget = gtk_sat_module_open(cfgfile);
+    if (widget == NULL)
+        return NULL;
+
+    gtk_sat_module_read_sats(GTK_SAT_MODULE(widget));
+    gtk_sat_module_start(GTK_SAT_MODULE(widget), FALSE);
+
+    return widget;
+}
+
+/**
+ * \brief Create a GtkSatModule widget without satellites.
+ * \param cfgfile The name of the configuration file (.mod)
+ * \return The new module or NULL if the configuration is not valid.
+ *
+ * This reads the configuration and the ground stations. The module can not
+ * be used until gtk_sat_module_read_sats() and gtk_sat_module_start() have
+ * been called; gtk_sat_module_new() does all three.
+ */
+GtkWidget      *gtk_sat_module_open(const gchar * cfgfile)
+{
+    GtkWidget      *widget;
+    guint           i;
+    gint64          t = startup_profile_begin();
 
     /* Read configuration data.
        If cfgfile is not existing or is NULL, start the wizard
@@ -304,6 +374,10 @@ GtkWidget      *gtk_sat_module_new(const gchar * cfgfile)
     }
     /*initialize the qth engine and get position */
     qth_data_update_init(GTK_SAT_MODULE(widget)->qth);
+    for (i = 0; i < GTK_SAT_MODULE(widget)->stations->len; i++)
+        qth_data_update_init(((obs_station_t *)
+                              g_ptr_array_index(GTK_SAT_MODULE(widget)->
+                                                stations, i))->qth);
 
     /* module state */
     if ((g_key_file_has_key(GTK_SAT_MODULE(widget)->cfgdata,
@@ -327,8 +401,48 @@ GtkWidget      *gtk_sat_module_new(const gchar * cfgfile)
     GTK_SAT_MODULE(widget)->tmgPdnum = get_current_daynum();
     GTK_SAT_MODULE(widget)->tmgCdnum = get_current_daynum();
 
-    /* load satellites */
-    gtk_sat_module_load_sats(GTK_SAT_MODULE(widget));
+    startup_profile_end(t, "gtk_sat_module_open", "%s",
+                        GTK_SAT_MODULE(widget)->name);
+
+    return widget;
+}
+
+/**
+ * \brief Start a module after its satellites have been read.
+ * \param module The module returned by gtk_sat_module_open()
+ * \param lazy Do not create the views until gtk_sat_module_materialize()
+ *
+ * Creating the views, in particular the maps, is the slowest part of
+ * opening a module; lazy modules are cheap until they are first shown.
+ */
+void gtk_sat_module_start(GtkSatModule * module, gboolean lazy)
+{
+    GtkWidget      *widget = GTK_WIDGET(module);
+    GtkWidget      *butbox;
+    gchar          *buffer;
+    gint64          t = startup_profile_begin();
+
+    sync_stations(module);
+
+    /* start tracking data server */
+    buffer = g_key_file_get_string(GTK_SAT_MODULE(widget)->cfgdata,
+                                   MOD_CFG_GLOBAL_SECTION,
+                                   MOD_CFG_SERVER_KEY, NULL);
+    if (buffer != NULL && buffer[0] != '\0')
+        GTK_SAT_MODULE(widget)->server =
+            mod_server_new(g_strstrip(buffer),
+                           GTK_SAT_MODULE(widget)->satellites);
+    g_free(buffer);
+
+    /* create shared memory snapshot */
+    buffer = g_key_file_get_string(GTK_SAT_MODULE(widget)->cfgdata,
+                                   MOD_CFG_GLOBAL_SECTION,
+                                   MOD_CFG_SHM_KEY, NULL);
+    if (buffer != NULL && buffer[0] != '\0')
+        GTK_SAT_MODULE(widget)->shm =
+            mod_shm_new(g_strstrip(buffer),
+                        GTK_SAT_MODULE(widget)->satellites->num);
+    g_free(buffer);
 
     /* create buttons */
     GTK_SAT_MODULE(widget)->popup_button =
@@ -373,7 +487,9 @@ GtkWidget      *gtk_sat_module_new(const gchar * cfgfile)
     gtk_box_pack_start(GTK_BOX(widget), butbox, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(widget), gtk_hseparator_new(), FALSE, FALSE, 0);
 
-    create_module_layout(GTK_SAT_MODULE(widget));
+    module->lazy = lazy;
+    if (!lazy)
+        create_module_layout(module);
 
     gtk_widget_show_all(widget);
 
@@ -382,7 +498,36 @@ GtkWidget      *gtk_sat_module_new(const gchar * cfgfile)
         g_timeout_add(GTK_SAT_MODULE(widget)->timeout,
                       gtk_sat_module_timeout_cb, widget);
 
-    return widget;
+    startup_profile_end(t, "gtk_sat_module_start", "%s%s", module->name,
+                        lazy ? " (lazy)" : "");
+}
+
+/**
+ * \brief Create the views of a lazy module.
+ * \param module The module
+ *
+ * Nothing is done if the views already exist.
+ */
+void gtk_sat_module_materialize(GtkSatModule * module)
+{
+    gint64          t;
+
+    if (!module->lazy)
+        return;
+
+    t = startup_profile_begin();
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Creating views of %s"), __func__, module->name);
+
+    module->lazy = FALSE;
+    create_module_layout(module);
+    gtk_widget_show_all(GTK_WIDGET(module));
+
+    if (module->target > 0)
+        gtk_sat_module_select_sat(module, module->target);
+
+    startup_profile_end(t, "gtk_sat_module_materialize", "%s", module->name);
 }
 
 /**
@@ -409,7 +554,7 @@ static void create_module_layout(GtkSatModule * module)
     for (i = 0; i < module->nviews; i++)
     {
         /* create the view */
-        view = create_view(module, module->grid[5 * i]);
+        view = create_view(module, module->grid[5 * i], i);
 
         /* store a pointer to the view */
         module->views = g_slist_append(module->views, view);
@@ -429,38 +574,40 @@ static void create_module_layout(GtkSatModule * module)
  * \brief Create a new view.
  * \param module Pointer to the parent GtkSatModule widget
  * \param num The number ID of the view to create, see gtk_sat_mod_view_t
+ * \param idx The index of the view in the layout grid
  * \return Pointer to a new GtkWidget of type corresponding to num. If num
  *         is invalid, a GtkSatList is returned.
  */
-static GtkWidget *create_view(GtkSatModule * module, guint num)
+static GtkWidget *create_view(GtkSatModule * module, guint num, guint idx)
 {
     GtkWidget      *view;
+    sat_registry_t *sats;
+    qth_t          *qth;
+    event_queue_t  *events;
+
+    view_data(module, idx, &sats, &qth, &events);
 
     switch (num)
     {
     case GTK_SAT_MOD_VIEW_LIST:
-        view = gtk_sat_list_new(module->cfgdata,
-                                module->satellites, module->qth, 0);
+        view = gtk_sat_list_new(module->cfgdata, sats, qth, 0);
         break;
 
     case GTK_SAT_MOD_VIEW_MAP:
-        view = gtk_sat_map_new(module->cfgdata,
-                               module->satellites, module->qth);
+        view = gtk_sat_map_new(module->cfgdata, sats, qth);
         break;
 
     case GTK_SAT_MOD_VIEW_POLAR:
-        view = gtk_polar_view_new(module->cfgdata,
-                                  module->satellites, module->qth);
+        view = gtk_polar_view_new(module->cfgdata, sats, qth);
         break;
 
     case GTK_SAT_MOD_VIEW_SINGLE:
-        view = gtk_single_sat_new(module->cfgdata,
-                                  module->satellites, module->qth, 0);
+        view = gtk_single_sat_new(module->cfgdata, sats, qth, 0);
         break;
 
     case GTK_SAT_MOD_VIEW_EVENT:
-        view = gtk_event_list_new(module->cfgdata,
-                                  module->satellites, module->qth, 0);
+        view = gtk_event_list_new(module->cfgdata, sats, qth, 0);
+        gtk_event_list_set_events(view, events);
         break;
 
     default:
@@ -468,14 +615,46 @@ static GtkWidget *create_view(GtkSatModule * module, guint num)
                     _("%s:%d: Invalid child type (%d). Using GtkSatList."),
                     __FILE__, __LINE__, num);
 
-        view = gtk_sat_list_new(module->cfgdata,
-                                module->satellites, module->qth, 0);
+        view = gtk_sat_list_new(module->cfgdata, sats, qth, 0);
         break;
     }
 
     return view;
 }
 
+/**
+ * \brief Get the satellites and the QTH shown by a view.
+ * \param module Pointer to the GtkSatModule widget
+ * \param idx The index of the view in the layout grid
+ * \param sats Return value for the satellites
+ * \param qth Return value for the QTH
+ * \param events Return value for the AOS/LOS events
+ *
+ * Views showing an additional ground station get the shadow satellites of
+ * that station.
+ */
+static void view_data(GtkSatModule * module, guint idx,
+                      sat_registry_t ** sats, qth_t ** qth,
+                      event_queue_t ** events)
+{
+    obs_station_t  *st;
+    guint           n = (module->viewqth != NULL) ? module->viewqth[idx] : 0;
+
+    if ((n == 0) || (n > module->stations->len))
+    {
+        *sats = module->satellites;
+        *qth = module->qth;
+        *events = module->events;
+    }
+    else
+    {
+        st = g_ptr_array_index(module->stations, n - 1);
+        *sats = st->sats;
+        *qth = st->qth;
+        *events = st->events;
+    }
+}
+
 /**
  * \brief Read moule configuration data.
  * \ingroup satmodpriv
@@ -489,6 +668,9 @@ gtk_sat_module_read_cfg_data(GtkSatModule * module, const gchar * cfgfile)
     gchar          *qthfile;
     gchar          *confdir;
     gchar         **buffv;
+    gint           *viewqth;
+    gsize           nviewqth;
+    obs_station_t  *station;
     guint           length, i;
     GError         *error = NULL;
 
@@ -561,9 +743,23 @@ gtk_sat_module_read_cfg_data(GtkSatModule * module, const gchar * cfgfile)
     }
 
     g_free(buffer);
-    g_free(confdir);
     g_free(qthfile);
 
+    /* additional ground stations */
+    buffv = g_key_file_get_string_list(module->cfgdata,
+                                       MOD_CFG_GLOBAL_SECTION,
+                                       MOD_CFG_QTH_FILES_KEY, NULL, NULL);
+    for (i = 0; (buffv != NULL) && (buffv[i] != NULL); i++)
+    {
+        qthfile = g_strconcat(confdir, G_DIR_SEPARATOR_S, buffv[i], NULL);
+        station = obs_station_new(qthfile);
+        if (station != NULL)
+            g_ptr_array_add(module->stations, station);
+        g_free(qthfile);
+    }
+    g_strfreev(buffv);
+    g_free(confdir);
+
     /* get timeout value */
     module->timeout = mod_cfg_get_int(module->cfgdata,
                                       MOD_CFG_GLOBAL_SECTION,
@@ -618,23 +814,48 @@ gtk_sat_module_read_cfg_data(GtkSatModule * module, const gchar * cfgfile)
                     _("%s: Unable to allocate memory for grid."), __func__);
     }
     g_strfreev(buffv);
+
+    /* ground station of each view; missing entries use the module QTH */
+    module->viewqth = g_new0(guint, MAX(module->nviews, 1));
+    viewqth = g_key_file_get_integer_list(module->cfgdata,
+                                          MOD_CFG_GLOBAL_SECTION,
+                                          MOD_CFG_VIEW_QTH, &nviewqth, NULL);
+    for (i = 0; (viewqth != NULL) && (i < nviewqth) && (i < module->nviews);
+         i++)
+    {
+        if ((viewqth[i] > 0) && ((guint) viewqth[i] <= module->stations->len))
+            module->viewqth[i] = viewqth[i];
+    }
+    g_free(viewqth);
 }
 
 /**
  * \brief Read satellites into memory.
  *
  * This function reads the list of satellites from the configfile and
- * and then adds each satellite to the hash table.
+ * and then loads the satellites into the registry.
  */
 static void gtk_sat_module_load_sats(GtkSatModule * module)
+{
+    gtk_sat_module_read_sats(module);
+    sync_stations(module);
+}
+
+/**
+ * \brief Read the satellites of a module into its registry.
+ * \param module The module
+ *
+ * Only the configuration, the QTH and the registry of the module are used,
+ * so the satellites of different modules can be read in parallel threads
+ * while the modules are not running.
+ */
+void gtk_sat_module_read_sats(GtkSatModule * module)
 {
     gint           *sats = NULL;
     gsize           length;
     GError         *error = NULL;
-    guint           i;
-    sat_t          *sat;
-    guint          *key = NULL;
     guint           succ = 0;
+    gint64          t = startup_profile_begin();
 
     /* get list of satellites from config file; abort in case of error */
     sats = g_key_file_get_integer_list(module->cfgdata,
@@ -654,68 +875,32 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
         {
             g_free(sats);
         }
-
-        return;
     }
-
-    /* read each satellite into hash table */
-    for (i = 0; i < length; i++)
+    else
     {
-        sat = g_new(sat_t, 1);
+        /* read the satellites into the registry; duplicates are skipped */
+        succ = sat_registry_load(module->satellites, sats, length,
+                                 module->qth);
 
-        if (gtk_sat_data_read_sat(sats[i], sat))
-        {
-            /* the satellite could not be read */
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Error reading data for #%d"),
-                        __func__, sats[i]);
-
-            g_free(sat);
-        }
-        else
-        {
-            /* check whether satellite is already in list
-               in order to avoid duplicates
-             */
-            key = g_new0(guint, 1);
-            *key = sats[i];
-
-            if (g_hash_table_lookup(module->satellites, key) == NULL)
-            {
-                gtk_sat_data_init_sat(sat, module->qth);
-                g_hash_table_insert(module->satellites, key, sat);
-                succ++;
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: Read data for #%d"), __func__, sats[i]);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_WARN,
-                            _("%s: Sat #%d already in list"),
-                            __func__, sats[i]);
-
-                /* it is not needed in this case */
-                g_free(sat);
-            }
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Read %d out of %d satellites"), __func__, succ,
+                    length);
 
-        }
+        g_free(sats);
     }
 
-    sat_log_log(SAT_LOG_LEVEL_INFO,
-                _("%s: Read %d out of %d satellites"), __func__, succ, length);
-
-    g_free(sats);
+    startup_profile_end(t, "gtk_sat_module_read_sats", "%s: %u satellites",
+                        module->name, succ);
 }
 
-/**
- * \brief Free satellite data
- * 
- * This function is called automatically for each satellite when
- * the hash table is destroyed.
- */
-static void gtk_sat_module_free_sat(gpointer sat)
+/** \brief Make the shadows of the ground stations follow the registry. */
+static void sync_stations(GtkSatModule * module)
 {
-    gtk_sat_data_free_sat(SAT(sat));
+    guint           i;
+
+    for (i = 0; i < module->stations->len; i++)
+        obs_station_sync(g_ptr_array_index(module->stations, i),
+                         module->satellites);
 }
 
 /** Module timeout callback. */
@@ -726,6 +911,7 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
     gboolean        needupdate = FALSE;
     GdkWindowState  state;
     gdouble         delta;
+    gdouble         dist;
     guint           i;
 
     /*update the qth position */
@@ -752,6 +938,13 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         break;
     }
 
+    /* clients of the tracking data server and readers of the snapshot
+       expect data in every cycle */
+    if (mod->server != NULL && mod_server_has_clients(mod->server))
+        needupdate = TRUE;
+    if (mod->shm != NULL)
+        needupdate = TRUE;
+
     if (needupdate)
     {
         if (g_mutex_trylock(&mod->busy) == FALSE)
@@ -784,36 +977,45 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         }
 
         /* reset event update counter if is has expired or if we have moved
-           significantly */
-        if (mod->event_count == mod->event_timeout ||
-            qth_small_dist(mod->qth, mod->qth_event) > 1.0)
+           far; after a small move the known events are refined instead */
+        dist = qth_small_dist(mod->qth, mod->qth_event);
+        mod->event_moved = FALSE;
+        if (mod->event_count == mod->event_timeout || dist > REFINE_MAX_DIST)
         {
             mod->event_count = 0;       // will trigger find_aos() and find_los()
         }
+        else if (dist > 1.0)
+        {
+            mod->event_moved = TRUE;    // will trigger refine_aos_los()
+        }
 
         /* if the events are going to be recalculated store the position */
-        if (mod->event_count == 0)
+        if (mod->event_count == 0 || mod->event_moved)
         {
             qth_small_save(mod->qth, &(mod->qth_event));
         }
 
-        /* update satellite data */
+        /* use interpolated ephemeris unless we are running in real time */
+        mod->ephem_active = (mod->throttle != 1) &&
+            sat_cfg_get_bool(SAT_CFG_BOOL_PRED_EPHEM_CACHE);
+
+        /* observer frame shared by all satellites in this cycle */
+        predict_obs_frame(&mod->frame, mod->qth, mod->tmgCdnum);
+
+        /* update satellite data; the views only read the published data
+           and use private copies for look-ahead, so one pass is enough */
         if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
+            for (i = 0; i < mod->satellites->num; i++)
+                gtk_sat_module_update_sat(mod, i);
+        update_stations(mod);
 
-        /* update children */
-        for (i = 0; i < mod->nviews; i++)
+        /* update children; a lazy module has none yet */
+        for (i = 0; !mod->lazy && i < mod->nviews; i++)
         {
             child = GTK_WIDGET(g_slist_nth_data(mod->views, i));
             update_child(child, mod->tmgCdnum);
         }
 
-        /* update satellite data (it may have got out of sync during child updates) */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
-
         /* update target if autotracking is enabled */
         if (mod->autotrack)
             update_autotrack(mod);
@@ -832,6 +1034,13 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         if (mod->skg)
             update_skg(mod);
 
+        /* send the data of this cycle to the server clients and to the
+           shared memory snapshot */
+        if (mod->server)
+            mod_server_publish(mod->server, mod->tmgCdnum);
+        if (mod->shm)
+            mod_shm_publish(mod->shm, mod->satellites, mod->tmgCdnum);
+
         mod->event_count++;
 
         /* store time keeping variables */
@@ -852,6 +1061,26 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
     return TRUE;
 }
 
+/**
+ * \brief Update the additional ground stations.
+ * \param module The GtkSatModule widget.
+ *
+ * The satellites have already been calculated for the module QTH; the
+ * stations reuse their state and only calculate the observer relative data.
+ */
+static void update_stations(GtkSatModule * module)
+{
+    guint           i;
+
+    if (module->satellites == NULL)
+        return;
+
+    for (i = 0; i < module->stations->len; i++)
+        obs_station_update(g_ptr_array_index(module->stations, i),
+                           module->satellites, module->tmgCdnum,
+                           module->event_count == 0);
+}
+
 /**
  * Update a child widget.
  * \param child Pointer to the child widget (views)
@@ -901,27 +1130,22 @@ static void update_child(GtkWidget * child, gdouble tstamp)
 
 /**
  * \brief Update a given satellite.
- * \param key The hash table key (catnum)
- * \param val The hash table value (sat_t structure)
- * \param data User data (the GtkSatModule widget).
+ * \param module The GtkSatModule widget.
+ * \param idx The index of the satellite in the registry.
  *
  * This function updates the tracking data for a given satelite. It is called by
- * the timeout handler for each element in the hash table.
+ * the timeout handler for each satellite in the registry. The calculations
+ * are done on the propagator state of the satellite and the result is
+ * published to the views when it is complete.
  */
-static void gtk_sat_module_update_sat(gpointer key, gpointer val,
-                                      gpointer data)
+static void gtk_sat_module_update_sat(GtkSatModule * module, guint idx)
 {
     sat_t          *sat;
-    GtkSatModule   *module;
     gdouble         daynum;
     gdouble         maxdt;
 
-    (void)key;                  /* prevent unused parameter compiler warning */
+    sat = sat_registry_work(module->satellites, idx);
 
-    g_return_if_fail((val != NULL) && (data != NULL));
-
-    sat = SAT(val);
-    module = GTK_SAT_MODULE(data);
     maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
 
     /* get current time (real or simulated */
@@ -940,6 +1164,12 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
         sat->aos = find_aos(sat, module->qth, daynum, maxdt);
         sat->los = find_los(sat, module->qth, daynum, maxdt);
     }
+    else if (module->event_moved)
+    {
+        /* a moving observer shifts the events by a few seconds per km,
+           so start from the previous times */
+        refine_aos_los(sat, module->qth, daynum, maxdt);
+    }
     /*
        Update AOS and LOS for this satellite if it was known and is before 
        the current time. 
@@ -982,7 +1212,14 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
     if (sat->los > 0 && sat->los < daynum)
         sat->los = find_los(sat, module->qth, daynum, maxdt);
 
-    predict_calc(sat, module->qth, daynum);
+    if (module->ephem_active)
+        ephem_cache_calc(module->ephem, sat, &module->frame);
+    else
+        predict_calc_frame(sat, &module->frame);
+
+    sat_registry_publish(module->satellites, idx);
+    event_queue_update(module->events,
+                       sat_registry_nth(module->satellites, idx));
 }
 
 /**
@@ -1305,16 +1542,6 @@ static void update_header(GtkSatModule * module)
         tmg_update_state(module);
 }
 
-static gboolean empty(gpointer key, gpointer val, gpointer data)
-{
-    (void)key;                  /* prevent unused parameter compiler warning */
-    (void)val;                  /* prevent unused parameter compiler warning */
-    (void)data;                 /* prevent unused parameter compiler warning */
-
-    /* TRUE => sat removed from hash table */
-    return TRUE;
-}
-
 /**
  * \brief Reload satellites.
  * \param module Pointer to a GtkSatModule widget.
@@ -1332,6 +1559,9 @@ static gboolean empty(gpointer key, gpointer val, gpointer data)
 void gtk_sat_module_reload_sats(GtkSatModule * module)
 {
     GtkWidget      *child;
+    sat_registry_t *sats;
+    qth_t          *qth;
+    event_queue_t  *events;
     guint           i;
 
     g_return_if_fail(IS_GTK_SAT_MODULE(module));
@@ -1343,8 +1573,12 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
                 _("%s: Reloading satellites for module %s"),
                 __func__, module->name);
 
-    /* remove each element from the hash table, but keep the hash table */
-    g_hash_table_foreach_remove(module->satellites, empty, NULL);
+    /* remove the satellites, but keep the registry */
+    sat_registry_clear(module->satellites);
+
+    /* the cached nodes belong to the old orbital elements */
+    ephem_cache_clear(module->ephem);
+    event_queue_clear(module->events);
 
     /* reset event counter so that next AOS/LOS gets re-calculated */
     module->event_count = 0;
@@ -1353,10 +1587,11 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
     gtk_sat_module_load_sats(module);
 
     /* update children */
-    for (i = 0; i < module->nviews; i++)
+    for (i = 0; !module->lazy && i < module->nviews; i++)
     {
         child = GTK_WIDGET(g_slist_nth_data(module->views, i));
-        reload_sats_in_child(child, module);
+        view_data(module, i, &sats, &qth, &events);
+        reload_sats_in_child(child, sats);
     }
 
     /* FIXME: radio and rotator controller */
@@ -1366,30 +1601,30 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
 }
 
 /** Reload satellites in view */
-static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
+static void reload_sats_in_child(GtkWidget * widget, sat_registry_t * sats)
 {
     if (IS_GTK_SINGLE_SAT(G_OBJECT(widget)))
     {
-        gtk_single_sat_reload_sats(widget, module->satellites);
+        gtk_single_sat_reload_sats(widget, sats);
     }
 
     else if (IS_GTK_POLAR_VIEW(widget))
     {
-        gtk_polar_view_reload_sats(widget, module->satellites);
+        gtk_polar_view_reload_sats(widget, sats);
     }
 
     else if (IS_GTK_SAT_MAP(widget))
     {
-        gtk_sat_map_reload_sats(widget, module->satellites);
+        gtk_sat_map_reload_sats(widget, sats);
     }
 
     else if (IS_GTK_SAT_LIST(widget))
     {
-        /* NOP */
+        gtk_sat_list_reload_sats(widget, sats);
     }
     else if (IS_GTK_EVENT_LIST(widget))
     {
-        /* NOP */
+        gtk_event_list_reload_sats(widget, sats);
     }
 
     else
@@ -1408,7 +1643,7 @@ void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
     module->target = catnum;
 
     /* select satellite in each view */
-    for (i = 0; i < module->nviews; i++)
+    for (i = 0; !module->lazy && i < module->nviews; i++)
     {
         child = GTK_WIDGET(g_slist_nth_data(module->views, i));
 
@@ -1527,55 +1762,33 @@ static void update_skg(GtkSatModule * module)
     }
 }
 
-/** Check and update autotrack target */
+/**
+ * Check and update autotrack target.
+ *
+ * The target is kept as long as it is above the horizon. Otherwise a
+ * satellite in range is selected, or the satellite with the next AOS if
+ * there is none. Both are read from the top of the event queue.
+ */
 static void update_autotrack(GtkSatModule * module)
 {
-    GList          *satlist = NULL;
-    GList          *iter;
     sat_t          *sat = NULL;
-    guint           i, n;
-    double          next_aos;
     gint            next_sat;
 
     if (module->target > 0)
-        sat = g_hash_table_lookup(module->satellites, &module->target);
+        sat = sat_registry_lookup(module->satellites, module->target);
 
     /* do nothing if current target is still above horizon */
     if (sat != NULL && sat->el > 0.0)
         return;
 
-    /* set target to satellite with next AOS */
-    satlist = g_hash_table_get_values(module->satellites);
-    iter = satlist;
-    n = g_list_length(satlist);
-    if (n == 0)
+    /* set target to a satellite in range or the one with the next AOS */
+    sat = event_queue_next_los(module->events);
+    if (sat == NULL)
+        sat = event_queue_next_aos(module->events);
+    if (sat == NULL)
         return;
 
-    next_aos = module->tmgCdnum + 10.f; /* hope there is AOS within 10 days */
-    next_sat = module->target;
-
-    i = 0;
-    while (i++ < n)
-    {
-        sat = (sat_t *) iter->data;
-
-        /* if sat is above horizon, select it and we are done */
-        if (sat->el > 0.0)
-        {
-            next_sat = sat->tle.catnr;
-            break;
-        }
-
-        /* we have a candidate if AOS is in the future */
-        if (sat->aos > module->tmgCdnum && sat->aos < next_aos)
-        {
-            next_aos = sat->aos;
-            next_sat = sat->tle.catnr;
-        }
-
-        iter = iter->next;
-    }
-
+    next_sat = sat->tle.catnr;
     if (next_sat != module->target)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
@@ -1583,6 +1796,4 @@ static void update_autotrack(GtkSatModule * module)
                     module->target, next_sat);
         gtk_sat_module_select_sat(module, next_sat);
     }
-
-    g_list_free(satlist);
 }
@@ -33,7 +33,13 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 #include "gtk-sat-data.h"
+#include "ephem-cache.h"
+#include "event-queue.h"
+#include "mod-server.h"
+#include "mod-shm.h"
 #include "qth-data.h"
+#include "obs-station.h"
+#include "sat-registry.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -107,16 +113,20 @@ struct _gtk_sat_module {
     guint           head_timeout;
     guint           event_count;
     guint           event_timeout;
+    gboolean        event_moved;        /*!< QTH moved; refine AOS/LOS in this cycle */
 
     /* layout and children */
     guint          *grid;       /*!< The grid layout array [(type,left,right,top,bottom),...] */
     guint           nviews;     /*!< The number of views */
+    gboolean        lazy;       /*!< The views have not been created yet */
     GSList         *views;      /*!< Pointers to the views */
+    guint          *viewqth;    /*!< Ground station of each view, 0 is the module QTH */
 
     GKeyFile       *cfgdata;    /*!< Configuration data. */
     qth_t          *qth;        /*!< QTH information. */
     qth_small_t     qth_event;  /*!< QTH information for last AOS/LOS update. */
-    GHashTable     *satellites; /*!< Satellites. */
+    sat_registry_t *satellites; /*!< Satellites. */
+    GPtrArray      *stations;   /*!< Additional ground stations (obs_station_t). */
 
     guint32         timeout;    /*!< Timeout value [msec] */
 
@@ -151,6 +161,13 @@ struct _gtk_sat_module {
 
     gboolean        reset;      /*!< Flag indicating whether time reset is in progress */
 
+    ephem_cache_t  *ephem;      /*!< Interpolated ephemeris used in simulated time */
+    gboolean        ephem_active;       /*!< Whether ephem is used in this cycle */
+    event_queue_t  *events;     /*!< Upcoming AOS/LOS events */
+    obs_frame_t     frame;      /*!< Observer frame for the current cycle */
+    mod_server_t   *server;     /*!< Tracking data server or NULL */
+    mod_shm_t      *shm;        /*!< Shared memory snapshot or NULL */
+
     /* auto-tracking */
     gint            target;     /*!< Target satellite */
     gboolean        autotrack;  /*!< Whether automatic tracking is enabled */
@@ -166,6 +183,10 @@ struct _GtkSatModuleClass {
 
 GType           gtk_sat_module_get_type(void);
 GtkWidget      *gtk_sat_module_new(const gchar * cfgfile);
+GtkWidget      *gtk_sat_module_open(const gchar * cfgfile);
+void            gtk_sat_module_read_sats(GtkSatModule * module);
+void            gtk_sat_module_start(GtkSatModule * module, gboolean lazy);
+void            gtk_sat_module_materialize(GtkSatModule * module);
 
 
 void            gtk_sat_module_close_cb(GtkWidget * button, gpointer data);
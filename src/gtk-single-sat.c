@@ -210,7 +210,7 @@ gtk_single_sat_destroy (GtkObject *object)
 
 
 GtkWidget *
-gtk_single_sat_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth, guint32 fields)
+gtk_single_sat_new (GKeyFile *cfgdata, sat_registry_t *sats, qth_t *qth, guint32 fields)
 {
     GtkWidget *widget;
     GtkWidget *hbox;      /* horizontal box for header */
@@ -228,7 +228,7 @@ gtk_single_sat_new (GKeyFile *cfgdata, GHashTable *sats, qth_t *qth, guint32 fie
     /* Read configuration data. */
     /* ... */
 
-    g_hash_table_foreach (sats, store_sats, widget);
+    sat_registry_foreach (sats, store_sats, widget);
     GTK_SINGLE_SAT (widget)->selected = 0;
     GTK_SINGLE_SAT (widget)->qth = qth;
     GTK_SINGLE_SAT (widget)->cfgdata = cfgdata;
@@ -410,9 +410,10 @@ gtk_single_sat_update          (GtkWidget *widget)
             obs_astro_t astro;
 
 
+            /* the satellite is published data; keep the result here */
             Calculate_RADec (sat, ssat->qth, &astro);
-            sat->ra = Degrees(astro.ra);
-            sat->dec = Degrees(astro.dec);
+            ssat->ra = Degrees(astro.ra);
+            ssat->dec = Degrees(astro.dec);
         }
 
         /* update visible fields one by one */
@@ -500,12 +501,12 @@ update_field            (GtkSingleSat *ssat, guint i)
 
 
     case SINGLE_SAT_FIELD_RA:
-        buff = g_strdup_printf ("%6.2f\302\260", sat->ra);
+        buff = g_strdup_printf ("%6.2f\302\260", ssat->ra);
         break;
 
 
     case SINGLE_SAT_FIELD_DEC:
-        buff = g_strdup_printf ("%6.2f\302\260", sat->dec);
+        buff = g_strdup_printf ("%6.2f\302\260", ssat->dec);
         break;
 
 
@@ -937,7 +938,7 @@ select_satellite        (GtkWidget *menuitem, gpointer data)
 /** \brief Refresh internal references to the satellites.
  */
 void
-gtk_single_sat_reload_sats (GtkWidget *single_sat, GHashTable *sats)
+gtk_single_sat_reload_sats (GtkWidget *single_sat, sat_registry_t *sats)
 {
 
     /* free GSlists */
@@ -945,7 +946,7 @@ gtk_single_sat_reload_sats (GtkWidget *single_sat, GHashTable *sats)
     GTK_SINGLE_SAT (single_sat)->sats = NULL;
 
     /* reload satellites */
-    g_hash_table_foreach (sats, store_sats, single_sat);
+    sat_registry_foreach (sats, store_sats, single_sat);
 
 }
 
@@ -960,7 +961,7 @@ gtk_single_sat_reload_sats (GtkWidget *single_sat, GHashTable *sats)
 void
 gtk_single_sat_reconf          (GtkWidget    *widget,
                                 GKeyFile     *newcfg,
-                                GHashTable   *sats,
+                                sat_registry_t *sats,
                                 qth_t        *qth,
                                 gboolean      local)
 {
@@ -141,6 +141,8 @@ struct _gtk_single_sat
      guint          selected;     /*!< index of selected sat. */
 
      gdouble       tstamp;       /*!< time stamp of calculations; update by GtkSatModule */
+     gdouble       ra;           /*!< Right ascension of the selected sat [deg]. */
+     gdouble       dec;          /*!< Declination of the selected sat [deg]. */
      
      void (* update) (GtkWidget *widget);  /*!< update function */
 };
@@ -154,18 +156,18 @@ struct _GtkSingleSatClass
 
 GType          gtk_single_sat_get_type        (void);
 GtkWidget*     gtk_single_sat_new             (GKeyFile   *cfgdata,
-                                                          GHashTable *sats,
+                                                          sat_registry_t *sats,
                                                           qth_t      *qth,
                                                           guint32     fields);
 void           gtk_single_sat_update          (GtkWidget  *widget);
 void           gtk_single_sat_reconf          (GtkWidget  *widget,
                                                           GKeyFile   *newcfg,
-                                                          GHashTable *sats,
+                                                          sat_registry_t *sats,
                                                           qth_t      *qth,
                                                           gboolean    local);
 
 
-void gtk_single_sat_reload_sats (GtkWidget *single_sat, GHashTable *sats);
+void gtk_single_sat_reload_sats (GtkWidget *single_sat, sat_registry_t *sats);
 void gtk_single_sat_select_sat  (GtkWidget *single_sat, gint catnum);
 
 #ifdef __cplusplus
@@ -226,11 +226,12 @@ static void gtk_sky_glance_destroy(GtkObject * object)
 
 /**
  * \brief Create a new GtkSkyGlance widget.
- * \param sats Pointer to the hash table containing the asociated satellites.
+ * \param sats Pointer to the registry containing the asociated satellites.
  * \param qth Pointer to the ground station data.
  * \param ts The t0 for the timeline or 0 to use the current date and time.
  */
-GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
+GtkWidget      *gtk_sky_glance_new(sat_registry_t * sats, qth_t * qth,
+                                   gdouble ts)
 {
     GtkWidget      *skg;
     GooCanvasItemModel *root;
@@ -238,7 +239,7 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
     guint           number;
 
     /* check that we have at least one satellite */
-    number = g_hash_table_size(sats);
+    number = sats->num;
     if (number == 0)
     {
         /* no satellites */
@@ -254,7 +255,7 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
     GTK_SKY_GLANCE(skg)->qth = qth;
 
     /* get settings */
-    GTK_SKY_GLANCE(skg)->numsat = g_hash_table_size(sats);
+    GTK_SKY_GLANCE(skg)->numsat = sats->num;
 
     /* if ts = 0 use current time */
     if (ts > 0.0)
@@ -306,7 +307,7 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
     g_object_unref(root);
 
     /* add satellite passes */
-    g_hash_table_foreach(GTK_SKY_GLANCE(skg)->sats, create_sat, skg);
+    sat_registry_foreach(GTK_SKY_GLANCE(skg)->sats, create_sat, skg);
 
     gtk_container_add(GTK_CONTAINER(skg), GTK_SKY_GLANCE(skg)->canvas);
 
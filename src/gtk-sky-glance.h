@@ -35,6 +35,7 @@
 #include "gtk-sat-data.h"
 
 #include "predict-tools.h"
+#include "sat-registry.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -70,7 +71,7 @@ struct _GtkSkyGlance {
 
     GtkWidget      *canvas;     /*!< The canvas widget */
 
-    GHashTable     *sats;       /*!< Copy of satellites. */
+    sat_registry_t *sats;       /*!< Copy of satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
 
     GSList         *passes;     /*!< Canvas items representing each pass.
@@ -111,7 +112,8 @@ struct _GtkSkyGlanceClass {
 
 
 GType           gtk_sky_glance_get_type(void);
-GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts);
+GtkWidget      *gtk_sky_glance_new(sat_registry_t * sats, qth_t * qth,
+                                   gdouble ts);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
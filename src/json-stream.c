@@ -0,0 +1,562 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Streaming JSON reader.
+ *
+ * nxjson needs the whole document in memory and builds a tree of it, which
+ * is wasteful for large files like the SatNOGS transmitter database where
+ * each object is only needed once. This reader is fed the input in chunks
+ * of any size and reports objects, arrays and values through callbacks as
+ * soon as they are complete. Memory use is bounded by the longest string
+ * and the nesting depth, not by the size of the document.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "json-stream.h"
+#include "sat-log.h"
+
+
+/** \brief What the grammar expects next. */
+typedef enum {
+    JS_EXPECT_VALUE = 0,        /*!< Any value */
+    JS_EXPECT_VALUE_OR_END,     /*!< Array element or ']' */
+    JS_EXPECT_KEY,              /*!< Member name */
+    JS_EXPECT_KEY_OR_END,       /*!< Member name or '}' */
+    JS_EXPECT_COLON,            /*!< ':' after a member name */
+    JS_EXPECT_COMMA_OR_END,     /*!< ',' or the end of the container */
+    JS_EXPECT_DONE              /*!< Top level value complete */
+} js_expect_t;
+
+/** \brief State of the tokenizer. */
+typedef enum {
+    JS_LEX_NONE = 0,            /*!< Between tokens */
+    JS_LEX_STRING,              /*!< Inside a string */
+    JS_LEX_ESCAPE,              /*!< After a backslash in a string */
+    JS_LEX_UNICODE,             /*!< Reading the digits of \uXXXX */
+    JS_LEX_BARE                 /*!< Inside a number or literal */
+} js_lex_t;
+
+struct _json_stream {
+    json_stream_cb_t cb;        /*!< Callbacks */
+    gpointer    data;           /*!< User data for the callbacks */
+
+    js_expect_t expect;
+    js_lex_t    lex;
+    gchar       stack[JSON_STREAM_MAX_DEPTH];   /*!< '{' or '[' per level */
+    guint       depth;          /*!< Number of open containers */
+
+    GString    *tok;            /*!< Current string, number or literal */
+    GString    *key;            /*!< Last member name */
+    gunichar    ucode;          /*!< Code unit of \uXXXX being read */
+    guint       udigits;        /*!< Digits of ucode read so far */
+    gunichar    usurr;          /*!< Pending high surrogate or 0 */
+
+    guint64     offset;         /*!< Bytes consumed before current chunk */
+    gchar      *error;          /*!< Error message or NULL */
+};
+
+
+static gboolean js_fail(json_stream_t * js, guint64 pos, const gchar * msg);
+static gboolean js_scalar(json_stream_t * js, guint64 pos,
+                          json_stream_type_t type);
+static gboolean js_bare(json_stream_t * js, guint64 pos);
+static gboolean js_punct(json_stream_t * js, guint64 pos, gchar c);
+static void     js_append_unichar(json_stream_t * js, gunichar c);
+static void     js_flush_surrogate(json_stream_t * js);
+
+
+/**
+ * \brief Create a new reader.
+ * \param cb The callbacks; the structure is copied.
+ * \param data User data passed to the callbacks.
+ */
+json_stream_t  *json_stream_new(const json_stream_cb_t * cb, gpointer data)
+{
+    json_stream_t  *js;
+
+    js = g_new0(json_stream_t, 1);
+    if (cb != NULL)
+        js->cb = *cb;
+    js->data = data;
+    js->tok = g_string_sized_new(256);
+    js->key = g_string_sized_new(64);
+
+    return js;
+}
+
+/** \brief Free a reader. */
+void json_stream_free(json_stream_t * js)
+{
+    if (js == NULL)
+        return;
+
+    g_string_free(js->tok, TRUE);
+    g_string_free(js->key, TRUE);
+    g_free(js->error);
+    g_free(js);
+}
+
+/** \brief Get the error message of a failed reader or NULL. */
+const gchar    *json_stream_error(json_stream_t * js)
+{
+    g_return_val_if_fail(js != NULL, NULL);
+
+    return js->error;
+}
+
+/**
+ * \brief Feed a chunk of input to the reader.
+ * \param js The reader.
+ * \param buf The input; it does not have to end on a token boundary.
+ * \param len The number of bytes in buf.
+ * \return FALSE if the input is not valid JSON, see json_stream_error().
+ */
+gboolean json_stream_feed(json_stream_t * js, const gchar * buf, gsize len)
+{
+    gsize           i = 0;
+    gsize           run;
+    gchar           c;
+    gint            h;
+
+    g_return_val_if_fail(js != NULL, FALSE);
+
+    if (js->error != NULL)
+        return FALSE;
+
+    while (i < len)
+    {
+        c = buf[i];
+
+        switch (js->lex)
+        {
+        case JS_LEX_STRING:
+            /* copy plain characters in one go */
+            for (run = 0; i + run < len; run++)
+                if (buf[i + run] == '"' || buf[i + run] == '\\')
+                    break;
+            if (run > 0)
+            {
+                js_flush_surrogate(js);
+                g_string_append_len(js->tok, buf + i, run);
+                i += run;
+            }
+            else if (c == '"')
+            {
+                js_flush_surrogate(js);
+                js->lex = JS_LEX_NONE;
+                if (!js_scalar(js, js->offset + i, JSON_STREAM_STRING))
+                    return FALSE;
+                i++;
+            }
+            else
+            {
+                js->lex = JS_LEX_ESCAPE;
+                i++;
+            }
+
+            if (js->tok->len > JSON_STREAM_MAX_TOKEN)
+                return js_fail(js, js->offset + i, _("String too long"));
+            break;
+
+        case JS_LEX_ESCAPE:
+            js->lex = JS_LEX_STRING;
+            if (c == 'u')
+            {
+                js->lex = JS_LEX_UNICODE;
+                js->ucode = 0;
+                js->udigits = 0;
+                i++;
+                break;
+            }
+
+            js_flush_surrogate(js);
+            switch (c)
+            {
+            case 'b':
+                g_string_append_c(js->tok, '\b');
+                break;
+            case 'f':
+                g_string_append_c(js->tok, '\f');
+                break;
+            case 'n':
+                g_string_append_c(js->tok, '\n');
+                break;
+            case 'r':
+                g_string_append_c(js->tok, '\r');
+                break;
+            case 't':
+                g_string_append_c(js->tok, '\t');
+                break;
+            case '"':
+            case '\\':
+            case '/':
+                g_string_append_c(js->tok, c);
+                break;
+            default:
+                return js_fail(js, js->offset + i, _("Invalid escape"));
+            }
+            i++;
+            break;
+
+        case JS_LEX_UNICODE:
+            h = g_ascii_xdigit_value(c);
+            if (h < 0)
+                return js_fail(js, js->offset + i, _("Invalid escape"));
+
+            js->ucode = (js->ucode << 4) | (gunichar) h;
+            if (++js->udigits == 4)
+            {
+                js_append_unichar(js, js->ucode);
+                js->lex = JS_LEX_STRING;
+            }
+            i++;
+            break;
+
+        case JS_LEX_BARE:
+            if (g_ascii_isalnum(c) || c == '-' || c == '+' || c == '.')
+            {
+                g_string_append_c(js->tok, c);
+                if (js->tok->len > JSON_STREAM_MAX_TOKEN)
+                    return js_fail(js, js->offset + i, _("Number too long"));
+                i++;
+            }
+            else
+            {
+                /* end of token; c is handled as the next token */
+                js->lex = JS_LEX_NONE;
+                if (!js_bare(js, js->offset + i))
+                    return FALSE;
+            }
+            break;
+
+        default:
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+                i++;
+            }
+            else if (c == '"')
+            {
+                g_string_truncate(js->tok, 0);
+                js->usurr = 0;
+                js->lex = JS_LEX_STRING;
+                i++;
+            }
+            else if (g_ascii_isalnum(c) || c == '-')
+            {
+                g_string_truncate(js->tok, 0);
+                g_string_append_c(js->tok, c);
+                js->lex = JS_LEX_BARE;
+                i++;
+            }
+            else
+            {
+                if (!js_punct(js, js->offset + i, c))
+                    return FALSE;
+                i++;
+            }
+            break;
+        }
+    }
+
+    js->offset += len;
+
+    return TRUE;
+}
+
+/**
+ * \brief Tell the reader that the input is complete.
+ * \return FALSE if the input ended before the top level value was complete.
+ */
+gboolean json_stream_finish(json_stream_t * js)
+{
+    g_return_val_if_fail(js != NULL, FALSE);
+
+    if (js->error != NULL)
+        return FALSE;
+
+    if (js->lex == JS_LEX_BARE)
+    {
+        js->lex = JS_LEX_NONE;
+        if (!js_bare(js, js->offset))
+            return FALSE;
+    }
+
+    if (js->lex != JS_LEX_NONE)
+        return js_fail(js, js->offset, _("Unterminated string"));
+
+    if (js->expect != JS_EXPECT_DONE)
+        return js_fail(js, js->offset, _("Unexpected end of input"));
+
+    return TRUE;
+}
+
+/**
+ * \brief Read a JSON file.
+ * \param fname The file name.
+ * \param cb The callbacks.
+ * \param data User data passed to the callbacks.
+ * \return TRUE if the whole file was read successfully.
+ *
+ * The file is read in blocks of JSON_STREAM_BUFSIZE bytes. Errors are
+ * logged; the callbacks may already have been called for the part of the
+ * file that came before the error.
+ */
+gboolean json_stream_parse_file(const gchar * fname,
+                                const json_stream_cb_t * cb, gpointer data)
+{
+    json_stream_t  *js;
+    FILE           *fp;
+    gchar          *buf;
+    gsize           n;
+    gboolean        ok = TRUE;
+
+    fp = g_fopen(fname, "rb");
+    if (fp == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not open %s"), __func__, fname);
+        return FALSE;
+    }
+
+    js = json_stream_new(cb, data);
+    buf = g_malloc(JSON_STREAM_BUFSIZE);
+
+    while (ok && (n = fread(buf, 1, JSON_STREAM_BUFSIZE, fp)) > 0)
+        ok = json_stream_feed(js, buf, n);
+
+    if (ok && ferror(fp))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error reading %s"), __func__, fname);
+        ok = FALSE;
+    }
+    else if (ok)
+    {
+        ok = json_stream_finish(js);
+    }
+
+    if (json_stream_error(js) != NULL)
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: %s: %s"),
+                    __func__, fname, json_stream_error(js));
+
+    g_free(buf);
+    json_stream_free(js);
+    fclose(fp);
+
+    return ok;
+}
+
+/** \brief Record an error at a given byte position; always returns FALSE. */
+static gboolean js_fail(json_stream_t * js, guint64 pos, const gchar * msg)
+{
+    if (js->error == NULL)
+        js->error = g_strdup_printf(_("%s at byte %" G_GUINT64_FORMAT),
+                                    msg, pos);
+
+    return FALSE;
+}
+
+/** \brief Key of the item being reported; NULL outside of objects. */
+static const gchar *js_item_key(json_stream_t * js)
+{
+    if (js->depth > 0 && js->stack[js->depth - 1] == '{')
+        return js->key->str;
+
+    return NULL;
+}
+
+/** \brief Update the expected token after a complete value. */
+static void js_value_done(json_stream_t * js)
+{
+    js->expect = (js->depth == 0) ? JS_EXPECT_DONE : JS_EXPECT_COMMA_OR_END;
+}
+
+/** \brief Handle a complete scalar token in js->tok. */
+static gboolean js_scalar(json_stream_t * js, guint64 pos,
+                          json_stream_type_t type)
+{
+    switch (js->expect)
+    {
+    case JS_EXPECT_KEY:
+    case JS_EXPECT_KEY_OR_END:
+        if (type != JSON_STREAM_STRING)
+            return js_fail(js, pos, _("Expected member name"));
+
+        g_string_assign(js->key, js->tok->str);
+        js->expect = JS_EXPECT_COLON;
+        return TRUE;
+
+    case JS_EXPECT_VALUE:
+    case JS_EXPECT_VALUE_OR_END:
+        if (js->cb.value != NULL)
+            js->cb.value(js->data, js_item_key(js), js->depth, type,
+                         js->tok->str);
+        js_value_done(js);
+        return TRUE;
+
+    default:
+        return js_fail(js, pos, _("Unexpected value"));
+    }
+}
+
+/** \brief Classify and handle a complete number or literal. */
+static gboolean js_bare(json_stream_t * js, guint64 pos)
+{
+    const gchar    *s = js->tok->str;
+    gchar          *end;
+
+    if (!strcmp(s, "true") || !strcmp(s, "false"))
+        return js_scalar(js, pos, JSON_STREAM_BOOL);
+
+    if (!strcmp(s, "null"))
+        return js_scalar(js, pos, JSON_STREAM_NULL);
+
+    if (s[0] == '-' || g_ascii_isdigit(s[0]))
+    {
+        g_ascii_strtod(s, &end);
+        if (end != s && *end == '\0')
+            return js_scalar(js, pos, JSON_STREAM_NUMBER);
+    }
+
+    return js_fail(js, pos, _("Invalid literal"));
+}
+
+/** \brief Handle a structural character. */
+static gboolean js_punct(json_stream_t * js, guint64 pos, gchar c)
+{
+    switch (c)
+    {
+    case '{':
+    case '[':
+        if (js->expect != JS_EXPECT_VALUE &&
+            js->expect != JS_EXPECT_VALUE_OR_END)
+            return js_fail(js, pos, _("Unexpected container"));
+
+        if (js->depth == JSON_STREAM_MAX_DEPTH)
+            return js_fail(js, pos, _("Nesting too deep"));
+
+        if (c == '{' && js->cb.object_start != NULL)
+            js->cb.object_start(js->data, js_item_key(js), js->depth);
+        else if (c == '[' && js->cb.array_start != NULL)
+            js->cb.array_start(js->data, js_item_key(js), js->depth);
+
+        js->stack[js->depth++] = c;
+        js->expect = (c == '{') ? JS_EXPECT_KEY_OR_END :
+            JS_EXPECT_VALUE_OR_END;
+        return TRUE;
+
+    case '}':
+    case ']':
+        if (js->depth == 0 ||
+            js->stack[js->depth - 1] != ((c == '}') ? '{' : '['))
+            return js_fail(js, pos, _("Mismatched bracket"));
+
+        if ((c == '}' && js->expect != JS_EXPECT_KEY_OR_END &&
+             js->expect != JS_EXPECT_COMMA_OR_END) ||
+            (c == ']' && js->expect != JS_EXPECT_VALUE_OR_END &&
+             js->expect != JS_EXPECT_COMMA_OR_END))
+            return js_fail(js, pos, _("Unexpected end of container"));
+
+        js->depth--;
+        if (c == '}' && js->cb.object_end != NULL)
+            js->cb.object_end(js->data, js->depth);
+        else if (c == ']' && js->cb.array_end != NULL)
+            js->cb.array_end(js->data, js->depth);
+
+        js_value_done(js);
+        return TRUE;
+
+    case ':':
+        if (js->expect != JS_EXPECT_COLON)
+            return js_fail(js, pos, _("Unexpected ':'"));
+
+        js->expect = JS_EXPECT_VALUE;
+        return TRUE;
+
+    case ',':
+        if (js->expect != JS_EXPECT_COMMA_OR_END)
+            return js_fail(js, pos, _("Unexpected ','"));
+
+        js->expect = (js->stack[js->depth - 1] == '{') ? JS_EXPECT_KEY :
+            JS_EXPECT_VALUE;
+        return TRUE;
+
+    default:
+        return js_fail(js, pos, _("Unexpected character"));
+    }
+}
+
+/**
+ * \brief Append the code unit of a \uXXXX escape to the current string.
+ *
+ * Surrogate pairs are combined; unpaired surrogates become U+FFFD.
+ * \u0000 is dropped since the values are passed on as C strings.
+ */
+static void js_append_unichar(json_stream_t * js, gunichar c)
+{
+    if (c >= 0xDC00 && c < 0xE000 && js->usurr != 0)
+    {
+        c = 0x10000 + ((js->usurr - 0xD800) << 10) + (c - 0xDC00);
+        js->usurr = 0;
+    }
+    else
+    {
+        js_flush_surrogate(js);
+
+        if (c >= 0xD800 && c < 0xDC00)
+        {
+            js->usurr = c;
+            return;
+        }
+
+        if (c >= 0xDC00 && c < 0xE000)
+            c = 0xFFFD;
+    }
+
+    if (c != 0)
+        g_string_append_unichar(js->tok, c);
+}
+
+/** \brief Replace a high surrogate that is not followed by a low one. */
+static void js_flush_surrogate(json_stream_t * js)
+{
+    if (js->usurr != 0)
+    {
+        g_string_append_unichar(js->tok, 0xFFFD);
+        js->usurr = 0;
+    }
+}
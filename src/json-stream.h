@@ -0,0 +1,87 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H 1
+
+#include <glib.h>
+
+
+/** \brief Size of the read buffer used by json_stream_parse_file(). */
+#define JSON_STREAM_BUFSIZE     65536
+
+/** \brief Longest string or number accepted in the input. */
+#define JSON_STREAM_MAX_TOKEN   65536
+
+/** \brief Deepest nesting of objects and arrays accepted in the input. */
+#define JSON_STREAM_MAX_DEPTH   64
+
+
+/** \brief Type of a scalar value. */
+typedef enum {
+    JSON_STREAM_NULL = 0,       /*!< null */
+    JSON_STREAM_BOOL,           /*!< true or false */
+    JSON_STREAM_NUMBER,         /*!< Number; the text is as in the input */
+    JSON_STREAM_STRING          /*!< String; the text is unescaped UTF-8 */
+} json_stream_type_t;
+
+/**
+ * \brief Callbacks of the streaming JSON reader.
+ *
+ * The key is the member name when the item is a member of an object and
+ * NULL when it is an array element or the top level value. The depth is
+ * the number of enclosing objects and arrays, so the elements of a top
+ * level array have depth 1. Any of the callbacks may be NULL.
+ *
+ * The text of a value is only valid during the callback. Booleans are
+ * passed as "true" or "false", null as "null".
+ */
+typedef struct {
+    void (*object_start) (gpointer data, const gchar *key, guint depth);
+    void (*object_end)   (gpointer data, guint depth);
+    void (*array_start)  (gpointer data, const gchar *key, guint depth);
+    void (*array_end)    (gpointer data, guint depth);
+    void (*value)        (gpointer data, const gchar *key, guint depth,
+                          json_stream_type_t type, const gchar *text);
+} json_stream_cb_t;
+
+/** \brief Opaque streaming JSON reader. */
+typedef struct _json_stream json_stream_t;
+
+
+json_stream_t  *json_stream_new        (const json_stream_cb_t *cb,
+                                        gpointer data);
+void            json_stream_free       (json_stream_t *js);
+gboolean        json_stream_feed       (json_stream_t *js,
+                                        const gchar *buf, gsize len);
+gboolean        json_stream_finish     (json_stream_t *js);
+const gchar    *json_stream_error      (json_stream_t *js);
+gboolean        json_stream_parse_file (const gchar *fname,
+                                        const json_stream_cb_t *cb,
+                                        gpointer data);
+
+#endif
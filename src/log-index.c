@@ -0,0 +1,308 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Index of a log file for the log browser.
+ *
+ * The log file is memory mapped and scanned once to record where each line
+ * starts and which level it has. The lines are only split into their fields
+ * when they are shown, so opening a large log file costs one pass over the
+ * file and eight bytes per line. Filtering by level and time only looks at
+ * the index and the time stamps at the beginning of the lines.
+ *
+ * Gpredict 1.3 and earlier had 4 fields:
+ *   Date and time | Message source | Message type | Message
+ * As of 1.4 we no longer have message source:
+ *   Date and time | Message type | Message
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "log-index.h"
+#include "sat-log.h"
+
+
+/** \brief Lines allocated for the first block of the index. */
+#define LOG_INDEX_CHUNK 4096
+
+/** \brief Offset and level of an index entry. */
+#define LINE_OFFSET(e)  ((gsize) ((e) >> LOG_INDEX_LEVEL_BITS))
+#define LINE_LEVEL(e)   ((guint) ((e) & ((1 << LOG_INDEX_LEVEL_BITS) - 1)))
+
+/** \brief Level mask with all levels. */
+#define ALL_LEVELS      ((1u << LOG_INDEX_LEVELS) - 1)
+
+
+static gsize    parse_line(const gchar * data, gsize start, gsize len,
+                           log_line_t * line);
+
+
+/**
+ * \brief Open and index a log file.
+ * \param fname The name of the log file.
+ * \return The index or NULL if the file can not be opened.
+ */
+log_index_t    *log_index_open(const gchar * fname)
+{
+    log_index_t    *idx;
+    GError         *error = NULL;
+    GMappedFile    *file;
+    log_line_t      line;
+    gsize           pos, next;
+    guint           alloc = 0;
+
+    file = g_mapped_file_new(fname, FALSE, &error);
+    if (file == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error opening log file (%s)"),
+                    __func__, error->message);
+        g_clear_error(&error);
+        return NULL;
+    }
+
+    idx = g_new0(log_index_t, 1);
+    idx->file = file;
+    idx->data = g_mapped_file_get_contents(file);
+    idx->len = g_mapped_file_get_length(file);
+
+    for (pos = 0; pos < idx->len; pos = next)
+    {
+        next = parse_line(idx->data, pos, idx->len, &line);
+
+        /* skip empty lines */
+        if (line.time_len == 0 && line.msg_len == 0)
+            continue;
+
+        if (idx->nlines == alloc)
+        {
+            alloc = (alloc == 0) ? LOG_INDEX_CHUNK : 2 * alloc;
+            idx->lines = g_renew(guint64, idx->lines, alloc);
+        }
+
+        idx->lines[idx->nlines++] =
+            ((guint64) pos << LOG_INDEX_LEVEL_BITS) | line.level;
+        idx->count[line.level]++;
+    }
+
+    /* give back what was allocated in advance */
+    idx->lines = g_renew(guint64, idx->lines, idx->nlines);
+    idx->nrows = idx->nlines;
+
+    return idx;
+}
+
+/** \brief Free a log index and unmap the file. */
+void log_index_free(log_index_t * idx)
+{
+    if (idx == NULL)
+        return;
+
+    g_mapped_file_unref(idx->file);
+    g_free(idx->lines);
+    g_free(idx->rows);
+    g_free(idx);
+}
+
+/**
+ * \brief Select the lines to show.
+ * \param idx The log index.
+ * \param levels Bit mask of the levels to show, 1 << level.
+ * \param from Earliest time stamp to show or NULL.
+ * \param to Latest time stamp to show or NULL.
+ *
+ * The time stamps have the format of the log file, YYYY/MM/DD HH:MM:SS.
+ * They may be shortened; "2017/05/01" as to includes the whole day. Lines
+ * without a time stamp are hidden when a time is given.
+ */
+void log_index_filter(log_index_t * idx, guint levels,
+                      const gchar * from, const gchar * to)
+{
+    log_line_t      line;
+    gsize           nfrom, nto;
+    guint           i;
+
+    g_return_if_fail(idx != NULL);
+
+    nfrom = (from != NULL) ? strlen(from) : 0;
+    nto = (to != NULL) ? strlen(to) : 0;
+
+    g_free(idx->rows);
+    idx->rows = NULL;
+    idx->nrows = idx->nlines;
+
+    if (nfrom == 0 && nto == 0 && (levels & ALL_LEVELS) == ALL_LEVELS)
+        return;
+
+    idx->rows = g_new(guint, idx->nlines);
+    idx->nrows = 0;
+
+    for (i = 0; i < idx->nlines; i++)
+    {
+        if (!(levels & (1u << LINE_LEVEL(idx->lines[i]))))
+            continue;
+
+        if (nfrom > 0 || nto > 0)
+        {
+            parse_line(idx->data, LINE_OFFSET(idx->lines[i]), idx->len,
+                       &line);
+
+            if (line.time_len == 0)
+                continue;
+
+            /* a line time that is a prefix of from is earlier */
+            if (nfrom > 0 &&
+                (memcmp(line.time, from, MIN(line.time_len, nfrom)) < 0 ||
+                 (memcmp(line.time, from, MIN(line.time_len, nfrom)) == 0 &&
+                  line.time_len < nfrom)))
+                continue;
+
+            /* only compare the part given in to */
+            if (nto > 0 &&
+                memcmp(line.time, to, MIN(line.time_len, nto)) > 0)
+                continue;
+        }
+
+        idx->rows[idx->nrows++] = i;
+    }
+
+    idx->rows = g_renew(guint, idx->rows, idx->nrows);
+}
+
+/**
+ * \brief Get the fields of a row.
+ * \param idx The log index.
+ * \param row The row; rows are the lines passing the current filter.
+ * \param line The fields; they point into the log file and are not
+ *             terminated.
+ */
+void log_index_get(log_index_t * idx, guint row, log_line_t * line)
+{
+    guint           i;
+
+    g_return_if_fail(idx != NULL && row < idx->nrows);
+
+    i = (idx->rows != NULL) ? idx->rows[row] : row;
+    parse_line(idx->data, LINE_OFFSET(idx->lines[i]), idx->len, line);
+}
+
+/** \brief Parse the number of a level field; -1 if it is not a number. */
+static gint parse_level(const gchar * s, gsize len)
+{
+    gint            level = 0;
+    gsize           i;
+
+    if (len == 0 || len > 2)
+        return -1;
+
+    for (i = 0; i < len; i++)
+    {
+        if (!g_ascii_isdigit(s[i]))
+            return -1;
+        level = 10 * level + (s[i] - '0');
+    }
+
+    return level;
+}
+
+/**
+ * \brief Split a line into its fields.
+ * \param data The contents of the log file.
+ * \param start Offset of the line.
+ * \param len Length of the log file.
+ * \param line The fields.
+ * \return The offset of the next line.
+ *
+ * Lines that do not have the expected fields are shown as errors with the
+ * whole line as message, like the old log browser did.
+ */
+static gsize parse_line(const gchar * data, gsize start, gsize len,
+                        log_line_t * line)
+{
+    const gchar    *s = data + start;
+    const gchar    *nl;
+    const gchar    *p1, *p2, *p3;
+    gsize           n, next;
+    gint            level;
+
+    nl = memchr(s, '\n', len - start);
+    if (nl != NULL)
+    {
+        n = nl - s;
+        next = start + n + 1;
+    }
+    else
+    {
+        n = len - start;
+        next = len;
+    }
+
+    if (n > 0 && s[n - 1] == '\r')
+        n--;
+
+    line->time = s;
+    line->time_len = 0;
+    line->level = SAT_LOG_LEVEL_ERROR;
+    line->msg = s;
+    line->msg_len = n;
+
+    p1 = memchr(s, SAT_LOG_MSG_SEPARATOR[0], n);
+    if (p1 == NULL)
+        return next;
+
+    p2 = memchr(p1 + 1, SAT_LOG_MSG_SEPARATOR[0], s + n - p1 - 1);
+    if (p2 == NULL)
+        return next;
+
+    level = parse_level(p1 + 1, p2 - p1 - 1);
+    if (level < 0)
+    {
+        /* v1.3 and earlier with message source */
+        p3 = memchr(p2 + 1, SAT_LOG_MSG_SEPARATOR[0], s + n - p2 - 1);
+        if (p3 == NULL)
+            return next;
+
+        level = parse_level(p2 + 1, p3 - p2 - 1);
+        p2 = p3;
+    }
+
+    if (level < 0 || level >= LOG_INDEX_LEVELS)
+        return next;
+
+    line->time_len = p1 - s;
+    line->level = level;
+    line->msg = p2 + 1;
+    line->msg_len = s + n - p2 - 1;
+
+    return next;
+}
@@ -0,0 +1,81 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H 1
+
+#include <glib.h>
+#include "sat-log.h"
+
+
+/** \brief Number of levels in a log file, SAT_LOG_LEVEL_NONE..DEBUG. */
+#define LOG_INDEX_LEVELS    (SAT_LOG_LEVEL_DEBUG + 1)
+
+/** \brief Bits of an index entry used for the level. */
+#define LOG_INDEX_LEVEL_BITS 3
+
+/** \brief Length of the time stamp at the beginning of a line. */
+#define LOG_INDEX_TIME_LEN  19
+
+
+/**
+ * \brief Index of a memory mapped log file.
+ *
+ * Each line of the file has one entry holding the offset of the line and
+ * its level, so that the index takes eight bytes per line regardless of
+ * the length of the messages. The rows are the lines that pass the current
+ * filter.
+ */
+typedef struct {
+    GMappedFile    *file;           /*!< The mapped log file */
+    const gchar    *data;           /*!< Contents of the file */
+    gsize           len;            /*!< Length of the file */
+    guint64        *lines;          /*!< offset << LOG_INDEX_LEVEL_BITS | level */
+    guint           nlines;         /*!< Number of lines */
+    guint           count[LOG_INDEX_LEVELS];    /*!< Lines per level */
+    guint          *rows;           /*!< Lines passing the filter */
+    guint           nrows;          /*!< Number of rows */
+} log_index_t;
+
+/** \brief Fields of one line; the strings point into the mapped file. */
+typedef struct {
+    const gchar    *time;           /*!< Time stamp */
+    gsize           time_len;       /*!< Length of the time stamp */
+    sat_log_level_t level;          /*!< Message level */
+    const gchar    *msg;            /*!< The message */
+    gsize           msg_len;        /*!< Length of the message */
+} log_line_t;
+
+
+log_index_t    *log_index_open   (const gchar *fname);
+void            log_index_free   (log_index_t *idx);
+void            log_index_filter (log_index_t *idx, guint levels,
+                                  const gchar *from, const gchar *to);
+void            log_index_get    (log_index_t *idx, guint row,
+                                  log_line_t *line);
+
+#endif
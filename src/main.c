@@ -54,6 +54,7 @@
 #include "sat-cfg.h"
 #include "sat-debugger.h"
 #include "sat-log.h"
+#include "startup-profile.h"
 
 
 /** Main application widget. */
@@ -65,12 +66,23 @@ static gboolean cleantle = FALSE;
 /** Command line flag for cleaning TRSP data */
 static gboolean cleantrsp = FALSE;
 
+/** Trace file for --profile-startup, NULL if not profiling. */
+static gchar   *profile_file = NULL;
+
+static gboolean profile_startup_cb(const gchar * option_name,
+                                   const gchar * value, gpointer data,
+                                   GError ** error);
+
 /** \brief Command line options. */
 static GOptionEntry entries[] = {
     {"clean-tle", 0, 0, G_OPTION_ARG_NONE, &cleantle,
      "Clean the TLE data in user's configuration directory", NULL},
     {"clean-trsp", 0, 0, G_OPTION_ARG_NONE, &cleantrsp,
      "Clean the transponder data in user's configuration directory", NULL},
+    {"profile-startup", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK,
+     profile_startup_cb,
+     "Print startup timing and write a trace to FILE (default: logs/startup-trace.json)",
+     "FILE"},
     {NULL}
 };
 
@@ -98,6 +110,7 @@ static void     tle_mon_stop(void);
 static gpointer update_tle_thread(gpointer data);
 static void     clean_tle(void);
 static void     clean_trsp(void);
+static gboolean profile_finish_cb(gpointer data);
 
 #ifdef G_OS_WIN32
 static void     InitWinSock2(void);
@@ -110,6 +123,8 @@ int main(int argc, char *argv[])
     GError         *err = NULL;
     GOptionContext *context;
     guint           error = 0;
+    gint64          t0 = g_get_monotonic_time();
+    gint64          t;
 
 
 
@@ -132,10 +147,16 @@ int main(int argc, char *argv[])
     if (!g_option_context_parse(context, &argc, &argv, &err))
         g_print(_("Option parsing failed: %s\n"), err->message);
 
+    /* origin is the top of main() so gtk_init() is included in the total */
+    if (profile_file != NULL)
+        startup_profile_init(profile_file, t0);
+
     /* start logger first, so that we can catch error messages if any */
     sat_log_init();
 
+    t = startup_profile_begin();
     sat_cfg_load();
+    startup_profile_end(t, "sat_cfg_load", NULL);
 
     /* get logging level */
     sat_log_set_level(sat_cfg_get_int(SAT_CFG_INT_LOG_LEVEL));
@@ -148,7 +169,9 @@ int main(int argc, char *argv[])
         clean_trsp();
 
     /* check that user settings are ok */
+    t = startup_profile_begin();
     error = first_time_check_run();
+    startup_profile_end(t, "first_time_check_run", NULL);
 
     if (error)
     {
@@ -162,8 +185,14 @@ int main(int argc, char *argv[])
     }
 
     /* create application */
+    t = startup_profile_begin();
     gpredict_app_create();
     gtk_widget_show_all(app);
+    startup_profile_end(t, "gpredict_app_create", NULL);
+
+    /* startup is over once the main loop has drawn the first frame */
+    if (profile_file != NULL)
+        g_idle_add_full(G_PRIORITY_LOW, profile_finish_cb, NULL, NULL);
 
     //sat_debugger_run ();
 
@@ -178,6 +207,7 @@ int main(int argc, char *argv[])
     gtk_main();
 
     g_option_context_free(context);
+    g_free(profile_file);
 
     sat_cfg_save();
     sat_log_close();
@@ -676,3 +706,42 @@ static void clean_trsp(void)
     g_free(targetdirname);
 
 }
+
+/** \brief Handle --profile-startup[=FILE]. */
+static gboolean profile_startup_cb(const gchar * option_name,
+                                   const gchar * value, gpointer data,
+                                   GError ** error)
+{
+    gchar          *confdir;
+
+    (void)option_name;
+    (void)data;
+    (void)error;
+
+    g_free(profile_file);
+
+    if (value != NULL && value[0] != '\0')
+    {
+        profile_file = g_strdup(value);
+    }
+    else
+    {
+        confdir = get_user_conf_dir();
+        profile_file = g_strconcat(confdir, G_DIR_SEPARATOR_S, "logs",
+                                   G_DIR_SEPARATOR_S, "startup-trace.json",
+                                   NULL);
+        g_free(confdir);
+    }
+
+    return TRUE;
+}
+
+/** \brief Finish the startup profile when the main loop becomes idle. */
+static gboolean profile_finish_cb(gpointer data)
+{
+    (void)data;
+
+    startup_profile_finish();
+
+    return FALSE;
+}
@@ -0,0 +1,424 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Shared cache of scaled map images.
+ *
+ * Every map view used to decode the map file, shift it to the centre
+ * longitude and scale the full map to the view size on each resize. Large
+ * maps make this slow, and every view of every module repeated the work.
+ *
+ * The images are now shared between all views with the same map file and
+ * centre longitude. Each image keeps a pyramid of half-size levels, so a
+ * resize only needs to scale down the nearest larger level, and the most
+ * recently scaled sizes are kept so that views with the same size share
+ * the same pixbuf. When SAT_CFG_BOOL_MAP_CACHE_DISK is set, the pyramid
+ * levels are also stored as PNG files in the user cache directory.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "map-cache.h"
+#include "map-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+
+static void     map_image_free(map_image_t * img);
+static void     load_full_map(map_image_t * img);
+static void     set_levels(map_image_t * img);
+static GdkPixbuf *get_level(map_image_t * img, guint level);
+static gchar   *level_file_name(map_image_t * img, guint level);
+static void     save_level(map_image_t * img, guint level);
+
+/** \brief The open map images keyed by file name and centre longitude. */
+static GHashTable *images = NULL;
+
+
+/**
+ * \brief Get a map image.
+ * \param file The map file.
+ * \param clon The longitude at the centre of the map [deg].
+ * \return The map image, which must be released with map_cache_close().
+ *
+ * If the file can not be loaded, a dummy image is used so that the caller
+ * always gets a valid map.
+ */
+map_image_t    *map_cache_open(const gchar * file, gfloat clon)
+{
+    map_image_t    *img;
+    gchar          *key;
+    gchar          *buff;
+    GStatBuf        st;
+
+    if (images == NULL)
+        images = g_hash_table_new(g_str_hash, g_str_equal);
+
+    key = g_strdup_printf("%s|%.1f", file, clon);
+    img = g_hash_table_lookup(images, key);
+    if (img != NULL)
+    {
+        g_free(key);
+        img->users++;
+        return img;
+    }
+
+    img = g_new0(map_image_t, 1);
+    img->key = key;
+    img->file = g_strdup(file);
+    img->clon = clon;
+    img->users = 1;
+
+    /* the disk cache files are only valid for this version of the file */
+    if (g_stat(file, &st) == 0)
+        buff = g_strdup_printf("%s|%ld|%ld|%.1f", file, (glong) st.st_mtime,
+                               (glong) st.st_size, clon);
+    else
+        buff = g_strdup(key);
+    img->stamp = g_compute_checksum_for_string(G_CHECKSUM_MD5, buff, -1);
+    g_free(buff);
+
+    /* the size is all we need until a level is requested */
+    if (gdk_pixbuf_get_file_info(file, &img->width, &img->height) == NULL)
+        load_full_map(img);
+    else
+        set_levels(img);
+
+    g_hash_table_insert(images, img->key, img);
+
+    return img;
+}
+
+
+/**
+ * \brief Release a map image.
+ * \param img The map image obtained from map_cache_open().
+ *
+ * The image is freed when it is no longer used by any map view.
+ */
+void map_cache_close(map_image_t * img)
+{
+    if (img == NULL || --img->users > 0)
+        return;
+
+    g_hash_table_remove(images, img->key);
+    map_image_free(img);
+}
+
+
+/**
+ * \brief Get the map scaled to a given size.
+ * \param img The map image.
+ * \param width The requested width.
+ * \param height The requested height.
+ * \return A new reference to the scaled map.
+ *
+ * The map is scaled from the smallest pyramid level that is at least as
+ * large as the requested size.
+ */
+GdkPixbuf      *map_cache_get_scaled(map_image_t * img, gint width,
+                                     gint height)
+{
+    GdkPixbuf      *pbuf;
+    GdkPixbuf      *level;
+    guint           i, k;
+    gint            mapw, maph;
+
+    width = MAX(width, 1);
+    height = MAX(height, 1);
+
+    /* recently used size? */
+    for (i = 0; i < MAP_CACHE_SCALED && img->scaled[i] != NULL; i++)
+    {
+        pbuf = img->scaled[i];
+        if (gdk_pixbuf_get_width(pbuf) == width &&
+            gdk_pixbuf_get_height(pbuf) == height)
+        {
+            /* move it to the front */
+            for (; i > 0; i--)
+                img->scaled[i] = img->scaled[i - 1];
+            img->scaled[0] = pbuf;
+
+            return g_object_ref(pbuf);
+        }
+    }
+
+    /* find the smallest level that is large enough; start over if the
+       map turned out to be unreadable and was replaced by the dummy */
+    do
+    {
+        mapw = img->width;
+        maph = img->height;
+
+        k = 0;
+        while (k + 1 < img->nlevels &&
+               (img->width >> (k + 1)) >= width &&
+               (img->height >> (k + 1)) >= height)
+            k++;
+
+        level = get_level(img, k);
+    }
+    while (img->width != mapw || img->height != maph);
+
+    if (gdk_pixbuf_get_width(level) == width &&
+        gdk_pixbuf_get_height(level) == height)
+        pbuf = g_object_ref(level);
+    else
+        pbuf = gdk_pixbuf_scale_simple(level, width, height,
+                                       GDK_INTERP_BILINEAR);
+
+    /* store it as the most recent one */
+    if (img->scaled[MAP_CACHE_SCALED - 1] != NULL)
+        g_object_unref(img->scaled[MAP_CACHE_SCALED - 1]);
+    for (i = MAP_CACHE_SCALED - 1; i > 0; i--)
+        img->scaled[i] = img->scaled[i - 1];
+    img->scaled[0] = pbuf;
+
+    return g_object_ref(pbuf);
+}
+
+
+static void map_image_free(map_image_t * img)
+{
+    guint           i;
+
+    for (i = 0; i < MAP_CACHE_LEVELS; i++)
+        if (img->levels[i] != NULL)
+            g_object_unref(img->levels[i]);
+
+    for (i = 0; i < MAP_CACHE_SCALED; i++)
+        if (img->scaled[i] != NULL)
+            g_object_unref(img->scaled[i]);
+
+    g_free(img->key);
+    g_free(img->file);
+    g_free(img->stamp);
+    g_free(img);
+}
+
+
+/** \brief Compute the number of pyramid levels from the map size. */
+static void set_levels(map_image_t * img)
+{
+    guint           i;
+
+    img->nlevels = 1;
+    for (i = 1; i < MAP_CACHE_LEVELS; i++)
+    {
+        if ((img->width >> i) < MAP_CACHE_MIN_WIDTH)
+            break;
+        img->nlevels++;
+    }
+}
+
+
+/**
+ * \brief Decode the map file and shift it to the centre longitude.
+ *
+ * If the decoded size differs from the size read from the file header,
+ * e.g. because the dummy map is used, the other levels are discarded and
+ * the pyramid is sized again.
+ */
+static void load_full_map(map_image_t * img)
+{
+    GError         *error = NULL;
+    GdkPixbuf      *tmpbuf;
+    guint           i;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Loading map file %s"), __func__, img->file);
+
+    tmpbuf = gdk_pixbuf_new_from_file(img->file, &error);
+
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error loading map file (%s)"),
+                    __func__, error->message);
+        g_clear_error(&error);
+
+        /* create a dummy GdkPixbuf to avoid crash */
+        tmpbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 400, 200);
+        gdk_pixbuf_fill(tmpbuf, 0x0F0F0F0F);
+    }
+
+    /* create a blank map with same parameters as tmpbuf */
+    img->levels[0] = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
+                                    FALSE,
+                                    gdk_pixbuf_get_bits_per_sample(tmpbuf),
+                                    gdk_pixbuf_get_width(tmpbuf),
+                                    gdk_pixbuf_get_height(tmpbuf));
+
+    map_tools_shift_center(tmpbuf, img->levels[0], img->clon);
+    g_object_unref(tmpbuf);
+
+    if (img->width == gdk_pixbuf_get_width(img->levels[0]) &&
+        img->height == gdk_pixbuf_get_height(img->levels[0]))
+        return;
+
+    img->width = gdk_pixbuf_get_width(img->levels[0]);
+    img->height = gdk_pixbuf_get_height(img->levels[0]);
+    set_levels(img);
+
+    for (i = 1; i < MAP_CACHE_LEVELS; i++)
+    {
+        if (img->levels[i] != NULL)
+        {
+            g_object_unref(img->levels[i]);
+            img->levels[i] = NULL;
+        }
+    }
+
+    for (i = 0; i < MAP_CACHE_SCALED; i++)
+    {
+        if (img->scaled[i] != NULL)
+        {
+            g_object_unref(img->scaled[i]);
+            img->scaled[i] = NULL;
+        }
+    }
+}
+
+
+/**
+ * \brief Get a pyramid level, creating it if necessary.
+ *
+ * A level is read from the disk cache if possible, otherwise it is scaled
+ * down from the previous level.
+ */
+static GdkPixbuf *get_level(map_image_t * img, guint level)
+{
+    gint            width, height;
+    gchar          *fname;
+    GdkPixbuf      *src;
+
+    if (img->levels[level] != NULL)
+        return img->levels[level];
+
+    if (level == 0)
+    {
+        load_full_map(img);
+        return img->levels[0];
+    }
+
+    width = img->width >> level;
+    height = img->height >> level;
+
+    if (sat_cfg_get_bool(SAT_CFG_BOOL_MAP_CACHE_DISK))
+    {
+        fname = level_file_name(img, level);
+        if (g_file_test(fname, G_FILE_TEST_EXISTS))
+        {
+            img->levels[level] = gdk_pixbuf_new_from_file(fname, NULL);
+
+            /* discard files we did not write */
+            if (img->levels[level] != NULL &&
+                (gdk_pixbuf_get_width(img->levels[level]) != width ||
+                 gdk_pixbuf_get_height(img->levels[level]) != height))
+            {
+                g_object_unref(img->levels[level]);
+                img->levels[level] = NULL;
+            }
+        }
+        g_free(fname);
+
+        if (img->levels[level] != NULL)
+            return img->levels[level];
+    }
+
+    /* creating level 0 may change the size of the map */
+    src = get_level(img, level - 1);
+    width = MAX(img->width >> level, 1);
+    height = MAX(img->height >> level, 1);
+
+    img->levels[level] = gdk_pixbuf_scale_simple(src, width, height,
+                                                 GDK_INTERP_BILINEAR);
+
+    if (sat_cfg_get_bool(SAT_CFG_BOOL_MAP_CACHE_DISK))
+        save_level(img, level);
+
+    return img->levels[level];
+}
+
+
+/** \brief Get the disk cache file name of a pyramid level. */
+static gchar   *level_file_name(map_image_t * img, guint level)
+{
+    gchar          *name;
+    gchar          *fname;
+
+    name = g_strdup_printf("%s-%u.png", img->stamp, level);
+    fname = g_build_filename(g_get_user_cache_dir(), "Gpredict", "maps",
+                             name, NULL);
+    g_free(name);
+
+    return fname;
+}
+
+
+/** \brief Store a pyramid level in the disk cache. */
+static void save_level(map_image_t * img, guint level)
+{
+    GError         *error = NULL;
+    gchar          *fname;
+    gchar          *tmpname;
+    gchar          *dir;
+
+    fname = level_file_name(img, level);
+    tmpname = g_strconcat(fname, ".tmp", NULL);
+
+    dir = g_path_get_dirname(fname);
+    g_mkdir_with_parents(dir, 0755);
+    g_free(dir);
+
+    /* write to a temporary file so that other instances never see
+       a partial file */
+    if (gdk_pixbuf_save(img->levels[level], tmpname, "png", &error,
+                        "compression", "1", NULL))
+    {
+        g_rename(tmpname, fname);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not save map cache file %s (%s)"),
+                    __func__, fname, error->message);
+        g_clear_error(&error);
+        g_remove(tmpname);
+    }
+
+    g_free(tmpname);
+    g_free(fname);
+}
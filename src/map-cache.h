@@ -0,0 +1,72 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H 1
+
+#include <glib.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+
+/** \brief Maximum number of pyramid levels, including the full map. */
+#define MAP_CACHE_LEVELS    8
+
+/** \brief Smallest width of a pyramid level [pixels]. */
+#define MAP_CACHE_MIN_WIDTH 256
+
+/** \brief Number of scaled maps kept per map image. */
+#define MAP_CACHE_SCALED    4
+
+
+/** \brief A map image shared by all map views using the same file and centre.
+ *
+ * The map is kept as a pyramid where each level has half the size of the
+ * previous one. Level 0 is the full map, shifted to the centre longitude.
+ * Levels are created when they are first needed and can optionally be
+ * persisted in the user cache directory, so that the full map does not need
+ * to be decoded at all when the views are smaller than level 1.
+ */
+typedef struct {
+    gchar      *key;        /*!< Hash key: file name and centre longitude */
+    gchar      *file;       /*!< The map file */
+    gfloat      clon;       /*!< Centre longitude [deg] */
+    gchar      *stamp;      /*!< Identifies file contents for the disk cache */
+    gint        width;      /*!< Width of the full map */
+    gint        height;     /*!< Height of the full map */
+    guint       nlevels;    /*!< Number of pyramid levels */
+    GdkPixbuf  *levels[MAP_CACHE_LEVELS];   /*!< Pyramid, NULL until needed */
+    GdkPixbuf  *scaled[MAP_CACHE_SCALED];   /*!< Recently scaled maps */
+    guint       users;      /*!< Number of map views using this image */
+} map_image_t;
+
+
+map_image_t    *map_cache_open       (const gchar *file, gfloat clon);
+void            map_cache_close      (map_image_t *img);
+GdkPixbuf      *map_cache_get_scaled (map_image_t *img, gint width,
+                                      gint height);
+
+#endif
@@ -59,6 +59,7 @@
 #include "mod-mgr.h"
 #include "mod-cfg.h"
 #include "compat.h"
+#include "startup-profile.h"
 #ifdef HAVE_CONFIG_H
 #  include <build-config.h>
 #endif
@@ -73,6 +74,12 @@ static GSList *modules = NULL;
 /** \brief The notebook widget for docked modules */
 static GtkWidget *nbook = NULL;
 
+/** \brief Modules are being restored; do not create views on page switch */
+static gboolean restoring = FALSE;
+
+/** \brief Number of threads reading satellites if the CPU count is not known */
+#define MOD_MGR_THREADS 4
+
 
 static void update_window_title (void);
 static void switch_page_cb      (GtkNotebook     *notebook,
@@ -83,6 +90,16 @@ static void switch_page_cb      (GtkNotebook     *notebook,
 static void create_module_window (GtkWidget *module);
 
 
+/** \brief Read the satellites of a module in a worker thread. */
+static void
+load_sats_job (gpointer data, gpointer user_data)
+{
+    (void) user_data; /* avoid unused parameter compiler warning */
+
+    gtk_sat_module_read_sats ((GtkSatModule *) data);
+}
+
+
 /** \brief Create and initialise module manager.
  *  \return The main module container widget (GtkNotebook).
  *
@@ -91,6 +108,9 @@ static void create_module_window (GtkWidget *module);
  * caller, the function checks whether any modules should be restored (ie.
  * openend), if yes, it creates them and adds them to the notebook.
  *
+ * The satellites of all modules are read in parallel on a thread pool.
+ * Docked modules are started lazily, and only the views of the current
+ * page are created; the other pages get their views when first shown.
  */
 GtkWidget *
 mod_mgr_create (void)
@@ -102,6 +122,12 @@ mod_mgr_create (void)
     gchar     *modfile;
     gchar     *confdir;
     gint    page;
+    GPtrArray *opened;
+    GThreadPool *pool;
+    GError    *err = NULL;
+    gint    nthreads;
+    gboolean   docked;
+    gint64     t;
 
     /* create notebook */
     nbook = gtk_notebook_new ();
@@ -118,6 +144,7 @@ mod_mgr_create (void)
     if (openmods) {
         mods = g_strsplit (openmods, ";", 0);
         count = g_strv_length (mods);
+        opened = g_ptr_array_new ();
 
         for (i = 0; i < count; i++) {
 
@@ -127,23 +154,11 @@ mod_mgr_create (void)
                                    mods[i], ".mod", NULL);
             g_free (confdir);
             
-            /* create module */
-            module = gtk_sat_module_new (modfile);
+            /* create module without satellites */
+            module = gtk_sat_module_open (modfile);
 
             if (IS_GTK_SAT_MODULE (module)) {
-
-                /* if module state was window or user does not want to restore the
-                   state of the modules, pack the module into the notebook */
-                if ((GTK_SAT_MODULE (module)->state == GTK_SAT_MOD_STATE_DOCKED) ||
-                    !sat_cfg_get_bool (SAT_CFG_BOOL_MOD_STATE)) {
-
-                    mod_mgr_add_module (module, TRUE);
-
-                }
-                else {
-                    mod_mgr_add_module (module, FALSE);
-                    create_module_window (module);
-                }
+                g_ptr_array_add (opened, module);
             }
             else {
                 sat_log_log (SAT_LOG_LEVEL_ERROR,
@@ -158,10 +173,72 @@ mod_mgr_create (void)
 
         }
 
+        /* read the satellites of all modules in parallel */
+        t = startup_profile_begin ();
+#if GLIB_CHECK_VERSION(2, 36, 0)
+        nthreads = g_get_num_processors ();
+#else
+        nthreads = MOD_MGR_THREADS;
+#endif
+        pool = g_thread_pool_new (load_sats_job, NULL, nthreads, FALSE, &err);
+        for (i = 0; i < (gint) opened->len; i++) {
+            if (pool != NULL)
+                g_thread_pool_push (pool, g_ptr_array_index (opened, i), NULL);
+            else
+                load_sats_job (g_ptr_array_index (opened, i), NULL);
+        }
+
+        if (pool != NULL) {
+            g_thread_pool_free (pool, FALSE, TRUE);
+        }
+        else {
+            sat_log_log (SAT_LOG_LEVEL_ERROR,
+                         _("%s: Failed to create worker threads (%s)"),
+                         __func__, err->message);
+            g_clear_error (&err);
+        }
+        startup_profile_end (t, "mod_mgr_read_sats", "%u modules", opened->len);
+
+        /* adding pages switches to them; keep them lazy meanwhile */
+        restoring = TRUE;
+
+        for (i = 0; i < (gint) opened->len; i++) {
+
+            module = GTK_WIDGET (g_ptr_array_index (opened, i));
+
+            /* if module state was window or user does not want to restore the
+               state of the modules, pack the module into the notebook */
+            docked = (GTK_SAT_MODULE (module)->state == GTK_SAT_MOD_STATE_DOCKED) ||
+                !sat_cfg_get_bool (SAT_CFG_BOOL_MOD_STATE);
+
+            gtk_sat_module_start (GTK_SAT_MODULE (module), docked);
+
+            if (docked) {
+                mod_mgr_add_module (module, TRUE);
+            }
+            else {
+                mod_mgr_add_module (module, FALSE);
+                create_module_window (module);
+            }
+        }
+
+        restoring = FALSE;
+
         /* set to the page open when gpredict was closed */
         if (page >=0)
             gtk_notebook_set_current_page (GTK_NOTEBOOK (nbook), page);
 
+        /* create the views of the visible page */
+        page = gtk_notebook_get_current_page (GTK_NOTEBOOK (nbook));
+        if (page >= 0) {
+            module = gtk_notebook_get_nth_page (GTK_NOTEBOOK (nbook), page);
+            gtk_sat_module_materialize (GTK_SAT_MODULE (module));
+        }
+
+        sat_log_log (SAT_LOG_LEVEL_INFO,
+                     _("%s: Restored %u modules"), __func__, opened->len);
+
+        g_ptr_array_free (opened, TRUE);
         g_strfreev (mods);
         g_free (openmods);
 
@@ -587,6 +664,10 @@ static void switch_page_cb      (GtkNotebook     *notebook,
                              gtk_notebook_get_tab_label_text (GTK_NOTEBOOK (nbook), pg));
     gtk_window_set_title (GTK_WINDOW (app), title);
     g_free (title);
+
+    /* lazy modules get their views when they are first shown */
+    if (!restoring)
+        gtk_sat_module_materialize (GTK_SAT_MODULE (pg));
 }
 
 
@@ -0,0 +1,863 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file mod-server.c
+ * \brief Tracking data server of a module.
+ *
+ * The server listens on a local TCP port or on a Unix socket and sends the
+ * satellite data of the module to its clients after each module cycle.
+ * The data is taken from the published satellites of the module, so serving
+ * a client never propagates an orbit.
+ *
+ * Clients send commands as text lines:
+ *
+ *   SAT <catnum> ... | *     Satellites to send (default: all)
+ *   FIELDS <name> ...        Fields to send (default: az el range rate)
+ *   MODE text | binary       Format of the data and replies
+ *   LIST                     List the satellites of the module
+ *   QUIT                     Close the connection
+ *
+ * The fields are az, el, range, rate, doppler (at 100 MHz), lat, lon, alt,
+ * vel, aos and los. SAT and FIELDS reply with the current selection, also
+ * when given without arguments. Each command is answered with a line
+ * starting with OK or ERR.
+ *
+ * In text mode each cycle sends one line per satellite holding the Julian
+ * date, the catalogue number and the selected fields in the order of the
+ * field table below. In binary mode each message is a frame of a 32 bit
+ * length of the rest of the frame and one type byte. Reply frames ('R')
+ * hold the reply text. Data frames ('D') hold the Julian date (f64), the
+ * field mask (u32), the number of satellites (u32) and for each satellite
+ * the catalogue number (u32) followed by the selected fields (f64). All
+ * numbers are little endian.
+ *
+ * Sockets are non-blocking and written from the main loop. A client that
+ * does not keep up has its cycles skipped while its queue is full and is
+ * dropped when it has missed too many of them in a row.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#ifdef G_OS_UNIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "mod-server.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+#define SERVER_MAX_CLIENTS  16      /*!< Connections accepted at once */
+#define CLIENT_MAX_LINE     1024    /*!< Longest command line [bytes] */
+#define CLIENT_MAX_QUEUE    65536   /*!< Cycles are skipped above this [bytes] */
+#define CLIENT_MAX_SKIPPED  50      /*!< Drop client after this many skipped cycles */
+#define CLIENT_READ_SIZE    512     /*!< Bytes read per wakeup */
+
+/** \brief Fields sent to a new client (az, el, range, rate). */
+#define FIELDS_DEFAULT      0x0f
+
+
+/** \brief Satellite data field that can be sent to the clients. */
+typedef struct {
+    const gchar    *name;       /*!< Name used in the FIELDS command */
+    const gchar    *fmt;        /*!< Format in text mode */
+    glong           offset;     /*!< Offset of the value in sat_t */
+    gdouble         scale;      /*!< Scale factor applied to the value */
+} server_field_t;
+
+/* Doppler shift is given for 100 MHz like in the list view */
+static const server_field_t fields[] = {
+    {"az", "%.2f", G_STRUCT_OFFSET(sat_t, az), 1.0},
+    {"el", "%.2f", G_STRUCT_OFFSET(sat_t, el), 1.0},
+    {"range", "%.3f", G_STRUCT_OFFSET(sat_t, range), 1.0},
+    {"rate", "%.4f", G_STRUCT_OFFSET(sat_t, range_rate), 1.0},
+    {"doppler", "%.1f", G_STRUCT_OFFSET(sat_t, range_rate),
+     -100.0e06 / 299792.4580},
+    {"lat", "%.4f", G_STRUCT_OFFSET(sat_t, ssplat), 1.0},
+    {"lon", "%.4f", G_STRUCT_OFFSET(sat_t, ssplon), 1.0},
+    {"alt", "%.3f", G_STRUCT_OFFSET(sat_t, alt), 1.0},
+    {"vel", "%.4f", G_STRUCT_OFFSET(sat_t, velo), 1.0},
+    {"aos", "%.8f", G_STRUCT_OFFSET(sat_t, aos), 1.0},
+    {"los", "%.8f", G_STRUCT_OFFSET(sat_t, los), 1.0}
+};
+
+#define NUM_FIELDS  G_N_ELEMENTS(fields)
+
+
+struct _mod_server {
+    GSocket        *listener;   /*!< Listening socket */
+    GSource        *accept_src; /*!< Source watching the listener */
+    gchar          *path;       /*!< Unix socket file or NULL */
+    sat_registry_t *reg;        /*!< Satellites of the module */
+    GList          *clients;    /*!< Connected clients (server_client_t) */
+};
+
+/** \brief Connected client. */
+typedef struct {
+    mod_server_t   *srv;
+    GSocket        *sock;
+    GSource        *in_src;     /*!< Source watching for commands */
+    GSource        *out_src;    /*!< Source watching for room to write */
+    GString        *line;       /*!< Incomplete command line */
+    GByteArray     *out;        /*!< Data not yet sent */
+    gboolean        binary;     /*!< Binary mode */
+    gboolean        all;        /*!< Send all satellites */
+    GArray         *catnums;    /*!< Selected satellites unless all */
+    guint32         mask;       /*!< Selected fields */
+    guint           skipped;    /*!< Cycles skipped in a row */
+    gboolean        closing;    /*!< Close when the queue is empty */
+} server_client_t;
+
+
+static gboolean client_in_cb(GSocket * sock, GIOCondition cond,
+                             gpointer data);
+static gboolean client_out_cb(GSocket * sock, GIOCondition cond,
+                              gpointer data);
+
+
+static void put_u32(GByteArray * buf, guint32 val)
+{
+    val = GUINT32_TO_LE(val);
+    g_byte_array_append(buf, (const guint8 *)&val, 4);
+}
+
+static void put_f64(GByteArray * buf, gdouble val)
+{
+    union {
+        gdouble         d;
+        guint64         u;
+    } v;
+
+    v.d = val;
+    v.u = GUINT64_TO_LE(v.u);
+    g_byte_array_append(buf, (const guint8 *)&v.u, 8);
+}
+
+/** \brief Write the frame length at the start of a frame. */
+static void end_frame(GByteArray * buf, guint start)
+{
+    guint32         len = GUINT32_TO_LE(buf->len - start - 4);
+
+    memcpy(buf->data + start, &len, 4);
+}
+
+static gdouble field_value(const sat_t * sat, guint f)
+{
+    return *(const gdouble *)((const gchar *)sat + fields[f].offset) *
+        fields[f].scale;
+}
+
+static void client_free(server_client_t * c)
+{
+    c->srv->clients = g_list_remove(c->srv->clients, c);
+
+    if (c->in_src != NULL)
+    {
+        g_source_destroy(c->in_src);
+        g_source_unref(c->in_src);
+    }
+    if (c->out_src != NULL)
+    {
+        g_source_destroy(c->out_src);
+        g_source_unref(c->out_src);
+    }
+
+    g_socket_close(c->sock, NULL);
+    g_object_unref(c->sock);
+    g_string_free(c->line, TRUE);
+    g_byte_array_free(c->out, TRUE);
+    g_array_free(c->catnums, TRUE);
+    g_free(c);
+}
+
+/**
+ * \brief Send as much of the queue as the socket takes.
+ * \return FALSE if the client has been closed.
+ */
+static gboolean client_flush(server_client_t * c)
+{
+    GError         *err = NULL;
+    gssize          n;
+
+    while (c->out->len > 0)
+    {
+        n = g_socket_send(c->sock, (const gchar *)c->out->data, c->out->len,
+                          NULL, &err);
+        if (n < 0)
+        {
+            if (g_error_matches(err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+                g_clear_error(&err);
+                break;
+            }
+
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Dropping client (%s)"), __func__,
+                        err->message);
+            g_clear_error(&err);
+            client_free(c);
+            return FALSE;
+        }
+
+        g_byte_array_remove_range(c->out, 0, n);
+    }
+
+    if (c->out->len > 0 && c->out_src == NULL)
+    {
+        c->out_src = g_socket_create_source(c->sock, G_IO_OUT, NULL);
+        g_source_set_callback(c->out_src, (GSourceFunc) client_out_cb, c,
+                              NULL);
+        g_source_attach(c->out_src, NULL);
+    }
+    else if (c->out->len == 0)
+    {
+        if (c->out_src != NULL)
+        {
+            g_source_destroy(c->out_src);
+            g_source_unref(c->out_src);
+            c->out_src = NULL;
+        }
+        if (c->closing)
+        {
+            client_free(c);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean client_out_cb(GSocket * sock, GIOCondition cond,
+                              gpointer data)
+{
+    (void)sock;
+    (void)cond;
+
+    /* the source is removed by client_flush() once the queue is empty */
+    client_flush((server_client_t *) data);
+
+    return TRUE;
+}
+
+/** \brief Queue a reply to a command. */
+static void client_reply(server_client_t * c, const gchar * fmt, ...)
+{
+    va_list         args;
+    gchar          *msg;
+    guint           start;
+
+    va_start(args, fmt);
+    msg = g_strdup_vprintf(fmt, args);
+    va_end(args);
+
+    if (c->binary)
+    {
+        start = c->out->len;
+        put_u32(c->out, 0);
+        g_byte_array_append(c->out, (const guint8 *)"R", 1);
+        g_byte_array_append(c->out, (const guint8 *)msg, strlen(msg));
+        end_frame(c->out, start);
+    }
+    else
+    {
+        g_byte_array_append(c->out, (const guint8 *)msg, strlen(msg));
+        g_byte_array_append(c->out, (const guint8 *)"\n", 1);
+    }
+
+    g_free(msg);
+}
+
+static void cmd_sat(server_client_t * c, gchar ** argv, guint argc)
+{
+    GString        *str;
+    GArray         *catnums;
+    gchar          *end;
+    gint64          catnum;
+    gint            val;
+    guint           i;
+
+    if (argc == 0)
+    {
+        str = g_string_new("OK SAT");
+        if (c->all)
+            g_string_append(str, " *");
+        for (i = 0; !c->all && i < c->catnums->len; i++)
+            g_string_append_printf(str, " %d",
+                                   g_array_index(c->catnums, gint, i));
+        client_reply(c, "%s", str->str);
+        g_string_free(str, TRUE);
+        return;
+    }
+
+    if (argc == 1 && !strcmp(argv[0], "*"))
+    {
+        c->all = TRUE;
+        g_array_set_size(c->catnums, 0);
+        cmd_sat(c, NULL, 0);
+        return;
+    }
+
+    catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    for (i = 0; i < argc; i++)
+    {
+        catnum = g_ascii_strtoll(argv[i], &end, 10);
+        if (*end != '\0' || catnum <= 0 || catnum > G_MAXINT ||
+            sat_registry_index(c->srv->reg, (gint) catnum) < 0)
+        {
+            client_reply(c, "ERR unknown satellite %s", argv[i]);
+            g_array_free(catnums, TRUE);
+            return;
+        }
+        val = (gint) catnum;
+        g_array_append_val(catnums, val);
+    }
+
+    g_array_free(c->catnums, TRUE);
+    c->catnums = catnums;
+    c->all = FALSE;
+    cmd_sat(c, NULL, 0);
+}
+
+static void cmd_fields(server_client_t * c, gchar ** argv, guint argc)
+{
+    GString        *str;
+    guint32         mask = 0;
+    guint           i, f;
+
+    if (argc == 0)
+    {
+        str = g_string_new("OK FIELDS");
+        for (f = 0; f < NUM_FIELDS; f++)
+            if (c->mask & (1 << f))
+                g_string_append_printf(str, " %s", fields[f].name);
+        client_reply(c, "%s", str->str);
+        g_string_free(str, TRUE);
+        return;
+    }
+
+    for (i = 0; i < argc; i++)
+    {
+        for (f = 0; f < NUM_FIELDS; f++)
+            if (!g_ascii_strcasecmp(argv[i], fields[f].name))
+                break;
+
+        if (f == NUM_FIELDS)
+        {
+            client_reply(c, "ERR unknown field %s", argv[i]);
+            return;
+        }
+        mask |= 1 << f;
+    }
+
+    c->mask = mask;
+    cmd_fields(c, NULL, 0);
+}
+
+static void cmd_list(server_client_t * c)
+{
+    sat_t          *sat;
+    guint           i;
+
+    for (i = 0; i < c->srv->reg->num; i++)
+    {
+        sat = sat_registry_nth(c->srv->reg, i);
+        client_reply(c, "SAT %d %s", sat->tle.catnr, sat->nickname);
+    }
+    client_reply(c, "OK LIST %u", c->srv->reg->num);
+}
+
+/** \brief Execute a command line from a client. */
+static void client_command(server_client_t * c, const gchar * line)
+{
+    gchar         **argv;
+    guint           argc = 0;
+    guint           i;
+
+    /* split on blanks and commas and drop the empty tokens */
+    argv = g_strsplit_set(line, " \t,", -1);
+    for (i = 0; argv[i] != NULL; i++)
+    {
+        if (argv[i][0] != '\0')
+            argv[argc++] = argv[i];
+        else
+            g_free(argv[i]);
+    }
+    argv[argc] = NULL;
+
+    if (argc == 0)
+    {
+        /* empty line */
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "SAT"))
+    {
+        cmd_sat(c, argv + 1, argc - 1);
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "FIELDS"))
+    {
+        cmd_fields(c, argv + 1, argc - 1);
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "MODE") && argc == 2 &&
+             !g_ascii_strcasecmp(argv[1], "text"))
+    {
+        c->binary = FALSE;
+        client_reply(c, "OK MODE text");
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "MODE") && argc == 2 &&
+             !g_ascii_strcasecmp(argv[1], "binary"))
+    {
+        c->binary = TRUE;
+        client_reply(c, "OK MODE binary");
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "LIST"))
+    {
+        cmd_list(c);
+    }
+    else if (!g_ascii_strcasecmp(argv[0], "QUIT"))
+    {
+        client_reply(c, "OK BYE");
+        c->closing = TRUE;
+    }
+    else
+    {
+        client_reply(c, "ERR invalid command %s", argv[0]);
+    }
+
+    g_strfreev(argv);
+}
+
+static gboolean client_in_cb(GSocket * sock, GIOCondition cond,
+                             gpointer data)
+{
+    server_client_t *c = (server_client_t *) data;
+    GError         *err = NULL;
+    gchar           buf[CLIENT_READ_SIZE];
+    gssize          n, i;
+
+    (void)cond;
+
+    n = g_socket_receive(sock, buf, sizeof(buf), NULL, &err);
+    if (n < 0 && g_error_matches(err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+        g_clear_error(&err);
+        return TRUE;
+    }
+    if (n <= 0)
+    {
+        /* closed by the client or failed */
+        g_clear_error(&err);
+        client_free(c);
+        return FALSE;
+    }
+
+    for (i = 0; i < n && !c->closing; i++)
+    {
+        if (buf[i] == '\n')
+        {
+            client_command(c, c->line->str);
+            g_string_truncate(c->line, 0);
+        }
+        else if (buf[i] != '\r')
+        {
+            g_string_append_c(c->line, buf[i]);
+        }
+
+        if (c->line->len > CLIENT_MAX_LINE)
+        {
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Dropping client (command too long)"),
+                        __func__);
+            client_free(c);
+            return FALSE;
+        }
+    }
+
+    /* nothing more is read after QUIT */
+    if (c->closing)
+    {
+        g_source_destroy(c->in_src);
+        g_source_unref(c->in_src);
+        c->in_src = NULL;
+    }
+
+    client_flush(c);
+
+    return TRUE;
+}
+
+static gboolean accept_cb(GSocket * sock, GIOCondition cond, gpointer data)
+{
+    mod_server_t   *srv = (mod_server_t *) data;
+    server_client_t *c;
+    GSocket        *csock;
+    GError         *err = NULL;
+
+    (void)cond;
+
+    csock = g_socket_accept(sock, NULL, &err);
+    if (csock == NULL)
+    {
+        if (!g_error_matches(err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Could not accept client (%s)"), __func__,
+                        err->message);
+        g_clear_error(&err);
+        return TRUE;
+    }
+
+    if (g_list_length(srv->clients) >= SERVER_MAX_CLIENTS)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Too many clients, connection refused"), __func__);
+        g_socket_close(csock, NULL);
+        g_object_unref(csock);
+        return TRUE;
+    }
+
+    g_socket_set_blocking(csock, FALSE);
+
+    c = g_new0(server_client_t, 1);
+    c->srv = srv;
+    c->sock = csock;
+    c->line = g_string_new(NULL);
+    c->out = g_byte_array_new();
+    c->all = TRUE;
+    c->catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    c->mask = FIELDS_DEFAULT;
+
+    c->in_src = g_socket_create_source(csock, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                       NULL);
+    g_source_set_callback(c->in_src, (GSourceFunc) client_in_cb, c, NULL);
+    g_source_attach(c->in_src, NULL);
+
+    srv->clients = g_list_prepend(srv->clients, c);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Client connected (%d)"),
+                __func__, g_list_length(srv->clients));
+
+    return TRUE;
+}
+
+/** \brief Append the data of one satellite to the queue of a client. */
+static void put_sat(server_client_t * c, const sat_t * sat, gdouble t)
+{
+    gchar           buf[G_ASCII_DTOSTR_BUF_SIZE];
+    guint           f;
+
+    if (c->binary)
+    {
+        put_u32(c->out, (guint32) sat->tle.catnr);
+        for (f = 0; f < NUM_FIELDS; f++)
+            if (c->mask & (1 << f))
+                put_f64(c->out, field_value(sat, f));
+        return;
+    }
+
+    g_ascii_formatd(buf, sizeof(buf), "%.8f", t);
+    g_byte_array_append(c->out, (const guint8 *)buf, strlen(buf));
+    g_snprintf(buf, sizeof(buf), " %d", sat->tle.catnr);
+    g_byte_array_append(c->out, (const guint8 *)buf, strlen(buf));
+
+    for (f = 0; f < NUM_FIELDS; f++)
+    {
+        if (!(c->mask & (1 << f)))
+            continue;
+
+        g_byte_array_append(c->out, (const guint8 *)" ", 1);
+        g_ascii_formatd(buf, sizeof(buf), fields[f].fmt,
+                        field_value(sat, f));
+        g_byte_array_append(c->out, (const guint8 *)buf, strlen(buf));
+    }
+    g_byte_array_append(c->out, (const guint8 *)"\n", 1);
+}
+
+/** \brief Queue and send the data of one cycle to a client. */
+static void client_publish(server_client_t * c, gdouble t)
+{
+    sat_registry_t *reg = c->srv->reg;
+    guint           start = 0;
+    guint           count = 0;
+    guint32         val;
+    gint            idx;
+    guint           i, n;
+
+    if (c->closing)
+        return;
+
+    /* the client has not read the previous cycles yet */
+    if (c->out->len > CLIENT_MAX_QUEUE)
+    {
+        if (++c->skipped > CLIENT_MAX_SKIPPED)
+        {
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Dropping client (too slow)"), __func__);
+            client_free(c);
+        }
+        return;
+    }
+    c->skipped = 0;
+
+    if (c->binary)
+    {
+        start = c->out->len;
+        put_u32(c->out, 0);
+        g_byte_array_append(c->out, (const guint8 *)"D", 1);
+        put_f64(c->out, t);
+        put_u32(c->out, c->mask);
+        put_u32(c->out, 0);
+    }
+
+    n = c->all ? reg->num : c->catnums->len;
+    for (i = 0; i < n; i++)
+    {
+        /* the selected satellites may be gone after a reload */
+        idx = c->all ? (gint) i :
+            sat_registry_index(reg, g_array_index(c->catnums, gint, i));
+        if (idx < 0)
+            continue;
+
+        put_sat(c, sat_registry_nth(reg, idx), t);
+        count++;
+    }
+
+    if (c->binary)
+    {
+        val = GUINT32_TO_LE(count);
+        memcpy(c->out->data + start + 17, &val, 4);
+        end_frame(c->out, start);
+    }
+
+    client_flush(c);
+}
+
+#ifdef G_OS_UNIX
+static GSocket *listen_unix(const gchar * path, GError ** err)
+{
+    struct sockaddr_un saddr;
+    struct stat     st;
+    GSocket        *sock;
+    gint            fd;
+
+    if (strlen(path) >= sizeof(saddr.sun_path))
+    {
+        g_set_error(err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                    "path too long");
+        return NULL;
+    }
+
+    memset(&saddr, 0, sizeof(saddr));
+    saddr.sun_family = AF_UNIX;
+    strcpy(saddr.sun_path, path);
+
+    /* remove a socket left behind by a previous run, but not a live one */
+    if (g_lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 &&
+            connect(fd, (struct sockaddr *)&saddr, sizeof(saddr)) == 0)
+        {
+            close(fd);
+            g_set_error(err, G_IO_ERROR, G_IO_ERROR_ADDRESS_IN_USE,
+                        "socket in use");
+            return NULL;
+        }
+        if (fd >= 0 && errno == ECONNREFUSED)
+            g_unlink(path);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&saddr, sizeof(saddr)) < 0 ||
+        listen(fd, 8) < 0)
+    {
+        g_set_error(err, G_IO_ERROR, g_io_error_from_errno(errno), "%s",
+                    g_strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+
+    sock = g_socket_new_from_fd(fd, err);
+    if (sock == NULL)
+        close(fd);
+
+    return sock;
+}
+#endif
+
+static GSocket *listen_tcp(guint16 port, GError ** err)
+{
+    GSocket        *sock;
+    GInetAddress   *inet;
+    GSocketAddress *addr;
+    gboolean        ok;
+
+    sock = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                        G_SOCKET_PROTOCOL_DEFAULT, err);
+    if (sock == NULL)
+        return NULL;
+
+    /* local clients only */
+    inet = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    addr = g_inet_socket_address_new(inet, port);
+    ok = g_socket_bind(sock, addr, TRUE, err) && g_socket_listen(sock, err);
+    g_object_unref(addr);
+    g_object_unref(inet);
+
+    if (!ok)
+    {
+        g_object_unref(sock);
+        return NULL;
+    }
+
+    return sock;
+}
+
+/**
+ * \brief Start a tracking data server.
+ * \param address Port number on the loopback interface or unix:path.
+ * \param reg The satellites of the module.
+ * \return The new server or NULL if it could not be started.
+ */
+mod_server_t   *mod_server_new(const gchar * address, sat_registry_t * reg)
+{
+    mod_server_t   *srv;
+    GSocket        *sock = NULL;
+    GError         *err = NULL;
+    gchar          *path = NULL;
+    gchar          *end;
+    gint64          port;
+
+    g_return_val_if_fail(address != NULL && reg != NULL, NULL);
+
+    if (g_str_has_prefix(address, "unix:"))
+    {
+#ifdef G_OS_UNIX
+        path = g_strdup(address + 5);
+        sock = listen_unix(path, &err);
+#else
+        g_set_error(&err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                    "Unix sockets not supported");
+#endif
+    }
+    else
+    {
+        port = g_ascii_strtoll(address, &end, 10);
+        if (*end != '\0' || port <= 0 || port > 65535)
+            g_set_error(&err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                        "invalid port");
+        else
+            sock = listen_tcp((guint16) port, &err);
+    }
+
+    if (sock == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not start server on %s (%s)"), __func__,
+                    address, err->message);
+        g_clear_error(&err);
+        g_free(path);
+        return NULL;
+    }
+
+    g_socket_set_blocking(sock, FALSE);
+
+    srv = g_new0(mod_server_t, 1);
+    srv->listener = sock;
+    srv->path = path;
+    srv->reg = reg;
+    srv->accept_src = g_socket_create_source(sock, G_IO_IN, NULL);
+    g_source_set_callback(srv->accept_src, (GSourceFunc) accept_cb, srv,
+                          NULL);
+    g_source_attach(srv->accept_src, NULL);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Serving tracking data on %s"),
+                __func__, address);
+
+    return srv;
+}
+
+/** \brief Close all connections and stop the server. */
+void mod_server_free(mod_server_t * srv)
+{
+    if (srv == NULL)
+        return;
+
+    while (srv->clients != NULL)
+        client_free((server_client_t *) srv->clients->data);
+
+    g_source_destroy(srv->accept_src);
+    g_source_unref(srv->accept_src);
+    g_socket_close(srv->listener, NULL);
+    g_object_unref(srv->listener);
+
+    if (srv->path != NULL)
+    {
+        g_unlink(srv->path);
+        g_free(srv->path);
+    }
+
+    g_free(srv);
+}
+
+/** \brief Check whether any client is connected. */
+gboolean mod_server_has_clients(mod_server_t * srv)
+{
+    return srv->clients != NULL;
+}
+
+/**
+ * \brief Send the data of the current cycle to the clients.
+ * \param srv The server.
+ * \param t The time of the cycle (Julian date).
+ *
+ * Must be called after the satellites have been published.
+ */
+void mod_server_publish(mod_server_t * srv, gdouble t)
+{
+    GList          *node, *next;
+
+    /* clients may be dropped on the way */
+    for (node = srv->clients; node != NULL; node = next)
+    {
+        next = node->next;
+        client_publish((server_client_t *) node->data, t);
+    }
+}
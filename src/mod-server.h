@@ -0,0 +1,46 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef MOD_SERVER_H
+#define MOD_SERVER_H 1
+
+#include <glib.h>
+#include "sat-registry.h"
+
+
+/** \brief Default port of the tracking data server. */
+#define MOD_SERVER_PORT     4540
+
+/** \brief Tracking data server of a module. */
+typedef struct _mod_server mod_server_t;
+
+mod_server_t   *mod_server_new(const gchar * address, sat_registry_t * reg);
+void            mod_server_free(mod_server_t * srv);
+gboolean        mod_server_has_clients(mod_server_t * srv);
+void            mod_server_publish(mod_server_t * srv, gdouble t);
+
+#endif
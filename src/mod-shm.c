@@ -0,0 +1,275 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file mod-shm.c
+ * \brief Shared memory snapshot of the tracking data of a module.
+ *
+ * The published satellites of the module are copied to a POSIX shared
+ * memory object after each cycle, so that local programs can read the
+ * current pointing and Doppler data without a connection. The layout and
+ * the reader side are in gpredict-shm.h.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "mod-shm.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+#ifdef HAS_SHM_OPEN
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/types.h>
+#include "gpredict-shm.h"
+
+
+struct _mod_shm {
+    gchar          *name;       /*!< Name of the shared memory object */
+    gpredict_shm_t *map;        /*!< The mapped object */
+};
+
+
+/**
+ * \brief Check whether an existing object has been abandoned.
+ *
+ * Only a valid snapshot that is closed or whose writer process is gone is
+ * considered abandoned; anything else belongs to someone else.
+ */
+static gboolean shm_abandoned(const gchar * name)
+{
+    const gpredict_shm_t *old;
+    gboolean        abandoned;
+
+    old = gpredict_shm_open(name);
+    if (old == NULL)
+        return FALSE;
+
+    abandoned = old->closed ||
+        (kill((pid_t) old->writer, 0) < 0 && errno == ESRCH);
+    gpredict_shm_close(old);
+
+    return abandoned;
+}
+
+/** \brief Create and map a new object for capacity records. */
+static gpredict_shm_t *shm_create(const gchar * name, guint capacity)
+{
+    gpredict_shm_t *map;
+    gsize           size;
+    gint            fd;
+
+    size = sizeof(gpredict_shm_t) + capacity * sizeof(gpredict_shm_sat_t);
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST)
+    {
+        if (!shm_abandoned(name))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Shared memory %s is in use by another writer"),
+                        __func__, name);
+            return NULL;
+        }
+
+        /* left behind by a crashed instance */
+        shm_unlink(name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+
+    if (fd < 0)
+        goto error;
+
+    if (ftruncate(fd, size) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        goto error;
+    }
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        shm_unlink(name);
+        goto error;
+    }
+
+    /* the new object is zero filled */
+    map->magic = GPREDICT_SHM_MAGIC;
+    map->version = GPREDICT_SHM_VERSION;
+    map->size = size;
+    map->record_size = sizeof(gpredict_shm_sat_t);
+    map->capacity = capacity;
+    map->writer = (uint32_t) getpid();
+
+    return map;
+
+  error:
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Could not create shared memory %s (%s)"),
+                __func__, name, g_strerror(errno));
+    return NULL;
+}
+
+/** \brief Mark an object closed for its readers and unmap it. */
+static void shm_close(mod_shm_t * shm)
+{
+    if (shm->map == NULL)
+        return;
+
+    shm->map->closed = 1;
+    munmap(shm->map, shm->map->size);
+    shm_unlink(shm->name);
+    shm->map = NULL;
+}
+
+/**
+ * \brief Create a shared memory snapshot.
+ * \param name Name of the object. A leading / is added if missing.
+ * \param capacity Expected number of satellites.
+ * \return The new snapshot or NULL if the object could not be created.
+ */
+mod_shm_t      *mod_shm_new(const gchar * name, guint capacity)
+{
+    mod_shm_t      *shm;
+
+    g_return_val_if_fail(name != NULL, NULL);
+
+    shm = g_new0(mod_shm_t, 1);
+    shm->name = (name[0] == '/') ? g_strdup(name) :
+        g_strconcat("/", name, NULL);
+    shm->map = shm_create(shm->name, MAX(capacity, 1));
+
+    if (shm->map == NULL)
+    {
+        g_free(shm->name);
+        g_free(shm);
+        return NULL;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Writing tracking data to shared memory %s"),
+                __func__, shm->name);
+
+    return shm;
+}
+
+/** \brief Close and remove a shared memory snapshot. */
+void mod_shm_free(mod_shm_t * shm)
+{
+    if (shm == NULL)
+        return;
+
+    shm_close(shm);
+    g_free(shm->name);
+    g_free(shm);
+}
+
+/**
+ * \brief Write the data of the current cycle.
+ * \param shm The snapshot.
+ * \param reg The satellites of the module.
+ * \param t The time of the cycle (Julian date).
+ *
+ * Must be called after the satellites have been published. If there are
+ * more satellites than room, e.g. after a reload, the object is replaced
+ * by a larger one.
+ */
+void mod_shm_publish(mod_shm_t * shm, sat_registry_t * reg, gdouble t)
+{
+    gpredict_shm_sat_t *rec;
+    sat_t          *sat;
+    guint           i;
+
+    if (shm->map != NULL && reg->num > shm->map->capacity)
+        shm_close(shm);
+
+    if (shm->map == NULL)
+    {
+        shm->map = shm_create(shm->name, reg->num);
+        if (shm->map == NULL)
+            return;
+    }
+
+    /* odd while writing; g_atomic_int_inc() is a full barrier */
+    g_atomic_int_inc((gint *) &shm->map->seq);
+
+    for (i = 0; i < reg->num; i++)
+    {
+        sat = sat_registry_nth(reg, i);
+        rec = &shm->map->sats[i];
+
+        rec->catnum = sat->tle.catnr;
+        rec->az = sat->az;
+        rec->el = sat->el;
+        rec->range = sat->range;
+        rec->range_rate = sat->range_rate;
+        rec->ssplat = sat->ssplat;
+        rec->ssplon = sat->ssplon;
+        rec->alt = sat->alt;
+        rec->aos = sat->aos;
+        rec->los = sat->los;
+    }
+    shm->map->count = reg->num;
+    shm->map->time = t;
+
+    g_atomic_int_inc((gint *) &shm->map->seq);
+}
+
+#else
+
+mod_shm_t      *mod_shm_new(const gchar * name, guint capacity)
+{
+    (void)capacity;
+
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Shared memory %s not supported on this platform"),
+                __func__, name);
+
+    return NULL;
+}
+
+void mod_shm_free(mod_shm_t * shm)
+{
+    (void)shm;
+}
+
+void mod_shm_publish(mod_shm_t * shm, sat_registry_t * reg, gdouble t)
+{
+    (void)shm;
+    (void)reg;
+    (void)t;
+}
+
+#endif
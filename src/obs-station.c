@@ -0,0 +1,206 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Additional ground stations of a module.
+ *
+ * A module propagates its satellites once per cycle for its own QTH. The
+ * ECI state is the same for every observer, so the additional stations only
+ * redo the topocentric part and their own AOS/LOS search.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "obs-station.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+
+
+/**
+ * \brief Create a new station.
+ * \param qthfile The full path of the .qth file.
+ * \return The station, or NULL if the file can not be read.
+ */
+obs_station_t  *obs_station_new(const gchar * qthfile)
+{
+    obs_station_t  *st = g_new0(obs_station_t, 1);
+
+    st->qth = g_new0(qth_t, 1);
+    qth_init(st->qth);
+
+    if (!qth_data_read(qthfile, st->qth))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Can not load ground station %s"),
+                    __func__, qthfile);
+        obs_station_free(st);
+        return NULL;
+    }
+
+    st->sats = sat_registry_new();
+    st->events = event_queue_new();
+
+    return st;
+}
+
+
+/** \brief Free a station; the names of the satellites are not touched. */
+void obs_station_free(obs_station_t * st)
+{
+    if (st == NULL)
+        return;
+
+    qth_data_free(st->qth);
+
+    sat_registry_free_shadow(st->sats);
+
+    if (st->events != NULL)
+        event_queue_free(st->events);
+
+    g_free(st);
+}
+
+
+/**
+ * \brief Rebuild the shadow registry after the module satellites changed.
+ *
+ * The shadow registry keeps its address, so views attached to it only need
+ * to be told to reload.
+ */
+void obs_station_sync(obs_station_t * st, sat_registry_t * reg)
+{
+    guint           i;
+
+    sat_registry_clear_shadow(st->sats);
+
+    st->sats->num = reg->num;
+    st->sats->sats = g_memdup(reg->sats, reg->num * sizeof(sat_t));
+    st->sats->catnums = g_memdup(reg->catnums, reg->num * sizeof(gint));
+    for (i = 0; i < st->sats->num; i++)
+    {
+        st->sats->sats[i].aos = 0.0;
+        st->sats->sats[i].los = 0.0;
+    }
+
+    event_queue_clear(st->events);
+
+    /* force AOS/LOS update */
+    memset(&st->qth_event, 0, sizeof(qth_small_t));
+}
+
+
+/** \brief Update the AOS and LOS times of a shadow; see gtk_sat_module_update_sat(). */
+static void update_events(obs_station_t * st, sat_t * sat, gdouble t,
+                          gboolean events, gboolean moved)
+{
+    gdouble         maxdt;
+
+    maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+
+    if (events && has_aos(sat, st->qth))
+    {
+        sat->aos = find_aos(sat, st->qth, t, maxdt);
+        sat->los = find_los(sat, st->qth, t, maxdt);
+    }
+    else if (moved)
+    {
+        refine_aos_los(sat, st->qth, t, maxdt);
+    }
+
+    if (sat->aos > 0 && sat->aos < t)
+        sat->aos = find_aos(sat, st->qth, t, maxdt);
+
+    if (sat->los > 0 && sat->los < t)
+        sat->los = find_los(sat, st->qth, t, maxdt);
+}
+
+
+/**
+ * \brief Update the station for a new cycle.
+ * \param st The station.
+ * \param reg The module satellites, already calculated for time t.
+ * \param t The time of the cycle.
+ * \param events Whether the module recalculates its AOS/LOS times.
+ */
+void obs_station_update(obs_station_t * st, sat_registry_t * reg,
+                        gdouble t, gboolean events)
+{
+    obs_set_t       obs_set;
+    sat_t          *sat;
+    gdouble         aos, los;
+    gdouble         dist;
+    gboolean        moved = FALSE;
+    guint           i;
+
+    /* the module may still be reloading */
+    if (st->sats->num != reg->num)
+        return;
+
+    qth_data_update(st->qth, t);
+
+    /* refine the events if the station has moved, search them again if
+       it has moved far */
+    dist = qth_small_dist(st->qth, st->qth_event);
+    if (dist > REFINE_MAX_DIST)
+        events = TRUE;
+    else if (!events && dist > 1.0)
+        moved = TRUE;
+    if (events || moved)
+        qth_small_save(st->qth, &st->qth_event);
+
+    predict_obs_frame(&st->frame, st->qth, t);
+
+    for (i = 0; i < reg->num; i++)
+    {
+        sat = sat_registry_nth(st->sats, i);
+
+        /* the searches work on the shadow before it gets the new state */
+        update_events(st, sat, t, events, moved);
+        aos = sat->aos;
+        los = sat->los;
+
+        memcpy(sat, sat_registry_nth(reg, i), sizeof(sat_t));
+        sat->aos = aos;
+        sat->los = los;
+
+        Calculate_Obs_Frame(&st->frame, &sat->pos, &sat->vel, &obs_set);
+        sat->az = Degrees(obs_set.az);
+        sat->el = Degrees(obs_set.el);
+        sat->range = obs_set.range;
+        sat->range_rate = obs_set.range_rate;
+
+        event_queue_update(st->events, sat);
+    }
+}
@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef OBS_STATION_H
+#define OBS_STATION_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+#include "event-queue.h"
+#include "qth-data.h"
+#include "sat-registry.h"
+
+
+/** \brief An additional ground station of a module.
+ *
+ * The station keeps a shadow registry with one entry per satellite of the
+ * module. In each cycle the propagated state of the module satellites is
+ * copied into the shadows and only the observer relative data and the
+ * AOS/LOS times are calculated for the station, so views can be attached
+ * to the shadow registry and the station QTH as if they belonged to a
+ * module of their own. The shadows share the names with the module
+ * satellites.
+ */
+typedef struct {
+    qth_t          *qth;        /*!< The ground station */
+    qth_small_t     qth_event;  /*!< Position at the last AOS/LOS update */
+    obs_frame_t     frame;      /*!< Observer frame of the current cycle */
+    sat_registry_t *sats;       /*!< Shadows of the module satellites */
+    event_queue_t  *events;     /*!< AOS/LOS events of the shadows */
+} obs_station_t;
+
+
+obs_station_t  *obs_station_new    (const gchar *qthfile);
+void            obs_station_free   (obs_station_t *st);
+void            obs_station_sync   (obs_station_t *st, sat_registry_t *reg);
+void            obs_station_update (obs_station_t *st, sat_registry_t *reg,
+                                    gdouble t, gboolean events);
+
+#endif
@@ -35,6 +35,7 @@
 #  include <build-config.h>
 #endif
 #include "orbit-tools.h"
+#include "qth-track.h"
 
 
 
@@ -133,7 +134,7 @@ decayed        (sat_t *sat)
 gboolean
 has_aos        (sat_t *sat, qth_t *qth)
 {
-     double lin, sma, apogee;
+     double lin, sma, apogee, lat;
      gboolean retcode = FALSE;
 
      /* FIXME */
@@ -160,7 +161,13 @@ has_aos        (sat_t *sat, qth_t *qth)
              sma = 331.25 * exp(log(1440.0/sat->meanmo) * (2.0/3.0));
              apogee = sma * (1.0 + sat->tle.eo) - xkmper;
              
-             if ((acos(xkmper/(apogee+xkmper))+(lin)) > fabs(qth->lat*de2ra))
+             /* a track QTH may reach lower latitudes later on */
+             if (qth->track != NULL)
+                 lat = qth_track_min_lat(qth->track);
+             else
+                 lat = fabs(qth->lat);
+
+             if ((acos(xkmper/(apogee+xkmper))+(lin)) > lat*de2ra)
                  retcode = TRUE;
              else
                  retcode = FALSE;
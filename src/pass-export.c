@@ -0,0 +1,1045 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/** \brief Streaming export of predicted passes.
+ *  \ingroup predict
+ *
+ * The functions in this module write pass tables row by row to a buffered
+ * file or to a GString, in plain text, CSV or JSON. The output columns are
+ * resolved once per field mask into an array of column writers with their
+ * conversions already specialised for the selected format, so that writing
+ * a row is a single walk over the visible columns.
+ *
+ * The plain text output is identical to what the pass_to_txt functions
+ * produce; those are implemented on top of this writer.
+ */
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include "sgpsdp/sgp4sdp4.h"
+#include "sat-cfg.h"
+#include "sat-pass-dialogs.h"
+#include "predict-tools.h"
+#include "gtk-sat-data.h"
+#include "locator.h"
+#include "sat-vis.h"
+#include "time-tools.h"
+#include "pass-to-txt.h"
+#include "pass-export.h"
+#ifdef HAVE_CONFIG_H
+#  include <build-config.h>
+#endif
+
+
+/** \brief Size of the stdio buffer used when writing to a file. */
+#define EXPORT_BUFSIZE 65536
+
+
+typedef struct _export_col export_col_t;
+
+/** \brief Column writer; \a row points to a pass_detail_t or a pass_t. */
+typedef void (*export_col_fn) (pass_export_t *ex, const export_col_t *col,
+                               gconstpointer row, const obs_astro_t *astro);
+
+/** \brief Static description of an output column. */
+typedef struct {
+    guint          flag;     /*!< Bit in the field mask */
+    const gchar   *key;      /*!< Column name in CSV and JSON */
+    const gchar   *txtfmt;   /*!< Conversion in the text table, incl. spacing */
+    const gchar   *fmt;      /*!< Conversion in CSV and JSON */
+    gboolean       quote;    /*!< The value is a string in JSON */
+    export_col_fn  write;    /*!< Writer function */
+    glong          offset;   /*!< Offset of a plain gdouble field, or -1 */
+    gdouble      (*value) (gconstpointer row, const obs_astro_t *astro);
+} export_coldef_t;
+
+/** \brief Output column specialised for one output format. */
+struct _export_col {
+    const export_coldef_t *def;
+    gchar                 *pre;   /*!< Separator and key written before the value */
+    gchar                 *fmt;   /*!< Conversion of the value */
+};
+
+/** \brief Pass export writer. */
+struct _pass_export {
+    save_format_t   format;
+    FILE           *fp;          /*!< Output file or NULL */
+    GString        *str;         /*!< Output string or NULL */
+    gchar          *fname;       /*!< File name used in error messages */
+    qth_t          *qth;
+    gchar          *timefmt;     /*!< Time format from the configuration */
+
+    /*!< Number formatter, locale dependent for text, C locale otherwise */
+    void          (*num) (pass_export_t *ex, const gchar *fmt, gdouble val);
+
+    export_col_t    dcols[SINGLE_PASS_COL_NUMBER];  /*!< Detail columns */
+    guint           ndcols;
+    gint            dfields;     /*!< Field mask dcols was built for, or -1 */
+    gboolean        radec;       /*!< RA or Dec visible */
+
+    export_col_t    scols[MULTI_PASS_COL_NUMBER];   /*!< Summary columns */
+    guint           nscols;
+    gint            sfields;     /*!< Field mask scols was built for, or -1 */
+
+    gint            orbit;       /*!< Orbit column prepended to CSV details, or -1 */
+};
+
+
+static void out_len (pass_export_t *ex, const gchar *s, gsize len);
+static void out_str (pass_export_t *ex, const gchar *s);
+static void out (pass_export_t *ex, const gchar *fmt, ...);
+static void out_json_str (pass_export_t *ex, const gchar *s);
+static void out_jd (pass_export_t *ex, gdouble jd);
+static void out_json_time (pass_export_t *ex, const gchar *key, gdouble jd);
+static void out_csv_time (pass_export_t *ex, gdouble jd);
+static void num_locale (pass_export_t *ex, const gchar *fmt, gdouble val);
+static void num_ascii (pass_export_t *ex, const gchar *fmt, gdouble val);
+
+static void write_field (pass_export_t *ex, const export_col_t *col,
+                         gconstpointer row, const obs_astro_t *astro);
+static void write_calc (pass_export_t *ex, const export_col_t *col,
+                        gconstpointer row, const obs_astro_t *astro);
+static void write_ssp (pass_export_t *ex, const export_col_t *col,
+                       gconstpointer row, const obs_astro_t *astro);
+static void write_vis (pass_export_t *ex, const export_col_t *col,
+                       gconstpointer row, const obs_astro_t *astro);
+static void write_duration (pass_export_t *ex, const export_col_t *col,
+                            gconstpointer row, const obs_astro_t *astro);
+static void write_orbit (pass_export_t *ex, const export_col_t *col,
+                         gconstpointer row, const obs_astro_t *astro);
+static void write_pass_vis (pass_export_t *ex, const export_col_t *col,
+                            gconstpointer row, const obs_astro_t *astro);
+
+static gdouble value_ra (gconstpointer row, const obs_astro_t *astro);
+static gdouble value_dec (gconstpointer row, const obs_astro_t *astro);
+static gdouble value_doppler (gconstpointer row, const obs_astro_t *astro);
+static gdouble value_loss (gconstpointer row, const obs_astro_t *astro);
+static gdouble value_delay (gconstpointer row, const obs_astro_t *astro);
+
+static void build_cols (pass_export_t *ex, export_col_t *cols, guint *ncols,
+                        const export_coldef_t *defs, guint ndefs, gint fields);
+static void free_cols (export_col_t *cols, guint ncols);
+static void detail_cols (pass_export_t *ex, gint fields);
+static void summary_cols (pass_export_t *ex, gint fields);
+static void write_csv_header (pass_export_t *ex, const gchar *first,
+                              export_col_t *cols, guint ncols);
+static void write_comment (pass_export_t *ex, const gchar *text);
+static void write_json_observer (pass_export_t *ex);
+static void write_detail_rows (pass_export_t *ex, pass_t *pass, gint fields);
+static void write_summary_rows (pass_export_t *ex, GSList *passes, gint fields,
+                                gint dfields, gboolean full);
+
+static void Calc_RADec (gdouble jul_utc, gdouble saz, gdouble sel,
+                        qth_t *qth, obs_astro_t *obs_set);
+
+
+#define DOFF(f) G_STRUCT_OFFSET (pass_detail_t, f)
+#define POFF(f) G_STRUCT_OFFSET (pass_t, f)
+
+/** \brief Detail columns in the same order as the pass details table. */
+static const export_coldef_t DETAIL_COLS[] = {
+    { SINGLE_PASS_FLAG_AZ,         "az",         " %6.2f", "%.2f", FALSE, write_field, DOFF (az), NULL },
+    { SINGLE_PASS_FLAG_EL,         "el",         " %6.2f", "%.2f", FALSE, write_field, DOFF (el), NULL },
+    { SINGLE_PASS_FLAG_RA,         "ra",         " %6.2f", "%.2f", FALSE, write_calc,  -1, value_ra },
+    { SINGLE_PASS_FLAG_DEC,        "dec",        " %6.2f", "%.2f", FALSE, write_calc,  -1, value_dec },
+    { SINGLE_PASS_FLAG_RANGE,      "range",      " %5.0f", "%.1f", FALSE, write_field, DOFF (range), NULL },
+    { SINGLE_PASS_FLAG_RANGE_RATE, "range_rate", " %6.3f", "%.3f", FALSE, write_field, DOFF (range_rate), NULL },
+    { SINGLE_PASS_FLAG_LAT,        "lat",        " %6.2f", "%.2f", FALSE, write_field, DOFF (lat), NULL },
+    { SINGLE_PASS_FLAG_LON,        "lon",        " %7.2f", "%.2f", FALSE, write_field, DOFF (lon), NULL },
+    { SINGLE_PASS_FLAG_SSP,        "ssp",        " %s",    "%s",   TRUE,  write_ssp,   -1, NULL },
+    { SINGLE_PASS_FLAG_FOOTPRINT,  "footprint",  " %5.0f", "%.0f", FALSE, write_field, DOFF (footprint), NULL },
+    { SINGLE_PASS_FLAG_ALT,        "alt",        " %5.0f", "%.1f", FALSE, write_field, DOFF (alt), NULL },
+    { SINGLE_PASS_FLAG_VEL,        "vel",        " %5.3f", "%.3f", FALSE, write_field, DOFF (velo), NULL },
+    { SINGLE_PASS_FLAG_DOPPLER,    "doppler",    " %5.0f", "%.0f", FALSE, write_calc,  -1, value_doppler },
+    { SINGLE_PASS_FLAG_LOSS,       "loss",       " %6.2f", "%.2f", FALSE, write_calc,  -1, value_loss },
+    { SINGLE_PASS_FLAG_DELAY,      "delay",      " %5.2f", "%.3f", FALSE, write_calc,  -1, value_delay },
+    { SINGLE_PASS_FLAG_MA,         "ma",         " %6.2f", "%.2f", FALSE, write_field, DOFF (ma), NULL },
+    { SINGLE_PASS_FLAG_PHASE,      "phase",      " %6.2f", "%.2f", FALSE, write_field, DOFF (phase), NULL },
+    { SINGLE_PASS_FLAG_VIS,        "vis",        "  %c",   "%c",   TRUE,  write_vis,   -1, NULL },
+};
+
+/** \brief Optional summary columns in the same order as the passes table. */
+static const export_coldef_t SUMMARY_COLS[] = {
+    { MULTI_PASS_FLAG_DURATION,  "duration",  "  %s",    "%s",   TRUE,  write_duration, -1, NULL },
+    { MULTI_PASS_FLAG_MAX_EL,    "max_el",    "  %6.2f", "%.2f", FALSE, write_field, POFF (max_el), NULL },
+    { MULTI_PASS_FLAG_AOS_AZ,    "aos_az",    "  %6.2f", "%.2f", FALSE, write_field, POFF (aos_az), NULL },
+    { MULTI_PASS_FLAG_MAX_EL_AZ, "max_el_az", "  %9.2f", "%.2f", FALSE, write_field, POFF (maxel_az), NULL },
+    { MULTI_PASS_FLAG_LOS_AZ,    "los_az",    "  %6.2f", "%.2f", FALSE, write_field, POFF (los_az), NULL },
+    { MULTI_PASS_FLAG_ORBIT,     "orbit",     "  %5d",   "%d",   FALSE, write_orbit, -1, NULL },
+    { MULTI_PASS_FLAG_VIS,       "vis",       "  %s",    "%s",   TRUE,  write_pass_vis, -1, NULL },
+};
+
+
+/** \brief Create a writer that exports to a file.
+ *  \param fname The name of the file to create.
+ *  \param format The output format.
+ *  \param qth The observer.
+ *  \param err Location for error, or NULL.
+ *  \return A new writer or NULL if the file could not be created.
+ */
+pass_export_t *
+pass_export_open (const gchar *fname, save_format_t format, qth_t *qth, GError **err)
+{
+    pass_export_t *ex;
+    FILE          *fp;
+    gint           saved;
+
+
+    fp = g_fopen (fname, "wb");
+    if (fp == NULL) {
+        saved = errno;
+        g_set_error (err, G_FILE_ERROR, g_file_error_from_errno (saved),
+                     "%s", g_strerror (saved));
+        return NULL;
+    }
+    setvbuf (fp, NULL, _IOFBF, EXPORT_BUFSIZE);
+
+    ex = pass_export_new_str (NULL, format, qth);
+    ex->fp = fp;
+    ex->fname = g_strdup (fname);
+
+    return ex;
+}
+
+
+/** \brief Create a writer that appends to a string.
+ *  \param str The string to append to.
+ *  \param format The output format.
+ *  \param qth The observer.
+ */
+pass_export_t *
+pass_export_new_str (GString *str, save_format_t format, qth_t *qth)
+{
+    pass_export_t *ex;
+
+    ex = g_new0 (pass_export_t, 1);
+    ex->format = format;
+    ex->str = str;
+    ex->qth = qth;
+    ex->timefmt = sat_cfg_get_str (SAT_CFG_STR_TIME_FORMAT);
+    ex->num = (format == SAVE_FORMAT_TXT) ? num_locale : num_ascii;
+    ex->dfields = -1;
+    ex->sfields = -1;
+    ex->orbit = -1;
+
+    return ex;
+}
+
+
+/** \brief Flush and free a writer.
+ *  \param ex The writer.
+ *  \param err Location for error, or NULL.
+ *  \return TRUE if all data has been written.
+ */
+gboolean
+pass_export_close (pass_export_t *ex, GError **err)
+{
+    gboolean ok = TRUE;
+    gint     saved = 0;
+
+
+    if (ex->fp != NULL) {
+        if (ferror (ex->fp)) {
+            saved = errno ? errno : EIO;
+            ok = FALSE;
+        }
+        if (fclose (ex->fp) != 0 && ok) {
+            saved = errno;
+            ok = FALSE;
+        }
+        if (!ok)
+            g_set_error (err, G_FILE_ERROR, g_file_error_from_errno (saved),
+                         "%s", g_strerror (saved));
+    }
+
+    free_cols (ex->dcols, ex->ndcols);
+    free_cols (ex->scols, ex->nscols);
+    g_free (ex->timefmt);
+    g_free (ex->fname);
+    g_free (ex);
+
+    return ok;
+}
+
+
+/** \brief Export a single pass.
+ *  \param ex The writer.
+ *  \param pass The pass.
+ *  \param fields Visible columns (SINGLE_PASS_FLAG_*).
+ *  \param contents What to include, see pass_content_e.
+ */
+void
+pass_export_pass (pass_export_t *ex, pass_t *pass, gint fields, gint contents)
+{
+    gchar *buff;
+
+
+    switch (ex->format) {
+
+    case SAVE_FORMAT_TXT:
+    case SAVE_FORMAT_CSV:
+        if (contents == PASS_CONTENT_ALL) {
+            buff = pass_to_txt_pgheader (pass, ex->qth, fields);
+            if (ex->format == SAVE_FORMAT_TXT)
+                out_str (ex, buff);
+            else
+                write_comment (ex, buff);
+            g_free (buff);
+        }
+
+        if ((contents == PASS_CONTENT_ALL) || (contents == PASS_CONTENT_TABLE)) {
+            if (ex->format == SAVE_FORMAT_TXT) {
+                buff = pass_to_txt_tblheader (pass, ex->qth, fields);
+                out_str (ex, buff);
+                g_free (buff);
+            }
+            else {
+                detail_cols (ex, fields);
+                write_csv_header (ex, "time,time_jd", ex->dcols, ex->ndcols);
+            }
+        }
+
+        write_detail_rows (ex, pass, fields);
+        break;
+
+    case SAVE_FORMAT_JSON:
+        if (contents == PASS_CONTENT_DATA) {
+            write_detail_rows (ex, pass, fields);
+            out_str (ex, "\n");
+            break;
+        }
+
+        out_str (ex, "{\n  \"satellite\": ");
+        out_json_str (ex, pass->satname);
+        out (ex, ",\n  \"orbit\": %d,\n  \"observer\": ", pass->orbit);
+        write_json_observer (ex);
+        out_str (ex, ",\n  ");
+        out_json_time (ex, "aos", pass->aos);
+        out_str (ex, ",\n  ");
+        out_json_time (ex, "los", pass->los);
+        out_str (ex, ",\n  \"details\": ");
+        write_detail_rows (ex, pass, fields);
+        out_str (ex, "\n}\n");
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/** \brief Export a list of passes.
+ *  \param ex The writer.
+ *  \param passes The passes.
+ *  \param fields Visible summary columns (MULTI_PASS_FLAG_*).
+ *  \param dfields Visible detail columns (SINGLE_PASS_FLAG_*).
+ *  \param full Include the details of each pass.
+ *
+ * In CSV the summary and the details have different columns, so a full
+ * export is written as one detail table with the orbit number in the
+ * first column.
+ */
+void
+pass_export_passes (pass_export_t *ex, GSList *passes,
+                    gint fields, gint dfields, gboolean full)
+{
+    GSList *node;
+    pass_t *pass;
+    gchar  *buff;
+
+
+    g_return_if_fail (passes != NULL);
+
+    switch (ex->format) {
+
+    case SAVE_FORMAT_TXT:
+        buff = passes_to_txt_pgheader (passes, ex->qth, fields);
+        out_str (ex, buff);
+        g_free (buff);
+        buff = passes_to_txt_tblheader (passes, ex->qth, fields);
+        out_str (ex, buff);
+        g_free (buff);
+
+        write_summary_rows (ex, passes, fields, dfields, FALSE);
+
+        if (full) {
+            for (node = passes; node != NULL; node = node->next) {
+                pass = PASS (node->data);
+
+                out (ex, "\n Orbit %d\n", pass->orbit);
+                buff = pass_to_txt_tblheader (pass, ex->qth, dfields);
+                out_str (ex, buff);
+                g_free (buff);
+                write_detail_rows (ex, pass, dfields);
+            }
+        }
+        break;
+
+    case SAVE_FORMAT_CSV:
+        buff = passes_to_txt_pgheader (passes, ex->qth, fields);
+        write_comment (ex, buff);
+        g_free (buff);
+
+        if (full) {
+            detail_cols (ex, dfields);
+            write_csv_header (ex, "orbit,time,time_jd", ex->dcols, ex->ndcols);
+            for (node = passes; node != NULL; node = node->next) {
+                pass = PASS (node->data);
+                ex->orbit = pass->orbit;
+                write_detail_rows (ex, pass, dfields);
+            }
+            ex->orbit = -1;
+        }
+        else {
+            summary_cols (ex, fields);
+            write_csv_header (ex, "aos,aos_jd,tca,tca_jd,los,los_jd",
+                              ex->scols, ex->nscols);
+            write_summary_rows (ex, passes, fields, dfields, FALSE);
+        }
+        break;
+
+    case SAVE_FORMAT_JSON:
+        out_str (ex, "{\n  \"satellite\": ");
+        out_json_str (ex, PASS (passes->data)->satname);
+        out_str (ex, ",\n  \"observer\": ");
+        write_json_observer (ex);
+        out_str (ex, ",\n  \"passes\": ");
+        write_summary_rows (ex, passes, fields, dfields, full);
+        out_str (ex, "\n}\n");
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+/** \brief Write the detail rows of a pass.
+ *  \param ex The writer.
+ *  \param pass The pass.
+ *  \param fields Visible columns (SINGLE_PASS_FLAG_*).
+ *
+ * Only the table rows are written; in JSON this is an array of objects.
+ */
+void
+pass_export_pass_rows (pass_export_t *ex, pass_t *pass, gint fields)
+{
+    write_detail_rows (ex, pass, fields);
+}
+
+
+/** \brief Write the summary rows of a list of passes.
+ *  \param ex The writer.
+ *  \param passes The passes.
+ *  \param fields Visible columns (MULTI_PASS_FLAG_*).
+ *
+ * Only the table rows are written; in JSON this is an array of objects.
+ */
+void
+pass_export_passes_rows (pass_export_t *ex, GSList *passes, gint fields)
+{
+    write_summary_rows (ex, passes, fields, 0, FALSE);
+}
+
+
+
+static void
+out_len (pass_export_t *ex, const gchar *s, gsize len)
+{
+    if (len == 0)
+        return;
+
+    if (ex->fp != NULL)
+        fwrite (s, 1, len, ex->fp);
+    else
+        g_string_append_len (ex->str, s, len);
+}
+
+
+static void
+out_str (pass_export_t *ex, const gchar *s)
+{
+    out_len (ex, s, strlen (s));
+}
+
+
+static void
+out (pass_export_t *ex, const gchar *fmt, ...)
+{
+    va_list ap;
+
+    va_start (ap, fmt);
+    if (ex->fp != NULL)
+        vfprintf (ex->fp, fmt, ap);
+    else
+        g_string_append_vprintf (ex->str, fmt, ap);
+    va_end (ap);
+}
+
+
+/** \brief Write a quoted and escaped JSON string. */
+static void
+out_json_str (pass_export_t *ex, const gchar *s)
+{
+    const gchar *p, *start;
+
+    out_len (ex, "\"", 1);
+    for (p = start = (s != NULL ? s : ""); *p != '\0'; p++) {
+        if ((*p != '"') && (*p != '\\') && ((guchar) *p >= 0x20))
+            continue;
+
+        out_len (ex, start, p - start);
+        if ((*p == '"') || (*p == '\\'))
+            out (ex, "\\%c", *p);
+        else
+            out (ex, "\\u%04x", (guint) (guchar) *p);
+        start = p + 1;
+    }
+    out_len (ex, start, p - start);
+    out_len (ex, "\"", 1);
+}
+
+
+/** \brief Write a Julian date; only used in CSV and JSON. */
+static void
+out_jd (pass_export_t *ex, gdouble jd)
+{
+    num_ascii (ex, "%.8f", jd);
+}
+
+
+/** \brief Write a time as a "key":"time","key_jd":jd pair. */
+static void
+out_json_time (pass_export_t *ex, const gchar *key, gdouble jd)
+{
+    gchar tbuff[TIME_FORMAT_MAX_LENGTH];
+
+    daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, jd);
+    out (ex, "\"%s\":", key);
+    out_json_str (ex, tbuff);
+    out (ex, ",\"%s_jd\":", key);
+    out_jd (ex, jd);
+}
+
+
+/** \brief Write a time as a quoted string and a Julian date in CSV. */
+static void
+out_csv_time (pass_export_t *ex, gdouble jd)
+{
+    gchar tbuff[TIME_FORMAT_MAX_LENGTH];
+
+    daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, jd);
+    out (ex, "\"%s\",", tbuff);
+    out_jd (ex, jd);
+}
+
+
+static void
+num_locale (pass_export_t *ex, const gchar *fmt, gdouble val)
+{
+    out (ex, fmt, val);
+}
+
+
+/** \brief Format a number independently of the locale (CSV and JSON). */
+static void
+num_ascii (pass_export_t *ex, const gchar *fmt, gdouble val)
+{
+    gchar buff[G_ASCII_DTOSTR_BUF_SIZE];
+
+    out_str (ex, g_ascii_formatd (buff, G_ASCII_DTOSTR_BUF_SIZE, fmt, val));
+}
+
+
+
+static void
+write_field (pass_export_t *ex, const export_col_t *col,
+             gconstpointer row, const obs_astro_t *astro)
+{
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    out_str (ex, col->pre);
+    ex->num (ex, col->fmt,
+             *(const gdouble *) ((const guint8 *) row + col->def->offset));
+}
+
+
+static void
+write_calc (pass_export_t *ex, const export_col_t *col,
+            gconstpointer row, const obs_astro_t *astro)
+{
+    out_str (ex, col->pre);
+    ex->num (ex, col->fmt, col->def->value (row, astro));
+}
+
+
+static void
+write_ssp (pass_export_t *ex, const export_col_t *col,
+           gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_detail_t *detail = row;
+    gchar                ssp[7];
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    longlat2locator (detail->lon, detail->lat, ssp, 3);
+    out_str (ex, col->pre);
+    out (ex, col->fmt, ssp);
+}
+
+
+static void
+write_vis (pass_export_t *ex, const export_col_t *col,
+           gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_detail_t *detail = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    out_str (ex, col->pre);
+    out (ex, col->fmt, vis_to_chr (detail->vis));
+}
+
+
+static void
+write_duration (pass_export_t *ex, const export_col_t *col,
+                gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_t *pass = row;
+    gchar         buff[16];
+    guint         h,m,s;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    /* convert julian date to seconds */
+    s = (guint) ((pass->los - pass->aos) * 86400);
+
+    h = s / 3600;
+    s -= 3600*h;
+    m = s / 60;
+    s -= 60*m;
+
+    g_snprintf (buff, sizeof (buff), "%02d:%02d:%02d", h, m, s);
+    out_str (ex, col->pre);
+    out (ex, col->fmt, buff);
+}
+
+
+static void
+write_orbit (pass_export_t *ex, const export_col_t *col,
+             gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_t *pass = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    out_str (ex, col->pre);
+    out (ex, col->fmt, pass->orbit);
+}
+
+
+static void
+write_pass_vis (pass_export_t *ex, const export_col_t *col,
+                gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_t *pass = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    out_str (ex, col->pre);
+    out (ex, col->fmt, pass->vis);
+}
+
+
+static gdouble
+value_ra (gconstpointer row, const obs_astro_t *astro)
+{
+    (void) row; /* avoid unused parameter compiler warning */
+
+    return Degrees (astro->ra);
+}
+
+
+static gdouble
+value_dec (gconstpointer row, const obs_astro_t *astro)
+{
+    (void) row; /* avoid unused parameter compiler warning */
+
+    return Degrees (astro->dec);
+}
+
+
+/** \brief Doppler shift at 100 MHz. */
+static gdouble
+value_doppler (gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_detail_t *detail = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    return -100.0e06 * (detail->range_rate / 299792.4580);
+}
+
+
+/** \brief Path loss at 100 MHz in dB. */
+static gdouble
+value_loss (gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_detail_t *detail = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    return 72.4 + 20.0*log10 (detail->range);
+}
+
+
+/** \brief Signal delay in msec. */
+static gdouble
+value_delay (gconstpointer row, const obs_astro_t *astro)
+{
+    const pass_detail_t *detail = row;
+
+    (void) astro; /* avoid unused parameter compiler warning */
+
+    return detail->range / 299.7924580;
+}
+
+
+
+/** \brief Specialise the visible columns for the output format.
+ *  \param ex The writer.
+ *  \param cols The column array to (re)build.
+ *  \param ncols Location of the number of columns in \a cols.
+ *  \param defs The column definitions.
+ *  \param ndefs The number of column definitions.
+ *  \param fields The field mask.
+ */
+static void
+build_cols (pass_export_t *ex, export_col_t *cols, guint *ncols,
+            const export_coldef_t *defs, guint ndefs, gint fields)
+{
+    export_col_t *col;
+    guint         i;
+
+
+    free_cols (cols, *ncols);
+    *ncols = 0;
+
+    for (i = 0; i < ndefs; i++) {
+
+        if (!(fields & defs[i].flag))
+            continue;
+
+        col = &cols[(*ncols)++];
+        col->def = &defs[i];
+
+        switch (ex->format) {
+
+        case SAVE_FORMAT_CSV:
+            col->pre = g_strdup (",");
+            col->fmt = g_strdup (defs[i].fmt);
+            break;
+
+        case SAVE_FORMAT_JSON:
+            col->pre = g_strdup_printf (",\"%s\":", defs[i].key);
+            if (defs[i].quote)
+                col->fmt = g_strdup_printf ("\"%s\"", defs[i].fmt);
+            else
+                col->fmt = g_strdup (defs[i].fmt);
+            break;
+
+        default:
+            col->pre = g_strdup ("");
+            col->fmt = g_strdup (defs[i].txtfmt);
+            break;
+        }
+    }
+}
+
+
+static void
+free_cols (export_col_t *cols, guint ncols)
+{
+    guint i;
+
+    for (i = 0; i < ncols; i++) {
+        g_free (cols[i].pre);
+        g_free (cols[i].fmt);
+    }
+}
+
+
+static void
+detail_cols (pass_export_t *ex, gint fields)
+{
+    if (fields == ex->dfields)
+        return;
+
+    build_cols (ex, ex->dcols, &ex->ndcols,
+                DETAIL_COLS, G_N_ELEMENTS (DETAIL_COLS), fields);
+    ex->dfields = fields;
+    ex->radec = (fields & (SINGLE_PASS_FLAG_RA | SINGLE_PASS_FLAG_DEC)) != 0;
+}
+
+
+static void
+summary_cols (pass_export_t *ex, gint fields)
+{
+    if (fields == ex->sfields)
+        return;
+
+    build_cols (ex, ex->scols, &ex->nscols,
+                SUMMARY_COLS, G_N_ELEMENTS (SUMMARY_COLS), fields);
+    ex->sfields = fields;
+}
+
+
+static void
+write_csv_header (pass_export_t *ex, const gchar *first,
+                  export_col_t *cols, guint ncols)
+{
+    guint i;
+
+    out_str (ex, first);
+    for (i = 0; i < ncols; i++)
+        out (ex, ",%s", cols[i].def->key);
+    out_len (ex, "\n", 1);
+}
+
+
+/** \brief Write a multi-line text as CSV comment lines. */
+static void
+write_comment (pass_export_t *ex, const gchar *text)
+{
+    gchar **lines;
+    guint   i;
+
+    lines = g_strsplit (text, "\n", -1);
+    for (i = 0; lines[i] != NULL; i++)
+        if (lines[i][0] != '\0')
+            out (ex, "# %s\n", lines[i]);
+    g_strfreev (lines);
+}
+
+
+static void
+write_json_observer (pass_export_t *ex)
+{
+    out_str (ex, "{\"name\":");
+    out_json_str (ex, ex->qth->name);
+    out_str (ex, ",\"location\":");
+    out_json_str (ex, ex->qth->loc);
+    out_str (ex, ",\"lat\":");
+    num_ascii (ex, "%.4f", ex->qth->lat);
+    out_str (ex, ",\"lon\":");
+    num_ascii (ex, "%.4f", ex->qth->lon);
+    out (ex, ",\"alt\":%d}", ex->qth->alt);
+}
+
+
+static void
+write_detail_rows (pass_export_t *ex, pass_t *pass, gint fields)
+{
+    GSList             *node;
+    pass_detail_t      *detail;
+    const export_col_t *col, *end;
+    obs_astro_t         astro;
+    gchar               tbuff[TIME_FORMAT_MAX_LENGTH];
+    guint               n = 0;
+
+
+    detail_cols (ex, fields);
+    end = ex->dcols + ex->ndcols;
+    memset (&astro, 0, sizeof (astro));
+
+    if (ex->format == SAVE_FORMAT_JSON)
+        out_len (ex, "[", 1);
+
+    for (node = pass->details; node != NULL; node = node->next, n++) {
+
+        detail = PASS_DETAIL (node->data);
+
+        switch (ex->format) {
+
+        case SAVE_FORMAT_CSV:
+            if (ex->orbit >= 0)
+                out (ex, "%d,", ex->orbit);
+            out_csv_time (ex, detail->time);
+            break;
+
+        case SAVE_FORMAT_JSON:
+            out_str (ex, (n > 0) ? ",\n    {" : "\n    {");
+            out_json_time (ex, "time", detail->time);
+            break;
+
+        default:
+            daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, detail->time);
+            out (ex, " %s", tbuff);
+            break;
+        }
+
+        /* RA and Dec come from the same calculation */
+        if (ex->radec)
+            Calc_RADec (detail->time, detail->az, detail->el, ex->qth, &astro);
+
+        for (col = ex->dcols; col < end; col++)
+            col->def->write (ex, col, detail, &astro);
+
+        if (ex->format == SAVE_FORMAT_JSON)
+            out_len (ex, "}", 1);
+        else
+            out_len (ex, "\n", 1);
+    }
+
+    if (ex->format == SAVE_FORMAT_JSON)
+        out_str (ex, (n > 0) ? "\n  ]" : "]");
+}
+
+
+static void
+write_summary_rows (pass_export_t *ex, GSList *passes, gint fields,
+                    gint dfields, gboolean full)
+{
+    GSList             *node;
+    pass_t             *pass;
+    const export_col_t *col, *end;
+    gchar               tbuff[TIME_FORMAT_MAX_LENGTH];
+    guint               n = 0;
+
+
+    summary_cols (ex, fields);
+    end = ex->scols + ex->nscols;
+
+    if (ex->format == SAVE_FORMAT_JSON)
+        out_len (ex, "[", 1);
+
+    for (node = passes; node != NULL; node = node->next, n++) {
+
+        pass = PASS (node->data);
+
+        switch (ex->format) {
+
+        case SAVE_FORMAT_CSV:
+            out_csv_time (ex, pass->aos);
+            out_len (ex, ",", 1);
+            out_csv_time (ex, pass->tca);
+            out_len (ex, ",", 1);
+            out_csv_time (ex, pass->los);
+            break;
+
+        case SAVE_FORMAT_JSON:
+            out_str (ex, (n > 0) ? ",\n    {" : "\n    {");
+            out_json_time (ex, "aos", pass->aos);
+            out_len (ex, ",", 1);
+            out_json_time (ex, "tca", pass->tca);
+            out_len (ex, ",", 1);
+            out_json_time (ex, "los", pass->los);
+            break;
+
+        default:
+            daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, pass->aos);
+            out (ex, " %s", tbuff);
+            daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, pass->tca);
+            out (ex, "  %s", tbuff);
+            daynum_to_str (tbuff, TIME_FORMAT_MAX_LENGTH, ex->timefmt, pass->los);
+            out (ex, "  %s", tbuff);
+            break;
+        }
+
+        for (col = ex->scols; col < end; col++)
+            col->def->write (ex, col, pass, NULL);
+
+        if (ex->format == SAVE_FORMAT_JSON) {
+            if (full) {
+                out_str (ex, ",\"details\":");
+                write_detail_rows (ex, pass, dfields);
+            }
+            out_len (ex, "}", 1);
+        }
+        else {
+            out_len (ex, "\n", 1);
+        }
+    }
+
+    if (ex->format == SAVE_FORMAT_JSON)
+        out_str (ex, (n > 0) ? "\n  ]" : "]");
+}
+
+
+
+/*** FIXME: formalise with other copies */
+static void
+Calc_RADec (gdouble jul_utc, gdouble saz, gdouble sel,
+            qth_t *qth, obs_astro_t *obs_set)
+{
+
+    double phi,theta,sin_theta,cos_theta,sin_phi,cos_phi,
+        az,el,Lxh,Lyh,Lzh,Sx,Ex,Zx,Sy,Ey,Zy,Sz,Ez,Zz,
+        Lx,Ly,Lz,cos_delta,sin_alpha,cos_alpha;
+    geodetic_t geodetic;
+
+
+    geodetic.lon = qth->lon * de2ra;
+    geodetic.lat = qth->lat * de2ra;
+    geodetic.alt = qth->alt / 1000.0;
+    geodetic.theta = 0;
+
+    az = saz * de2ra;
+    el = sel * de2ra;
+    phi   = geodetic.lat;
+    theta = FMod2p(ThetaG_JD(jul_utc) + geodetic.lon);
+    sin_theta = sin(theta);
+    cos_theta = cos(theta);
+    sin_phi = sin(phi);
+    cos_phi = cos(phi);
+    Lxh = -cos(az) * cos(el);
+    Lyh =  sin(az) * cos(el);
+    Lzh =  sin(el);
+    Sx = sin_phi * cos_theta;
+    Ex = -sin_theta;
+    Zx = cos_theta * cos_phi;
+    Sy = sin_phi * sin_theta;
+    Ey = cos_theta;
+    Zy = sin_theta*cos_phi;
+    Sz = -cos_phi;
+    Ez = 0;
+    Zz = sin_phi;
+    Lx = Sx*Lxh + Ex * Lyh + Zx*Lzh;
+    Ly = Sy*Lxh + Ey * Lyh + Zy*Lzh;
+    Lz = Sz*Lxh + Ez * Lyh + Zz*Lzh;
+    obs_set->dec = ArcSin(Lz);  /* Declination (radians)*/
+    cos_delta = sqrt(1 - Sqr(Lz));
+    sin_alpha = Ly / cos_delta;
+    cos_alpha = Lx / cos_delta;
+    obs_set->ra = AcTan(sin_alpha,cos_alpha); /* Right Ascension (radians)*/
+    obs_set->ra = FMod2p(obs_set->ra);
+}
+
+
@@ -0,0 +1,54 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PASS_EXPORT_H
+#define PASS_EXPORT_H 1
+
+#include <gtk/gtk.h>
+#include "predict-tools.h"
+#include "gtk-sat-data.h"
+#include "save-pass.h"
+
+
+/** \brief Opaque pass export writer. */
+typedef struct _pass_export pass_export_t;
+
+
+pass_export_t *pass_export_open     (const gchar *fname, save_format_t format,
+                                     qth_t *qth, GError **err);
+pass_export_t *pass_export_new_str  (GString *str, save_format_t format, qth_t *qth);
+gboolean       pass_export_close    (pass_export_t *ex, GError **err);
+
+void pass_export_pass        (pass_export_t *ex, pass_t *pass,
+                              gint fields, gint contents);
+void pass_export_passes      (pass_export_t *ex, GSList *passes,
+                              gint fields, gint dfields, gboolean full);
+void pass_export_pass_rows   (pass_export_t *ex, pass_t *pass, gint fields);
+void pass_export_passes_rows (pass_export_t *ex, GSList *passes, gint fields);
+
+
+#endif
@@ -39,6 +39,7 @@
 #include "gtk-sat-data.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
+#include "qth-track.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
@@ -46,25 +47,84 @@
 
 static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
                                 gdouble maxdt, gdouble min_el);
+static gdouble  refine_event(sat_t * sat, qth_t * qth, gdouble start,
+                             gdouble guess, gboolean rising);
+
+/* limits for following a known AOS/LOS time when the observer moves */
+#define REFINE_MAX_ITER 6
+#define REFINE_WINDOW   0.007   /* ~10 min */
 
 /**
  * \brief SGP4SDP4 driver for doing AOS/LOS calculations.
  * \param sat Pointer to the satellite data.
  * \param qth Pointer to the QTH data.
  * \param t The time for calculation (Julian Date)
+ *
+ * When several satellites are calculated for the same location and time,
+ * use predict_obs_frame() and predict_calc_frame() instead.
  */
 void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
 {
-    obs_set_t       obs_set;
-    geodetic_t      sat_geodetic;
+    obs_frame_t     frame;
+
+    predict_obs_frame(&frame, qth, t);
+    predict_calc_frame(sat, &frame);
+}
+
+/**
+ * \brief Calculate the observer frame for a given location and time.
+ * \param frame The frame to fill in.
+ * \param qth Pointer to the QTH data.
+ * \param t The time for calculation (Julian Date)
+ *
+ * The frame contains the observer position and the sidereal time and
+ * rotation used to get from the satellite position to azimuth and
+ * elevation. It only depends on the QTH and the time and can be shared by
+ * all satellites calculated for that time.
+ *
+ * For a track QTH the observer is placed on the track at t, so everything
+ * built on predict_calc(), e.g. find_aos(), find_los() and get_passes(),
+ * follows the planned route.
+ */
+void predict_obs_frame(obs_frame_t * frame, qth_t * qth, gdouble t)
+{
     geodetic_t      obs_geodetic;
-    double          age;
+
+    if (qth->track != NULL)
+    {
+        qth_track_frame(qth->track, t, frame);
+        return;
+    }
 
     obs_geodetic.lon = qth->lon * de2ra;
     obs_geodetic.lat = qth->lat * de2ra;
     obs_geodetic.alt = qth->alt / 1000.0;
     obs_geodetic.theta = 0;
 
+    Calculate_Observer_Frame(t, &obs_geodetic, frame);
+}
+
+/**
+ * \brief SGP4SDP4 driver using a precomputed observer frame.
+ * \param sat Pointer to the satellite data.
+ * \param frame The observer frame; the calculation is done for frame->time.
+ */
+void predict_calc_frame(sat_t * sat, obs_frame_t * frame)
+{
+    predict_calc_state(sat, frame->time);
+    predict_calc_from_state(sat, frame);
+}
+
+/**
+ * \brief Calculate the ECI state of a satellite.
+ * \param sat Pointer to the satellite data.
+ * \param t The time for calculation (Julian Date)
+ *
+ * Only runs SGP4/SDP4, leaving sat->pos and sat->vel in km and km/sec.
+ * Use this when the observer relative data is not needed.
+ */
+void predict_calc_state(sat_t * sat, gdouble t)
+{
     sat->jul_utc = t;
     sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
 
@@ -75,12 +135,33 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
         SGP4(sat, sat->tsince);
 
     Convert_Sat_State(&sat->pos, &sat->vel);
+}
+
+/**
+ * \brief Calculate observer relative data from a known satellite state.
+ * \param sat Pointer to the satellite data.
+ * \param frame The observer frame; the calculation is done for frame->time.
+ *
+ * This function performs the second half of predict_calc(), i.e. everything
+ * that comes after the SGP4/SDP4 call. It assumes that sat->pos and sat->vel
+ * already contain the ECI position and velocity in km and km/sec at the time
+ * of the frame, and that sat->phase contains the orbit phase in radians. It
+ * is used by the ephemeris cache to finish off interpolated states.
+ */
+void predict_calc_from_state(sat_t * sat, obs_frame_t * frame)
+{
+    obs_set_t       obs_set;
+    geodetic_t      sat_geodetic;
+    double          age;
+
+    sat->jul_utc = frame->time;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
 
     /* get the velocity of the satellite */
     Magnitude(&sat->vel);
     sat->velo = sat->vel.w;
-    Calculate_Obs(sat->jul_utc, &sat->pos, &sat->vel, &obs_geodetic, &obs_set);
-    Calculate_LatLonAlt(sat->jul_utc, &sat->pos, &sat_geodetic);
+    Calculate_Obs_Frame(frame, &sat->pos, &sat->vel, &obs_set);
+    Calculate_LatLonAlt_ThetaG(frame->thetag, &sat->pos, &sat_geodetic);
 
     while (sat_geodetic.lon < -pi)
         sat_geodetic.lon += twopi;
@@ -343,6 +424,103 @@ gdouble find_prev_aos(sat_t * sat, qth_t * qth, gdouble start)
     return aostime;
 }
 
+/**
+ * \brief Refine a known AOS or LOS time.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The current time; the event must come after it.
+ * \param guess The previous time of the event.
+ * \param rising TRUE for AOS, FALSE for LOS.
+ * \return The refined time or 0.0 if the event could not be followed.
+ *
+ * The elevation is solved for zero with the secant method starting at the
+ * previous time. After a small move of the observer the event is found in a
+ * few propagator calls. The result is rejected if it drifts out of the
+ * window around the guess or has the wrong direction, which happens when
+ * the pass disappeared or a new one appeared in front of it.
+ */
+static gdouble refine_event(sat_t * sat, qth_t * qth, gdouble start,
+                            gdouble guess, gboolean rising)
+{
+    gdouble         t0, t1, t;
+    gdouble         el0, el1;
+    gint            i;
+
+    if (guess <= start)
+        return 0.0;
+
+    t0 = guess;
+    predict_calc(sat, qth, t0);
+    el0 = sat->el;
+
+    /* first step like the fine steps of find_aos() and find_los() */
+    if (rising)
+        t1 = t0 - el0 * sqrt(sat->alt) / 530000.0;
+    else
+        t1 = t0 + el0 * sqrt(sat->alt) / 502500.0;
+
+    t = t0;
+    for (i = 0; i < REFINE_MAX_ITER && fabs(el0) >= 0.005; i++)
+    {
+        predict_calc(sat, qth, t1);
+        el1 = sat->el;
+
+        if (fabs(el1) < 0.005)
+        {
+            t = t1;
+            break;
+        }
+
+        if (el1 == el0)
+            return 0.0;
+
+        t = t1 - el1 * (t1 - t0) / (el1 - el0);
+        if (fabs(t - guess) > REFINE_WINDOW)
+            return 0.0;
+
+        t0 = t1;
+        el0 = el1;
+        t1 = t;
+    }
+
+    if (i == REFINE_MAX_ITER || t <= start || fabs(t - guess) > REFINE_WINDOW)
+        return 0.0;
+
+    /* check the direction with the elevation 1 second earlier */
+    predict_calc(sat, qth, t);
+    el0 = sat->el;
+    predict_calc(sat, qth, t - 1.0 / 86400.0);
+    if (rising ? (sat->el > el0) : (sat->el < el0))
+        return 0.0;
+
+    return t;
+}
+
+/**
+ * \brief Update the AOS and LOS times after the observer has moved.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the new QTH data.
+ * \param start The current time.
+ * \param maxdt The upper time limit in days for a new search.
+ *
+ * The previous sat->aos and sat->los are used as starting points and
+ * refined with refine_event(). A full find_aos() or find_los() is only done
+ * for an event that was unknown or could not be followed.
+ */
+void refine_aos_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
+{
+    gdouble         t;
+
+    if (!has_aos(sat, qth))
+        return;
+
+    t = (sat->aos > 0.0) ? refine_event(sat, qth, start, sat->aos, TRUE) : 0.0;
+    sat->aos = (t > 0.0) ? t : find_aos(sat, qth, start, maxdt);
+
+    t = (sat->los > 0.0) ? refine_event(sat, qth, start, sat->los, FALSE) : 0.0;
+    sat->los = (t > 0.0) ? t : find_los(sat, qth, start, maxdt);
+}
+
 /**
  * \brief Predict the next pass.
  * \param sat Pointer to the satellite data.
@@ -84,11 +84,19 @@ typedef struct {
 
 /* SGP4/SDP4 driver */
 void predict_calc (sat_t *sat, qth_t *qth, gdouble t);
+void predict_obs_frame (obs_frame_t *frame, qth_t *qth, gdouble t);
+void predict_calc_frame (sat_t *sat, obs_frame_t *frame);
+void predict_calc_from_state (sat_t *sat, obs_frame_t *frame);
+void predict_calc_state (sat_t *sat, gdouble t);
 
 /* AOS/LOS time calculators */
 gdouble find_aos           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_los           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 gdouble find_prev_aos      (sat_t *sat, qth_t *qth, gdouble start);
+void    refine_aos_los     (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
+
+/** \brief Largest move in km where refine_aos_los() can replace a search. */
+#define REFINE_MAX_DIST 10.0
 
 /* next events */
 pass_t *get_next_pass      (sat_t *sat, qth_t *qth, gdouble maxdt);
@@ -30,10 +30,6 @@
 #include <build-config.h>
 #endif
 
-#ifdef HAS_LIBGPS
-#include <gps.h>
-#endif
-
 #include <glib.h>
 #include <glib/gi18n.h>
 
@@ -42,6 +38,8 @@
 #include "locator.h"
 #include "orbit-tools.h"
 #include "qth-data.h"
+#include "qth-gpsd.h"
+#include "qth-track.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
@@ -49,6 +47,40 @@
 void            qth_validate(qth_t * qth);
 
 
+/**
+ * \brief Load the trajectory of a track QTH.
+ * \param qth The QTH with the track file name.
+ * \param filename The .qth file; a relative track file name is relative
+ *                 to its directory.
+ */
+static void load_track(qth_t * qth, const gchar * filename)
+{
+    gchar          *dir;
+    gchar          *path;
+
+    if (qth->track_file == NULL || qth->track_file[0] == '\0')
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Track QTH %s has no track file."),
+                    __func__, qth->name);
+        return;
+    }
+
+    if (g_path_is_absolute(qth->track_file))
+    {
+        path = g_strdup(qth->track_file);
+    }
+    else
+    {
+        dir = g_path_get_dirname(filename);
+        path = g_build_filename(dir, qth->track_file, NULL);
+        g_free(dir);
+    }
+
+    qth->track = qth_track_read(path);
+    g_free(path);
+}
+
 /**
  * Read QTH data from file.
  * \param filename The file to read from.
@@ -234,6 +266,13 @@ gint qth_data_read(const gchar * filename, qth_t * qth)
     }
 #endif
 
+    /* Trajectory */
+    qth->track_file = g_key_file_get_string(qth->data, QTH_CFG_MAIN_SECTION,
+                                            QTH_CFG_TRACK_KEY, NULL);
+    qth->track = NULL;
+    if (qth->type == QTH_TRACK_TYPE)
+        load_track(qth, filename);
+
     /* set QRA based on data */
     if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
     {
@@ -325,6 +364,13 @@ gint qth_data_save(const gchar * filename, qth_t * qth)
                            QTH_CFG_GPSD_PORT_KEY, qth->gpsd_port);
 #endif
 
+    /* trajectory */
+    if (qth->track_file && (g_utf8_strlen(qth->track_file, -1) > 0))
+    {
+        g_key_file_set_string(qth->data, QTH_CFG_MAIN_SECTION,
+                              QTH_CFG_TRACK_KEY, qth->track_file);
+    }
+
     /* saving code */
     ok = !(gpredict_save_key_file(qth->data, filename));
 
@@ -377,177 +423,65 @@ void qth_data_free(qth_t * qth)
         qth->data = NULL;
     }
 
+    g_free(qth->track_file);
+    qth_track_free(qth->track);
+
     g_free(qth);
 }
 
+/** \brief Move the QTH to a new position. */
+static void set_position(qth_t * qth, gdouble lat, gdouble lon, gdouble alt)
+{
+    qth->lat = lat;
+    qth->lon = lon;
+    qth->alt = alt;
+
+    /* check that data is valid */
+    qth_validate(qth);
+
+    /* update qra */
+    if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not set QRA for %s at %f, %f."),
+                    __func__, qth->name, qth->lon, qth->lat);
+    }
+}
+
 /**
  * \brief Update the qth data by whatever method is appropriate.
  * \param qth the qth data structure to update
  * \param qth the time at which the qth is to be computed. this may be ignored by gps updates.
+ *
+ * For gpsd this only picks up the latest fix; the connection is serviced
+ * by the main loop, see qth-gpsd.c. A track QTH is moved to its planned
+ * position at t, which may be in simulated time.
  */
 gboolean qth_data_update(qth_t * qth, gdouble t)
 {
-    gboolean        retval = FALSE;
-
-#ifdef HAS_LIBGPS
-    guint           num_loops = 0;
-#endif
-
-    if (qth->type != QTH_GPSD_TYPE)
-        return FALSE; // FIXME: retval OK? */
-
-
-    if (((t - qth->gpsd_update) > 30.0 / 86400.0) &&
-        (t - qth->gpsd_connected > 30.0 / 86400.0))
-    {
-        /* if needed restart the gpsd interface */
-        qth_data_update_stop(qth);
-        qth_data_update_init(qth);
-        qth->gpsd_connected = t;
-    }
+    qth_gpsd_fix_t  fix;
+    gdouble         lat, lon, alt;
 
-    if (qth->gps_data != NULL)
+    if (qth->type == QTH_TRACK_TYPE && qth->track != NULL)
     {
+        qth_track_position(qth->track, t, &lat, &lon, &alt);
+        if (lat == qth->lat && lon == qth->lon && (gint) alt == qth->alt)
+            return FALSE;
 
-    /** FIXME: refactor */
-
-#ifdef HAS_LIBGPS
-        switch (GPSD_API_MAJOR_VERSION)
-        {
-        case 4:
-#if GPSD_API_MAJOR_VERSION==4
-            while (gps_waiting(qth->gps_data) == TRUE)
-            {
-                /* this is a watchdog in case there is a problem with the gpsd code. */
-                /* if the server was up and has failed then gps_waiting in 2.92 confirmed */
-                /* will return 1 (supposedly fixed in later versions.) */
-                /* if we do not do this as a while loop, the gpsd packets can backup  */
-                /*   and no longer be in sync with the gps receiver */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_poll(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-        case 5:
-#if GPSD_API_MAJOR_VERSION==5
-            while (gps_waiting(qth->gps_data, 0) == 1)
-            {
-                /* see comment from above */
-                /* hopefully not needed but does not hurt anything. */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_read(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-        default:
-            break;
-        }
-#endif
-        if (retval == TRUE)
-        {
-            qth->gpsd_update = t;
-        }
+        set_position(qth, lat, lon, alt);
+        return TRUE;
     }
 
+    if (qth->type != QTH_GPSD_TYPE)
+        return FALSE; // FIXME: retval OK? */
 
-    /* check that data is valid */
-    qth_validate(qth);
+    if ((qth->gpsd == NULL) || !qth_gpsd_get_fix(qth->gpsd, &fix))
+        return FALSE;
 
-    /* update qra */
-    if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Could not set QRA for %s at %f, %f."),
-                    __func__, qth->name, qth->lon, qth->lat);
-    }
+    qth->gpsd_update = t;
+    set_position(qth, fix.lat, fix.lon, fix.alt);
 
-    return retval;
+    return TRUE;
 }
 
 /**
@@ -555,84 +489,18 @@ gboolean qth_data_update(qth_t * qth, gdouble t)
  * \param qth the qth data structure to update
  * 
  * Initial intention of this is to open sockets and ports to gpsd 
- * and other like services to update the qth position.
+ * and other like services to update the qth position. The gpsd
+ * connection is opened in the background; this function does not block.
  */
 gboolean qth_data_update_init(qth_t * qth)
 {
-#ifdef HAS_LIBGPS
-    char           *port;
-#endif
-    gboolean        retval = FALSE;
-
-
     if (qth->type != QTH_GPSD_TYPE)
         return FALSE;
 
-    /** FIXME: refactor */
-
-#ifdef HAS_LIBGPS
-    switch (GPSD_API_MAJOR_VERSION)
-    {
-    case 4:
-#if GPSD_API_MAJOR_VERSION==4
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open_r(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    case 5:
-#if GPSD_API_MAJOR_VERSION==5
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Unsupported gpsd api major version (%d)"),
-                    __func__, GPSD_API_MAJOR_VERSION);
-
-
-        return FALSE;
-        break;
-    }
-#else
-    return FALSE;
-#endif
+    if (qth->gpsd == NULL)
+        qth->gpsd = qth_gpsd_new(qth->gpsd_server, qth->gpsd_port);
 
-    return retval;
+    return (qth->gpsd != NULL);
 }
 
 /**
@@ -647,23 +515,11 @@ void qth_data_update_stop(qth_t * qth)
     if (qth->type != QTH_GPSD_TYPE)
         return;
 
-    /* close gpsd socket */
-    if (qth->gps_data != NULL)
+    /* close gpsd connection */
+    if (qth->gpsd != NULL)
     {
-#ifdef HAS_LIBGPS
-        switch (GPSD_API_MAJOR_VERSION)
-        {
-        case 4:
-            gps_close(qth->gps_data);
-            break;
-        case 5:
-            gps_close(qth->gps_data);
-            break;
-        default:
-            break;
-        }
-#endif
-        qth->gps_data = NULL;
+        qth_gpsd_free(qth->gpsd);
+        qth->gpsd = NULL;
     }
 }
 
@@ -677,13 +533,14 @@ void qth_init(qth_t * qth)
     qth->lon = 0;
     qth->alt = 0;
     qth->type = QTH_STATIC_TYPE;
-    qth->gps_data = NULL;
+    qth->gpsd = NULL;
+    qth->track_file = NULL;
+    qth->track = NULL;
     qth->name = NULL;
     qth->loc = NULL;
     qth->gpsd_port = 0;
     qth->gpsd_server = NULL;
     qth->gpsd_update = 0.0;
-    qth->gpsd_connected = 0.0;
     qth->qra = g_strdup("AA00");
 }
 
@@ -701,7 +558,8 @@ void qth_safe(qth_t * qth)
     qth->lat = 0;
     qth->lon = 0;
     qth->alt = 0;
-    qth->gps_data = NULL;
+    qth->gpsd = NULL;
+    qth->track = NULL;
 }
 
 /**
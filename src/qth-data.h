@@ -41,12 +41,13 @@ typedef struct {
     gint            alt;        /*!< Altitude above sea level in meters. */
     gchar          *qra;        /*!< QRA locator */
     gchar          *wx;         /*!< Weather station code (4 chars). */
-    gint            type;       /*!< QTH type (static,gpsd). */
+    gint            type;       /*!< QTH type (static,gpsd,track). */
     gchar          *gpsd_server;        /*!< GPSD Server name. */
     gint            gpsd_port;  /*!< GPSD Server port. */
     gdouble         gpsd_update;        /*!< Time last GPSD update was received. */
-    gdouble         gpsd_connected;     /*!< Time last GPSD update was last attempted to connect. */
-    struct gps_data_t *gps_data;        /*!< gpsd data structure. */
+    struct _qth_gpsd *gpsd;     /*!< gpsd client, see qth-gpsd.h. */
+    gchar          *track_file; /*!< Trajectory file, see qth-track.c. */
+    struct _qth_track *track;   /*!< Trajectory of a track QTH. */
     GKeyFile       *data;       /*!< Raw data from cfg file. */
 } qth_t;
 
@@ -59,7 +60,8 @@ typedef struct {
 
 enum {
     QTH_STATIC_TYPE = 0,
-    QTH_GPSD_TYPE
+    QTH_GPSD_TYPE,
+    QTH_TRACK_TYPE
 } qth_data_type;
 
 
@@ -576,6 +576,7 @@ static gboolean
     qth->type = gpsdenabled;
     qth->gpsd_port = gpsdport;
 #endif
+    qth->track_file = NULL;
 
     /* store values */
     confdir = get_user_conf_dir ();
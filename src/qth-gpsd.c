@@ -0,0 +1,456 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file qth-gpsd.c
+ * \brief Non-blocking gpsd client for mobile ground stations.
+ *
+ * The connection to gpsd is opened in a short lived thread, since
+ * connecting may block for the whole TCP timeout when gpsd is unreachable.
+ * Once connected, the socket is watched by the main loop and reports are
+ * parsed as they arrive. A dropped or silent connection is closed and
+ * reopened in the background with exponential backoff.
+ *
+ * The latest fix is published as a whole; qth_data_update() picks it up
+ * at the start of a module update, so a cycle never mixes two fixes.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#ifdef HAS_LIBGPS
+#include <gps.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "qth-gpsd.h"
+#include "sat-log.h"
+
+#if defined(HAS_LIBGPS) && \
+    ((GPSD_API_MAJOR_VERSION == 4) || (GPSD_API_MAJOR_VERSION == 5))
+#define QTH_GPSD_SUPPORTED 1
+#endif
+
+#ifdef QTH_GPSD_SUPPORTED
+
+#define GPSD_BACKOFF_MIN    2   /*!< First reconnect delay [s] */
+#define GPSD_BACKOFF_MAX    60  /*!< Longest reconnect delay [s] */
+#define GPSD_SILENCE        30  /*!< Reconnect after this long without data [s] */
+#define GPSD_MAX_READS      64  /*!< Reports handled per wakeup */
+
+
+struct _qth_gpsd {
+    gchar          *server;
+    gint            port;
+    gint            refcount;   /*!< The owner plus a running connect thread */
+    gboolean        closed;     /*!< qth_gpsd_free() has been called */
+    struct gps_data_t *gps_data;        /*!< Open connection or NULL */
+    GIOChannel     *chan;       /*!< Channel on the gpsd socket */
+    guint           watch;      /*!< Socket watch */
+    guint           timer;      /*!< Reconnect or silence timer */
+    guint           backoff;    /*!< Next reconnect delay [s] */
+    gint64          last_data;  /*!< Monotonic time of the last report [us] */
+    qth_gpsd_fix_t  fix;        /*!< Latest fix */
+    guint           seq;        /*!< Incremented for each new fix */
+    guint           seen;       /*!< seq at the last qth_gpsd_get_fix() */
+};
+
+/** \brief Result of a connect thread, handed to the main loop. */
+typedef struct {
+    qth_gpsd_t     *gpsd;
+    struct gps_data_t *gps_data;        /*!< Open connection or NULL */
+} gpsd_conn_t;
+
+
+static void     start_connect(qth_gpsd_t * gpsd);
+static void     schedule_retry(qth_gpsd_t * gpsd);
+static void     disconnect(qth_gpsd_t * gpsd);
+static void     gpsd_unref(qth_gpsd_t * gpsd);
+
+
+static gboolean gpsd_open(const gchar * server, gint port,
+                          struct gps_data_t *gps_data)
+{
+    gchar          *portstr;
+    gint            res;
+
+    portstr = g_strdup_printf("%d", port);
+#if GPSD_API_MAJOR_VERSION == 4
+    res = gps_open_r(server, portstr, gps_data);
+#else
+    res = gps_open(server, portstr, gps_data);
+#endif
+    g_free(portstr);
+
+    if (res == -1)
+        return FALSE;
+
+    (void)gps_stream(gps_data, WATCH_ENABLE, NULL);
+
+    return TRUE;
+}
+
+/** \brief Read one report; returns FALSE if the connection has failed. */
+static gboolean gpsd_read(struct gps_data_t *gps_data)
+{
+#if GPSD_API_MAJOR_VERSION == 4
+    return (gps_poll(gps_data) == 0);
+#else
+    return (gps_read(gps_data) >= 0);
+#endif
+}
+
+/** \brief Check, without blocking, whether more data is buffered. */
+static gboolean gpsd_waiting(struct gps_data_t *gps_data)
+{
+#if GPSD_API_MAJOR_VERSION == 4
+    return gps_waiting(gps_data);
+#else
+    return gps_waiting(gps_data, 0);
+#endif
+}
+
+
+/** \brief Publish the fix of the last report if it has changed. */
+static void handle_report(qth_gpsd_t * gpsd)
+{
+    struct gps_data_t *data = gpsd->gps_data;
+    qth_gpsd_fix_t  fix = gpsd->fix;
+
+    /* handling packet_set inline with
+       http://gpsd.berlios.de/client-howto.html
+     */
+    if (!(data->set & PACKET_SET))
+        return;
+
+    if (data->fix.mode >= MODE_2D)
+    {
+        fix.lat = data->fix.latitude;
+        fix.lon = data->fix.longitude;
+    }
+
+    if (data->fix.mode == MODE_3D)
+        fix.alt = data->fix.altitude;
+    else
+        fix.alt = 0;
+
+    if ((fix.lat != gpsd->fix.lat) || (fix.lon != gpsd->fix.lon) ||
+        (fix.alt != gpsd->fix.alt))
+    {
+        gpsd->fix = fix;
+        gpsd->seq++;
+    }
+}
+
+static gboolean io_cb(GIOChannel * chan, GIOCondition cond, gpointer data)
+{
+    qth_gpsd_t     *gpsd = data;
+    guint           n;
+
+    (void)chan;
+
+    if (!(cond & (G_IO_HUP | G_IO_ERR)))
+    {
+        /* libgps may buffer several reports from one read */
+        for (n = 0; n < GPSD_MAX_READS; n++)
+        {
+            if (!gpsd_read(gpsd->gps_data))
+                break;
+
+            gpsd->last_data = g_get_monotonic_time();
+            gpsd->backoff = GPSD_BACKOFF_MIN;
+            handle_report(gpsd);
+
+            if (!gpsd_waiting(gpsd->gps_data))
+                return TRUE;
+        }
+
+        if (n == GPSD_MAX_READS)
+            return TRUE;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_WARN,
+                _("%s: Lost connection to gpsd at %s:%d"),
+                __func__, gpsd->server, gpsd->port);
+
+    /* this source is removed by returning FALSE */
+    gpsd->watch = 0;
+    disconnect(gpsd);
+    schedule_retry(gpsd);
+
+    return FALSE;
+}
+
+/** \brief Reconnect if gpsd has been silent for too long. */
+static gboolean silence_cb(gpointer data)
+{
+    qth_gpsd_t     *gpsd = data;
+
+    if (g_get_monotonic_time() - gpsd->last_data <
+        (gint64) GPSD_SILENCE * G_USEC_PER_SEC)
+        return TRUE;
+
+    sat_log_log(SAT_LOG_LEVEL_WARN,
+                _("%s: No data from gpsd at %s:%d for %d seconds"),
+                __func__, gpsd->server, gpsd->port, GPSD_SILENCE);
+
+    gpsd->timer = 0;
+    disconnect(gpsd);
+    schedule_retry(gpsd);
+
+    return FALSE;
+}
+
+static gboolean retry_cb(gpointer data)
+{
+    qth_gpsd_t     *gpsd = data;
+
+    gpsd->timer = 0;
+    start_connect(gpsd);
+
+    return FALSE;
+}
+
+/** \brief Take over the connection opened by a connect thread. */
+static gboolean connect_done(gpointer data)
+{
+    gpsd_conn_t    *conn = data;
+    qth_gpsd_t     *gpsd = conn->gpsd;
+
+    if (gpsd->closed)
+    {
+        if (conn->gps_data != NULL)
+        {
+            gps_close(conn->gps_data);
+            g_free(conn->gps_data);
+        }
+    }
+    else if (conn->gps_data == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not open gpsd at %s:%d"),
+                    __func__, gpsd->server, gpsd->port);
+        schedule_retry(gpsd);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Connected to gpsd at %s:%d"),
+                    __func__, gpsd->server, gpsd->port);
+
+        gpsd->gps_data = conn->gps_data;
+        gpsd->chan = g_io_channel_unix_new(gpsd->gps_data->gps_fd);
+        gpsd->watch = g_io_add_watch(gpsd->chan,
+                                     G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                     io_cb, gpsd);
+        gpsd->last_data = g_get_monotonic_time();
+        gpsd->timer = g_timeout_add_seconds(GPSD_SILENCE / 3, silence_cb,
+                                            gpsd);
+    }
+
+    /* the reference held by the thread */
+    gpsd_unref(gpsd);
+    g_free(conn);
+
+    return FALSE;
+}
+
+static gpointer connect_thread(gpointer data)
+{
+    gpsd_conn_t    *conn = data;
+
+    conn->gps_data = g_new0(struct gps_data_t, 1);
+    if (!gpsd_open(conn->gpsd->server, conn->gpsd->port, conn->gps_data))
+    {
+        g_free(conn->gps_data);
+        conn->gps_data = NULL;
+    }
+
+    g_idle_add(connect_done, conn);
+
+    return NULL;
+}
+
+static void start_connect(qth_gpsd_t * gpsd)
+{
+    gpsd_conn_t    *conn;
+    GThread        *thread;
+    GError         *err = NULL;
+
+    conn = g_new0(gpsd_conn_t, 1);
+    conn->gpsd = gpsd;
+    gpsd->refcount++;
+
+    thread = g_thread_try_new("gpredict_gpsd", connect_thread, conn, &err);
+    if (thread == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create gpsd thread (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+        g_free(conn);
+        gpsd->refcount--;
+        schedule_retry(gpsd);
+        return;
+    }
+
+    g_thread_unref(thread);
+}
+
+static void schedule_retry(qth_gpsd_t * gpsd)
+{
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Reconnecting to gpsd in %d seconds"),
+                __func__, gpsd->backoff);
+
+    gpsd->timer = g_timeout_add_seconds(gpsd->backoff, retry_cb, gpsd);
+    gpsd->backoff = MIN(2 * gpsd->backoff, GPSD_BACKOFF_MAX);
+}
+
+/** \brief Close the connection and remove the sources of the client. */
+static void disconnect(qth_gpsd_t * gpsd)
+{
+    if (gpsd->watch > 0)
+    {
+        g_source_remove(gpsd->watch);
+        gpsd->watch = 0;
+    }
+
+    if (gpsd->timer > 0)
+    {
+        g_source_remove(gpsd->timer);
+        gpsd->timer = 0;
+    }
+
+    if (gpsd->chan != NULL)
+    {
+        g_io_channel_unref(gpsd->chan);
+        gpsd->chan = NULL;
+    }
+
+    if (gpsd->gps_data != NULL)
+    {
+        gps_close(gpsd->gps_data);
+        g_free(gpsd->gps_data);
+        gpsd->gps_data = NULL;
+    }
+}
+
+static void gpsd_unref(qth_gpsd_t * gpsd)
+{
+    if (--gpsd->refcount > 0)
+        return;
+
+    g_free(gpsd->server);
+    g_free(gpsd);
+}
+
+
+/**
+ * \brief Start a gpsd client.
+ * \param server The gpsd host.
+ * \param port The gpsd port.
+ * \return A new client. The connection is opened in the background.
+ */
+qth_gpsd_t     *qth_gpsd_new(const gchar * server, gint port)
+{
+    qth_gpsd_t     *gpsd;
+
+    gpsd = g_new0(qth_gpsd_t, 1);
+    gpsd->server = g_strdup(server);
+    gpsd->port = port;
+    gpsd->refcount = 1;
+    gpsd->backoff = GPSD_BACKOFF_MIN;
+
+    start_connect(gpsd);
+
+    return gpsd;
+}
+
+/**
+ * \brief Stop a gpsd client.
+ * \param gpsd The client.
+ *
+ * A connect thread that is still running finishes in the background and
+ * the connection it opens is closed immediately.
+ */
+void qth_gpsd_free(qth_gpsd_t * gpsd)
+{
+    gpsd->closed = TRUE;
+    disconnect(gpsd);
+    gpsd_unref(gpsd);
+}
+
+/**
+ * \brief Get the latest fix.
+ * \param gpsd The client.
+ * \param fix Location where the fix is stored.
+ * \return TRUE if the position has changed since the previous call.
+ */
+gboolean qth_gpsd_get_fix(qth_gpsd_t * gpsd, qth_gpsd_fix_t * fix)
+{
+    if (gpsd->seq == gpsd->seen)
+        return FALSE;
+
+    *fix = gpsd->fix;
+    gpsd->seen = gpsd->seq;
+
+    return TRUE;
+}
+
+#else
+
+qth_gpsd_t     *qth_gpsd_new(const gchar * server, gint port)
+{
+    (void)server;
+    (void)port;
+
+#ifdef HAS_LIBGPS
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Unsupported gpsd api major version (%d)"),
+                __func__, GPSD_API_MAJOR_VERSION);
+#endif
+
+    return NULL;
+}
+
+void qth_gpsd_free(qth_gpsd_t * gpsd)
+{
+    (void)gpsd;
+}
+
+gboolean qth_gpsd_get_fix(qth_gpsd_t * gpsd, qth_gpsd_fix_t * fix)
+{
+    (void)gpsd;
+    (void)fix;
+
+    return FALSE;
+}
+
+#endif
@@ -0,0 +1,47 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef QTH_GPSD_H
+#define QTH_GPSD_H 1
+
+#include <glib.h>
+
+/** \brief Position reported by gpsd. */
+typedef struct {
+    gdouble         lat;        /*!< Latitude in dec. deg. North. */
+    gdouble         lon;        /*!< Longitude in dec. deg. East. */
+    gint            alt;        /*!< Altitude in meters; 0 without a 3D fix. */
+} qth_gpsd_fix_t;
+
+/** \brief Opaque gpsd client. */
+typedef struct _qth_gpsd qth_gpsd_t;
+
+qth_gpsd_t     *qth_gpsd_new(const gchar * server, gint port);
+void            qth_gpsd_free(qth_gpsd_t * gpsd);
+gboolean        qth_gpsd_get_fix(qth_gpsd_t * gpsd, qth_gpsd_fix_t * fix);
+
+#endif
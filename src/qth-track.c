@@ -0,0 +1,494 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file qth-track.c
+ * \brief Planned observer trajectories.
+ *
+ * A track is a list of time tagged positions read from a text file with
+ * one point per line:
+ *
+ *     time,lat,lon[,alt]
+ *
+ * The time is either a Julian date or an ISO 8601 UTC time such as
+ * 2020-01-01 12:00:00 or 2020-01-01T12:00:00Z, the latitude and longitude
+ * are in decimal degrees North and East and the optional altitude is in
+ * meters. Empty lines and lines starting with '#' are ignored, and so is a
+ * header line. The times must increase.
+ *
+ * The position between two points is interpolated linearly in latitude,
+ * longitude and altitude. When the track is loaded it is sampled at a fixed
+ * time step and the earth fixed observer state is cached for every sample,
+ * so the observer frame at any time only needs a lookup, an interpolation
+ * between two samples and the rotation by the sidereal time. This keeps
+ * pass predictions along the track about as cheap as for a fixed site.
+ * Before the first and after the last point the observer stays where the
+ * track starts or ends.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "qth-track.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Time step of the cached observer states in days (30 s). */
+#define TRACK_STEP      (30.0 / 86400.0)
+
+/** \brief Upper limit on the number of cached observer states. */
+#define TRACK_MAX_NODES 100000
+
+
+/** \brief A point of the track as read from the file. */
+typedef struct {
+    gdouble         t;          /*!< Julian date */
+    gdouble         lat;        /*!< Latitude [rad] */
+    gdouble         lon;        /*!< Longitude [rad], continuous along the track */
+    gdouble         alt;        /*!< Altitude [km] */
+} track_point_t;
+
+/** \brief Cached earth fixed observer state. */
+typedef struct {
+    gdouble         lat;        /*!< Latitude [rad] */
+    gdouble         lon;        /*!< Longitude [rad], continuous along the track */
+    gdouble         alt;        /*!< Altitude [km] */
+    gdouble         sin_lat, cos_lat, sin_lon, cos_lon;
+    gdouble         pos[3];     /*!< ECEF position [km] */
+    gdouble         vel[3];     /*!< ECEF velocity towards the next node [km/sec] */
+} track_node_t;
+
+/** \brief Observer trajectory sampled at a fixed time step. */
+struct _qth_track {
+    gdouble         start;      /*!< Time of the first node */
+    gdouble         step;       /*!< Time between two nodes [days] */
+    guint           num;        /*!< Number of nodes */
+    track_node_t   *nodes;      /*!< The cached observer states */
+    gdouble         min_lat;    /*!< Smallest absolute latitude [deg] */
+};
+
+
+/** \brief Parse a number field. */
+static gboolean parse_num(gchar * str, gdouble * val)
+{
+    gchar          *end;
+
+    g_strstrip(str);
+    *val = g_ascii_strtod(str, &end);
+
+    return (end != str && *end == '\0' && isfinite(*val));
+}
+
+/** \brief Parse the time field; either a Julian date or an ISO 8601 UTC time. */
+static gboolean parse_time(gchar * str, gdouble * t)
+{
+    GDateTime      *dt;
+    gchar          *end;
+    gint            y, mo, d, h, mi;
+    gint            n = 0;
+    gdouble         s;
+
+    g_strstrip(str);
+
+    *t = g_ascii_strtod(str, &end);
+    if (end != str && *end == '\0')
+        return (*t > 1.0e6);
+
+    if (sscanf(str, "%d-%d-%d%*1[ T]%d:%d:%n", &y, &mo, &d, &h, &mi, &n) != 5
+        || n == 0)
+        return FALSE;
+
+    /* the seconds may have a fraction */
+    s = g_ascii_strtod(str + n, &end);
+    if (end == str + n || (*end != '\0' && g_strcmp0(end, "Z") != 0) ||
+        s < 0.0 || s >= 61.0)
+        return FALSE;
+
+    dt = g_date_time_new_utc(y, mo, d, h, mi, 0.0);
+    if (dt == NULL)
+        return FALSE;
+
+    *t = g_date_time_to_unix(dt) / 86400.0 + 2440587.5 + s / 86400.0;
+    g_date_time_unref(dt);
+
+    return TRUE;
+}
+
+/** \brief Parse one line of the track file. */
+static gboolean parse_point(const gchar * line, track_point_t * pt)
+{
+    gchar         **fields;
+    gdouble         lat, lon;
+    gdouble         alt = 0.0;
+    guint           n;
+    gboolean        ok = FALSE;
+
+    fields = g_strsplit(line, ",", 5);
+    n = g_strv_length(fields);
+
+    if (n == 3 || n == 4)
+        ok = parse_time(fields[0], &pt->t) &&
+            parse_num(fields[1], &lat) && parse_num(fields[2], &lon) &&
+            (n == 3 || parse_num(fields[3], &alt)) &&
+            fabs(lat) <= 90.0 && fabs(lon) <= 360.0;
+
+    g_strfreev(fields);
+
+    if (ok)
+    {
+        pt->lat = lat * de2ra;
+        pt->lon = lon * de2ra;
+        pt->alt = alt / 1000.0;
+    }
+
+    return ok;
+}
+
+/** \brief Fill in the cached state of a node at a geodetic position. */
+static void set_node(track_node_t * node, gdouble lat, gdouble lon,
+                     gdouble alt)
+{
+    gdouble         c, sq, achcp;
+
+    node->lat = lat;
+    node->lon = lon;
+    node->alt = alt;
+    node->sin_lat = sin(lat);
+    node->cos_lat = cos(lat);
+    node->sin_lon = sin(lon);
+    node->cos_lon = cos(lon);
+
+    /* same as Calculate_User_PosVel() without the earth rotation */
+    c = 1 / sqrt(1 + __f * (__f - 2) * Sqr(node->sin_lat));
+    sq = Sqr(1 - __f) * c;
+    achcp = (xkmper * c + alt) * node->cos_lat;
+    node->pos[0] = achcp * node->cos_lon;
+    node->pos[1] = achcp * node->sin_lon;
+    node->pos[2] = (xkmper * sq + alt) * node->sin_lat;
+}
+
+/** \brief Sample the points at a fixed time step and cache the states. */
+static qth_track_t *build_track(GArray * pts)
+{
+    qth_track_t    *track;
+    track_point_t  *p = (track_point_t *) pts->data;
+    track_point_t  *a, *b;
+    gdouble         span, t, f;
+    guint           i, j;
+    guint           k = 0;
+
+    track = g_new0(qth_track_t, 1);
+    track->start = p[0].t;
+    track->min_lat = 90.0;
+    for (i = 0; i < pts->len; i++)
+        track->min_lat = MIN(track->min_lat, fabs(Degrees(p[i].lat)));
+
+    /* choose the step so that the last node falls on the last point */
+    span = p[pts->len - 1].t - p[0].t;
+    track->num = MIN((guint) ceil(span / TRACK_STEP), TRACK_MAX_NODES - 1) + 1;
+    track->step = (track->num > 1) ? span / (track->num - 1) : TRACK_STEP;
+    track->nodes = g_new0(track_node_t, track->num);
+
+    for (i = 0; i < track->num; i++)
+    {
+        t = track->start + i * track->step;
+
+        /* points a and b bracket t */
+        while (k + 2 < pts->len && p[k + 1].t < t)
+            k++;
+        a = &p[k];
+        b = &p[MIN(k + 1, pts->len - 1)];
+
+        f = (b->t > a->t) ? CLAMP((t - a->t) / (b->t - a->t), 0.0, 1.0) : 0.0;
+        set_node(&track->nodes[i],
+                 a->lat + f * (b->lat - a->lat),
+                 a->lon + f * (b->lon - a->lon),
+                 a->alt + f * (b->alt - a->alt));
+    }
+
+    /* the velocity along the track is constant between two nodes */
+    for (i = 0; i + 1 < track->num; i++)
+        for (j = 0; j < 3; j++)
+            track->nodes[i].vel[j] =
+                (track->nodes[i + 1].pos[j] - track->nodes[i].pos[j]) /
+                (track->step * secday);
+
+    return track;
+}
+
+/**
+ * \brief Read an observer trajectory from a file.
+ * \param filename The file to read, see the description of qth-track.c.
+ * \return The new track or NULL if the file could not be read. Free it with
+ *         qth_track_free().
+ */
+qth_track_t    *qth_track_read(const gchar * filename)
+{
+    GArray         *pts;
+    GError         *error = NULL;
+    gchar          *contents;
+    gchar         **lines;
+    track_point_t   pt;
+    track_point_t  *prev;
+    qth_track_t    *track = NULL;
+    guint           i;
+
+    if (!g_file_get_contents(filename, &contents, NULL, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not read track %s (%s)"),
+                    __func__, filename, error->message);
+        g_clear_error(&error);
+        return NULL;
+    }
+
+    lines = g_strsplit(contents, "\n", -1);
+    g_free(contents);
+    pts = g_array_new(FALSE, FALSE, sizeof(track_point_t));
+
+    for (i = 0; lines[i] != NULL; i++)
+    {
+        g_strstrip(lines[i]);
+        if (lines[i][0] == '\0' || lines[i][0] == '#')
+            continue;
+
+        if (!parse_point(lines[i], &pt))
+        {
+            /* column names */
+            if (pts->len == 0 && !g_ascii_isdigit(lines[i][0]))
+                continue;
+
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Invalid point in %s line %d"),
+                        __func__, filename, i + 1);
+            goto out;
+        }
+
+        if (pts->len > 0)
+        {
+            prev = &g_array_index(pts, track_point_t, pts->len - 1);
+            if (pt.t < prev->t)
+            {
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: Time goes backwards in %s line %d"),
+                            __func__, filename, i + 1);
+                goto out;
+            }
+
+            /* keep the longitude continuous across the date line */
+            while (pt.lon - prev->lon > pi)
+                pt.lon -= twopi;
+            while (pt.lon - prev->lon < -pi)
+                pt.lon += twopi;
+
+            if (pt.t == prev->t)
+            {
+                *prev = pt;
+                continue;
+            }
+        }
+
+        g_array_append_val(pts, pt);
+    }
+
+    if (pts->len == 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: No points in track %s"), __func__, filename);
+        goto out;
+    }
+
+    track = build_track(pts);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Read %d points from %s"), __func__, pts->len, filename);
+
+  out:
+    g_strfreev(lines);
+    g_array_free(pts, TRUE);
+
+    return track;
+}
+
+/** \brief Free an observer trajectory. */
+void qth_track_free(qth_track_t * track)
+{
+    if (track == NULL)
+        return;
+
+    g_free(track->nodes);
+    g_free(track);
+}
+
+/** \brief Copy an observer trajectory, NULL is copied as NULL. */
+qth_track_t    *qth_track_copy(const qth_track_t * track)
+{
+    qth_track_t    *copy;
+
+    if (track == NULL)
+        return NULL;
+
+    copy = g_memdup(track, sizeof(qth_track_t));
+    copy->nodes = g_memdup(track->nodes, track->num * sizeof(track_node_t));
+
+    return copy;
+}
+
+/**
+ * \brief Get the time span of a track.
+ * \param track The track.
+ * \param start Where the time of the first point is stored.
+ * \param end Where the time of the last point is stored.
+ */
+void qth_track_span(const qth_track_t * track, gdouble * start, gdouble * end)
+{
+    *start = track->start;
+    *end = track->start + (track->num - 1) * track->step;
+}
+
+/**
+ * \brief Get the smallest absolute latitude along a track.
+ *
+ * Used instead of the QTH latitude when checking whether a satellite can
+ * be seen from the track at all.
+ */
+gdouble qth_track_min_lat(const qth_track_t * track)
+{
+    return track->min_lat;
+}
+
+/** \brief Interpolate the cached observer state at time t. */
+static void track_lookup(const qth_track_t * track, gdouble t,
+                         track_node_t * out)
+{
+    const track_node_t *a, *b;
+    gdouble         x, f;
+    guint           i;
+
+    x = (t - track->start) / track->step;
+
+    /* standing still before the start and after the end */
+    if (x <= 0.0 || x >= track->num - 1)
+    {
+        *out = track->nodes[(x <= 0.0) ? 0 : track->num - 1];
+        out->vel[0] = out->vel[1] = out->vel[2] = 0.0;
+        return;
+    }
+
+    i = (guint) x;
+    f = x - i;
+    a = &track->nodes[i];
+    b = &track->nodes[i + 1];
+
+#define LERP(m) out->m = a->m + f * (b->m - a->m)
+    LERP(lat);
+    LERP(lon);
+    LERP(alt);
+    LERP(sin_lat);
+    LERP(cos_lat);
+    LERP(sin_lon);
+    LERP(cos_lon);
+    LERP(pos[0]);
+    LERP(pos[1]);
+    LERP(pos[2]);
+#undef LERP
+    out->vel[0] = a->vel[0];
+    out->vel[1] = a->vel[1];
+    out->vel[2] = a->vel[2];
+}
+
+/**
+ * \brief Get the observer position on a track.
+ * \param track The track.
+ * \param t The time (Julian date).
+ * \param lat Where the latitude in dec. deg. North is stored.
+ * \param lon Where the longitude in dec. deg. East is stored.
+ * \param alt Where the altitude in meters is stored.
+ */
+void qth_track_position(const qth_track_t * track, gdouble t,
+                        gdouble * lat, gdouble * lon, gdouble * alt)
+{
+    track_node_t    n;
+
+    track_lookup(track, t, &n);
+
+    *lat = Degrees(n.lat);
+    *lon = Degrees(FMod2p(n.lon + pi) - pi);
+    *alt = n.alt * 1000.0;
+}
+
+/**
+ * \brief Calculate the observer frame on a track.
+ * \param track The track.
+ * \param t The time (Julian date).
+ * \param frame The frame to fill in.
+ *
+ * This is the track equivalent of Calculate_Observer_Frame(). The velocity
+ * includes the motion along the track, so range rates and Doppler shifts
+ * are right for a moving observer as well.
+ */
+void qth_track_frame(const qth_track_t * track, gdouble t,
+                     obs_frame_t * frame)
+{
+    track_node_t    n;
+    gdouble         sin_g, cos_g;
+
+    track_lookup(track, t, &n);
+
+    frame->time = t;
+    frame->thetag = ThetaG_JD(t);
+    sin_g = sin(frame->thetag);
+    cos_g = cos(frame->thetag);
+
+    frame->geodetic.lat = n.lat;
+    frame->geodetic.lon = FMod2p(n.lon + pi) - pi;
+    frame->geodetic.alt = n.alt;
+    frame->geodetic.theta = FMod2p(frame->thetag + n.lon);
+
+    /* rotate the earth fixed state by the sidereal time */
+    frame->pos.x = n.pos[0] * cos_g - n.pos[1] * sin_g;
+    frame->pos.y = n.pos[0] * sin_g + n.pos[1] * cos_g;
+    frame->pos.z = n.pos[2];
+    frame->vel.x = n.vel[0] * cos_g - n.vel[1] * sin_g - mfactor * frame->pos.y;
+    frame->vel.y = n.vel[0] * sin_g + n.vel[1] * cos_g + mfactor * frame->pos.x;
+    frame->vel.z = n.vel[2];
+    Magnitude(&frame->pos);
+    Magnitude(&frame->vel);
+
+    frame->sin_lat = n.sin_lat;
+    frame->cos_lat = n.cos_lat;
+    frame->sin_theta = sin_g * n.cos_lon + cos_g * n.sin_lon;
+    frame->cos_theta = cos_g * n.cos_lon - sin_g * n.sin_lon;
+
+    Calculate_Observer_Rotation(frame);
+}
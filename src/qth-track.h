@@ -0,0 +1,50 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef QTH_TRACK_H
+#define QTH_TRACK_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Opaque observer trajectory, see qth-track.c. */
+typedef struct _qth_track qth_track_t;
+
+
+qth_track_t    *qth_track_read     (const gchar *filename);
+void            qth_track_free     (qth_track_t *track);
+qth_track_t    *qth_track_copy     (const qth_track_t *track);
+void            qth_track_span     (const qth_track_t *track,
+                                    gdouble *start, gdouble *end);
+gdouble         qth_track_min_lat  (const qth_track_t *track);
+void            qth_track_position (const qth_track_t *track, gdouble t,
+                                    gdouble *lat, gdouble *lon, gdouble *alt);
+void            qth_track_frame    (const qth_track_t *track, gdouble t,
+                                    obs_frame_t *frame);
+
+#endif
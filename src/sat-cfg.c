@@ -133,9 +133,12 @@ sat_cfg_bool_t sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     { "MODULES", "POLAR_SHOW_TRACK_AUTO", FALSE},
     { "TLE",     "SERVER_AUTH",        FALSE},
     { "TLE",     "PROXY_AUTH",         FALSE},
+    { "TRSP",    "ADD_NEW_SATS",       TRUE},
     { "TLE",     "ADD_NEW_SATS",       TRUE},
     { "LOG",     "KEEP_LOG_FILES",     FALSE},
-    { "PREDICT", "USE_REAL_T0",        FALSE}
+    { "PREDICT", "USE_REAL_T0",        FALSE},
+    { "PREDICT", "EPHEM_CACHE",        TRUE},
+    { "MODULES", "MAP_CACHE_DISK",     FALSE}
 };
 
 /** Array containing the integer configuration parameters */
@@ -57,6 +57,8 @@ typedef enum {
     SAT_CFG_BOOL_TLE_ADD_NEW,   /*!< Add new satellites to database. */
     SAT_CFG_BOOL_KEEP_LOG_FILES,        /*!< Whether to keep old log files */
     SAT_CFG_BOOL_PRED_USE_REAL_T0,      /*!< Whether to use current time as T0 fro predictions */
+    SAT_CFG_BOOL_PRED_EPHEM_CACHE,      /*!< Use interpolated ephemeris in simulated time */
+    SAT_CFG_BOOL_MAP_CACHE_DISK,        /*!< Store scaled maps in the user cache directory */
     SAT_CFG_BOOL_NUM            /*!< Number of boolean parameters */
 } sat_cfg_bool_e;
 
@@ -29,41 +29,35 @@
 #include <glib/gi18n.h>
 #include "sat-log.h"
 #include "sat-log-browser.h"
+#include "sat-log-model.h"
+#include "log-index.h"
 #include "compat.h"
 
 
-/* columns in the message list */
-typedef enum {
-    MSG_LIST_COL_TIME = 0,
-    MSG_LIST_COL_LEVEL,
-    MSG_LIST_COL_MSG,
-    MSG_LIST_COL_NUMBER
-} msg_list_col_t;
-
-/* data structure to hold one message */
-typedef struct {
-    time_t          time;       /* time stamp */
-    sat_log_level_t level;      /* debug level */
-    gchar          *message;    /* the message itself */
-} message_t;
-
 /* Easy access to column titles */
-const gchar    *MSG_LIST_COL_TITLE[MSG_LIST_COL_NUMBER] = {
+const gchar    *MSG_LIST_COL_TITLE[SAT_LOG_MODEL_COL_NUMBER] = {
     N_("Time"),
     N_("Level"),
     N_("Message")
 };
 
-const gfloat    MSG_LIST_COL_TITLE_ALIGN[MSG_LIST_COL_NUMBER] = {
+const gfloat    MSG_LIST_COL_TITLE_ALIGN[SAT_LOG_MODEL_COL_NUMBER] = {
     0.5, 0.5, 0.0
 };
 
-const gchar    *DEBUG_STR[6] = {
-    N_("NONE"),
-    N_("ERROR"),
-    N_("WARNING"),
-    N_("INFO"),
-    N_("DEBUG")
+/* initial column widths; the columns have fixed size so that the tree view
+   does not have to format every row to find out how wide they are */
+const gint      MSG_LIST_COL_WIDTH[SAT_LOG_MODEL_COL_NUMBER] = {
+    150, 80, 500
+};
+
+/* titles of the levels in the summary */
+const gchar    *LEVEL_TITLE[LOG_INDEX_LEVELS] = {
+    NULL,
+    N_("Errors"),
+    N_("Warnings"),
+    N_("Info"),
+    N_("Debug")
 };
 
 
@@ -72,20 +66,19 @@ extern GtkWidget *app;
 
 static gboolean initialised = FALSE;    /* Is module initialised? */
 
-/* counters */
-static guint32  errors = 0;     /* Number of error messages */
-static guint32  warnings = 0;   /* Number of warning messages */
-static guint32  infos = 0;      /* Number of verbose messages */
-static guint32  debugs = 0;     /* Number of trace messages */
+/* index of the log file being shown */
+static log_index_t *logidx = NULL;
 
-/* summary labels; they need to be accessible at runtime */
-static GtkWidget *errorlabel, *warnlabel, *infolabel, *debuglabel, *sumlabel;
+/* summary labels and filter widgets; they need to be accessible at runtime */
+static GtkWidget *countlabel[LOG_INDEX_LEVELS], *sumlabel;
+static GtkWidget *levelcheck[LOG_INDEX_LEVELS];
+static GtkWidget *fromentry, *toentry;
 
 /* The message window itself */
 static GtkWidget *window;
 
-/* the tree view model */
-GtkTreeModel   *model;
+/* the tree view */
+static GtkWidget *treeview;
 
 
 static gint     message_window_delete(GtkWidget *, GdkEvent *, gpointer);
@@ -94,17 +87,17 @@ static void     message_window_response(GtkWidget *, gint, gpointer);
 
 /* message list and tree widget functions */
 static GtkWidget *create_message_list(void);
-static GtkTreeModel *create_list_model(void);
 static GtkWidget *create_message_summary(void);
+static GtkWidget *create_message_filter(void);
 
 /* load debug file related */
 static void     load_debug_file(GtkWidget * parent);
 static int      read_debug_file(const gchar * filename);
 static void     clear_message_list(void);
 
-static void     add_debug_message(const gchar * datetime,
-                                  sat_log_level_t debug_level,
-                                  const char *message);
+static void     update_summary(void);
+static void     apply_filter(void);
+static void     filter_changed_cb(GtkWidget * widget, gpointer data);
 
 /* Initialise message window.
  *
@@ -115,6 +108,7 @@ static void     add_debug_message(const gchar * datetime,
 void sat_log_browser_open()
 {
     GtkWidget      *hbox;
+    GtkWidget      *vbox;
     gchar          *fname;
     gchar          *confdir;
     gchar          *title;
@@ -127,8 +121,12 @@ void sat_log_browser_open()
         gtk_box_pack_start(GTK_BOX(hbox), create_message_list(),
                            TRUE, TRUE, 0);
 
-        gtk_box_pack_start(GTK_BOX(hbox),
+        vbox = gtk_vbox_new(FALSE, 10);
+        gtk_box_pack_start(GTK_BOX(vbox),
                            create_message_summary(), FALSE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(vbox),
+                           create_message_filter(), FALSE, TRUE, 0);
+        gtk_box_pack_start(GTK_BOX(hbox), vbox, FALSE, TRUE, 0);
 
         /* create dialog window; we use "fake" stock responses to catch user
            button clicks (save_as and pause)
@@ -190,66 +188,66 @@ void sat_log_browser_open()
 }
 
 
-/** \brief Add a message to message list */
-static void add_debug_message(const gchar * datetime,
-                              sat_log_level_t debug_level, const char *message)
+/** \brief Show the message counts of the current log file */
+static void update_summary()
 {
-    guint           total;      /* totalt number of messages */
+    guint           total = 0;  /* totalt number of messages */
     gchar          *str;        /* string to show message count */
-    GtkTreeIter     item;       /* new item added to the list store */
-
-    gtk_list_store_append(GTK_LIST_STORE(model), &item);
-    gtk_list_store_set(GTK_LIST_STORE(model), &item,
-                       MSG_LIST_COL_TIME, datetime,
-                       MSG_LIST_COL_LEVEL, _(DEBUG_STR[debug_level]),
-                       MSG_LIST_COL_MSG, message, -1);
+    guint           i;
 
-    /* increment severity counter */
-    switch (debug_level)
+    for (i = SAT_LOG_LEVEL_ERROR; i < LOG_INDEX_LEVELS; i++)
     {
-
-        /* runtime error */
-    case SAT_LOG_LEVEL_ERROR:
-        errors++;
-        str = g_strdup_printf("%d", errors);
-        gtk_label_set_text(GTK_LABEL(errorlabel), str);
+        str = g_strdup_printf("%d", logidx ? logidx->count[i] : 0);
+        gtk_label_set_text(GTK_LABEL(countlabel[i]), str);
         g_free(str);
-        break;
+    }
 
-        /* warning */
-    case SAT_LOG_LEVEL_WARN:
-        warnings++;
-        str = g_strdup_printf("%d", warnings);
-        gtk_label_set_text(GTK_LABEL(warnlabel), str);
-        g_free(str);
-        break;
+    if (logidx != NULL)
+        total = logidx->nlines;
 
-        /* info */
-    case SAT_LOG_LEVEL_INFO:
-        infos++;
-        str = g_strdup_printf("%d", infos);
-        gtk_label_set_text(GTK_LABEL(infolabel), str);
-        g_free(str);
-        break;
+    str = g_strdup_printf("<b>%d</b>", total);
+    gtk_label_set_markup(GTK_LABEL(sumlabel), str);
+    g_free(str);
+}
 
-        /* debug */
-    case SAT_LOG_LEVEL_DEBUG:
-        debugs++;
-        str = g_strdup_printf("%d", debugs);
-        gtk_label_set_text(GTK_LABEL(debuglabel), str);
-        g_free(str);
-        break;
+/**
+ * \brief Show the messages passing the filter.
+ *
+ * The model is rebuilt rather than changed, so that the tree view does not
+ * get a signal for each row that appears or disappears.
+ */
+static void apply_filter()
+{
+    GtkTreeModel   *model;
+    guint           levels = 1 << SAT_LOG_LEVEL_NONE;
+    guint           i;
 
-    default:
-        break;
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), NULL);
+
+    if (logidx != NULL)
+    {
+        for (i = SAT_LOG_LEVEL_ERROR; i < LOG_INDEX_LEVELS; i++)
+            if (gtk_toggle_button_get_active
+                (GTK_TOGGLE_BUTTON(levelcheck[i])))
+                levels |= 1 << i;
+
+        log_index_filter(logidx, levels,
+                         gtk_entry_get_text(GTK_ENTRY(fromentry)),
+                         gtk_entry_get_text(GTK_ENTRY(toentry)));
     }
 
-    /* the sum does not have to be updated for each line */
-    total = errors + warnings + infos + debugs;
-    str = g_strdup_printf("<b>%d</b>", total);
-    gtk_label_set_markup(GTK_LABEL(sumlabel), str);
-    g_free(str);
+    model = sat_log_model_new(logidx);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), model);
+    g_object_unref(model);
+}
+
+/** \brief Filter settings changed */
+static void filter_changed_cb(GtkWidget * widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
 
+    apply_filter();
 }
 
 /*** FIXME: does not seem to be necessary */
@@ -273,8 +271,10 @@ static void message_window_destroy(GtkWidget * widget, gpointer data)
     (void)widget;
     (void)data;
 
-    /* clean up memory */
-    /* GSList, ... */
+    /* clean up memory; the model must not outlive the index */
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), NULL);
+    log_index_free(logidx);
+    logidx = NULL;
 
     initialised = FALSE;
 }
@@ -370,110 +370,33 @@ static void load_debug_file(GtkWidget * parent)
 }
 
 
-/** \brief Read contents of debug file. */
+/**
+ * \brief Read contents of debug file.
+ *
+ * The file is memory mapped and indexed; the messages are only read from it
+ * when they are shown.
+ */
 static int read_debug_file(const gchar * filename)
 {
-    GIOChannel     *logfile = NULL;     /* the log file */
-    GError         *error = NULL;       /* error structure */
-    gint            errorcode = 0;      /* error code returned by function */
-    gchar          *line;       /* line read from file */
-    gsize           length;     /* length of line read from file */
-    gchar         **buff;
-
+    log_index_t    *idx;
 
     /* check file and read contents */
-    if (g_file_test(filename, G_FILE_TEST_EXISTS))
-    {
+    if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+        return 1;
 
-        /* open file */
-        logfile = g_io_channel_new_file(filename, "r", &error);
+    idx = log_index_open(filename);
+    if (idx == NULL)
+        return 1;
 
-        if (logfile)
-        {
-            /* read the file line by line */
-            while (g_io_channel_read_line(logfile,
-                                          &line,
-                                          &length,
-                                          NULL, NULL) != G_IO_STATUS_EOF)
-            {
-
-                /* trim line and split it */
-                line = g_strdelimit(line, "\n", '\0');
-
-                buff = g_strsplit(line, SAT_LOG_MSG_SEPARATOR, MSG_LIST_COL_NUMBER + 1); // +1 because we used to have a msg source (pre 1.4)
-
-                /* Gpredict 1.3 and earlier had 4 fields:
-                 *   buff[0]: Date and time
-                 *   buff[1]: Message source
-                 *   buff[2]: Message type
-                 *   buff[3]: Message
-                 * As of 1.4 we no longer have message source:
-                 *   buff[0]: Date and time
-                 *   buff[1]: Message type
-                 *   buff[2]: Message
-                 * 
-                 * Gpredicxt 1.4+ will be able to read logs generated by earlier versions
-                 * but not the other way around.
-                 */
-                switch (g_strv_length(buff))
-                {
-
-                case 1:
-                    add_debug_message("", SAT_LOG_LEVEL_ERROR, buff[0]);
-                    break;
-
-                case 3:
-                    /* v1.4 and later */
-                    add_debug_message(buff[0],
-                                      (guint) g_ascii_strtod(buff[1], NULL),
-                                      buff[2]);
-                    break;
-
-                case 4:
-                    /* v1.3 and earlier with message source */
-                    add_debug_message(buff[0],  /* buff[1], - used to be message src */
-                                      (guint) g_ascii_strtod(buff[2], NULL),
-                                      buff[3]);
-                    break;
-                default:
-                    add_debug_message("", SAT_LOG_LEVEL_ERROR,
-                                      _("Log file is corrupt"));
-                    break;
-                }
-
-                /* clean up */
-                g_free(line);
-                g_strfreev(buff);
-            }
-
-            errorcode = 0;
-
-            /* Close IO chanel; don't care about status.
-               Shutdown will flush the stream and close the channel
-               as soon as the reference count is dropped. Order matters!
-             */
-            g_io_channel_shutdown(logfile, TRUE, NULL);
-            g_io_channel_unref(logfile);
+    /* the old index is still used by the model until it is replaced */
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), NULL);
+    log_index_free(logidx);
+    logidx = idx;
 
-        }
-        else
-        {
-            /* an error occured */
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%d: Error open debug log (%s)"),
-                        __FILE__, __LINE__, error->message);
-
-            g_clear_error(&error);
-
-            errorcode = 1;
-        }
-    }
-    else
-    {
-        errorcode = 1;
-    }
+    apply_filter();
+    update_summary();
 
-    return errorcode;
+    return 0;
 }
 
 
@@ -485,19 +408,13 @@ static int read_debug_file(const gchar * filename)
  */
 static void clear_message_list()
 {
-    /* clear the meaase list */
-    gtk_list_store_clear(GTK_LIST_STORE(model));
-
-    /* reset the counters and text widgets */
-    errors = 0;
-    warnings = 0;
-    debugs = 0;
-
-    gtk_label_set_text(GTK_LABEL(errorlabel), "0");
-    gtk_label_set_text(GTK_LABEL(warnlabel), "0");
-    gtk_label_set_text(GTK_LABEL(infolabel), "0");
-    gtk_label_set_text(GTK_LABEL(debuglabel), "0");
-    gtk_label_set_markup(GTK_LABEL(sumlabel), "<b>0</b>");
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), NULL);
+    log_index_free(logidx);
+    logidx = NULL;
+
+    /* empty list and reset the counters */
+    apply_filter();
+    update_summary();
 }
 
 
@@ -505,23 +422,26 @@ static void clear_message_list()
 /* Create list view */
 static GtkWidget *create_message_list()
 {
-    GtkWidget      *treeview;   /* high level treev iew widget */
     GtkWidget      *swin;       /* scrolled window containing the tree view */
     GtkCellRenderer *renderer;  /* cell renderer used to create a column */
     GtkTreeViewColumn *column;  /* place holder for a tree view column */
+    GtkTreeModel   *model;
 
     guint           i;
 
     treeview = gtk_tree_view_new();
     gtk_tree_view_set_rules_hint(GTK_TREE_VIEW(treeview), TRUE);
 
-    for (i = 0; i < MSG_LIST_COL_NUMBER; i++)
+    for (i = 0; i < SAT_LOG_MODEL_COL_NUMBER; i++)
     {
         renderer = gtk_cell_renderer_text_new();
         column =
             gtk_tree_view_column_new_with_attributes(_(MSG_LIST_COL_TITLE[i]),
                                                      renderer, "text", i,
                                                      NULL);
+        gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+        gtk_tree_view_column_set_fixed_width(column, MSG_LIST_COL_WIDTH[i]);
+        gtk_tree_view_column_set_resizable(column, TRUE);
         gtk_tree_view_insert_column(GTK_TREE_VIEW(treeview), column, -1);
 
         /* only aligns the headers? */
@@ -529,8 +449,11 @@ static GtkWidget *create_message_list()
                                            MSG_LIST_COL_TITLE_ALIGN[i]);
     }
 
+    /* all rows have the same height; only the visible rows are formatted */
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), TRUE);
+
     /* create tree view model and finalise tree view */
-    model = create_list_model();
+    model = sat_log_model_new(NULL);
     gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), model);
     g_object_unref(model);
 
@@ -544,69 +467,34 @@ static GtkWidget *create_message_list()
 }
 
 
-/* create tree view model; we actually create a GtkListStore because we are
-   only interested in a flat list. A GtkListStore can be cast to a GtkTreeModel
-   without any problems.
-*/
-static GtkTreeModel *create_list_model()
-{
-    GtkListStore   *liststore;
-
-    liststore = gtk_list_store_new(MSG_LIST_COL_NUMBER, G_TYPE_STRING,
-                                   G_TYPE_STRING, G_TYPE_STRING);
-
-    /*** Fill existing data into the list here ***/
-
-    return GTK_TREE_MODEL(liststore);
-}
-
-
 /* create summary */
 static GtkWidget *create_message_summary()
 {
-    GtkWidget      *vbox;
     GtkWidget      *table;      /* table containing everything */
     GtkWidget      *frame;      /* surrounding frame */
     GtkWidget      *label;      /* dummy label */
-
-    /* create labels */
-    errorlabel = gtk_label_new("0");
-    gtk_misc_set_alignment(GTK_MISC(errorlabel), 1.0, 0.5);
-
-    warnlabel = gtk_label_new("0");
-    gtk_misc_set_alignment(GTK_MISC(warnlabel), 1.0, 0.5);
-
-    infolabel = gtk_label_new("0");
-    gtk_misc_set_alignment(GTK_MISC(infolabel), 1.0, 0.5);
-
-    debuglabel = gtk_label_new("0");
-    gtk_misc_set_alignment(GTK_MISC(debuglabel), 1.0, 0.5);
-
-    sumlabel = gtk_label_new(NULL);
-    gtk_label_set_use_markup(GTK_LABEL(sumlabel), TRUE);
-    gtk_label_set_markup(GTK_LABEL(sumlabel), "<b>0</b>");
-    gtk_misc_set_alignment(GTK_MISC(sumlabel), 1.0, 0.5);
+    guint           i;
 
     /* create table and add widgets */
     table = gtk_table_new(6, 2, TRUE);
     gtk_table_set_col_spacings(GTK_TABLE(table), 5);
     gtk_container_set_border_width(GTK_CONTAINER(table), 10);
 
-    label = gtk_label_new(_("Errors"));
-    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
-    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 0, 1);
-
-    label = gtk_label_new(_("Warnings"));
-    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
-    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 1, 2);
-
-    label = gtk_label_new(_("Info"));
-    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
-    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 2, 3);
-
-    label = gtk_label_new(_("Debug"));
-    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
-    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 3, 4);
+    /* one check button per level to select the messages to show */
+    for (i = SAT_LOG_LEVEL_ERROR; i < LOG_INDEX_LEVELS; i++)
+    {
+        levelcheck[i] = gtk_check_button_new_with_label(_(LEVEL_TITLE[i]));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(levelcheck[i]), TRUE);
+        g_signal_connect(levelcheck[i], "toggled",
+                         G_CALLBACK(filter_changed_cb), NULL);
+        gtk_table_attach_defaults(GTK_TABLE(table), levelcheck[i],
+                                  0, 1, i - 1, i);
+
+        countlabel[i] = gtk_label_new("0");
+        gtk_misc_set_alignment(GTK_MISC(countlabel[i]), 1.0, 0.5);
+        gtk_table_attach_defaults(GTK_TABLE(table), countlabel[i],
+                                  1, 2, i - 1, i);
+    }
 
     gtk_table_attach_defaults(GTK_TABLE(table),
                               gtk_hseparator_new(), 0, 2, 4, 5);
@@ -617,10 +505,10 @@ static GtkWidget *create_message_summary()
     gtk_label_set_markup(GTK_LABEL(label), _("<b>Total</b>"));
     gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 5, 6);
 
-    gtk_table_attach_defaults(GTK_TABLE(table), errorlabel, 1, 2, 0, 1);
-    gtk_table_attach_defaults(GTK_TABLE(table), warnlabel, 1, 2, 1, 2);
-    gtk_table_attach_defaults(GTK_TABLE(table), infolabel, 1, 2, 2, 3);
-    gtk_table_attach_defaults(GTK_TABLE(table), debuglabel, 1, 2, 3, 4);
+    sumlabel = gtk_label_new(NULL);
+    gtk_label_set_use_markup(GTK_LABEL(sumlabel), TRUE);
+    gtk_label_set_markup(GTK_LABEL(sumlabel), "<b>0</b>");
+    gtk_misc_set_alignment(GTK_MISC(sumlabel), 1.0, 0.5);
     gtk_table_attach_defaults(GTK_TABLE(table), sumlabel, 1, 2, 5, 6);
 
     /* frame around the table */
@@ -628,9 +516,52 @@ static GtkWidget *create_message_summary()
     gtk_frame_set_label_align(GTK_FRAME(frame), 0.5, 0.5);
     gtk_container_add(GTK_CONTAINER(frame), table);
 
-    /* pack frame into vbox so that it doesn't gets streched vertically */
-    vbox = gtk_vbox_new(FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(vbox), frame, FALSE, FALSE, 0);
+    return frame;
+}
+
+
+/* create time filter */
+static GtkWidget *create_message_filter()
+{
+    GtkWidget      *table;      /* table containing everything */
+    GtkWidget      *frame;      /* surrounding frame */
+    GtkWidget      *label;      /* dummy label */
+    const gchar    *tip;
+
+    tip = _("Time in the format of the log file, YYYY/MM/DD HH:MM:SS.\n"
+            "The time may be shortened, e.g. 2017/05/01 for a whole day.\n"
+            "Press Enter to apply the filter.");
+
+    table = gtk_table_new(2, 2, FALSE);
+    gtk_table_set_col_spacings(GTK_TABLE(table), 5);
+    gtk_table_set_row_spacings(GTK_TABLE(table), 5);
+    gtk_container_set_border_width(GTK_CONTAINER(table), 10);
+
+    label = gtk_label_new(_("From"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 0, 1);
+
+    fromentry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(fromentry), LOG_INDEX_TIME_LEN);
+    gtk_widget_set_tooltip_text(fromentry, tip);
+    g_signal_connect(fromentry, "activate",
+                     G_CALLBACK(filter_changed_cb), NULL);
+    gtk_table_attach_defaults(GTK_TABLE(table), fromentry, 1, 2, 0, 1);
+
+    label = gtk_label_new(_("To"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 1, 2);
+
+    toentry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(toentry), LOG_INDEX_TIME_LEN);
+    gtk_widget_set_tooltip_text(toentry, tip);
+    g_signal_connect(toentry, "activate",
+                     G_CALLBACK(filter_changed_cb), NULL);
+    gtk_table_attach_defaults(GTK_TABLE(table), toentry, 1, 2, 1, 2);
+
+    frame = gtk_frame_new(_(" Filter "));
+    gtk_frame_set_label_align(GTK_FRAME(frame), 0.5, 0.5);
+    gtk_container_add(GTK_CONTAINER(frame), table);
 
-    return vbox;
+    return frame;
 }
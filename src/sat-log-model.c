@@ -0,0 +1,315 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+
+#include "sat-log-model.h"
+
+
+/** \brief Names of the message levels. */
+static const gchar *LEVEL_STR[LOG_INDEX_LEVELS] = {
+    N_("NONE"),
+    N_("ERROR"),
+    N_("WARNING"),
+    N_("INFO"),
+    N_("DEBUG")
+};
+
+
+static void     sat_log_model_init(SatLogModel * model);
+static void     sat_log_model_tree_model_init(GtkTreeModelIface * iface);
+
+static GtkTreeModelFlags get_flags(GtkTreeModel * model);
+static gint     get_n_columns(GtkTreeModel * model);
+static GType    get_column_type(GtkTreeModel * model, gint index);
+static gboolean get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+                         GtkTreePath * path);
+static GtkTreePath *get_path(GtkTreeModel * model, GtkTreeIter * iter);
+static void     get_value(GtkTreeModel * model, GtkTreeIter * iter,
+                          gint column, GValue * value);
+static gboolean iter_next(GtkTreeModel * model, GtkTreeIter * iter);
+static gboolean iter_children(GtkTreeModel * model, GtkTreeIter * iter,
+                              GtkTreeIter * parent);
+static gboolean iter_has_child(GtkTreeModel * model, GtkTreeIter * iter);
+static gint     iter_n_children(GtkTreeModel * model, GtkTreeIter * iter);
+static gboolean iter_nth_child(GtkTreeModel * model, GtkTreeIter * iter,
+                               GtkTreeIter * parent, gint n);
+static gboolean iter_parent(GtkTreeModel * model, GtkTreeIter * iter,
+                            GtkTreeIter * child);
+
+
+GType sat_log_model_get_type()
+{
+    static GType    sat_log_model_type = 0;
+
+    if (!sat_log_model_type)
+    {
+        static const GTypeInfo sat_log_model_info = {
+            sizeof(SatLogModelClass),
+            NULL,               /* base_init */
+            NULL,               /* base_finalize */
+            NULL,               /* class_init */
+            NULL,               /* class_finalize */
+            NULL,               /* class_data */
+            sizeof(SatLogModel),
+            0,                  /* n_preallocs */
+            (GInstanceInitFunc) sat_log_model_init,
+            NULL
+        };
+
+        static const GInterfaceInfo tree_model_info = {
+            (GInterfaceInitFunc) sat_log_model_tree_model_init,
+            NULL,               /* interface_finalize */
+            NULL                /* interface_data */
+        };
+
+        sat_log_model_type = g_type_register_static(G_TYPE_OBJECT,
+                                                    "SatLogModel",
+                                                    &sat_log_model_info, 0);
+        g_type_add_interface_static(sat_log_model_type, GTK_TYPE_TREE_MODEL,
+                                    &tree_model_info);
+    }
+
+    return sat_log_model_type;
+}
+
+static void sat_log_model_init(SatLogModel * model)
+{
+    model->idx = NULL;
+    model->stamp = g_random_int();
+}
+
+static void sat_log_model_tree_model_init(GtkTreeModelIface * iface)
+{
+    iface->get_flags = get_flags;
+    iface->get_n_columns = get_n_columns;
+    iface->get_column_type = get_column_type;
+    iface->get_iter = get_iter;
+    iface->get_path = get_path;
+    iface->get_value = get_value;
+    iface->iter_next = iter_next;
+    iface->iter_children = iter_children;
+    iface->iter_has_child = iter_has_child;
+    iface->iter_n_children = iter_n_children;
+    iface->iter_nth_child = iter_nth_child;
+    iface->iter_parent = iter_parent;
+}
+
+/**
+ * \brief Create a new log model.
+ * \param idx The log index or NULL for an empty model. The index must stay
+ *            alive and unchanged as long as the model is in use.
+ */
+GtkTreeModel   *sat_log_model_new(log_index_t * idx)
+{
+    SatLogModel    *model;
+
+    model = g_object_new(SAT_TYPE_LOG_MODEL, NULL);
+    model->idx = idx;
+
+    return GTK_TREE_MODEL(model);
+}
+
+/** \brief Number of rows in the model. */
+static guint n_rows(GtkTreeModel * model)
+{
+    log_index_t    *idx = SAT_LOG_MODEL(model)->idx;
+
+    return (idx != NULL) ? idx->nrows : 0;
+}
+
+/** \brief Point an iterator at a row; FALSE if there is no such row. */
+static gboolean set_iter(GtkTreeModel * model, GtkTreeIter * iter, guint row)
+{
+    if (row >= n_rows(model))
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->stamp = SAT_LOG_MODEL(model)->stamp;
+    iter->user_data = GUINT_TO_POINTER(row);
+
+    return TRUE;
+}
+
+/**
+ * \brief Copy a message to a newly allocated UTF-8 string.
+ *
+ * Log files written by other programs or with another locale may contain
+ * invalid UTF-8, which GTK+ does not accept; such bytes are replaced by '?'.
+ */
+static gchar   *make_utf8(const gchar * s, gsize len)
+{
+    const gchar    *end;
+    GString        *str;
+
+    if (g_utf8_validate(s, len, &end))
+        return g_strndup(s, len);
+
+    str = g_string_sized_new(len);
+    do
+    {
+        g_string_append_len(str, s, end - s);
+        g_string_append_c(str, '?');
+        len -= end - s + 1;
+        s = end + 1;
+    }
+    while (!g_utf8_validate(s, len, &end));
+    g_string_append_len(str, s, len);
+
+    return g_string_free(str, FALSE);
+}
+
+static GtkTreeModelFlags get_flags(GtkTreeModel * model)
+{
+    (void)model;                /* avoid unused parameter compiler warning */
+
+    return GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint get_n_columns(GtkTreeModel * model)
+{
+    (void)model;                /* avoid unused parameter compiler warning */
+
+    return SAT_LOG_MODEL_COL_NUMBER;
+}
+
+static GType get_column_type(GtkTreeModel * model, gint index)
+{
+    (void)model;                /* avoid unused parameter compiler warning */
+    (void)index;                /* avoid unused parameter compiler warning */
+
+    return G_TYPE_STRING;
+}
+
+static gboolean get_iter(GtkTreeModel * model, GtkTreeIter * iter,
+                         GtkTreePath * path)
+{
+    gint           *indices;
+
+    if (gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    indices = gtk_tree_path_get_indices(path);
+
+    return set_iter(model, iter, (guint) indices[0]);
+}
+
+static GtkTreePath *get_path(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    g_return_val_if_fail(iter->stamp == SAT_LOG_MODEL(model)->stamp, NULL);
+
+    return gtk_tree_path_new_from_indices(GPOINTER_TO_UINT(iter->user_data),
+                                          -1);
+}
+
+/** \brief Format a field of a row; this is where the file is read. */
+static void get_value(GtkTreeModel * model, GtkTreeIter * iter,
+                      gint column, GValue * value)
+{
+    log_line_t      line;
+
+    g_value_init(value, G_TYPE_STRING);
+
+    g_return_if_fail(iter->stamp == SAT_LOG_MODEL(model)->stamp);
+
+    log_index_get(SAT_LOG_MODEL(model)->idx,
+                  GPOINTER_TO_UINT(iter->user_data), &line);
+
+    switch (column)
+    {
+    case SAT_LOG_MODEL_COL_TIME:
+        g_value_take_string(value, g_strndup(line.time, line.time_len));
+        break;
+
+    case SAT_LOG_MODEL_COL_LEVEL:
+        g_value_set_static_string(value, _(LEVEL_STR[line.level]));
+        break;
+
+    case SAT_LOG_MODEL_COL_MSG:
+        g_value_take_string(value, make_utf8(line.msg, line.msg_len));
+        break;
+
+    default:
+        break;
+    }
+}
+
+static gboolean iter_next(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    return set_iter(model, iter, GPOINTER_TO_UINT(iter->user_data) + 1);
+}
+
+static gboolean iter_children(GtkTreeModel * model, GtkTreeIter * iter,
+                              GtkTreeIter * parent)
+{
+    if (parent != NULL)
+        return FALSE;
+
+    return set_iter(model, iter, 0);
+}
+
+static gboolean iter_has_child(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    (void)model;                /* avoid unused parameter compiler warning */
+    (void)iter;                 /* avoid unused parameter compiler warning */
+
+    return FALSE;
+}
+
+static gint iter_n_children(GtkTreeModel * model, GtkTreeIter * iter)
+{
+    if (iter != NULL)
+        return 0;
+
+    return (gint) n_rows(model);
+}
+
+static gboolean iter_nth_child(GtkTreeModel * model, GtkTreeIter * iter,
+                               GtkTreeIter * parent, gint n)
+{
+    if (parent != NULL || n < 0)
+        return FALSE;
+
+    return set_iter(model, iter, (guint) n);
+}
+
+static gboolean iter_parent(GtkTreeModel * model, GtkTreeIter * iter,
+                            GtkTreeIter * child)
+{
+    (void)model;                /* avoid unused parameter compiler warning */
+    (void)iter;                 /* avoid unused parameter compiler warning */
+    (void)child;                /* avoid unused parameter compiler warning */
+
+    return FALSE;
+}
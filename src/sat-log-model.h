@@ -0,0 +1,77 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_LOG_MODEL_H
+#define SAT_LOG_MODEL_H 1
+
+#include <gtk/gtk.h>
+#include "log-index.h"
+
+
+/** \brief Columns of the log model; all are strings. */
+typedef enum {
+    SAT_LOG_MODEL_COL_TIME = 0,
+    SAT_LOG_MODEL_COL_LEVEL,
+    SAT_LOG_MODEL_COL_MSG,
+    SAT_LOG_MODEL_COL_NUMBER
+} sat_log_model_col_t;
+
+
+#define SAT_TYPE_LOG_MODEL          (sat_log_model_get_type ())
+#define SAT_LOG_MODEL(obj)          G_TYPE_CHECK_INSTANCE_CAST (obj,\
+                                    sat_log_model_get_type (),     \
+                                    SatLogModel)
+#define IS_SAT_LOG_MODEL(obj)       G_TYPE_CHECK_INSTANCE_TYPE (obj, sat_log_model_get_type ())
+
+
+typedef struct _sat_log_model SatLogModel;
+typedef struct _SatLogModelClass SatLogModelClass;
+
+/**
+ * \brief Flat GtkTreeModel showing the rows of a log index.
+ *
+ * The rows are formatted when the tree view asks for them, so only the
+ * visible rows are ever converted to strings. The model does not own the
+ * index and does not follow changes to it; after changing the filter of
+ * the index a new model has to be set on the view.
+ */
+struct _sat_log_model {
+    GObject         parent;
+
+    log_index_t    *idx;        /*!< The log index or NULL */
+    gint            stamp;      /*!< Stamp of valid iterators */
+};
+
+struct _SatLogModelClass {
+    GObjectClass    parent_class;
+};
+
+
+GType           sat_log_model_get_type(void);
+GtkTreeModel   *sat_log_model_new(log_index_t * idx);
+
+#endif
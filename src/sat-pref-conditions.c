@@ -42,6 +42,7 @@ static GtkWidget *lookahead;
 static GtkWidget *res;
 static GtkWidget *nument;
 static GtkWidget *twspin;
+static GtkWidget *ephem;
 
 static gboolean dirty = FALSE;  /* used to check whether any changes have occurred */
 static gboolean reset = FALSE;
@@ -67,7 +68,7 @@ GtkWidget *sat_pref_conditions_create ()
      dirty = FALSE;
      reset = FALSE;
 
-     table = gtk_table_new (14, 3, FALSE);
+     table = gtk_table_new (15, 3, FALSE);
      gtk_table_set_row_spacings (GTK_TABLE (table), 10);
      gtk_table_set_col_spacings (GTK_TABLE (table), 5);
 
@@ -330,6 +331,24 @@ GtkWidget *sat_pref_conditions_create ()
     gtk_table_attach (GTK_TABLE (table), tzero, 0, 3, 13, 14,
                       GTK_FILL | GTK_EXPAND, GTK_SHRINK,
                       0, 0);
+
+    /* interpolated ephemeris in simulated time */
+    ephem = gtk_check_button_new_with_label (_("Use interpolated ephemeris when simulating time"));
+    gtk_widget_set_tooltip_text (ephem,
+                                 _("Check this box if you want Gpredict to interpolate "\
+                                   "the satellite positions between precalculated points "\
+                                   "while the time controller is not running in real time.\n\n"\
+                                   "This greatly reduces the CPU load when running with a "\
+                                   "high throttle value. The position error is below 10 m "\
+                                   "for most satellites."));
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (ephem),
+                                  sat_cfg_get_bool (SAT_CFG_BOOL_PRED_EPHEM_CACHE));
+    g_signal_connect (G_OBJECT (ephem), "toggled",
+                      G_CALLBACK (spin_changed_cb), NULL);
+
+    gtk_table_attach (GTK_TABLE (table), ephem, 0, 3, 14, 15,
+                      GTK_FILL | GTK_EXPAND, GTK_SHRINK,
+                      0, 0);
     
      /* create vertical box */
      vbox = gtk_vbox_new (FALSE, 0);
@@ -374,6 +393,8 @@ sat_pref_conditions_ok     ()
                          gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (twspin)));
         sat_cfg_set_bool (SAT_CFG_BOOL_PRED_USE_REAL_T0,
                           gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (tzero)));
+        sat_cfg_set_bool (SAT_CFG_BOOL_PRED_EPHEM_CACHE,
+                          gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (ephem)));
 
           dirty = FALSE;
      }
@@ -385,6 +406,7 @@ sat_pref_conditions_ok     ()
           sat_cfg_reset_int (SAT_CFG_INT_PRED_NUM_ENTRIES);
         sat_cfg_reset_int (SAT_CFG_INT_PRED_TWILIGHT_THLD);
         sat_cfg_reset_bool (SAT_CFG_BOOL_PRED_USE_REAL_T0);
+        sat_cfg_reset_bool (SAT_CFG_BOOL_PRED_EPHEM_CACHE);
 
           reset = FALSE;
      }
@@ -461,6 +483,8 @@ reset_cb               (GtkWidget *button, gpointer data)
                                sat_cfg_get_int_def (SAT_CFG_INT_PRED_TWILIGHT_THLD));
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (tzero),
                                   sat_cfg_get_bool_def (SAT_CFG_BOOL_PRED_USE_REAL_T0));
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (ephem),
+                                  sat_cfg_get_bool_def (SAT_CFG_BOOL_PRED_EPHEM_CACHE));
 
      /* reset flags */
      reset = TRUE;
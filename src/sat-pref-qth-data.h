@@ -42,6 +42,7 @@ typedef enum {
      QTH_LIST_COL_TYPE,        /*!< Is this QTH the default one? */
      QTH_LIST_COL_GPSD_SERVER,        /*!< Is this QTH the default one? */
      QTH_LIST_COL_GPSD_PORT,        /*!< Is this QTH the default one? */
+     QTH_LIST_COL_TRACK,      /*!< Trajectory file of a track QTH. */
      QTH_LIST_COL_NUM         /*!< The number of fields. */
 } qth_list_col_t;
 
@@ -49,6 +49,7 @@
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
 #endif
+#include "compat.h"
 #include "gpredict-utils.h"
 #include "loc-tree.h"
 #include "sat-cfg.h"
@@ -56,6 +57,7 @@
 #include "sat-pref-qth-data.h"
 #include "sat-pref-qth-editor.h"
 #include "locator.h"
+#include "qth-data.h"
 
 /**
  * Symbolic refs to be used when calling select_location in order
@@ -79,11 +81,21 @@ static GtkWidget *ns, *ew;
 
 static GtkWidget *qra;          /* QRA locator */
 
+static GtkWidget *type;         /* QTH type */
 #ifdef HAS_LIBGPS
-static GtkWidget *type;         /* GPSD type */
 static GtkWidget *server;       /* GPSD Server */
 static GtkWidget *port;         /* GPSD Port */
 #endif
+static GtkWidget *track;        /* Track file */
+
+/* QTH types in the order of the type combo */
+static const gint qth_types[] = {
+    QTH_STATIC_TYPE,
+#ifdef HAS_LIBGPS
+    QTH_GPSD_TYPE,
+#endif
+    QTH_TRACK_TYPE
+};
 static gulong   latsigid, lonsigid, nssigid, ewsigid, qrasigid;
 
 static GtkWidget *wx;           /* weather station */
@@ -97,6 +109,7 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new);
 
 static void     latlon_changed(GtkWidget * widget, gpointer data);
 static void     qra_changed(GtkEntry * entry, gpointer data);
+static void     type_changed(GtkComboBox * combo, gpointer data);
 
 
 /**
@@ -348,21 +361,43 @@ static GtkWidget *create_editor_widgets(GtkTreeView * treeview, gboolean new)
                      GUINT_TO_POINTER(SELECTION_MODE_WX));
     gtk_table_attach_defaults(GTK_TABLE(table), wxbut, 3, 4, 7, 8);
 
-#ifdef HAS_LIBGPS
-    /* GPSD enabled */
+    /* QTH type */
     label = gtk_label_new(_("QTH Type"));
     gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
     gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 8, 9);
 
     type = gtk_combo_box_new_text();
     gtk_combo_box_append_text(GTK_COMBO_BOX(type), "Static");
+#ifdef HAS_LIBGPS
     gtk_combo_box_append_text(GTK_COMBO_BOX(type), "GPSD");
+#endif
+    gtk_combo_box_append_text(GTK_COMBO_BOX(type), "Track");
     gtk_combo_box_set_active(GTK_COMBO_BOX(type), 0);
     gtk_widget_set_tooltip_text(type,
                                 _("A qth can be static, ie. it does not "
-                                  "change, or gpsd based for computers with "
-                                  "gps attached."));
+                                  "change, gpsd based for computers with "
+                                  "gps attached, or follow a planned track "
+                                  "read from a file."));
+    g_signal_connect(type, "changed", G_CALLBACK(type_changed), NULL);
     gtk_table_attach_defaults(GTK_TABLE(table), type, 1, 2, 8, 9);
+
+    /* Track file */
+    label = gtk_label_new(_("Track"));
+    gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
+    gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, 11, 12);
+
+    track = gtk_file_chooser_button_new(_("Select track file"),
+                                        GTK_FILE_CHOOSER_ACTION_OPEN);
+    gtk_widget_set_tooltip_text(track,
+                                _("File with the planned trajectory of a "
+                                  "track QTH. Each line holds a point as "
+                                  "time,lat,lon,alt where the time is UTC, "
+                                  "e.g. 2020-01-01 12:00:00, and the "
+                                  "altitude in meters is optional."));
+    gtk_widget_set_sensitive(track, FALSE);
+    gtk_table_attach_defaults(GTK_TABLE(table), track, 1, 4, 11, 12);
+
+#ifdef HAS_LIBGPS
     /* GPSD Server */
     label = gtk_label_new(_("GPSD Server"));
     gtk_misc_set_alignment(GTK_MISC(label), 0.0, 0.5);
@@ -411,6 +446,10 @@ static void update_widgets(GtkTreeView * treeview)
     gchar          *qthgpsdserver;      /* gpsdserver */
     guint           qthtype;    /* type */
     guint           qthgpsdport;        /* gpsdport */
+    gchar          *qthtrack;   /* track file */
+    gchar          *confdir;
+    gchar          *path;
+    guint           i;
 
     selection = gtk_tree_view_get_selection(treeview);
     if (gtk_tree_selection_get_selected(selection, &model, &iter))
@@ -426,6 +465,7 @@ static void update_widgets(GtkTreeView * treeview)
                            QTH_LIST_COL_WX, &qthwx,
                            QTH_LIST_COL_GPSD_SERVER, &qthgpsdserver,
                            QTH_LIST_COL_GPSD_PORT, &qthgpsdport,
+                           QTH_LIST_COL_TRACK, &qthtrack,
                            QTH_LIST_COL_TYPE, &qthtype, -1);
 
         /* update widgets and free memory afterwards */
@@ -475,8 +515,28 @@ static void update_widgets(GtkTreeView * treeview)
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(alt), qthalt);
 #ifdef HAS_LIBGPS
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(port), qthgpsdport);
-        gtk_combo_box_set_active(GTK_COMBO_BOX(type), qthtype);
 #endif
+        for (i = 0; i < G_N_ELEMENTS(qth_types); i++)
+            if (qth_types[i] == (gint) qthtype)
+                gtk_combo_box_set_active(GTK_COMBO_BOX(type), i);
+
+        /* relative track files are next to the .qth files */
+        if (qthtrack && qthtrack[0] != '\0')
+        {
+            if (g_path_is_absolute(qthtrack))
+            {
+                path = g_strdup(qthtrack);
+            }
+            else
+            {
+                confdir = get_user_conf_dir();
+                path = g_build_filename(confdir, qthtrack, NULL);
+                g_free(confdir);
+            }
+            gtk_file_chooser_set_filename(GTK_FILE_CHOOSER(track), path);
+            g_free(path);
+        }
+        g_free(qthtrack);
 
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
                     _("%s:%d: Loaded %s for editing:\n"
@@ -512,6 +572,7 @@ static void clear_widgets()
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(lon), 0.0);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(alt), 0);
     gtk_entry_set_text(GTK_ENTRY(qra), "");
+    gtk_file_chooser_unselect_all(GTK_FILE_CHOOSER(track));
 }
 
 /**
@@ -536,6 +597,7 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
     guint           qthalt;
     guint           qthtype;
     guint           qthgpsdport;
+    gchar          *qthtrack;
     const gchar    *qthqra;
 
     /* get values from dialog box */
@@ -562,11 +624,10 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
 
 #ifdef HAS_LIBGPS
     qthgpsdport = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(port));
-    qthtype = gtk_combo_box_get_active(GTK_COMBO_BOX(type));
 #else
     qthgpsdport = 0;
-    qthtype = 0; // FIXME: should probably use a #define
 #endif
+    qthtype = qth_types[MAX(gtk_combo_box_get_active(GTK_COMBO_BOX(type)), 0)];
 
     /* get liststore */
     liststore = GTK_LIST_STORE(gtk_tree_view_get_model(treeview));
@@ -597,6 +658,8 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
         }
     }
 
+    qthtrack = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(track));
+
     /* update values */
     gtk_list_store_set(liststore, &iter,
                        QTH_LIST_COL_NAME, qthname,
@@ -608,7 +671,9 @@ static gboolean apply_changes(GtkTreeView * treeview, gboolean new)
                        QTH_LIST_COL_WX, qthwx,
                        QTH_LIST_COL_GPSD_SERVER, qthgpsdserver,
                        QTH_LIST_COL_GPSD_PORT, qthgpsdport,
+                       QTH_LIST_COL_TRACK, qthtrack,
                        QTH_LIST_COL_TYPE, qthtype, -1);
+    g_free(qthtrack);
 
     qthqra = gtk_entry_get_text(GTK_ENTRY(qra));
     gtk_list_store_set(liststore, &iter, QTH_LIST_COL_QRA, qthqra, -1);
@@ -897,3 +962,14 @@ static void qra_changed(GtkEntry * entry, gpointer data)
     }
 
 }
+
+/** Make the track file selectable for track QTHs only. */
+static void type_changed(GtkComboBox * combo, gpointer data)
+{
+    gint            active = gtk_combo_box_get_active(combo);
+
+    (void)data;                 /* avoid unused parameter compiler warning */
+
+    gtk_widget_set_sensitive(track, active >= 0 &&
+                             qth_types[active] == QTH_TRACK_TYPE);
+}
@@ -331,7 +331,8 @@ create_and_fill_model ()
                                      G_TYPE_BOOLEAN,    // Default
                                      G_TYPE_INT, //type
                                      G_TYPE_STRING, //server
-                                     G_TYPE_INT //port
+                                     G_TYPE_INT, //port
+                                     G_TYPE_STRING //track
                                              );
 
      gtk_tree_sortable_set_sort_column_id( GTK_TREE_SORTABLE(liststore), QTH_LIST_COL_NAME,GTK_SORT_ASCENDING);
@@ -491,6 +492,7 @@ read_qth_file (GtkListStore *liststore, gchar *filename)
                               QTH_LIST_COL_TYPE, qth->type,
                               QTH_LIST_COL_GPSD_SERVER, qth->gpsd_server,
                               QTH_LIST_COL_GPSD_PORT, qth->gpsd_port,
+                              QTH_LIST_COL_TRACK, qth->track_file,
                               -1);
 
      g_free (fname);
@@ -906,6 +908,7 @@ save_qth (GtkTreeModel *model,
                          QTH_LIST_COL_TYPE, &qth.type,
                          QTH_LIST_COL_GPSD_SERVER, &qth.gpsd_server,
                          QTH_LIST_COL_GPSD_PORT, &qth.gpsd_port,
+                         QTH_LIST_COL_TRACK, &qth.track_file,
                          -1);
 
     confdir = get_user_conf_dir ();
@@ -941,6 +944,7 @@ save_qth (GtkTreeModel *model,
      g_free (qth.loc);
      g_free (qth.desc);
      g_free (qth.wx);
+     g_free (qth.track_file);
 
      return FALSE;
 }
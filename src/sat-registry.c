@@ -0,0 +1,335 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/**
+ * \brief Satellite registry.
+ *
+ * The satellites of a module used to live in a hash table keyed by
+ * individually allocated catalogue numbers, so that every lookup had to
+ * allocate a key and iterating visited the satellites in hash order. The
+ * registry keeps them in a single array sorted by catalogue number instead;
+ * lookups are a binary search in a compact array of integers and iteration
+ * is a plain loop in a deterministic order.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "gtk-sat-data.h"
+#include "sat-log.h"
+#include "sat-registry.h"
+#include "startup-profile.h"
+
+
+static int      compare_catnum(const void *a, const void *b);
+static void     free_sat_data(sat_t * sat);
+
+
+/** \brief Create a new, empty registry. */
+sat_registry_t *sat_registry_new()
+{
+    return g_new0(sat_registry_t, 1);
+}
+
+/** \brief Free a registry and all satellites in it. */
+void sat_registry_free(sat_registry_t * reg)
+{
+    if (reg == NULL)
+        return;
+
+    sat_registry_clear(reg);
+    g_free(reg);
+}
+
+/**
+ * \brief Remove all satellites from the registry.
+ *
+ * All sat_t pointers and indices obtained from the registry become invalid.
+ */
+void sat_registry_clear(sat_registry_t * reg)
+{
+    guint           i;
+
+    g_return_if_fail(reg != NULL);
+
+    for (i = 0; i < reg->num; i++)
+        free_sat_data(&reg->sats[i]);
+
+    g_free(reg->sats);
+    g_free(reg->work);
+    g_free(reg->catnums);
+    reg->sats = NULL;
+    reg->work = NULL;
+    reg->catnums = NULL;
+    reg->num = 0;
+}
+
+/**
+ * \brief Remove all satellites from a shadow registry.
+ *
+ * A shadow registry holds copies of the satellites of another registry and
+ * borrows their names, so unlike sat_registry_clear() the satellite data is
+ * left alone.
+ */
+void sat_registry_clear_shadow(sat_registry_t * reg)
+{
+    g_return_if_fail(reg != NULL);
+
+    g_free(reg->sats);
+    g_free(reg->work);
+    g_free(reg->catnums);
+    reg->sats = NULL;
+    reg->work = NULL;
+    reg->catnums = NULL;
+    reg->num = 0;
+}
+
+/** \brief Free a shadow registry; see sat_registry_clear_shadow(). */
+void sat_registry_free_shadow(sat_registry_t * reg)
+{
+    if (reg == NULL)
+        return;
+
+    sat_registry_clear_shadow(reg);
+    g_free(reg);
+}
+
+/**
+ * \brief Load satellites into the registry.
+ * \param reg The registry.
+ * \param catnums The catalogue numbers of the satellites to load.
+ * \param length The number of elements in catnums.
+ * \param qth The QTH used to initialise the satellites.
+ * \return The number of satellites loaded.
+ *
+ * The registry is cleared before loading. Satellites that can not be read
+ * and duplicates are skipped.
+ */
+guint sat_registry_load(sat_registry_t * reg, const gint * catnums,
+                        gsize length, qth_t * qth)
+{
+    sat_t          *sat;
+    guint           i, j;
+    guint           num = 0;
+    gint64          t;
+
+    g_return_val_if_fail(reg != NULL, 0);
+
+    sat_registry_clear(reg);
+
+    if (length == 0)
+        return 0;
+
+    reg->sats = g_new0(sat_t, length);
+
+    for (i = 0; i < length; i++)
+    {
+        t = startup_profile_begin();
+        if (gtk_sat_data_read_sat(catnums[i], &reg->sats[num]))
+        {
+            /* the satellite could not be read */
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error reading data for #%d"),
+                        __func__, catnums[i]);
+            free_sat_data(&reg->sats[num]);
+        }
+        else
+        {
+            num++;
+        }
+        startup_profile_end(t, "gtk_sat_data_read_sat", "%d", catnums[i]);
+    }
+
+    /* sort, then drop duplicates */
+    qsort(reg->sats, num, sizeof(sat_t), compare_catnum);
+
+    for (i = 0, j = 0; i < num; i++)
+    {
+        sat = &reg->sats[i];
+
+        if (j > 0 && reg->sats[j - 1].tle.catnr == sat->tle.catnr)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Sat #%d already in list"),
+                        __func__, sat->tle.catnr);
+            free_sat_data(sat);
+            continue;
+        }
+
+        if (i != j)
+            reg->sats[j] = *sat;
+
+        sat = &reg->sats[j++];
+        gtk_sat_data_init_sat(sat, qth);
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Read data for #%d"), __func__, sat->tle.catnr);
+    }
+
+    reg->num = j;
+    reg->catnums = g_new(gint, reg->num);
+    for (i = 0; i < reg->num; i++)
+        reg->catnums[i] = reg->sats[i].tle.catnr;
+
+    /* the names are owned by sats and shared with the working copies */
+    reg->work = g_memdup(reg->sats, reg->num * sizeof(sat_t));
+
+    return reg->num;
+}
+
+/**
+ * \brief Get the index of a satellite.
+ * \param reg The registry.
+ * \param catnum The catalogue number of the satellite.
+ * \return The index of the satellite or -1 if it is not in the registry.
+ */
+gint sat_registry_index(sat_registry_t * reg, gint catnum)
+{
+    guint           lo = 0;
+    guint           hi;
+    guint           mid;
+
+    g_return_val_if_fail(reg != NULL, -1);
+
+    hi = reg->num;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+
+        if (reg->catnums[mid] < catnum)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < reg->num && reg->catnums[lo] == catnum)
+        return (gint) lo;
+
+    return -1;
+}
+
+/**
+ * \brief Look up a satellite.
+ * \param reg The registry.
+ * \param catnum The catalogue number of the satellite.
+ * \return The satellite or NULL if it is not in the registry.
+ */
+sat_t          *sat_registry_lookup(sat_registry_t * reg, gint catnum)
+{
+    gint            i;
+
+    i = sat_registry_index(reg, catnum);
+    if (i < 0)
+        return NULL;
+
+    return &reg->sats[i];
+}
+
+/**
+ * \brief Publish the tracking data of a satellite.
+ * \param reg The registry.
+ * \param i The index of the satellite.
+ *
+ * Copies the data calculated for the current cycle from the propagator
+ * state to the satellite seen by the views. The orbital elements and the
+ * SGP4/SDP4 state are not copied, and neither are RA and Dec, which the
+ * views calculate themselves when they need them.
+ */
+void sat_registry_publish(sat_registry_t * reg, guint i)
+{
+    sat_t          *dst;
+    const sat_t    *src;
+
+    g_return_if_fail((reg != NULL) && (i < reg->num));
+
+    dst = &reg->sats[i];
+    src = &reg->work[i];
+
+    dst->pos = src->pos;
+    dst->vel = src->vel;
+    dst->jul_utc = src->jul_utc;
+    dst->tsince = src->tsince;
+    dst->aos = src->aos;
+    dst->los = src->los;
+    dst->az = src->az;
+    dst->el = src->el;
+    dst->range = src->range;
+    dst->range_rate = src->range_rate;
+    dst->ssplat = src->ssplat;
+    dst->ssplon = src->ssplon;
+    dst->alt = src->alt;
+    dst->velo = src->velo;
+    dst->ma = src->ma;
+    dst->footprint = src->footprint;
+    dst->phase = src->phase;
+    dst->orbit = src->orbit;
+}
+
+/**
+ * \brief Call a function for each satellite in catalogue number order.
+ * \param reg The registry.
+ * \param func The function; it gets a pointer to the catalogue number as
+ *             key and the sat_t as value, like for the old hash table.
+ * \param data User data passed to func.
+ */
+void sat_registry_foreach(sat_registry_t * reg, GHFunc func, gpointer data)
+{
+    guint           i;
+
+    g_return_if_fail(reg != NULL);
+
+    for (i = 0; i < reg->num; i++)
+        func(&reg->catnums[i], &reg->sats[i], data);
+}
+
+/** \brief Compare function for sorting satellites by catalogue number. */
+static int compare_catnum(const void *a, const void *b)
+{
+    const sat_t    *sa = a;
+    const sat_t    *sb = b;
+
+    if (sa->tle.catnr < sb->tle.catnr)
+        return -1;
+
+    return (sa->tle.catnr > sb->tle.catnr);
+}
+
+/** \brief Free the strings owned by a satellite, but not the sat_t itself. */
+static void free_sat_data(sat_t * sat)
+{
+    g_free(sat->name);
+    g_free(sat->nickname);
+    g_free(sat->website);
+    sat->name = NULL;
+    sat->nickname = NULL;
+    sat->website = NULL;
+}
@@ -0,0 +1,77 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_REGISTRY_H
+#define SAT_REGISTRY_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+#include "qth-data.h"
+
+
+/** \brief The satellites of a module.
+ *
+ * The satellites are stored in one contiguous array sorted by catalogue
+ * number, with a parallel array of the catalogue numbers used for lookups.
+ * Indices and sat_t pointers remain valid until the registry is cleared or
+ * reloaded.
+ *
+ * The propagator works on a second array, work, and the tracking data of
+ * each cycle is copied to sats by sat_registry_publish() once it is
+ * complete. The views only read sats and do their own look-ahead on
+ * private copies, so the data they see is always from one cycle.
+ */
+typedef struct {
+    sat_t      *sats;       /*!< Satellites sorted by catalogue number */
+    sat_t      *work;       /*!< Propagator state, work[i] belongs to sats[i] */
+    gint       *catnums;    /*!< catnums[i] == sats[i].tle.catnr */
+    guint       num;        /*!< Number of satellites */
+} sat_registry_t;
+
+
+/** \brief Get the satellite with index i. */
+#define sat_registry_nth(reg, i)  (&(reg)->sats[(i)])
+
+/** \brief Get the propagator state of the satellite with index i. */
+#define sat_registry_work(reg, i) (&(reg)->work[(i)])
+
+
+sat_registry_t *sat_registry_new     (void);
+void            sat_registry_free    (sat_registry_t *reg);
+void            sat_registry_clear   (sat_registry_t *reg);
+void            sat_registry_clear_shadow (sat_registry_t *reg);
+void            sat_registry_free_shadow  (sat_registry_t *reg);
+guint           sat_registry_load    (sat_registry_t *reg,
+                                      const gint *catnums, gsize length,
+                                      qth_t *qth);
+gint            sat_registry_index   (sat_registry_t *reg, gint catnum);
+sat_t          *sat_registry_lookup  (sat_registry_t *reg, gint catnum);
+void            sat_registry_publish (sat_registry_t *reg, guint i);
+void            sat_registry_foreach (sat_registry_t *reg,
+                                      GHFunc func, gpointer data);
+
+#endif
@@ -39,7 +39,7 @@
 #include "gtk-sat-data.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
-#include "pass-to-txt.h"
+#include "pass-export.h"
 #include "save-pass.h"
 #ifdef HAVE_CONFIG_H
 #  include <build-config.h>
@@ -56,18 +56,16 @@ static void save_passes_exec (GtkWidget *parent,
                               GSList *passes, qth_t *qth,
                               const gchar *savedir, const gchar *savefile,
                               gint format, gint contents);
-static void save_to_file (GtkWidget *parent, const gchar *fname, const gchar *data);
+static pass_export_t *open_export (GtkWidget *parent, const gchar *fname,
+                                   gint format, qth_t *qth);
+static void close_export (GtkWidget *parent, pass_export_t *ex, const gchar *fname);
 
 
-enum pass_content_e {
-    PASS_CONTENT_ALL = 0,
-    PASS_CONTENT_TABLE,
-    PASS_CONTENT_DATA,
-};
-
-enum passes_content_e {
-    PASSES_CONTENT_FULL = 0,
-    PASSES_CONTENT_SUM,
+/** \brief File name extension for each save_format_t */
+static const gchar *SAVE_EXT[] = {
+    ".txt",
+    ".csv",
+    ".json"
 };
 
 
@@ -171,14 +169,16 @@ void save_pass   (GtkWidget *parent)
 
     fmtchooser = gtk_combo_box_new_text ();
     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Plain text (*.txt)"));
+    gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Comma separated values (*.csv)"));
+    gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("JSON (*.json)"));
     /*     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Hypertext (*.html)")); */
     /*     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Docbook (*.xml)")); */
-    gtk_combo_box_set_active (GTK_COMBO_BOX (fmtchooser),
-                              sat_cfg_get_int (SAT_CFG_INT_PRED_SAVE_FORMAT));
+    format = sat_cfg_get_int (SAT_CFG_INT_PRED_SAVE_FORMAT);
+    if ((format < 0) || (format >= (gint) G_N_ELEMENTS (SAVE_EXT)))
+        format = SAVE_FORMAT_TXT;
+    gtk_combo_box_set_active (GTK_COMBO_BOX (fmtchooser), format);
     gtk_table_attach_defaults (GTK_TABLE (table), fmtchooser, 1, 2, 2, 3);
 
-    gtk_widget_set_sensitive (fmtchooser, FALSE);
-
     /* file contents */
     label = gtk_label_new (_("File contents:"));
     gtk_misc_set_alignment (GTK_MISC (label), 0.0, 0.5);
@@ -334,14 +334,16 @@ void save_passes (GtkWidget *parent)
 
     fmtchooser = gtk_combo_box_new_text ();
     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Plain text (*.txt)"));
+    gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Comma separated values (*.csv)"));
+    gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("JSON (*.json)"));
     /*     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Hypertext (*.html)")); */
     /*     gtk_combo_box_append_text (GTK_COMBO_BOX (fmtchooser), _("Docbook (*.xml)")); */
-    gtk_combo_box_set_active (GTK_COMBO_BOX (fmtchooser),
-                              sat_cfg_get_int (SAT_CFG_INT_PRED_SAVE_FORMAT));
+    format = sat_cfg_get_int (SAT_CFG_INT_PRED_SAVE_FORMAT);
+    if ((format < 0) || (format >= (gint) G_N_ELEMENTS (SAVE_EXT)))
+        format = SAVE_FORMAT_TXT;
+    gtk_combo_box_set_active (GTK_COMBO_BOX (fmtchooser), format);
     gtk_table_attach_defaults (GTK_TABLE (table), fmtchooser, 1, 2, 2, 3);
 
-    gtk_widget_set_sensitive (fmtchooser, FALSE);
-
     /* file contents */
     label = gtk_label_new (_("File contents:"));
     gtk_misc_set_alignment (GTK_MISC (label), 0.0, 0.5);
@@ -474,72 +476,31 @@ static void save_passes_exec (GtkWidget *parent,
                               const gchar *savedir, const gchar *savefile,
                               gint format, gint contents)
 {
-    gchar      *fname;
-    gchar      *pgheader;
-    gchar      *tblheader;
-    gchar      *tblcontents;
-    gchar      *buff = NULL;
-    gchar      *data = NULL;
-    pass_t     *pass;
-    gint        fields;
-    guint       i,n;
-
-
-    switch (format) {
-
-    case SAVE_FORMAT_TXT:
-
-        /* prepare full file name */
-        fname = g_strconcat (savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
-
-        /* get visible columns for summary */
-        fields = sat_cfg_get_int (SAT_CFG_INT_PRED_MULTI_COL);
+    pass_export_t *ex;
+    gchar         *fname;
 
-        /* create file contents */
-        pgheader = passes_to_txt_pgheader (passes, qth, fields);
-        tblheader = passes_to_txt_tblheader (passes, qth, fields);
-        tblcontents = passes_to_txt_tblcontents (passes, qth, fields);
-
-        data = g_strconcat (pgheader, tblheader, tblcontents, NULL);
-
-        g_free (pgheader);
-        g_free (tblheader);
-        g_free (tblcontents);
-
-        if (contents == PASSES_CONTENT_FULL) {
-            fields = sat_cfg_get_int (SAT_CFG_INT_PRED_SINGLE_COL);
-            n = g_slist_length (passes);
-
-            for (i = 0; i < n; i++) {
-
-                pass = PASS (g_slist_nth_data (passes, i));
-
-                tblheader = pass_to_txt_tblheader (pass, qth, fields);
-                tblcontents = pass_to_txt_tblcontents (pass, qth, fields);
-                buff = g_strdup_printf ("%s\n Orbit %d\n%s%s",
-                                        data, pass->orbit,
-                                        tblheader, tblcontents);
-                g_free (data);
-                data = g_strdup (buff);
-                g_free (buff);
-
-            }
-        }
 
-        /* save data */
-        save_to_file (parent, fname, data);
-        g_free (data);
-        g_free (fname);
-
-        break;
-
-    default:
+    if ((format < 0) || (format >= (gint) G_N_ELEMENTS (SAVE_EXT))) {
         sat_log_log (SAT_LOG_LEVEL_ERROR,
                      _("%s: Invalid file format: %d"),
                      __func__, format);
-        break;
+        return;
+    }
+
+    /* prepare full file name */
+    fname = g_strconcat (savedir, G_DIR_SEPARATOR_S, savefile, SAVE_EXT[format], NULL);
+
+    /* rows are written to the file as they are formatted */
+    ex = open_export (parent, fname, format, qth);
+    if (ex != NULL) {
+        pass_export_passes (ex, passes,
+                            sat_cfg_get_int (SAT_CFG_INT_PRED_MULTI_COL),
+                            sat_cfg_get_int (SAT_CFG_INT_PRED_SINGLE_COL),
+                            contents == PASSES_CONTENT_FULL);
+        close_export (parent, ex, fname);
     }
 
+    g_free (fname);
 }
 
 
@@ -567,96 +528,53 @@ static void save_pass_exec (GtkWidget *parent,
                             const gchar *savedir, const gchar *savefile,
                             gint format, gint contents)
 {
-    gchar      *fname;
-    gchar      *pgheader;
-    gchar      *tblheader;
-    gchar      *tblcontents;
-    gchar      *buff = NULL;
-    gchar      *data = NULL;
-    gint        fields;
-
-
-    switch (format) {
-
-    case SAVE_FORMAT_TXT:
-
-        /* prepare full file name */
-        fname = g_strconcat (savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
-
-        /* get visible columns */
-        fields = sat_cfg_get_int (SAT_CFG_INT_PRED_SINGLE_COL);
-
-        /* create file contents */
-        pgheader = pass_to_txt_pgheader (pass, qth, fields);
-        tblheader = pass_to_txt_tblheader (pass, qth, fields);
-        tblcontents = pass_to_txt_tblcontents (pass, qth, fields);
-
-        /* Add page header if selected */
-        if (contents == PASS_CONTENT_ALL) {
-            data = g_strdup (pgheader);
-        }
-
-        /* Add table header if selected */
-        if ((contents == PASS_CONTENT_ALL) || (contents == PASS_CONTENT_TABLE)) {
+    pass_export_t *ex;
+    gchar         *fname;
 
-            if (data != NULL) {
-                buff = g_strdup (data);
-                g_free (data);
-                data = g_strconcat (buff, tblheader, NULL);
-                g_free (buff);
-            }
-            else {
-                data = g_strdup (tblheader);
-            }
-
-        }
-
-        /* Add data */
-        if (data != NULL) {
-            buff = g_strdup (data);
-            g_free (data);
-            data = g_strconcat (buff, tblcontents, NULL);
-            g_free (buff);
-        }
-        else {
-            data = g_strdup (tblcontents);
-        }
-    
-        /* save data */
-        save_to_file (parent, fname, data);
-
-        /* clean up memory */
-        g_free (fname);
-        g_free (data);
-        g_free (pgheader);
-        g_free (tblheader);
-        g_free (tblcontents);
-
-        break;
 
-    default:
+    if ((format < 0) || (format >= (gint) G_N_ELEMENTS (SAVE_EXT))) {
         sat_log_log (SAT_LOG_LEVEL_ERROR,
                      _("%s: Invalid file format: %d"),
                      __func__, format);
-        break;
+        return;
     }
 
+    /* prepare full file name */
+    fname = g_strconcat (savedir, G_DIR_SEPARATOR_S, savefile, SAVE_EXT[format], NULL);
+
+    /* rows are written to the file as they are formatted */
+    ex = open_export (parent, fname, format, qth);
+    if (ex != NULL) {
+        pass_export_pass (ex, pass,
+                          sat_cfg_get_int (SAT_CFG_INT_PRED_SINGLE_COL),
+                          contents);
+        close_export (parent, ex, fname);
+    }
+
+    g_free (fname);
 }
 
 
 
 
-static void save_to_file (GtkWidget *parent, const gchar *fname, const gchar *data)
+/** \brief Create the export file.
+ *  \param parent Parent window (needed for error dialogs).
+ *  \param fname The file name.
+ *  \param format The file format.
+ *  \param qth The observer data.
+ *  \return A new pass export writer or NULL if the file could not be created.
+ */
+static pass_export_t *open_export (GtkWidget *parent, const gchar *fname,
+                                   gint format, qth_t *qth)
 {
-    GIOChannel *chan;
-    GError     *err = NULL;
-    GtkWidget  *dialog;
-    gsize       count;
+    pass_export_t *ex;
+    GError        *err = NULL;
+    GtkWidget     *dialog;
 
 
     /* create file */
-    chan = g_io_channel_new_file (fname, "w", &err);
-    if (err != NULL) {
+    ex = pass_export_open (fname, format, qth, &err);
+    if (ex == NULL) {
         sat_log_log (SAT_LOG_LEVEL_ERROR,
                      _("%s: Could not create file %s (%s)"),
                      __func__, fname, err->message);
@@ -674,13 +592,24 @@ static void save_to_file (GtkWidget *parent, const gchar *fname, const gchar *da
 
         /* clean up and return */
         g_clear_error (&err);
-
-        return;
     }
 
-    /* save contents to file */
-    g_io_channel_write_chars (chan, data, -1, &count, &err);
-    if (err != NULL) {
+    return ex;
+}
+
+
+/** \brief Flush and close the export file.
+ *  \param parent Parent window (needed for error dialogs).
+ *  \param ex The pass export writer.
+ *  \param fname The file name.
+ */
+static void close_export (GtkWidget *parent, pass_export_t *ex, const gchar *fname)
+{
+    GError     *err = NULL;
+    GtkWidget  *dialog;
+
+
+    if (!pass_export_close (ex, &err)) {
         sat_log_log (SAT_LOG_LEVEL_ERROR,
                      _("%s: An error occurred while saving data to %s (%s)"),
                      __func__, fname, err->message);
@@ -698,13 +627,7 @@ static void save_to_file (GtkWidget *parent, const gchar *fname, const gchar *da
     }
     else {
         sat_log_log (SAT_LOG_LEVEL_DEBUG,
-                     _("%s: Written %d characters to %s"),
-                     __func__, count, fname);
+                     _("%s: Data saved to %s"),
+                     __func__, fname);
     }
-
-    /* close file, we don't care about errors here */
-    g_io_channel_shutdown (chan, TRUE, NULL);
-    g_io_channel_unref (chan);
-
 }
-
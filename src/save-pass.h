@@ -37,10 +37,26 @@
 /** \brief Save format */
 typedef enum {
      SAVE_FORMAT_TXT = 0,   /*!< Save in plain text format (data only) */
+     SAVE_FORMAT_CSV,       /*!< Comma separated values */
+     SAVE_FORMAT_JSON,      /*!< JSON document */
      //SAVE_FORMAT_HTML,      /*!< HTML format (data and graphics) */
 } save_format_t;
 
 
+/** \brief Contents of a single pass file. */
+enum pass_content_e {
+    PASS_CONTENT_ALL = 0,   /*!< Page header, table header and data */
+    PASS_CONTENT_TABLE,     /*!< Table header and data */
+    PASS_CONTENT_DATA,      /*!< Data only */
+};
+
+/** \brief Contents of a multiple passes file. */
+enum passes_content_e {
+    PASSES_CONTENT_FULL = 0,    /*!< Summary followed by the details of each pass */
+    PASSES_CONTENT_SUM,         /*!< Summary only */
+};
+
+
 void save_pass   (GtkWidget *parent);
 void save_passes (GtkWidget *parent);
 
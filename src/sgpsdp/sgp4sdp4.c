@@ -541,6 +541,8 @@ Deep (int ientry, sat_t *sat)
 		xndot,xno2,xnodce,xnoi,xomi,xpidot,z1,z11,z12,z13,
 		z2,z21,z22,z23,z3,z31,z32,z33,ze,zf,zm,zmo,zn,
 		zsing,zsinh,zsini,zcosg,zcosh,zcosi,delt=0,ft=0;
+	double span,cptime;
+	int side,k;
 
 	switch (ientry) {
 	case dpinit : /* Entrance for deep space initialization */
@@ -840,6 +842,8 @@ Deep (int ientry, sat_t *sat)
 		sat->dps.stepp = 720;
 		sat->dps.stepn = -720;
 		sat->dps.step2 = 259200;
+		sat->dps.cp_num[0] = 0;
+		sat->dps.cp_num[1] = 0;
 		/* End case dpinit: */
 		return;
 
@@ -856,6 +860,33 @@ Deep (int ientry, sat_t *sat)
 		}
 		if( ~sat->flags & RESONANCE_FLAG ) return;
 
+		/* Resume from the nearest checkpoint between epoch and t
+		   instead of stepping back towards epoch or integrating
+		   across a long jump. The checkpoints are only recorded while
+		   integrating away from epoch, so the result does not depend
+		   on the order in which times are requested. */
+		side = (sat->deep_arg.t >= 0) ? 0 : 1;
+		span = DEEP_CP_STEPS*sat->dps.stepp;
+		k = (int) (fabs(sat->deep_arg.t)/span);
+		if (k > sat->dps.cp_num[side])
+			k = sat->dps.cp_num[side];
+		cptime = (side == 0) ? k*span : -k*span;
+
+		if( ((sat->dps.atime > 0) && (sat->deep_arg.t < 0)) ||
+		    ((sat->dps.atime < 0) && (sat->deep_arg.t >= 0)) ||
+		    (fabs(sat->deep_arg.t) < fabs(sat->dps.atime)) ||
+		    (fabs(cptime) > fabs(sat->dps.atime)) ) {
+			sat->dps.atime = cptime;
+			if (k == 0) {
+				sat->dps.xni = sat->dps.xnq;
+				sat->dps.xli = sat->dps.xlamo;
+			}
+			else {
+				sat->dps.xni = sat->dps.cp_xni[side][k-1];
+				sat->dps.xli = sat->dps.cp_xli[side][k-1];
+			}
+		}
+
 		do {
 			if( (sat->dps.atime == 0) ||
 			    ((sat->deep_arg.t >= 0) && (sat->dps.atime < 0)) || 
@@ -937,6 +968,17 @@ Deep (int ientry, sat_t *sat)
 					sat->dps.xli = sat->dps.xli+xldot*delt+xndot*sat->dps.step2;
 					sat->dps.xni = sat->dps.xni+xndot*delt+xnddt*sat->dps.step2;
 					sat->dps.atime = sat->dps.atime+delt;
+
+					/* record checkpoint when moving away from epoch */
+					k = (int) (fabs(sat->dps.atime)/span);
+					if( (delt*sat->dps.atime > 0) &&
+					    (fabs(sat->dps.atime) == k*span) &&
+					    (k == sat->dps.cp_num[side]+1) &&
+					    (k <= DEEP_CP_NUM) ) {
+						sat->dps.cp_xli[side][k-1] = sat->dps.xli;
+						sat->dps.cp_xni[side][k-1] = sat->dps.xni;
+						sat->dps.cp_num[side] = k;
+					}
 				}
 			}
 			while ( (sat->flags & DO_LOOP_FLAG) &&
@@ -111,6 +111,23 @@ typedef struct {
 	double range_rate;    /*!< Velocity [km/sec] */
 } obs_set_t;
 
+/** \brief Observer frame at a given time.
+ *  \ingroup sgpsdpif
+ *
+ * Everything Calculate_Obs() needs to know about the observer, so that it
+ * can be computed once and used for any number of satellites at the same
+ * time. See Calculate_Observer_Frame().
+ */
+typedef struct {
+	double     time;      /*!< Julian date */
+	geodetic_t geodetic;  /*!< Observer position [rad, km]; theta is LMST */
+	double     thetag;    /*!< Greenwich mean sidereal time [rad] */
+	vector_t   pos;       /*!< Observer ECI position [km] */
+	vector_t   vel;       /*!< Observer ECI velocity [km/sec] */
+	double     sin_lat, cos_lat, sin_theta, cos_theta;
+	double     rot[3][3]; /*!< ECI to topocentric (south, east, zenith) */
+} obs_frame_t;
+
 typedef struct {
 	double ra;   /*!< Right Ascension [dec] */
 	double dec;  /*!< Declination [dec] */
@@ -137,6 +154,12 @@ typedef struct {
 	double x1mth2,x3thm1,x7thm1,xmcof,xmdot,xnodcf,xnodot,xlcof;
 } sgpsdp_static_t;
 
+/* Checkpoints of the deep-space resonance integrator. DEEP_CP_NUM
+   checkpoints are kept on each side of epoch, DEEP_CP_STEPS integrator
+   steps (12 hours each) apart. */
+#define DEEP_CP_NUM    32
+#define DEEP_CP_STEPS  8
+
 /* static data for DEEP */
 typedef struct {
 	double thgr,xnq,xqncl,omegaq,zmol,zmos,savtsn,ee2,e3,xi2;
@@ -147,6 +170,10 @@ typedef struct {
 	double xni,atime,stepp,stepn,step2,preep,pl,sghs,xli;
 	double d2201,d2211,sghl,sh1,pinc,pe,shs,zsingl,zcosgl;
 	double zsinhl,zcoshl,zsinil,zcosil;
+
+	/* Resonance integrator checkpoints; [0] after epoch, [1] before */
+	double cp_xli[2][DEEP_CP_NUM],cp_xni[2][DEEP_CP_NUM];
+	int    cp_num[2];
 } deep_static_t;
 
 /** \brief Satellite data structure
@@ -332,8 +359,15 @@ void    Convert_Sat_State(vector_t *pos, vector_t *vel);
 void    Calculate_User_PosVel(double _time, geodetic_t *geodetic,
                               vector_t *obs_pos, vector_t *obs_vel);
 void    Calculate_LatLonAlt(double _time, vector_t *pos, geodetic_t *geodetic);
+void    Calculate_LatLonAlt_ThetaG(double thetag, vector_t *pos,
+                                   geodetic_t *geodetic);
+void    Calculate_Observer_Frame(double _time, geodetic_t *geodetic,
+                                 obs_frame_t *frame);
+void    Calculate_Observer_Rotation(obs_frame_t *frame);
 void    Calculate_Obs(double _time, vector_t *pos, vector_t *vel,
                       geodetic_t *geodetic, obs_set_t *obs_set);
+void    Calculate_Obs_Frame(obs_frame_t *frame, vector_t *pos, vector_t *vel,
+                            obs_set_t *obs_set);
 void    Calculate_RADec_and_Obs(double _time, vector_t *pos, vector_t *vel,
 				geodetic_t *geodetic, obs_astro_t *obs_set);
 
@@ -49,13 +49,21 @@ Calculate_User_PosVel(double _time,
 /* oblate spheroid as defined in WGS '72.                     */
 void
 Calculate_LatLonAlt(double _time, vector_t *pos,  geodetic_t *geodetic)
+{
+	Calculate_LatLonAlt_ThetaG(ThetaG_JD(_time), pos, geodetic);
+} /*Procedure Calculate_LatLonAlt*/
+
+/* Same as Calculate_LatLonAlt but takes the Greenwich sidereal time */
+/* instead of the time, e.g. from an observer frame.                 */
+void
+Calculate_LatLonAlt_ThetaG(double thetag, vector_t *pos, geodetic_t *geodetic)
 {
 	/* Reference:  The 1992 Astronomical Almanac, page K12. */
 
 	double r,e2,phi,c;
 
 	geodetic->theta = AcTan(pos->y,pos->x);/*radians*/
-	geodetic->lon = FMod2p(geodetic->theta - ThetaG_JD(_time));/*radians*/
+	geodetic->lon = FMod2p(geodetic->theta - thetag);/*radians*/
 	r = sqrt(Sqr(pos->x) + Sqr(pos->y));
 	e2 = __f*(2 - __f);
 	geodetic->lat = AcTan(pos->z,r);/*radians*/
@@ -72,7 +80,7 @@ Calculate_LatLonAlt(double _time, vector_t *pos,  geodetic_t *geodetic)
 
 	if( geodetic->lat > pio2 ) geodetic->lat -= twopi;
   
-} /*Procedure Calculate_LatLonAlt*/
+} /*Procedure Calculate_LatLonAlt_ThetaG*/
 
 /*------------------------------------------------------------------*/
 
@@ -98,40 +106,91 @@ Calculate_Obs(double _time,
 	      vector_t *vel,
 	      geodetic_t *geodetic,
 	      obs_set_t *obs_set)
+{
+	obs_frame_t frame;
+
+	Calculate_Observer_Frame(_time, geodetic, &frame);
+	geodetic->theta = frame.geodetic.theta;
+	Calculate_Obs_Frame(&frame, pos, vel, obs_set);
+} /*Procedure Calculate_Obs*/
+
+/*------------------------------------------------------------------*/
+
+/* Procedure Calculate_Observer_Frame computes the observer position, */
+/* velocity and topocentric rotation at {time}. The frame can be used */
+/* with Calculate_Obs_Frame for any number of objects at that time.   */
+void
+Calculate_Observer_Frame(double _time,
+			 geodetic_t *geodetic,
+			 obs_frame_t *frame)
+{
+	frame->time = _time;
+	frame->geodetic = *geodetic;
+	frame->thetag = ThetaG_JD(_time);
+
+	Calculate_User_PosVel(_time, &frame->geodetic, &frame->pos, &frame->vel);
+
+	frame->sin_lat = sin(frame->geodetic.lat);
+	frame->cos_lat = cos(frame->geodetic.lat);
+	frame->sin_theta = sin(frame->geodetic.theta);
+	frame->cos_theta = cos(frame->geodetic.theta);
+
+	Calculate_Observer_Rotation(frame);
+} /*Procedure Calculate_Observer_Frame*/
+
+/*------------------------------------------------------------------*/
+
+/* Procedure Calculate_Observer_Rotation fills in the topocentric    */
+/* rotation of {frame} from its sin_lat, cos_lat, sin_theta and      */
+/* cos_theta, for frames whose position is computed elsewhere.       */
+void
+Calculate_Observer_Rotation(obs_frame_t *frame)
+{
+	frame->rot[0][0] = frame->sin_lat * frame->cos_theta;
+	frame->rot[0][1] = frame->sin_lat * frame->sin_theta;
+	frame->rot[0][2] = -frame->cos_lat;
+	frame->rot[1][0] = -frame->sin_theta;
+	frame->rot[1][1] = frame->cos_theta;
+	frame->rot[1][2] = 0;
+	frame->rot[2][0] = frame->cos_lat * frame->cos_theta;
+	frame->rot[2][1] = frame->cos_lat * frame->sin_theta;
+	frame->rot[2][2] = frame->sin_lat;
+} /*Procedure Calculate_Observer_Rotation*/
+
+/*------------------------------------------------------------------*/
+
+/* Same as Calculate_Obs but using a precomputed observer frame. */
+void
+Calculate_Obs_Frame(obs_frame_t *frame,
+		    vector_t *pos,
+		    vector_t *vel,
+		    obs_set_t *obs_set)
 {
 	double
-		sin_lat,cos_lat,
-		sin_theta,cos_theta,
 		el,azim,
 		top_s,top_e,top_z;
 
 	vector_t
-		obs_pos,obs_vel,range,rgvel;
+		range,rgvel;
 
-	Calculate_User_PosVel(_time, geodetic, &obs_pos, &obs_vel);
+	range.x = pos->x - frame->pos.x;
+	range.y = pos->y - frame->pos.y;
+	range.z = pos->z - frame->pos.z;
 
-	range.x = pos->x - obs_pos.x;
-	range.y = pos->y - obs_pos.y;
-	range.z = pos->z - obs_pos.z;
-
-	rgvel.x = vel->x - obs_vel.x;
-	rgvel.y = vel->y - obs_vel.y;
-	rgvel.z = vel->z - obs_vel.z;
+	rgvel.x = vel->x - frame->vel.x;
+	rgvel.y = vel->y - frame->vel.y;
+	rgvel.z = vel->z - frame->vel.z;
 
 	Magnitude(&range);
 
-	sin_lat = sin(geodetic->lat);
-	cos_lat = cos(geodetic->lat);
-	sin_theta = sin(geodetic->theta);
-	cos_theta = cos(geodetic->theta);
-	top_s = sin_lat * cos_theta * range.x
-		+ sin_lat * sin_theta * range.y
-		- cos_lat * range.z;
-	top_e = -sin_theta * range.x
-		+ cos_theta * range.y;
-	top_z = cos_lat * cos_theta * range.x
-		+ cos_lat * sin_theta * range.y
-		+ sin_lat * range.z;
+	top_s = frame->rot[0][0] * range.x
+		+ frame->rot[0][1] * range.y
+		- frame->cos_lat * range.z;
+	top_e = frame->rot[1][0] * range.x
+		+ frame->rot[1][1] * range.y;
+	top_z = frame->rot[2][0] * range.x
+		+ frame->rot[2][1] * range.y
+		+ frame->rot[2][2] * range.z;
 	azim = atan(-top_e/top_s); /*Azimuth*/
 	if( top_s > 0 ) 
 		azim = azim + pi;
@@ -150,14 +209,11 @@ Calculate_Obs(double _time,
 /* Correction is meaningless when apparent elevation is below horizon */
 //	obs_set->el = obs_set->el + Radians((1.02/tan(Radians(Degrees(el)+
 //							      10.3/(Degrees(el)+5.11))))/60);
-	if( obs_set->el >= 0 )
-		SetFlag(VISIBLE_FLAG);
-	else
-	{
+	/* VISIBLE_FLAG is not maintained: Flags is process-global and this
+	   runs in worker threads */
+	if( obs_set->el < 0 )
 		obs_set->el = el;  /*Reset to true elevation*/
-		ClearFlag(VISIBLE_FLAG);
-	} /*else*/
-} /*Procedure Calculate_Obs*/
+} /*Procedure Calculate_Obs_Frame*/
 
 /*------------------------------------------------------------------*/
 
@@ -0,0 +1,312 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \file startup-profile.c
+ * \brief Timing of the startup phases.
+ *
+ * With --profile-startup the startup phases are timed with the monotonic
+ * clock. Each phase is recorded as
+ *
+ *   start = startup_profile_begin();
+ *   ...
+ *   startup_profile_end(start, "phase", "%s", detail);
+ *
+ * When the main window has been drawn, startup_profile_finish() prints
+ * the total time per phase and writes all phases to a trace file in the
+ * Chrome trace event format, which can be opened in chrome://tracing or
+ * Perfetto. Recording then stops; without the option begin() returns 0
+ * and end() returns at once.
+ *
+ * Phases may be recorded from any thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "sat-log.h"
+#include "startup-profile.h"
+
+
+/** \brief A recorded phase. */
+typedef struct {
+    const gchar    *name;       /*!< Phase name, a string constant */
+    gchar          *detail;     /*!< E.g. module name or catalogue number */
+    gint64          start;      /*!< Start time [us] from origin */
+    gint64          dur;        /*!< Duration [us] */
+    guint           tid;        /*!< Thread number, 1 is the main thread */
+} profile_event_t;
+
+/** \brief Total time of a phase for the summary. */
+typedef struct {
+    const gchar    *name;
+    guint           count;
+    gint64          total;
+    gint64          max;
+} profile_sum_t;
+
+
+static gint     active = FALSE;
+static gchar   *trace = NULL;
+static gint64   origin = 0;
+static GArray  *events = NULL;
+static GHashTable *threads = NULL;
+static GMutex   mutex;
+
+
+/**
+ * \brief Start recording.
+ * \param tracefile The trace file to write.
+ * \param t0 Monotonic time when the program was started [us].
+ *
+ * Must be called from the main thread.
+ */
+void startup_profile_init(const gchar * tracefile, gint64 t0)
+{
+    g_return_if_fail(tracefile != NULL);
+
+    trace = g_strdup(tracefile);
+    origin = t0;
+    events = g_array_new(FALSE, FALSE, sizeof(profile_event_t));
+    threads = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_hash_table_insert(threads, g_thread_self(), GUINT_TO_POINTER(1));
+    g_atomic_int_set(&active, TRUE);
+}
+
+/** \brief Get the start time of a phase, 0 if not recording. */
+gint64 startup_profile_begin(void)
+{
+    if (!g_atomic_int_get(&active))
+        return 0;
+
+    return g_get_monotonic_time();
+}
+
+/**
+ * \brief Record a phase.
+ * \param start The value returned by startup_profile_begin().
+ * \param name Name of the phase; must be a string constant.
+ * \param fmt Optional printf format for the details, or NULL.
+ */
+void startup_profile_end(gint64 start, const gchar * name,
+                         const gchar * fmt, ...)
+{
+    profile_event_t ev;
+    gpointer        tid;
+    va_list         args;
+    gint64          now;
+
+    if (start == 0)
+        return;
+
+    now = g_get_monotonic_time();
+
+    ev.name = name;
+    ev.detail = NULL;
+    ev.start = start - origin;
+    ev.dur = now - start;
+    if (fmt != NULL)
+    {
+        va_start(args, fmt);
+        ev.detail = g_strdup_vprintf(fmt, args);
+        va_end(args);
+    }
+
+    g_mutex_lock(&mutex);
+    if (events == NULL)
+    {
+        /* finished meanwhile */
+        g_mutex_unlock(&mutex);
+        g_free(ev.detail);
+        return;
+    }
+
+    tid = g_hash_table_lookup(threads, g_thread_self());
+    if (tid == NULL)
+    {
+        tid = GUINT_TO_POINTER(g_hash_table_size(threads) + 1);
+        g_hash_table_insert(threads, g_thread_self(), tid);
+    }
+    ev.tid = GPOINTER_TO_UINT(tid);
+
+    g_array_append_val(events, ev);
+    g_mutex_unlock(&mutex);
+}
+
+/** \brief Append a string to a JSON document. */
+static void json_string(GString * json, const gchar * str)
+{
+    const gchar    *p;
+
+    g_string_append_c(json, '"');
+    for (p = str; *p != '\0'; p++)
+    {
+        if (*p == '"' || *p == '\\')
+            g_string_append_printf(json, "\\%c", *p);
+        else if ((guchar) * p < 0x20)
+            g_string_append_printf(json, "\\u%04x", (guchar) * p);
+        else
+            g_string_append_c(json, *p);
+    }
+    g_string_append_c(json, '"');
+}
+
+static void write_trace(GArray * evs)
+{
+    profile_event_t *ev;
+    GString        *json;
+    GError         *err = NULL;
+    guint           i;
+
+    json = g_string_new("{\"traceEvents\":[\n");
+    for (i = 0; i < evs->len; i++)
+    {
+        ev = &g_array_index(evs, profile_event_t, i);
+
+        g_string_append(json, "{\"name\":");
+        json_string(json, ev->name);
+        g_string_append_printf(json, ",\"cat\":\"startup\",\"ph\":\"X\","
+                               "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%"
+                               G_GINT64_FORMAT ",\"pid\":1,\"tid\":%u",
+                               ev->start, ev->dur, ev->tid);
+        if (ev->detail != NULL)
+        {
+            g_string_append(json, ",\"args\":{\"detail\":");
+            json_string(json, ev->detail);
+            g_string_append_c(json, '}');
+        }
+        g_string_append(json, (i + 1 < evs->len) ? "},\n" : "}\n");
+    }
+    g_string_append(json, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    if (!g_file_set_contents(trace, json->str, json->len, &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not write startup trace (%s)"),
+                    __func__, err->message);
+        g_clear_error(&err);
+    }
+
+    g_string_free(json, TRUE);
+}
+
+static gint compare_total(gconstpointer a, gconstpointer b)
+{
+    const profile_sum_t *sa = a;
+    const profile_sum_t *sb = b;
+
+    return (sa->total < sb->total) - (sa->total > sb->total);
+}
+
+static void print_summary(GArray * evs, gint64 total)
+{
+    profile_event_t *ev;
+    profile_sum_t  *sum;
+    GArray         *sums;
+    guint           i, j;
+
+    /* sum up by phase name */
+    sums = g_array_new(FALSE, TRUE, sizeof(profile_sum_t));
+    for (i = 0; i < evs->len; i++)
+    {
+        ev = &g_array_index(evs, profile_event_t, i);
+
+        for (j = 0; j < sums->len; j++)
+            if (!strcmp(g_array_index(sums, profile_sum_t, j).name, ev->name))
+                break;
+        if (j == sums->len)
+        {
+            g_array_set_size(sums, j + 1);
+            g_array_index(sums, profile_sum_t, j).name = ev->name;
+        }
+
+        sum = &g_array_index(sums, profile_sum_t, j);
+        sum->count++;
+        sum->total += ev->dur;
+        sum->max = MAX(sum->max, ev->dur);
+    }
+    g_array_sort(sums, compare_total);
+
+    g_print(_("Startup took %.1f ms (trace in %s)\n"), total / 1000.0, trace);
+    g_print("  %-28s %8s %12s %12s\n", _("Phase"), _("Count"),
+            _("Total [ms]"), _("Max [ms]"));
+    for (j = 0; j < sums->len; j++)
+    {
+        sum = &g_array_index(sums, profile_sum_t, j);
+        g_print("  %-28s %8u %12.1f %12.1f\n", sum->name, sum->count,
+                sum->total / 1000.0, sum->max / 1000.0);
+    }
+
+    g_array_free(sums, TRUE);
+}
+
+/**
+ * \brief Stop recording, print the summary and write the trace.
+ *
+ * Must be called from the main thread once startup is complete.
+ */
+void startup_profile_finish(void)
+{
+    GArray         *done;
+    gint64          total;
+    guint           i;
+
+    if (!g_atomic_int_get(&active))
+        return;
+
+    total = g_get_monotonic_time() - origin;
+    startup_profile_end(origin, "startup", NULL);
+
+    g_atomic_int_set(&active, FALSE);
+    g_mutex_lock(&mutex);
+    done = events;
+    events = NULL;
+    g_mutex_unlock(&mutex);
+
+    print_summary(done, total);
+    write_trace(done);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Startup took %.1f ms, trace written to %s"),
+                __func__, total / 1000.0, trace);
+
+    for (i = 0; i < done->len; i++)
+        g_free(g_array_index(done, profile_event_t, i).detail);
+    g_array_free(done, TRUE);
+
+    g_hash_table_destroy(threads);
+    threads = NULL;
+    g_free(trace);
+    trace = NULL;
+}
@@ -0,0 +1,147 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+/**
+ * \brief Solar terminator shared by all map views.
+ *
+ * Each map view used to compute the terminator with trigonometry on every
+ * update. The terminator is now computed once per update interval and the
+ * most recent results are kept, so that every map view of every module
+ * running at about the same time uses the same table.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <math.h>
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+#include "terminator.h"
+
+
+/** \brief Number of intervals kept, for modules running at different times. */
+#define TERMINATOR_SLOTS 4
+
+
+static void     terminator_compute(terminator_t * term, gdouble tstamp);
+
+static terminator_t cache[TERMINATOR_SLOTS];
+static gboolean valid[TERMINATOR_SLOTS];
+static guint    next_slot = 0;
+
+
+/**
+ * \brief Get the solar terminator.
+ * \param tstamp The time [Julian days].
+ * \return The terminator at the start of the update interval containing
+ *         tstamp. The pointer is owned by the cache and is only valid until
+ *         the next call with a time in a different interval.
+ */
+const terminator_t *terminator_get(gdouble tstamp)
+{
+    gdouble         start;
+    guint           i;
+
+    start = floor(tstamp / TERMINATOR_UPDATE_INTERVAL) *
+        TERMINATOR_UPDATE_INTERVAL;
+
+    for (i = 0; i < TERMINATOR_SLOTS; i++)
+    {
+        if (valid[i] && (cache[i].tstamp == start))
+            return &cache[i];
+    }
+
+    i = next_slot;
+    next_slot = (next_slot + 1) % TERMINATOR_SLOTS;
+
+    terminator_compute(&cache[i], start);
+    valid[i] = TRUE;
+
+    return &cache[i];
+}
+
+
+static inline gdouble sgn(gdouble const t)
+{
+    return t < 0.0 ? -1.0 : 1.0;
+}
+
+
+/** \brief Compute the terminator latitude at each degree of longitude. */
+static void terminator_compute(terminator_t * term, gdouble tstamp)
+{
+    /* Vector normal to plane containing a line of longitude (z component is
+       always zero). */
+    /* Note: our coordinates have z along the Earth's axis, x pointing through the
+       intersection of the Greenwich Meridian and the Equator, and y right-handedly
+       perpendicular to both. */
+    gdouble         lx, ly;
+
+    /* The position of the sun as latitude, longitude. */
+    geodetic_t      geodetic;
+
+    /* Vector which points from the centre of the Earth to the Sun in inertial
+       coordinates. */
+    vector_t        sun_;
+
+    /* The same vector in geodesic coordinates. */
+    gdouble         sx, sy, sz;
+
+    /* Vector cross-product of (lx,ly,lz) and sun vector. */
+    gdouble         rx, ry, rz;
+
+    gdouble         length;
+    gint            longitude;
+
+    Calculate_Solar_Position(tstamp, &sun_);
+    Calculate_LatLonAlt(tstamp, &sun_, &geodetic);
+
+    sx = cos(geodetic.lat) * cos(geodetic.lon);
+    sy = cos(geodetic.lat) * sin(-geodetic.lon);
+    sz = sin(geodetic.lat);
+
+    for (longitude = -180; longitude <= 180; ++longitude)
+    {
+        lx = cos(de2ra * (longitude + sgn(sz) * 90));
+        ly = sin(de2ra * (longitude + sgn(sz) * 90));
+        /* lz = 0.0; */
+
+        rx = ly * sz /* -lz*sy */ ;
+        ry = /* lz*sx */ -lx * sz;
+        rz = -lx * sy - ly * sx;
+
+        length = sqrt(rx * rx + ry * ry + rz * rz);
+        term->lat[longitude + 180] = asin(rz / length) * (1.0 / de2ra);
+    }
+
+    term->tstamp = tstamp;
+    term->sunlat = Degrees(geodetic.lat);
+    term->sunlon = Degrees(geodetic.lon);
+    term->nightlat = sz < 0.0 ? 90.0 : -90.0;
+}
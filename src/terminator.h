@@ -0,0 +1,58 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2013  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef TERMINATOR_H
+#define TERMINATOR_H 1
+
+#include <glib.h>
+
+
+/** \brief Time between terminator updates [days]. */
+#define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
+
+/** \brief Number of longitudes in the terminator table, -180 to 180. */
+#define TERMINATOR_POINTS   361
+
+
+/** \brief The solar terminator at a given time.
+ *
+ * The terminator is stored as a table of latitudes at each whole degree of
+ * longitude. Map views only need to scale the table to their size, so the
+ * trigonometry is done once per update interval for all views.
+ */
+typedef struct {
+    gdouble     tstamp;     /*!< Time of the computation (start of interval) */
+    gdouble     sunlat;     /*!< Latitude of the subsolar point [deg] */
+    gdouble     sunlon;     /*!< Longitude of the subsolar point [deg] */
+    gdouble     nightlat;   /*!< Latitude of the pole in darkness, +/-90 [deg] */
+    gdouble     lat[TERMINATOR_POINTS]; /*!< Latitude at longitude -180+i [deg] */
+} terminator_t;
+
+
+const terminator_t *terminator_get (gdouble tstamp);
+
+#endif
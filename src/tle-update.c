@@ -1115,7 +1115,6 @@ static void update_tle_in_file (const gchar *ldname,
     guint      total   = 0;  /* total no. of sats in gpredict tle file */
     gchar    **catstr;
     guint      catnr;
-    guint     *key = NULL;
     tle_t      tle;
     new_tle_t *ntle;
     op_stat_t  status;
@@ -1130,10 +1129,7 @@ static void update_tle_in_file (const gchar *ldname,
     
 
     /* see if we have new data for this satellite */
-    key = g_try_new0 (guint, 1);
-    *key = catnr;
-    ntle = (new_tle_t *) g_hash_table_lookup (data, key);
-    g_free (key);
+    ntle = (new_tle_t *) g_hash_table_lookup (data, &catnr);
 
     if (ntle == NULL) {
         /* no new data found for this sat => obsolete */
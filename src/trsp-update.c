@@ -29,16 +29,16 @@
  * information into satellite files identified by catalog id
  */
 #include <curl/curl.h>
+#include <string.h>
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
-#include <locale.h>
 
 #include "compat.h"
 #include "trsp-update.h"
 #include "gpredict-utils.h"
-#include "nxjson/nxjson.h"
+#include "json-stream.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 
@@ -55,314 +55,284 @@ typedef enum {
     TRSP_AUTO_UPDATE_NUM
 } trsp_auto_upd_freq_t;
 
-/*
- * Frequency information is an json array, nxjson does not support json kbject
- * arrays this struct is used to manipulate the json object array
- */
-typedef enum {
-    START = 0,          /* starting point */
-    OBBGN,              /* new obbject starts here */
-    OBEND,              /* objct end here, next char should be delimiter (comma) or next obect start, or array end */
-    NXDLM,              /* we have the delimiter, next one will be new object */
-    FINISH              /* array fineshes here */
-} m_state;
-
 /* Data structure to hold a TRSP set. */
 struct transponder {
-    char            uuid[30];           /* uuid */
     int             catnum;             /* Catalog number. */
-    char            description[99];    /* Transponder descriptoion */
+    gchar          *description;        /* Transponder descriptoion */
     long long       uplink_low;         /* Uplink starting frequency */
     long long       uplink_high;        /* uplink end frequency  */
     long long       downlink_low;       /* downlink starting frequency */
     long long       downlink_high;      /* downlink end frequency */
-    char            mode[20];           /* mode (from modes files) */
+    gint            mode_id;            /* mode (from modes files) */
     int             invert;             /* inverting / noninverting */
     double          baud;               /* baudrate */
     int             alive;              /* alive or dead */
 };
 
-/* Data structure to hold a MODES set. */
-struct modes {
-    int             id;         /* id */
-    char            name[99];   /* Mode name */
-};
-
-/* Data structure to hold a MODE set. */
-typedef struct {
-    guint    modnum;  /* Mode number. */
-    gchar   *modname; /* Mode description. */
-} new_mode_t;
-
-/* Data structure to hold a TRSP list. */
+/* State of the JSON readers in trsp_update_files(). */
 typedef struct {
-    guint    catnum;  /* Catalog number. */
-    guint    numtrsp; /* Number of transponders. */
-} new_trsp_t;
+    GHashTable     *modes;      /* mode names keyed by mode ID */
+    GHashTable     *files;      /* .trsp contents (GString) keyed by catnum */
+    gint            mode_id;    /* ID of the mode being read */
+    gchar          *mode_name;  /* Name of the mode being read */
+    struct transponder trsp;    /* Transmitter being read */
+    guint           count;      /* Number of objects read */
+} trsp_reader_t;
 
 /* private function prototypes */
 static size_t   my_write_func(void *ptr, size_t size, size_t nmemb,
                               FILE * stream);
 
-//int getMODElist_intoHashMap();
+/* The records are the objects in the top level array of each file. */
+#define TRSP_RECORD_DEPTH 1
 
-//static void check_and_print_mode(gpointer key, gpointer value, gpointer user_data)
-//{
-//    new_mode_t  *nmode = (new_mode_t *) value;
-//    guint      *num = user_data;
-//
-//    *num += 1;
-//
-//    (void) key; /* avoid unused parameter compiler warning */
-//
-//    printf("MODES LIST : %d %s \n", nmode->modnum, nmode->modname);
-//
-//}
+/** Start of a record in modes.json or transmitters.json. */
+static void trsp_record_start(gpointer data, const gchar * key, guint depth)
+{
+    trsp_reader_t  *rd = data;
 
+    (void)key;                  /* avoid unused parameter compiler warning */
 
-/** Free a new_mode_t structure. */
-static void free_new_mode (gpointer data)
-{
-	//TODO: remove this.
-    new_mode_t *mmode;
+    if (depth != TRSP_RECORD_DEPTH)
+        return;
 
-    mmode = (new_mode_t *) data;
+    rd->mode_id = -1;
+    g_free(rd->mode_name);
+    rd->mode_name = NULL;
 
-    g_free (mmode->modname);
-    g_free (mmode);
+    g_free(rd->trsp.description);
+    memset(&rd->trsp, 0, sizeof(rd->trsp));
+    rd->trsp.mode_id = -1;
 }
 
-/** Free a new_trsp_t structure. */
-static void free_new_trsp (gpointer data)
+/** Member of a modes.json record. */
+static void mode_value(gpointer data, const gchar * key, guint depth,
+                       json_stream_type_t type, const gchar * text)
 {
-	//TODO: remove this.
-    new_trsp_t *mtrsp;
-    mtrsp = (new_trsp_t *) data;
+    trsp_reader_t  *rd = data;
+
+    if (depth != TRSP_RECORD_DEPTH + 1)
+        return;
 
-    g_free (mtrsp);
+    if (type == JSON_STREAM_NUMBER && !strcmp(key, "id"))
+    {
+        rd->mode_id = (gint) g_ascii_strtoll(text, NULL, 10);
+    }
+    else if (type == JSON_STREAM_STRING && !strcmp(key, "name"))
+    {
+        g_free(rd->mode_name);
+        rd->mode_name = g_strdup(text);
+    }
 }
 
-void trsp_update_files(gchar * input_file)
+/** End of a modes.json record. */
+static void mode_end(gpointer data, guint depth)
 {
+    trsp_reader_t  *rd = data;
 
-    FILE           *mfp;                /* transmitter information json file */
-    FILE           *ffile;              /* transponder output file in gpredict format */
-    char            symbol;             /* characters to read from json file */
-    char            jsn_object[10000];  /* json array will be in this buffer before parsing */
-    m_state         jsn_state = START;  /* json parsing state */
-    new_mode_t     *nmode;
-    new_trsp_t	   *ntrsp;
-    GHashTable     *modes_hash;         /* hash table to store modes */
-    GHashTable	   *trsp_hash;          /* hash table to store satellite list to generate trsp files */
-    guint          *key = NULL;
+    if (depth != TRSP_RECORD_DEPTH || rd->mode_id < 0 ||
+        rd->mode_name == NULL)
+        return;
 
-    gchar          *userconfdir;
-    gchar          *trspfile;
-    gchar          *modesfile;
-    gchar          *trspfolder;
+    if (g_hash_table_lookup(rd->modes, GINT_TO_POINTER(rd->mode_id)) == NULL)
+    {
+        g_hash_table_insert(rd->modes, GINT_TO_POINTER(rd->mode_id),
+                            rd->mode_name);
+        rd->mode_name = NULL;
+    }
+    rd->count++;
+}
 
-    /* force decimal mark to dot when parsing JSON file */
-    setlocale(LC_NUMERIC, "C");
+/** Member of a transmitters.json record. */
+static void trsp_value(gpointer data, const gchar * key, guint depth,
+                       json_stream_type_t type, const gchar * text)
+{
+    struct transponder *trsp = &((trsp_reader_t *) data)->trsp;
 
-    modes_hash = g_hash_table_new_full (g_int_hash, g_int_equal, g_free, free_new_mode);
-    trsp_hash = g_hash_table_new_full (g_int_hash, g_int_equal, g_free, free_new_trsp);
+    if (depth != TRSP_RECORD_DEPTH + 1)
+        return;
 
-    userconfdir = get_user_conf_dir();
-    trspfolder = g_strconcat(userconfdir, G_DIR_SEPARATOR_S, "trsp", NULL);
-    modesfile = g_strconcat(trspfolder, "/modes.json", NULL);
+    if (type == JSON_STREAM_STRING)
+    {
+        if (!strcmp(key, "description"))
+        {
+            g_free(trsp->description);
+            trsp->description = g_strdup(text);
+        }
+    }
+    else if (type == JSON_STREAM_BOOL)
+    {
+        if (!strcmp(key, "invert"))
+            trsp->invert = !strcmp(text, "true");
+        else if (!strcmp(key, "alive"))
+            trsp->alive = !strcmp(text, "true");
+    }
+    else if (type == JSON_STREAM_NUMBER)
+    {
+        if (!strcmp(key, "norad_cat_id"))
+            trsp->catnum = (int)g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "uplink_low"))
+            trsp->uplink_low = g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "uplink_high"))
+            trsp->uplink_high = g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "downlink_low"))
+            trsp->downlink_low = g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "downlink_high"))
+            trsp->downlink_high = g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "mode_id"))
+            trsp->mode_id = (gint) g_ascii_strtoll(text, NULL, 10);
+        else if (!strcmp(key, "baud"))
+            trsp->baud = g_ascii_strtod(text, NULL);
+    }
+}
 
-    sprintf(jsn_object, " ");   /* initialize buffer */
-    mfp = fopen(modesfile, "r");
+/** End of a transmitters.json record; append it to the .trsp file. */
+static void trsp_end(gpointer data, guint depth)
+{
+    trsp_reader_t  *rd = data;
+    struct transponder *trsp = &rd->trsp;
+    GString        *fcontent;
+    const gchar    *mode;
+
+    if (depth != TRSP_RECORD_DEPTH)
+        return;
 
-    if (mfp != NULL)
+    if (trsp->catnum <= 0 || trsp->description == NULL)
     {
-        while ((symbol = getc(mfp)) != EOF)
-        {
-            if (symbol == '[')
-                jsn_state = START;
-            if (((jsn_state == START) || (jsn_state == NXDLM)) &&
-                (symbol == '{'))
-                jsn_state = OBBGN;
-            if ((jsn_state == OBBGN) && (symbol == '}'))
-                jsn_state = OBEND;
-            if ((jsn_state == OBEND) && (symbol == ','))
-                jsn_state = NXDLM;
-            if ((jsn_state == OBEND) && (symbol == ']'))
-                jsn_state = FINISH;
-            if (jsn_state == OBBGN)
-                sprintf(jsn_object, "%s%c", jsn_object, symbol);
-            if (jsn_state == OBEND)
-            {
-            	sprintf(jsn_object, "%s}", jsn_object);
-                const nx_json  *json = nx_json_parse(jsn_object, 0);
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Skipping transmitter without satellite or name"),
+                    __func__);
+        return;
+    }
+
+    fcontent = g_hash_table_lookup(rd->files, GINT_TO_POINTER(trsp->catnum));
+    if (fcontent == NULL)
+    {
+        fcontent = g_string_sized_new(512);
+        g_hash_table_insert(rd->files, GINT_TO_POINTER(trsp->catnum),
+                            fcontent);
+    }
 
-                if (json)
-                {
-                    struct modes m_modes;
-                    m_modes.id = nx_json_get(json, "id")->int_value;
-                    strcpy(m_modes.name , nx_json_get(json, "name")->text_value);
+    g_string_append_printf(fcontent, "\n[%s]\n", trsp->description);
+    if (trsp->uplink_low > 0)
+        g_string_append_printf(fcontent, "UP_LOW=%lld\n", trsp->uplink_low);
+    if (trsp->uplink_high > 0)
+        g_string_append_printf(fcontent, "UP_HIGH=%lld\n", trsp->uplink_high);
+    if (trsp->downlink_low > 0)
+        g_string_append_printf(fcontent, "DOWN_LOW=%lld\n",
+                               trsp->downlink_low);
+    if (trsp->downlink_high > 0)
+        g_string_append_printf(fcontent, "DOWN_HIGH=%lld\n",
+                               trsp->downlink_high);
+
+    mode = g_hash_table_lookup(rd->modes, GINT_TO_POINTER(trsp->mode_id));
+    if (mode != NULL)
+        g_string_append_printf(fcontent, "MODE=%s\n", mode);
+    else
+        g_string_append_printf(fcontent, "MODE=%d\n", MAX(trsp->mode_id, 0));
 
-                    /* add data to hash table */
-                    key = g_try_new0(guint, 1);
-                    *key = m_modes.id;
+    if (trsp->baud > 0.0)
+        g_string_append_printf(fcontent, "BAUD=%.0f\n", trsp->baud);
+    if (trsp->invert)
+        g_string_append_printf(fcontent, "INVERT=%s\n", "true");
 
-                    nmode = g_hash_table_lookup (modes_hash, key);
+    rd->count++;
+}
 
-                    if (nmode == NULL)
-                    {
-                        /* create new_mode structure */
-                        nmode = g_try_new(new_mode_t, 1);
-                        nmode->modnum = m_modes.id;
-                        nmode->modname = g_strdup(m_modes.name);
+/** Free the contents of a .trsp file. */
+static void free_trsp_content(gpointer data)
+{
+    g_string_free((GString *) data, TRUE);
+}
 
-                        g_hash_table_insert(modes_hash, key, nmode);
+/**
+ * Create .trsp files from the SatNOGS database.
+ *
+ * @param input_file The transmitters.json file; modes.json is expected in
+ *                   the same folder as the .trsp files.
+ *
+ * Both files are read in a single streaming pass each. The contents of the
+ * .trsp files are collected in memory and written when the whole database
+ * has been read, so that a damaged download does not leave half of the
+ * files updated.
+ */
+void trsp_update_files(gchar * input_file)
+{
+    static const json_stream_cb_t mode_cb = {
+        trsp_record_start, mode_end, NULL, NULL, mode_value
+    };
+    static const json_stream_cb_t trsp_cb = {
+        trsp_record_start, trsp_end, NULL, NULL, trsp_value
+    };
+
+    trsp_reader_t   rd;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    GError         *err = NULL;
+    guint           nfiles = 0;
 
-                    }
+    gchar          *userconfdir;
+    gchar          *trspfile;
+    gchar          *modesfile;
+    gchar          *trspfolder;
 
-                    sat_log_log(SAT_LOG_LEVEL_INFO, _("MODE %d %s"), m_modes.id, m_modes.name);
-                    nx_json_free(json);
-                } // if(json)
+    memset(&rd, 0, sizeof(rd));
+    rd.modes = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                     NULL, g_free);
+    rd.files = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                     NULL, free_trsp_content);
 
-                sprintf(jsn_object, " "); // empty the buffer
-            } //if(OBEND)
-        }  //while(symbol)
-        fclose(mfp);
-    } //if(mfp)
+    userconfdir = get_user_conf_dir();
+    trspfolder = g_strconcat(userconfdir, G_DIR_SEPARATOR_S, "trsp", NULL);
+    modesfile = g_strconcat(trspfolder, "/modes.json", NULL);
 
-//    guint num = 0;
-//    printf("---------- PRINTING MODES LIST ------- \n");
-//    g_hash_table_foreach (modes_hash, check_and_print_mode, &num);
+    /* without the modes the transponders get the numeric mode ID */
+    json_stream_parse_file(modesfile, &mode_cb, &rd);
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Read %d modes"), __func__,
+                rd.count);
 
-    sprintf(jsn_object, " ");   // initialize buffer
-    mfp = fopen(input_file, "r");
-    if (mfp != NULL)
+    rd.count = 0;
+    if (json_stream_parse_file(input_file, &trsp_cb, &rd))
     {
-        while ((symbol = getc(mfp)) != EOF)
+        g_hash_table_iter_init(&iter, rd.files);
+        while (g_hash_table_iter_next(&iter, &key, &value))
         {
-            if (symbol == '[')
-                jsn_state = START;
-            if (((jsn_state == START) || (jsn_state == NXDLM)) &&
-                (symbol == '{'))
-                jsn_state = OBBGN;
-            if ((jsn_state == OBBGN) && (symbol == '}'))
-                jsn_state = OBEND;
-            if ((jsn_state == OBEND) && (symbol == ','))
-                jsn_state = NXDLM;
-            if ((jsn_state == OBEND) && (symbol == ']'))
-                jsn_state = FINISH;
-
-            if (jsn_state == OBBGN)
-                sprintf(jsn_object, "%s%c", jsn_object, symbol);
-
-            if (jsn_state == OBEND)
+            trspfile = g_strdup_printf("%s%s%d.trsp", trspfolder,
+                                       G_DIR_SEPARATOR_S,
+                                       GPOINTER_TO_INT(key));
+
+            if (g_file_set_contents(trspfile, ((GString *) value)->str,
+                                    ((GString *) value)->len, &err))
+            {
+                nfiles++;
+            }
+            else
             {
-                sprintf(jsn_object, "%s}", jsn_object);
-                const nx_json  *json = nx_json_parse(jsn_object, 0);
-
-                if (json)
-                {
-                    struct transponder m_trsp;
-
-                    strcpy(m_trsp.description, nx_json_get(json, "description")->text_value);
-                    m_trsp.catnum        = nx_json_get(json, "norad_cat_id")->int_value;
-                    m_trsp.uplink_low    = nx_json_get(json, "uplink_low")->int_value;
-                    m_trsp.uplink_high   = nx_json_get(json, "uplink_high")->int_value;
-                    m_trsp.downlink_low  = nx_json_get(json, "downlink_low")->int_value;
-                    m_trsp.downlink_high = nx_json_get(json, "downlink_high")->int_value;
-
-                    key = g_try_new0 (guint, 1);
-                    *key = nx_json_get(json, "mode_id")->int_value;
-                    nmode = g_hash_table_lookup (modes_hash, key);
-                    if (nmode != NULL)
-						sprintf(m_trsp.mode,"%s",nmode->modname);
-                    else
-						sprintf(m_trsp.mode,"%lli",nx_json_get(json, "mode_id")->int_value);
-
-                    m_trsp.invert = nx_json_get(json, "invert")->int_value;
-                    m_trsp.baud   = nx_json_get(json, "baud")->dbl_value;
-                    m_trsp.alive  = nx_json_get(json, "alive")->int_value;
-
-                    //strcpy(m_trsp.uuid,nx_json_get(json,              "uuid")->text_value);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(">>> Preparing information for transponders of cat_id %d <<<"), m_trsp.catnum, __func__);
-                    ////sat_log_log (SAT_LOG_LEVEL_INFO, _("         uuid : %s"), m_trsp.uuid, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  description : %s"), m_trsp.description, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("        alive : %s"), m_trsp.alive ? "true" : "false", __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("   uplink_low : %Ld"),m_trsp.uplink_low, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  uplink_high : %Ld"),m_trsp.uplink_high, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" downink_low  : %Ld"),m_trsp.downlink_low, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("downlink_high : %Ld"),m_trsp.downlink_high, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Mode : %s"), m_trsp.mode, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("       Invert : %s"), m_trsp.invert ? "true" : "false", __func__);
-                    // sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Baud : %lf"),m_trsp.baud, __func__);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" norad_cat_id : %Ld"),m_trsp.catnum, __func__);
-                    char            m_catnum[20];
-
-                    sprintf(m_catnum, "%d", m_trsp.catnum);
-                    trspfile = g_strconcat(trspfolder, G_DIR_SEPARATOR_S,
-                                           m_catnum,".trsp", NULL);
-                    //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Writing to file : %s "), __func__, trspfile);
-
-                    //first lets delete the file we already have, to make space for the new version
-                    /* check existence and add data to hash table for future check */
-                    key = g_try_new0(guint, 1);
-                    *key = m_trsp.catnum;
-                    ntrsp = g_hash_table_lookup(trsp_hash, key);
-
-                    if (ntrsp == NULL)
-                    {
-                        /* create new_trsp structure */
-                        ntrsp = g_try_new (new_trsp_t, 1);
-                        ntrsp->catnum  = m_trsp.catnum;
-                        ntrsp->numtrsp = 1; //our first insertion of transponder to this file
-                        g_hash_table_insert(trsp_hash, key, ntrsp);
-                        g_remove(trspfile);
-
-                    }
-                    else
-                    {
-                    	//TODO: increase number of transponders here
-                        //ntrsp->numtrsp += 1; //number of transponder info in this file
-                        //g_hash_table_replace(trsp_hash, key, ntrsp);
-                    }
-
-                    //now lets write the new version
-                    ffile = g_fopen(trspfile, "a");
-                    if (ffile != NULL)
-                    {
-                        char            fcontent[1000];
-
-                        sprintf(fcontent, "\n[%s]\n", m_trsp.description);
-                        if (m_trsp.uplink_low > 0)
-                            sprintf(fcontent, "%sUP_LOW=%lld\n", fcontent, m_trsp.uplink_low);
-                        if (m_trsp.uplink_high > 0)
-                            sprintf(fcontent, "%sUP_HIGH=%lld\n", fcontent, m_trsp.uplink_high);
-                        if (m_trsp.downlink_low > 0)
-                            sprintf(fcontent, "%sDOWN_LOW=%lld\n", fcontent, m_trsp.downlink_low);
-                        if (m_trsp.downlink_high > 0)
-                            sprintf(fcontent, "%sDOWN_HIGH=%lld\n", fcontent, m_trsp.downlink_high);
-                        sprintf(fcontent, "%sMODE=%s\n", fcontent, m_trsp.mode);
-                        if (m_trsp.baud > 0.0)
-                            sprintf(fcontent, "%sBAUD=%.0f\n", fcontent, m_trsp.baud);
-                        if (m_trsp.invert)
-                            sprintf(fcontent, "%sINVERT=%s\n", fcontent, "true");
-                        fputs(fcontent, ffile);
-                        fclose(ffile);
-                    }
-                    else
-                    {
-                        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                    _("%s: Could not open trsp file for write"),
-                                    __func__);
-                    }
-                    nx_json_free(json);
-                } // if(json)
-                sprintf(jsn_object, " ");       //empty the buffer
-            } // if(OBEND)
-        } // while(symbol)
-        fclose(mfp);
-    } // if(mfp)
-
-    g_hash_table_destroy(modes_hash);
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: Could not write %s (%s)"),
+                            __func__, trspfile, err->message);
+                g_clear_error(&err);
+            }
+            g_free(trspfile);
+        }
+
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Wrote %d transponders to %d files"),
+                    __func__, rd.count, nfiles);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Transponder files not updated"), __func__);
+    }
+
+    g_free(rd.mode_name);
+    g_free(rd.trsp.description);
+    g_hash_table_destroy(rd.modes);
+    g_hash_table_destroy(rd.files);
+    g_free(userconfdir);
+    g_free(trspfolder);
+    g_free(modesfile);
 }
 
 /** Update MODES files from network. */